@@ -2,6 +2,10 @@ rm memc.a
 rm memc.o
 rm main.o
 rm memc
+rm memc_bench.o memc-bench
+rm memc_mock.o memc-mock
+rm memc_replay.o memc-replay
+rm memc_micro.o memc-micro
 
 rm test.o
 rm test
@@ -7,8 +7,8 @@ LIBCBPATH="../run/lib"
 CC="/usr/bin/clang -std=c11"
 LD="/usr/bin/clang -v "
 
-SRCS=" main.c memc.c "
-OBJS=" memc.o "
+SRCS=" main.c memc.c memc_sidecar.c memc_log.c memc_bench.c memc_mock.c memc_replay.c "
+OBJS=" memc.o memc_sidecar.o memc_log.o "
 FSRCS=" ./ext/get_option.c ./ext/ipvxurlformat.c ./ext/ipvxformat.c "
 FOBJS=" ./get_option.o ./ipvxurlformat.o ./ipvxformat.o "
 FLAGS=" -O0 -g -Weverything -fPIC -I. -I/usr/include -I../include "
@@ -19,7 +19,7 @@ for OBJ in $OBJS $FOBJS
    rm $OBJ
 done
 
-rm main.o
+rm main.o memc_bench.o memc_mock.o memc_micro.o memc_replay.o
 
 for I in $SRCS $FSRCS
  do
@@ -31,9 +31,22 @@ done
 #echo "LINKER: $LD $LDFLAGS $OBJS main.o $FOBJS -o memc"
 $LD -lcb -L. $LDFLAGS $OBJS main.o $FOBJS -o memc
 
+# Load generator, 19.10.2026
+$LD -lcb -L. $LDFLAGS $OBJS memc_bench.o $FOBJS -lm -o memc-bench
+
+# Replay of a capture, 19.10.2026
+$LD -lcb -L. $LDFLAGS $OBJS memc_replay.o $FOBJS -o memc-replay
+
+# Mock memcached, 19.10.2026
+$LD $LDFLAGS memc_mock.o ./get_option.o -o memc-mock
+
+# Microbenchmarks, 19.10.2026: memc.c is included, -O2
+$CC $FLAGS -O2 -c memc_micro.c
+$LD -lcb -L. $LDFLAGS memc_micro.o memc_log.o $FOBJS -o memc-micro
+
 $LD -shared -Wl -lcb -L. $LDFLAGS -o ./libmemc.so $OBJS
 
 rm memc.a
-rm main.o
+rm main.o memc_bench.o memc_mock.o memc_micro.o memc_replay.o
 ar -rcs memc.a $OBJS $FOBJS
 
@@ -8,26 +8,57 @@
 #include <sys/socket.h> // getaddrinfo
 #include <netdb.h>      // getaddrinfo
 #include <netinet/in.h> // IPPROTO_TCP
+#include <signal.h>     // sigaction
+#include <time.h>       // clock_gettime
+#include <arpa/inet.h>  // htons, ntohl
+#include <unistd.h>     // close
+#include <sys/stat.h>   // fstat
+#include <sys/mman.h>   // mmap
 
 
 #include "../include/ipvxformat.h"
 #include "../include/get_option.h"
 #include "../include/cb_buffer.h"
 #include "./memc.h"
+#include "./memc_sidecar.h"
 
 #define MEMCPORTLEN 10
 
 #define EXPIRATION  120
 
+#define MEMCSLOWLOGENTRIES 64
+
+/*
+ * Batch mode, 19.10.2026. The keys and values of the SETs and DELETEs in progress are
+ * kept in the arena, the writes are sent with memc_write_batch after MEMCBATCHWINDOW
+ * commands, if the arena is full and before a GET or a TOUCH. */
+#define MEMCBATCHARENA     ( 4*1024*1024 )
+#define MEMCBATCHWINDOW    256
+#define MEMCBATCHMAXVALUE  ( 1024*1024 )
+#define MEMCBATCHHDRLEN    7      // opcode, key length and value length (expiration of TOUCH)
+#define MEMCBATCHRESLEN    9      // opcode, status, key length and value length
+
+
 int  main( int argc, char *argv[] );
 static int get_ip_and_port(unsigned char **ip, int *iplen, unsigned char **port, int *portlen, char *ipandport[], int len);
 
 void usage( char *progname[] );
+static void sidecar_stop( int sig );
+static void slowlog_print( MEMC *cm );
+static int  batch_run( MEMC *cm, FILE *in, char binary, ushort expiration );
+static int  batch_read_text( FILE *in, char **line, size_t *linecap, int *opcode, uchar **key, int *keylen, uchar **value, int *valuelen, long lineno );
+static int  batch_read_binary( FILE *in, uchar *buf, int buflen, int *opcode, uchar **key, int *keylen, uchar **value, int *valuelen );
+static void batch_result( char binary, int opcode, uchar *key, int keylen, uchar *value, int valuelen, int err );
+static long batch_flush( MEMC *cm, memc_batch_op *writes, int count, char binary ); // returns the number of errors
+static int  load_run( MEMC *cm, char *path, int window, ushort expiration );
+static void load_progress( void *arg, memc_load_stats *st );
 
 void usage (char *progname[]){
         fprintf(stderr,"Usage:\n");
         fprintf(stderr,"\t%s [-g][-s][-d][-q][-h] [ -i <host ip> ] [ -r <number of servers to copy the data> ] \\\n", progname[0]);
-        fprintf(stderr,"\t\t [ -k <key> ] [ -m <data> ] <memcache IP>:<port> [ <memcache2 IP>:<port2> ... ]\n");
+        fprintf(stderr,"\t\t [ -k <key> ] [ -m <data> ] [ -u <socket path> ] [ -w <milliseconds> ] [ -b | -B <command file> ] \\\n");
+        fprintf(stderr,"\t\t [ -L <dump file> [ -W <window> ] [ -e <seconds> ] ] \\\n");
+        fprintf(stderr,"\t\t <memcache IP>:<port> [ <memcache2 IP>:<port2> ... ]\n");
         fprintf(stderr,"\t-i\tHost IP-address.\n");
         //fprintf(stderr,"\t-p\tHost port number.\n");
         fprintf(stderr,"\t-r\tNumber of servers to copy the data.\n");
@@ -38,21 +69,386 @@ void usage (char *progname[]){
         fprintf(stderr,"\t-d\tDELETE\n");
         //fprintf(stderr,"\t-l\tSASL List\n");
         fprintf(stderr,"\t-q\tQUIT\n");
+        fprintf(stderr,"\t-u\tSidecar, serve the local workers from the Unix socket until SIGINT or SIGTERM.\n");
+        fprintf(stderr,"\t-w\tSlow requests, print the requests slower than the milliseconds at exit.\n");
+        fprintf(stderr,"\t-b\tBatch, commands from the file ('-' is stdin), one in a line: 'get <key>', 'set <key> <value>',\n");
+        fprintf(stderr,"\t\t'delete <key>' or 'touch <key> <seconds>'. The results are written to stdout in the same order.\n");
+        fprintf(stderr,"\t-B\tBatch, commands in the binary form: opcode, key length (2 bytes), value length or\n");
+        fprintf(stderr,"\t\tthe expiration of TOUCH (4 bytes, network byte order), key and value.\n");
+        fprintf(stderr,"\t-L\tLoad, SET the records of the dump file to all of the servers. The file is either\n");
+        fprintf(stderr,"\t\t'<key> TAB <value>' lines or a binary dump starting with '%s'.\n", MEMCLOADMAGIC );
+        fprintf(stderr,"\t-W\tLoad, quiet SETs written before waiting for the server, default %i.\n", MEMCLOADWINDOW );
+        fprintf(stderr,"\t-e\tLoad and batch, expiration time of the SETs in seconds, default %i.\n", EXPIRATION );
         fprintf(stderr,"\t-h\tHelp.\n");
         fprintf(stderr,"\n\tConnects to memcache servers and performs the given command with the\n");
         fprintf(stderr,"\tkey and data.\n" );
 }
 
+void sidecar_stop( int sig ){
+	(void) sig;
+	memc_sidecar_stop();
+}
+/*
+ * Slow requests, the slowest first, 19.10.2026. */
+void slowlog_print( MEMC *cm ){
+	int indx = 0, count = 0, err = CBSUCCESS;
+	memc_slowlog_entry entries[ MEMCSLOWLOGENTRIES ];
+	err = memc_slowlog_dump( &(*cm), &entries[0], MEMCSLOWLOGENTRIES, &count );
+	if( err!=CBSUCCESS ) return;
+	cb_clog( CBLOGINFO, CBSUCCESS, "\nSlow requests: %i.", count );
+	for( indx=0; indx<count; ++indx ){
+		cb_clog( CBLOGINFO, CBSUCCESS, "\nopcode 0x%.2X key 0x%.8X value %u server %i status %i: total %llu us, acquire %llu sent %llu first byte %llu parsed %llu",
+			entries[ indx ].opcode, entries[ indx ].keyhash, entries[ indx ].msglen, entries[ indx ].dbsindx, entries[ indx ].status,
+			entries[ indx ].total / 1000, entries[ indx ].phase[ MEMCTRACEACQUIRE ] / 1000, entries[ indx ].phase[ MEMCTRACESENT ] / 1000,
+			entries[ indx ].phase[ MEMCTRACEFIRSTBYTE ] / 1000, entries[ indx ].phase[ MEMCTRACEPARSED ] / 1000 );
+	}
+	cb_flush_log();
+}
+
+/*
+ * Bulk load, 19.10.2026. The dump is mapped to memory and written to the redundant
+ * connections with memc_load. */
+typedef struct load_state {
+	struct timespec  start;
+	struct timespec  last;
+} load_state;
+
+int  load_run( MEMC *cm, char *path, int window, ushort expiration ){
+	int fd = -1, err = CBSUCCESS, format = MEMCLOADTSV;
+	double secs = 0;
+	struct stat sb;
+	uchar *data = NULL;
+	memc_load_stats st;
+	load_state ls;
+	if( cm==NULL || path==NULL ) return CBERRALLOC;
+	fd = open( &path[0], O_RDONLY );
+	if( fd<0 || fstat( fd, &sb )!=0 ){
+		cb_clog( CBLOGERR, CBERRFILEOP, "\nLoad file '%s', errno %i '%s'.", &path[0], errno, strerror( errno ) );
+		if( fd>=0 ) close( fd );
+		return CBERRFILEOP;
+	}
+	if( sb.st_size==0 ){
+		close( fd );
+		cb_clog( CBLOGINFO, CBSUCCESS, "\nLoad file '%s' was empty.", &path[0] );
+		return CBSUCCESS;
+	}
+	data = (uchar*) mmap( NULL, (size_t) sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if( data==MAP_FAILED ){
+		cb_clog( CBLOGERR, CBERRFILEOP, "\nmmap '%s', errno %i '%s'.", &path[0], errno, strerror( errno ) );
+		return CBERRFILEOP;
+	}
+	madvise( &data[0], (size_t) sb.st_size, MADV_SEQUENTIAL );
+	if( sb.st_size>=8 && memcmp( &data[0], MEMCLOADMAGIC, 8 )==0 )
+		format = MEMCLOADBINARY;
+
+	clock_gettime( CLOCK_MONOTONIC, &ls.start );
+	ls.last = ls.start;
+	err = memc_load( &(*cm), &data[0], (size_t) sb.st_size, format, window, expiration, &st, &load_progress, &ls );
+	clock_gettime( CLOCK_MONOTONIC, &ls.last );
+	munmap( &data[0], (size_t) sb.st_size );
+
+	secs = (double) ( ls.last.tv_sec - ls.start.tv_sec ) + (double) ( ls.last.tv_nsec - ls.start.tv_nsec ) / 1000000000.0;
+	if( secs<=0 ) secs = 0.000001;
+	fprintf( stderr, "\n" );
+	cb_clog( CBLOGINFO, CBSUCCESS, "\nLoaded %lu records (%.1f MB) to %i connections in %.3f s, %.0f records/s, %.1f MB/s. Failed %lu, skipped %lu, last error %i.",
+		st.records, (double) st.bytes / 1048576.0, st.connections, secs, (double) st.records / secs,
+		(double) st.bytes / 1048576.0 / secs, st.failed, st.skipped, st.lasterror );
+	cb_flush_log();
+	return err;
+}
+/*
+ * Called by the first connection after every window, at most once in a second. */
+void load_progress( void *arg, memc_load_stats *st ){
+	double secs = 0;
+	unsigned long int records = 0, bytes = 0;
+	struct timespec now;
+	load_state *ls = (load_state*) arg;
+	if( ls==NULL || st==NULL ) return;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	if( now.tv_sec==(*ls).last.tv_sec ) return;
+	(*ls).last = now;
+	records = __atomic_load_n( &(*st).records, __ATOMIC_RELAXED );
+	bytes = __atomic_load_n( &(*st).bytes, __ATOMIC_RELAXED );
+	secs = (double) ( now.tv_sec - (*ls).start.tv_sec ) + (double) ( now.tv_nsec - (*ls).start.tv_nsec ) / 1000000000.0;
+	if( secs<=0 ) return;
+	fprintf( stderr, "\r%lu records, %.1f MB, %.0f records/s", records, (double) bytes / 1048576.0, (double) records / secs );
+	fflush( stderr );
+}
+
+/*
+ * Batch mode, 19.10.2026. The commands use the connections of the process. GETs wait
+ * their responce, SETs and DELETEs are collected and written pipelined (quiet requests
+ * and a NOOP) every MEMCBATCHWINDOW commands; their result is the status of the server
+ * and it is written when the NOOP is answered. The results are in the order of the
+ * commands, text as the commands or binary as the binary commands. */
+int  batch_run( MEMC *cm, FILE *in, char binary, ushort expiration ){
+	int err = CBSUCCESS, opcode = 0, keylen = 0, valuelen = 0, msglen = 0, inflight = 0;
+	int arenaused = 0, need = 0;
+	uint cas = 0;
+	long lineno = 0, commands = 0, errors = 0;
+	size_t linecap = 0;
+	char *line = NULL;
+	uchar *arena = NULL, *getbuf = NULL, *readbuf = NULL;
+	uchar *key = NULL, *value = NULL, *akey = NULL, *avalue = NULL;
+	memc_batch_op *writes = NULL;
+	struct timespec ts1, ts2;
+	double secs = 0;
+	if( cm==NULL || in==NULL ) return CBERRALLOC;
+
+	arena = (uchar*) malloc( sizeof( uchar ) * MEMCBATCHARENA );
+	getbuf = (uchar*) malloc( sizeof( uchar ) * MEMCBATCHMAXVALUE );
+	readbuf = (uchar*) malloc( sizeof( uchar ) * ( MEMCBATCHMAXVALUE + 65536 ) );
+	writes = (memc_batch_op*) malloc( sizeof( memc_batch_op ) * MEMCBATCHWINDOW );
+	if( arena==NULL || getbuf==NULL || readbuf==NULL || writes==NULL ){
+		free( arena ); free( getbuf ); free( readbuf ); free( writes );
+		return CBERRALLOC;
+	}
+	clock_gettime( CLOCK_MONOTONIC, &ts1 );
+
+	for(;;){
+		++lineno;
+		if( binary==1 )
+			err = batch_read_binary( &(*in), &readbuf[0], MEMCBATCHMAXVALUE + 65536, &opcode, &key, &keylen, &value, &valuelen );
+		else
+			err = batch_read_text( &(*in), &line, &linecap, &opcode, &key, &keylen, &value, &valuelen, lineno );
+		if( err==CBSTREAMEND ) break;
+		if( err==CBNOTFOUND ) continue; // empty line or comment
+		if( err!=CBSUCCESS ){
+			++errors;
+			if( binary==1 ) break; // the stream can not be followed
+			continue;
+		}
+		++commands;
+
+		if( inflight>0 && ( opcode==MEMCGET || opcode==MEMCTOUCH ) ){
+			errors += batch_flush( &(*cm), &writes[0], inflight, binary ); // results in order, reads the writes
+			inflight = 0;
+			arenaused = 0;
+		}
+		if( opcode==MEMCGET ){
+			msglen = 0; cas = 0;
+			err = memc_get( &(*cm), &key, keylen, &getbuf, &msglen, MEMCBATCHMAXVALUE, &cas, 0 );
+			if( err!=MEMCSUCCESS && err!=MEMCKEYNOTFOUND && err!=MEMCRECVKEYNOTFOUND ) ++errors;
+			batch_result( binary, opcode, &key[0], keylen, &getbuf[0], ( err==MEMCSUCCESS ) ? msglen : 0, err );
+			continue;
+		}
+		if( opcode==MEMCTOUCH ){
+			err = memc_touch( &(*cm), &key, keylen, (ushort) valuelen, 0 );
+			if( err!=MEMCSUCCESS && err!=MEMCKEYNOTFOUND ) ++errors;
+			batch_result( binary, opcode, &key[0], keylen, NULL, 0, err );
+			continue;
+		}
+
+		/*
+		 * SET and DELETE, the key and the value are in the arena until the batch is written. The
+		 * writes of a key are in the order of the commands in the same connection. */
+		need = keylen + ( ( opcode==MEMCSET ) ? valuelen : 0 );
+		if( inflight>=MEMCBATCHWINDOW || arenaused + need > MEMCBATCHARENA ){
+			errors += batch_flush( &(*cm), &writes[0], inflight, binary );
+			inflight = 0;
+			arenaused = 0;
+		}
+		if( need > MEMCBATCHARENA ){
+			++errors;
+			batch_result( binary, opcode, &key[0], keylen, NULL, 0, CBOVERFLOW );
+			continue;
+		}
+		akey = &arena[ arenaused ];
+		memcpy( &akey[0], &key[0], (size_t) keylen );
+		arenaused += keylen;
+		memset( &writes[ inflight ], 0x00, sizeof( memc_batch_op ) );
+		if( opcode==MEMCSET ){
+			avalue = &arena[ arenaused ];
+			if( valuelen>0 ) memcpy( &avalue[0], &value[0], (size_t) valuelen );
+			arenaused += valuelen;
+			writes[ inflight ].msg = &avalue[0];
+			writes[ inflight ].msglen = valuelen;
+			writes[ inflight ].expiration = expiration;
+		}
+		writes[ inflight ].key = &akey[0];
+		writes[ inflight ].keylen = keylen;
+		writes[ inflight ].opcode = (uchar) opcode;
+		++inflight;
+	}
+	errors += batch_flush( &(*cm), &writes[0], inflight, binary );
+	memc_wait_all( &(*cm) );
+	fflush( stdout );
+
+	clock_gettime( CLOCK_MONOTONIC, &ts2 );
+	secs = (double) ( ts2.tv_sec - ts1.tv_sec ) + (double) ( ts2.tv_nsec - ts1.tv_nsec ) / 1000000000.0;
+	cb_clog( CBLOGINFO, CBSUCCESS, "\nBatch: %ld commands, %ld errors, %.3f s, %.1f commands/s.", commands, errors, secs, ( secs>0 ) ? (double) commands / secs : 0.0 );
+	cb_flush_log();
+	free( line );
+	free( arena );
+	free( getbuf );
+	free( readbuf );
+	free( writes );
+	return ( errors>0 ) ? CBNOTFOUND : CBSUCCESS;
+}
+/*
+ * Writes the SETs and DELETEs of the window and their results. If the batch could
+ * not be written, the result of every write is the error. */
+long batch_flush( MEMC *cm, memc_batch_op *writes, int count, char binary ){
+	int indx = 0, err = CBSUCCESS, batcherr = CBSUCCESS;
+	long errors = 0;
+	if( cm==NULL || writes==NULL || count<=0 ) return 0;
+	batcherr = memc_write_batch( &(*cm), &writes[0], count );
+	for( indx = 0; indx<count; ++indx ){
+		err = ( batcherr!=CBSUCCESS ) ? batcherr : writes[ indx ].status;
+		if( err!=MEMCSUCCESS && !( err==MEMCKEYNOTFOUND && writes[ indx ].opcode==MEMCDELETE ) )
+			++errors;
+		batch_result( binary, writes[ indx ].opcode, &writes[ indx ].key[0], writes[ indx ].keylen, NULL, 0, err );
+	}
+	return errors;
+}
+/*
+ * One line: 'get <key>', 'set <key> <value>', 'delete <key>' or 'touch <key> <seconds>'. The value
+ * is the rest of the line after one space. CBNOTFOUND if the line is empty or a comment. */
+int  batch_read_text( FILE *in, char **line, size_t *linecap, int *opcode, uchar **key, int *keylen, uchar **value, int *valuelen, long lineno ){
+	ssize_t len = 0;
+	char *cmd = NULL, *end = NULL, *str_err = NULL;
+	if( in==NULL || line==NULL || linecap==NULL || opcode==NULL || key==NULL || keylen==NULL || value==NULL || valuelen==NULL ) return CBERRALLOC;
+	len = getline( &(*line), &(*linecap), in );
+	if( len<0 ) return CBSTREAMEND;
+	while( len>0 && ( (*line)[ len-1 ]=='\n' || (*line)[ len-1 ]=='\r' ) )
+		(*line)[ --len ] = '\0';
+	cmd = &(*line)[0];
+	while( *cmd==' ' || *cmd=='\t' ) ++cmd;
+	if( *cmd=='\0' || *cmd=='#' ) return CBNOTFOUND;
+
+	/*
+	 * Command and key. */
+	end = strchr( cmd, (int) ' ' );
+	if( end==NULL ){
+		fprintf( stderr, "\nLine %ld: key is missing.", lineno );
+		return MEMCSENDINVALIDDATAERR;
+	}
+	*end = '\0';
+	*key = (uchar*) &end[1];
+	end = strchr( (char*) *key, (int) ' ' );
+	if( end!=NULL ) *end = '\0';
+	*keylen = (int) strlen( (char*) *key );
+	*value = NULL;
+	*valuelen = 0;
+	if( strcmp( cmd, "get" )==0 ){
+		*opcode = MEMCGET;
+	}else if( strcmp( cmd, "delete" )==0 ){
+		*opcode = MEMCDELETE;
+	}else if( strcmp( cmd, "set" )==0 && end!=NULL ){
+		*opcode = MEMCSET;
+		*value = (uchar*) &end[1];
+		*valuelen = (int) ( &(*line)[ len ] - (char*) *value );
+	}else if( strcmp( cmd, "touch" )==0 && end!=NULL ){
+		*opcode = MEMCTOUCH;
+		*valuelen = (int) strtol( &end[1], &str_err, 10 );
+		if( str_err==&end[1] || *str_err!='\0' || *valuelen<0 || *valuelen>65535 ){
+			fprintf( stderr, "\nLine %ld: expiration '%s' is not a number of seconds.", lineno, &end[1] );
+			return MEMCSENDINVALIDDATAERR;
+		}
+	}else{
+		fprintf( stderr, "\nLine %ld: unknown command '%s' or the value is missing.", lineno, cmd );
+		return MEMCSENDINVALIDDATAERR;
+	}
+	if( *keylen<=0 || *keylen>65535 ){
+		fprintf( stderr, "\nLine %ld: key length %i.", lineno, *keylen );
+		return MEMCSENDINVALIDDATAERR;
+	}
+	return CBSUCCESS;
+}
+/*
+ * Opcode (1 byte), key length (2), value length or TOUCH expiration (4), key and value. */
+int  batch_read_binary( FILE *in, uchar *buf, int buflen, int *opcode, uchar **key, int *keylen, uchar **value, int *valuelen ){
+	ushort klen = 0;
+	uint vlen = 0;
+	uchar hdr[ MEMCBATCHHDRLEN ];
+	if( in==NULL || buf==NULL || opcode==NULL || key==NULL || keylen==NULL || value==NULL || valuelen==NULL ) return CBERRALLOC;
+	if( fread( &hdr[0], 1, MEMCBATCHHDRLEN, in )!=MEMCBATCHHDRLEN ) return CBSTREAMEND;
+	memcpy( &klen, &hdr[1], 2 );
+	memcpy( &vlen, &hdr[3], 4 );
+	*opcode = (int) hdr[0];
+	*keylen = (int) ntohs( klen );
+	*valuelen = (int) ntohl( vlen );
+	if( *opcode!=MEMCGET && *opcode!=MEMCSET && *opcode!=MEMCDELETE && *opcode!=MEMCTOUCH ){
+		fprintf( stderr, "\nBinary command: unknown opcode 0x%.2X.", (uint) *opcode );
+		return MEMCSENDINVALIDDATAERR;
+	}
+	if( *opcode==MEMCTOUCH ){
+		if( *valuelen>65535 ) *valuelen = EXPIRATION;
+		vlen = 0;
+	}else if( *opcode!=MEMCSET ){
+		vlen = 0;
+	}else{
+		vlen = (uint) *valuelen;
+	}
+	if( *keylen<=0 || vlen>(uint) MEMCBATCHMAXVALUE || *keylen + (int) vlen > buflen ){
+		fprintf( stderr, "\nBinary command: key length %i, value length %u.", *keylen, vlen );
+		return MEMCSENDINVALIDDATAERR;
+	}
+	if( fread( &buf[0], 1, (size_t) *keylen + vlen, in )!=(size_t) *keylen + vlen ) return CBSTREAMEND;
+	*key = &buf[0];
+	*value = &buf[ *keylen ];
+	if( *opcode==MEMCSET ) *valuelen = (int) vlen;
+	return CBSUCCESS;
+}
+/*
+ * Text: 'VALUE <key> <length>' and the value in the next line, 'NOT_FOUND <key>', 'STORED <key>',
+ * 'DELETED <key>', 'TOUCHED <key>' or 'ERROR <key> <error>'. Binary: opcode (1 byte), status (2),
+ * key length (2), value length (4), key and value. The status is the error if it is not zero. */
+void batch_result( char binary, int opcode, uchar *key, int keylen, uchar *value, int valuelen, int err ){
+	ushort status = 0, klen = 0;
+	uint vlen = 0;
+	uchar hdr[ MEMCBATCHRESLEN ];
+	if( key==NULL || keylen<0 ) return;
+	if( err==MEMCRECVKEYNOTFOUND ) err = MEMCKEYNOTFOUND;
+	if( binary==1 ){
+		hdr[0] = (uchar) opcode;
+		status = htons( (ushort) ( ( err>=0 && err<65536 ) ? err : 65535 ) );
+		klen = htons( (ushort) keylen );
+		vlen = htonl( (uint) ( ( value!=NULL && valuelen>0 ) ? valuelen : 0 ) );
+		memcpy( &hdr[1], &status, 2 );
+		memcpy( &hdr[3], &klen, 2 );
+		memcpy( &hdr[5], &vlen, 4 );
+		fwrite( &hdr[0], 1, MEMCBATCHRESLEN, stdout );
+		fwrite( &key[0], 1, (size_t) keylen, stdout );
+		if( value!=NULL && valuelen>0 )
+			fwrite( &value[0], 1, (size_t) valuelen, stdout );
+		return;
+	}
+	if( err==MEMCSUCCESS && opcode==MEMCGET ){
+		printf( "VALUE %.*s %i\n", keylen, (char*) key, valuelen );
+		if( value!=NULL && valuelen>0 ) fwrite( &value[0], 1, (size_t) valuelen, stdout );
+		printf( "\n" );
+	}else if( err==MEMCSUCCESS ){
+		printf( "%s %.*s\n", ( opcode==MEMCSET ) ? "STORED" : ( ( opcode==MEMCDELETE ) ? "DELETED" : "TOUCHED" ), keylen, (char*) key );
+	}else if( err==MEMCKEYNOTFOUND ){
+		printf( "NOT_FOUND %.*s\n", keylen, (char*) key );
+	}else{
+		printf( "ERROR %.*s %i\n", keylen, (char*) key, err );
+	}
+}
+
 #define MESSAGELEN	(10*MAXPATHLEN)
 
 int  main( int argc, char *argv[] ){
 	int fromend = 0, atoms = 0, i = 0, indx = 0, num = 0, u = 0, err = CBSUCCESS;
 	uint cas = 0;
 	char *str_err=NULL;
-	const char *value  = NULL;
+	char *value  = NULL;
 	struct addrinfo  hints;
 	char  hostipset = 0;
 	char  hostportset = 0;
+	char  sidecarset = 0;
+	char  batchset = 0;  // 1 text, 2 binary
+	char  batchpath[ MAXPATHLEN+1 ];
+	FILE *batchin = NULL;
+	int   slowms = -1;
+	char  loadset = 0;
+	char  loadpath[ MAXPATHLEN+1 ];
+	int   loadwindow = MEMCLOADWINDOW;
+	int   expiration = EXPIRATION;
+	char  sidecarpath[ MAXPATHLEN+1 ];
+	struct sigaction sa;
 	char  cmd = MEMCGET;
         unsigned char  hostipdata[ MAXPATHLEN+1 ];
         unsigned char *hostip=NULL;
@@ -241,6 +637,75 @@ int  main( int argc, char *argv[] ){
             }
             continue;
           }
+          u = get_option( argv[i], argv[i+1], 'u', &value ); // sidecar socket, 19.10.2026
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL && strlen( (char*) value )>0 ){
+		strncpy( &sidecarpath[0], &(* (const char *) value), (size_t) MAXPATHLEN );
+		sidecarpath[ MAXPATHLEN ] = '\0';
+		sidecarset = 1;
+            }else{
+                fprintf( stderr, "\nSocket path igored, length was zero or negative." );
+            }
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'w', &value ); // slow requests, 19.10.2026
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL && strlen( (char*) value )>0 ){
+		slowms = (int) strtol( ( (const char *) value), &str_err, 10);
+            }else{
+                fprintf( stderr, "\nSlow request time igored, length was zero or negative." );
+            }
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'b', &value ); // batch, 19.10.2026
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL && strlen( (char*) value )>0 ){
+		strncpy( &batchpath[0], &(* (const char *) value), (size_t) MAXPATHLEN );
+		batchpath[ MAXPATHLEN ] = '\0';
+		batchset = 1;
+            }else{
+                fprintf( stderr, "\nCommand file igored, length was zero or negative." );
+            }
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'B', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL && strlen( (char*) value )>0 ){
+		strncpy( &batchpath[0], &(* (const char *) value), (size_t) MAXPATHLEN );
+		batchpath[ MAXPATHLEN ] = '\0';
+		batchset = 2;
+            }else{
+                fprintf( stderr, "\nCommand file igored, length was zero or negative." );
+            }
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'L', &value ); // bulk load, 19.10.2026
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL && strlen( (char*) value )>0 ){
+		strncpy( &loadpath[0], &(* (const char *) value), (size_t) MAXPATHLEN );
+		loadpath[ MAXPATHLEN ] = '\0';
+		loadset = 1;
+            }else{
+                fprintf( stderr, "\nLoad file igored, length was zero or negative." );
+            }
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'W', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL && strlen( (char*) value )>0 ){
+		loadwindow = (int) strtol( ( (const char *) value), &str_err, 10);
+		if( loadwindow<=0 ) loadwindow = MEMCLOADWINDOW;
+            }
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'e', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL && strlen( (char*) value )>0 ){
+		expiration = (int) strtol( ( (const char *) value), &str_err, 10);
+		if( expiration<0 || expiration>65535 ) expiration = EXPIRATION; // ushort in the library
+            }
+            continue;
+          }
           u = get_option( argv[i], NULL, 'g', &value );
           if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
 	    cmd = MEMCGET;
@@ -308,6 +773,13 @@ int  main( int argc, char *argv[] ){
 		exit( err );
 	}
 
+	/*
+	 * Slow requests, 19.10.2026. */
+	if( slowms>=0 ){
+		err = memc_slowlog_create( &(*cm), MEMCSLOWLOGENTRIES, slowms * 1000 );
+		if( err>=CBERROR ){ cb_clog( CBLOGERR, err, "\nmemc_slowlog_create, error %i.", err ); }
+	}
+
 	/*
 	 * MEMC */
 	err = memc_init( &(*cm) );
@@ -318,6 +790,46 @@ int  main( int argc, char *argv[] ){
 
 	//fprintf( stderr, "\nmain: iplen %i, portlen %i", portlen, iplen );
 
+	/*
+	 * Sidecar, the workers use the connections of this process. 19.10.2026 */
+	if( sidecarset==1 ){
+		memset( &sa, 0x00, sizeof( struct sigaction ) );
+		sa.sa_handler = &sidecar_stop;
+		sigemptyset( &sa.sa_mask );
+		sigaction( SIGINT, &sa, NULL );
+		sigaction( SIGTERM, &sa, NULL );
+		signal( SIGPIPE, SIG_IGN );
+		err = memc_sidecar_serve( &(*cm), &sidecarpath[0], MEMCSIDECARWORKERS );
+		if( err>=CBERROR ){ cb_clog( CBLOGERR, err, "\nmemc_sidecar_serve, error %i.", err ); }
+		cmd = -1; // no command
+	}
+
+	/*
+	 * Batch of commands over the same connections, 19.10.2026. */
+	if( batchset!=0 && sidecarset==0 ){
+		signal( SIGPIPE, SIG_IGN );
+		if( strcmp( &batchpath[0], "-" )==0 )
+			batchin = stdin;
+		else
+			batchin = fopen( &batchpath[0], ( batchset==2 ) ? "rb" : "r" );
+		if( batchin==NULL ){
+			cb_clog( CBLOGERR, CBERRFILEOP, "\nBatch file '%s', errno %i '%s'.", &batchpath[0], errno, strerror( errno ) );
+		}else{
+			err = batch_run( &(*cm), &(*batchin), ( batchset==2 ) ? 1 : 0, (ushort) expiration );
+			if( batchin!=stdin ) fclose( batchin );
+			batchin = NULL;
+		}
+		cmd = -1;
+	}
+
+	/*
+	 * Bulk load of a dump file, 19.10.2026. */
+	if( loadset!=0 && sidecarset==0 && batchset==0 ){
+		signal( SIGPIPE, SIG_IGN );
+		err = load_run( &(*cm), &loadpath[0], loadwindow, (ushort) expiration );
+		cmd = -1;
+	}
+
 	switch ( cmd ) {
 		case MEMCGET:
 			err = memc_get(  &(*cm), &key, keylen, &msg, &msglen, (int) MESSAGELEN, &cas, 0 ); // MAXPATHLEN, &cas, 0 );
@@ -375,6 +887,8 @@ int  main( int argc, char *argv[] ){
 	if( err>=CBERROR ){ 
 		cb_clog( CBLOGERR, err, "\n%s: memc_wait_all, error %i.", argv[0], err ); 
 	}
+	if( slowms>=0 )
+		slowlog_print( &(*cm) ); // 19.10.2026
 
 	/*
 	 * Free. */
@@ -32,17 +32,97 @@
 #include <netdb.h>      // addrinfo
 #include <unistd.h>     // close
 #include <fcntl.h>      // fcntl
+#include <time.h>       // clock_gettime
+#include <sched.h>      // sched_yield
+#include <signal.h>     // kill
+#include <sys/mman.h>   // mmap
+#include <sys/uio.h>    // writev
+#if defined(__linux__)
+#include <sys/syscall.h> // SYS_futex
+#include <linux/futex.h> // FUTEX_WAIT, FUTEX_WAKE
+#else
+#define FUTEX_WAIT           0      // sleeps a while instead
+#define FUTEX_WAKE           1
+#endif
+#include <limits.h>     // INT_MAX
 
 #include "../include/cb_buffer.h"
 #include "../include/db_conn_param.h"
 #include "./memc.h"
+#include "./memc_log.h"
+
+/*
+ * USDT probes of the provider 'memc', 19.10.2026. A nop and an ELF note each if
+ * <sys/sdt.h> is found (systemtap-sdt-dev), nothing otherwise or with MEMCNOPROBES.
+ * Attached with 'bpftrace -e usdt:./libmemc.so:memc:done { ... }' or 'perf probe sdt_memc:*'.
+ *
+ *   submit( opcode, keylen, msglen, trace id )        request to a server, before the connection
+ *   send( fd, opcode, keylen, msglen )                memc_send
+ *   sent( fd, bytes )
+ *   recv( fd )                                         memc_recv
+ *   received( fd, opcode, status, bytes )
+ *   done( statistics index, cindx, err, status, usec ) MEMCSTATSGET ..., usec 0 if not sent
+ *   connect( cindx, dbsindx, fd, err )                 memc_connect_thr
+ *   reconnect( cindx, dbsindx )
+ *   reinit( pid, forked )                              memc_reinit (0) and the fork child (1)
+ */
+#if ! defined( MEMCNOPROBES ) && defined( __has_include )
+#if __has_include( <sys/sdt.h> )
+#include <sys/sdt.h>
+#define MEMCPROBES
+#endif
+#endif
+#ifdef MEMCPROBES
+#define MEMCPROBE1( name, a )                  DTRACE_PROBE1( memc, name, a )
+#define MEMCPROBE2( name, a, b )               DTRACE_PROBE2( memc, name, a, b )
+#define MEMCPROBE4( name, a, b, c, d )         DTRACE_PROBE4( memc, name, a, b, c, d )
+#define MEMCPROBE5( name, a, b, c, d, e )      DTRACE_PROBE5( memc, name, a, b, c, d, e )
+#else
+#define MEMCPROBE1( name, a )                  do{ }while(0)
+#define MEMCPROBE2( name, a, b )               do{ }while(0)
+#define MEMCPROBE4( name, a, b, c, d )         do{ }while(0)
+#define MEMCPROBE5( name, a, b, c, d, e )      do{ }while(0)
+#endif
 
 #define SOCINMEMSIZECLIENT   8192
 #define SOCOUTMEMSIZECLIENT  8192
 #define SOCLINGERTIMECLIENT  7
 
+/*
+ * Byte order of the host at compile time, 19.10.2026. The network byte order of memcached is big endian. */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__==__ORDER_BIG_ENDIAN__
+#define MEMCHTON16( x )      ( (ushort) ( x ) )
+#define MEMCHTON32( x )      ( (uint) ( x ) )
+#define MEMCHTON64( x )      ( (unsigned long long int) ( x ) )
+#else
+#define MEMCHTON16( x )      __builtin_bswap16( (ushort) ( x ) )
+#define MEMCHTON32( x )      __builtin_bswap32( (uint) ( x ) )
+#define MEMCHTON64( x )      __builtin_bswap64( (unsigned long long int) ( x ) )
+#endif
+#define MEMCOPAQUE           0x02
+#define MEMCTEMPLATES        0x40   // opcodes with a request header template
+
+#define MEMCSHMMAGIC         0x6d656d63
+#define MEMCSHMRETRIES       64     // seqlock read retries and write lock attempts
+
+/* Longest sleep in memc_conn_acquire without a wake up, 19.10.2026 */
+#define MEMCCONNWAITMS       10
+
+/* Mutexes locked over fork, MEMC.fork_locked, 19.10.2026 */
+#define MEMCFORKSET          0x0004
+#define MEMCFORKDELETE       0x0008
+#define MEMCFORKFLIGHT       0x0040
+#define MEMCFORKPARAM        0x0080
+#define MEMCFORKPEND         0x0100
+#define MEMCFORKNEARCACHE    0x0200
+#define MEMCFORKNEGCACHE     0x0400
+#define MEMCFORKCONN         0x0800
+#define MEMCFORKPREFORK      0x1000
+
 static int    memc_send( int sockfd, memc_msg *hdr, memc_extras *ext, uchar **key, ushort keylen, uchar **msg, uint msglen );
+static int    memc_read( int sockfd, void *buf, size_t len ); // read, keeps the errno of a failure to the statistics
 static int    memc_recv( int sockfd, memc_msg *hdr, memc_extras *ext, uchar **key, ushort *keylen, int keybuflen, uchar **msg, uint *msglen, int msgbuflen );
+static int    memc_recv_discard( int sockfd, uint len ); // bytes read or -1
 static int    memc_get_starting_index( MEMC *cm, char key_last_byte );
 static void*  memc_init_thr( void *prm );         // Server calls this before fork (may fork first return later, in parellel)
 static int    memc_init_inner( MEMC *cm );
@@ -52,43 +132,417 @@ static int    memc_close_all( MEMC *cm );
 static void*  memc_connect_thr( void *prm );      // After IP and port is known, parallel, joined in memc_set and memc_get (and memc_delete, in memc_quit if connected) 
 static void*  memc_set_thr( void *prm );          // Parallel
 static int    memc_get_seq( MEMC_parameter *pm ); // In sequence
+static int    memc_get_cached( MEMC *cm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas, ushort vbucketid ); // memc_get without the capture
+static int    memc_get_network( MEMC *cm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas, ushort vbucketid, \
+		char stale, unsigned long long int nccas, int ncmsglen, unsigned long int ncgen, unsigned long int neggen, uint shmseq, unsigned long long int *cas64 );
+static int    memc_flight_join( MEMC *cm, uchar *key, int keylen, uchar *msg, int *msglen, int msgbuflen, unsigned long long int *cas, memc_flight **flight, char *waited );
+static int    memc_flight_finish( MEMC *cm, memc_flight *flight, int err, uchar *msg, int msglen, unsigned long long int cas );
+static void   memc_flight_invalidate( MEMC *cm, uchar *key, int keylen ); // after a write, the next reader does not join
+static memc_flight* memc_flight_get( MEMC *cm, int keylen ); // with the flight mutex, from the free list
+static void   memc_flight_put( MEMC *cm, memc_flight *flight ); // with the flight mutex, back to the free list
 static int    memc_set_common( MEMC *cm, uchar **key, uint keylen, uchar **msg, int msglen, uint cas, ushort vbucketid, ushort expiration, char replace );
 static int    memc_join_previous( MEMC *cm );
+static int    memc_join_reinit( MEMC *cm );
+static int    memc_join_key( MEMC *cm, uint keyhash, int *result ); // 'result' NULL leaves the completions to memc_wait_key
 static int    memc_create_all_sockets( MEMC *cm );
 static int    memc_create_socket( MEMC *cm, int indx );
+static int    memc_create_socket_fd( MEMC *cm, int *fd, int flags ); // 'flags' to the socket type, SOCK_CLOEXEC in the pre-fork pool
 static int    memc_get_any_connection( MEMC *cm );
 static int    memc_close_mutexes( MEMC *cm );
 
-static int    memc_get_param( MEMC_parameter **pm );
-static int    memc_free_param( MEMC_parameter *pm );
+static int    memc_get_param( MEMC *cm, MEMC_parameter **pm );
+static int    memc_free_param( MEMC_parameter *pm ); // back to the free list of the MEMC
+
+static int    memc_processing( dbs_conn *conn );       // atomic load
+static void   memc_processing_inc( dbs_conn *conn );
+static void   memc_processing_dec( dbs_conn *conn );   // not below zero
+static int    memc_conn_state( dbs_conn *conn );
+static int    memc_conn_transition( dbs_conn *conn, int from, int to ); // compare-and-swap, 1 if changed
+static int    memc_conn_acquire( dbs_conn *conn ); // READY to BUSY, waits if BUSY or CONNECTING, 1 if acquired
+static void   memc_conn_release( dbs_conn *conn, int err ); // BUSY to READY or to FAILED
+static void   memc_conn_store( dbs_conn *conn, int state ); // without compare, wakes the waiters
+static void   memc_conn_wake( dbs_conn *conn, int state );
+static int    memc_conn_futex( int *addr, int op, int val, int count );
+
+static int    memc_start_thread( MEMC *cm, MEMC_parameter *pm, void* (*thr)( void* ), uint keyhash ); // detached, with a completion
+static void   memc_thread_done( MEMC_parameter *pm, int err );  // frees the parameters and signals the completion
+static int    memc_wait_pending( MEMC *cm, uint keyhash, int cindx, char all, int *result ); // 'result' of the matching completions
+static void   memc_result_add( int *result, int err ); // a success before a status before an error
+static uint   memc_key_order( uchar *key, int keylen );          // hash of the key, not zero
+
+static void   memc_fork_register( MEMC *cm );
+static void   memc_fork_unregister( MEMC *cm );
+static void   memc_fork_prepare( void );        // pthread_atfork handlers
+static void   memc_fork_parent( void );
+static void   memc_fork_child( void );
+static void   memc_fork_install( void );        // once
+static void   memc_fork_unlock( MEMC *cm );
+static int    memc_fork_reconnect( MEMC *cm, char reconnect ); // first use in the child
+static int    memc_prefork_connect( MEMC *cm, int dbsindx, int *fd );
+static int    memc_prefork_fill( MEMC *cm );       // returns the number of connected sockets
+static void*  memc_prefork_thr( void *prm );
+static void   memc_prefork_refill( MEMC *cm );     // in a thread
+static int    memc_prefork_reap( memc_prefork *pf );  // sets taken by the children emptied, returns the number
+static void   memc_prefork_choose( memc_prefork *pf );
+static int    memc_prefork_parent( memc_prefork *pf ); // returns the number of empty places
+static int    memc_prefork_child( MEMC *cm );          // at the first use in the child
+
+static unsigned long long int memc_time_usec( void );
+static uint   memc_hash_key( uchar *key, int keylen );
+static memc_nearcache_entry* memc_nearcache_find( memc_nearcache *nc, uchar *key, int keylen ); // locked
+static int    memc_nearcache_get( MEMC *cm, uchar *key, int keylen, uchar *msg, int *msglen, int msgbuflen, unsigned long long int *cas, char *stale, unsigned long int *generation );
+static int    memc_nearcache_put( MEMC *cm, uchar *key, int keylen, uchar *msg, int msglen, unsigned long long int cas, unsigned long int generation );
+static int    memc_nearcache_validated( MEMC *cm, uchar *key, int keylen, unsigned long long int cas, unsigned long int generation );
+static int    memc_touch_seq( MEMC_parameter *pm, ushort expiration ); // In sequence, returns the CAS in 'cas64'
+static memc_shmcache_bucket* memc_shmcache_bucket_at( memc_shmcache *sc, uchar *key, int keylen );
+static int    memc_shmcache_get( MEMC *cm, uchar *key, int keylen, uchar *msg, int *msglen, int msgbuflen, unsigned long long int *cas, uint *seq );
+static int    memc_shmcache_put( MEMC *cm, uchar *key, int keylen, uchar *msg, int msglen, unsigned long long int cas, uint seq );
+static int    memc_shmcache_invalidate( MEMC *cm, uchar *key, int keylen );
+static int    memc_shmcache_lock( memc_shmcache_bucket *bkt ); // 1 if locked by the caller
+static void   memc_shmcache_unlock( memc_shmcache_bucket *bkt );
+static int    memc_negcache_get( MEMC *cm, uchar *key, int keylen, unsigned long int *generation );
+static int    memc_negcache_put( MEMC *cm, uchar *key, int keylen, unsigned long int generation );
+static void   memc_negcache_bloom_remove( memc_negcache *ng, int gen, uint hash, uint hash2 ); // locked
+static int    memc_negcache_invalidate( MEMC *cm, uchar *key, int keylen );
+static void   memc_negcache_rotate( memc_negcache *ng, unsigned long long int now ); // locked
+
+static memc_stats_server* memc_stats_cell( MEMC *cm, int cindx ); // of the shard of the thread
+static int    memc_stats_bucket( unsigned long long int usec );
+static unsigned long long int memc_stats_begin( MEMC *cm, int cindx ); // request sent, returns the start time
+static void   memc_stats_end( MEMC *cm, int cindx, int op, unsigned long long int start, int err, ushort status, unsigned long int out, unsigned long int in );
+static void   memc_stats_event( MEMC *cm, int cindx, int event ); // MEMCSTATSRETRY or MEMCSTATSRECONNECT
+static int    memc_conn_server( MEMC *cm, int cindx ); // 'sesdbparams' index of the connected server
+
+static void   memc_trace( MEMC *cm, MEMC_parameter *pm, int phase, int opcode, int err );
+static void   memc_trace_first_byte( MEMC_parameter *pm, int opcode ); // waits with MSG_PEEK
+static memc_trace_fanout* memc_trace_fanout_start( MEMC *cm, int opcode, uint *id, uchar *key, int keylen, uint msglen );
+static void   memc_trace_fanout_done( MEMC *cm, memc_trace_fanout *fo, int err ); // the last one calls MEMCTRACEFANOUT and memc_record_put
+static void   memc_slowlog_put( MEMC_parameter *pm, int opcode, int status, int keylen, uint msglen ); // if slower than the threshold
+static void   memc_record_put( MEMC *cm, int opcode, uchar *key, int keylen, uint msglen, unsigned long long int start, int err );
+static int    memc_record_flush( memc_recorder *rc ); // locked
+static int    memc_load_next( uchar *data, size_t datalen, size_t *pos, int format, uchar **key, int *keylen, uchar **value, uint *valuelen );
+static void*  memc_load_thr( void *prm );
+static int    memc_load_write( int fd, uchar *buf, size_t len );
+static int    memc_load_drain( int fd, memc_load_stats *st ); // until the next NOOP
+static int    memc_batch_write( MEMC *cm, int cindx, memc_batch_op *ops, int first, int last, unsigned long long int *start, int *written ); // a window and a NOOP
+static int    memc_batch_drain( MEMC *cm, int cindx, memc_batch_op *ops, int count, unsigned long long int start ); // until the next NOOP
 
 static int    memc_hdr_to_big_endian( memc_msg *hdr );
 static int    memc_ext_to_big_endian( memc_extras *ext );
+static void   memc_hdr_request( memc_msg *hdr, uchar opcode, ushort keylen, uint bodylen, ushort vbucketid, unsigned long long int cas ); // network byte order
+
+/*
+ * Request headers in the network byte order, 19.10.2026. memc_hdr_request copies the
+ * template of the opcode and stores the lengths, vbucket id and CAS. */
+#define MEMCTEMPLATE( op, extlen )  [ op ] = { .magic = MEMCREQUEST, .opcode = op, .extras_length = extlen, \
+		.data_type = MEMCDATATYPE, .opaque = MEMCHTON32( MEMCOPAQUE ) }
+static const memc_msg memc_hdr_templates[ MEMCTEMPLATES ] = {
+	MEMCTEMPLATE( MEMCGET, 0 ),
+	MEMCTEMPLATE( MEMCSET, 8 ),     // flags and expiration
+	MEMCTEMPLATE( MEMCREPLACE, 8 ),
+	MEMCTEMPLATE( MEMCDELETE, 0 ),
+	MEMCTEMPLATE( MEMCQUIT, 0 ),
+	MEMCTEMPLATE( MEMCTOUCH, 4 ),   // expiration
+	MEMCTEMPLATE( MEMCSETQ, 8 ),    // memc_load, memc_write_batch
+	MEMCTEMPLATE( MEMCREPLACEQ, 8 ),
+	MEMCTEMPLATE( MEMCDELETEQ, 0 ),
+	MEMCTEMPLATE( MEMCNOOP, 0 ),
+};
+
+/*
+ * Only a test of the pointer without a hook, 19.10.2026. */
+#define MEMCTRACE( cm, pm, phase, opcode, err )  do{ if( (*(cm)).trace_hook!=NULL || (*(cm)).slowlog!=NULL ) memc_trace( (cm), (pm), (phase), (opcode), (err) ); }while(0)
+
+/*
+ * Shard of the statistics of the thread, 19.10.2026. */
+#define MEMCSTATSRETRY          1
+#define MEMCSTATSRECONNECT      2
+static __thread int     memc_stats_thread_shard = -1;
+static __thread int     memc_io_errno = 0; // errno of the failed read or write of the request of the thread, 19.10.2026
+static uint             memc_stats_shards_given = 0;
+
+/*
+ * Allocated MEMCs, for the fork handlers, 19.10.2026. */
+static pthread_mutex_t  memc_fork_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t   memc_fork_once = PTHREAD_ONCE_INIT;
+static MEMC            *memc_fork_list = NULL;
+
+/*
+ * Counter of the threads using the connection, 19.10.2026. The callers and the
+ * threads update it without the connection mutex. */
+int  memc_processing( dbs_conn *conn ){
+	if( conn==NULL ) return 0;
+	return __atomic_load_n( &(*conn).processing, __ATOMIC_ACQUIRE );
+}
+void  memc_processing_inc( dbs_conn *conn ){
+	if( conn==NULL ) return;
+	__atomic_add_fetch( &(*conn).processing, 1, __ATOMIC_ACQ_REL );
+}
+void  memc_processing_dec( dbs_conn *conn ){
+	int val = 0;
+	if( conn==NULL ) return;
+	val = __atomic_load_n( &(*conn).processing, __ATOMIC_ACQUIRE );
+	while( val>0 && ! __atomic_compare_exchange_n( &(*conn).processing, &val, val-1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+		;
+}
+
+/*
+ * Connection state machine, 19.10.2026. */
+int  memc_conn_state( dbs_conn *conn ){
+	if( conn==NULL ) return MEMCCONNFAILED;
+	return __atomic_load_n( &(*conn).state, __ATOMIC_ACQUIRE );
+}
+int  memc_conn_transition( dbs_conn *conn, int from, int to ){
+	if( conn==NULL ) return 0;
+	if( ! __atomic_compare_exchange_n( &(*conn).state, &from, to, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+		return 0;
+	memc_conn_wake( &(*conn), to );
+	return 1;
+}
+void  memc_conn_store( dbs_conn *conn, int state ){
+	if( conn==NULL ) return;
+	__atomic_store_n( &(*conn).state, state, __ATOMIC_SEQ_CST );
+	memc_conn_wake( &(*conn), state );
+}
+/*
+ * The waiters are counted, the syscall only if some thread sleeps. One waiter is
+ * woken when the connection is READY again, all of them otherwise (FAILED,
+ * IDLE or CLOSING return from memc_conn_acquire). */
+void  memc_conn_wake( dbs_conn *conn, int state ){
+	if( __atomic_load_n( &(*conn).waiters, __ATOMIC_SEQ_CST )<=0 ) return;
+	if( state==MEMCCONNBUSY || state==MEMCCONNCONNECTING ) return;
+	memc_conn_futex( &(*conn).state, FUTEX_WAKE, 0, ( state==MEMCCONNREADY ) ? 1 : INT_MAX );
+}
+int  memc_conn_futex( int *addr, int op, int val, int count ){
+	struct timespec ts;
+	ts.tv_sec = 0;
+	ts.tv_nsec = MEMCCONNWAITMS * 1000000L;
+#if defined(__linux__)
+	if( op==FUTEX_WAIT )
+		return (int) syscall( SYS_futex, &(*addr), FUTEX_WAIT_PRIVATE, val, &ts, NULL, 0 );
+	return (int) syscall( SYS_futex, &(*addr), FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0 );
+#else
+	if( op==FUTEX_WAIT ){
+		ts.tv_nsec = 50000L;
+		return nanosleep( &ts, NULL );
+	}
+	return 0;
+#endif
+}
+/*
+ * Waits in the futex of the state while the connection is BUSY or CONNECTING, 19.10.2026. */
+int  memc_conn_acquire( dbs_conn *conn ){
+	int state = MEMCCONNREADY;
+	if( conn==NULL ) return 0;
+	while( ! __atomic_compare_exchange_n( &(*conn).state, &state, MEMCCONNBUSY, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) ){
+		if( state!=MEMCCONNBUSY && state!=MEMCCONNCONNECTING )
+			return 0; // not usable before reconnect
+		__atomic_add_fetch( &(*conn).waiters, 1, __ATOMIC_SEQ_CST );
+		if( __atomic_load_n( &(*conn).state, __ATOMIC_SEQ_CST )==state )
+			memc_conn_futex( &(*conn).state, FUTEX_WAIT, state, 0 );
+		__atomic_sub_fetch( &(*conn).waiters, 1, __ATOMIC_SEQ_CST );
+		state = MEMCCONNREADY;
+	}
+	return 1;
+}
+void  memc_conn_release( dbs_conn *conn, int err ){
+	/*
+	 * The stream is out of sequence after an io error in the middle of a message. */
+	if( err==CBERRFILEOP || ( err>=MEMCRECVINVALIDDATAERR && err<=MEMCSENDINVALIDEXTERR && err!=MEMCRECVKEYNOTFOUND ) )
+		memc_conn_transition( &(*conn), MEMCCONNBUSY, MEMCCONNFAILED );
+	else
+		memc_conn_transition( &(*conn), MEMCCONNBUSY, MEMCCONNREADY ); // if not reset meanwhile
+}
 
+/*
+ * Request threads are detached. A completion is signalled at the end instead of
+ * joining the thread, 19.10.2026. */
+uint  memc_key_order( uchar *key, int keylen ){
+	uint hash = 0;
+	if( key==NULL || keylen<=0 ) return 0;
+	hash = memc_hash_key( &(*key), keylen );
+	if( hash==0 ) return 1;
+	return hash;
+}
+int  memc_start_thread( MEMC *cm, MEMC_parameter *pm, void* (*thr)( void* ), uint keyhash ){
+	int err = 0;
+	pthread_t thrid;
+	pthread_attr_t attr;
+	memc_completion *cpl = NULL;
+	if( cm==NULL || pm==NULL || thr==NULL ) return CBERRALLOC;
+	(*pm).completion = NULL;
+	if( (*cm).pending_created==0 ) return MEMCUNINITIALIZED;
+
+	pthread_mutex_lock( &(*cm).pend );
+	if( (*cm).completion_pool!=NULL ){
+		cpl = &(*(*cm).completion_pool);
+		(*cm).completion_pool = (*cpl).next;
+	}else{
+		++(*cm).completion_mallocs;
+	}
+	pthread_mutex_unlock( &(*cm).pend );
+	if( cpl==NULL )
+		cpl = (memc_completion*) malloc( sizeof( memc_completion ) );
+	if( cpl==NULL ) return CBERRALLOC;
+	(*cpl).keyhash = keyhash;
+	(*cpl).cindx = (*pm).cindx;
+	(*cpl).err = CBSUCCESS;
+	(*cpl).done = 0;
+	pthread_mutex_lock( &(*cm).pend );
+	(*cpl).next = (*cm).pending;
+	(*cm).pending = &(*cpl);
+	++(*cm).pending_count;
+	pthread_mutex_unlock( &(*cm).pend );
+	(*pm).completion = &(*cpl);
+
+	err = pthread_attr_init( &attr );
+	if( err==0 ){
+		err = pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+		if( err==0 )
+			err = pthread_create( &thrid, &attr, thr, &(*pm) ); // pointer pm is copied to free it at the end of thread
+		pthread_attr_destroy( &attr );
+	}
+	if( err!=0 ){
+		(*pm).completion = NULL;
+		pthread_mutex_lock( &(*cm).pend );
+		(*cpl).err = MEMCERRTHREAD;
+		(*cpl).done = 1;
+		pthread_cond_broadcast( &(*cm).pend_cond );
+		pthread_mutex_unlock( &(*cm).pend );
+	}
+	return err;
+}
+void  memc_thread_done( MEMC_parameter *pm, int err ){
+	MEMC *cm = NULL;
+	memc_completion *cpl = NULL;
+	if( pm==NULL ) return;
+	cm = (*pm).cm;
+	cpl = (*pm).completion;
+	(*pm).completion = NULL;
+	if( (*pm).trace_fanout!=NULL ){
+		memc_trace_fanout_done( &(*cm), &(*(*pm).trace_fanout), err ); // 19.10.2026
+		(*pm).trace_fanout = NULL;
+	}
+	memc_free_param( pm );
+	if( cm==NULL || cpl==NULL ) return;
+	/*
+	 * The last use of 'cm' in the thread. */
+	pthread_mutex_lock( &(*cm).pend );
+	(*cpl).err = err;
+	(*cpl).done = 1;
+	pthread_cond_broadcast( &(*cm).pend_cond );
+	pthread_mutex_unlock( &(*cm).pend );
+}
+/*
+ * Results of the replicas, 19.10.2026. 'result' is -1 at first. */
+void  memc_result_add( int *result, int err ){
+	int rank = 0, prevrank = 0;
+	if( result==NULL ) return;
+	rank = ( err==CBSUCCESS ) ? 0 : ( ( err<CBERROR ) ? 1 : 2 );
+	prevrank = ( *result==CBSUCCESS ) ? 0 : ( ( *result<CBERROR ) ? 1 : 2 );
+	if( *result<0 || rank<prevrank || ( rank==2 && prevrank==2 && err<*result ) )
+		*result = err;
+}
+/*
+ * The completions of the keys are left in the list until memc_wait_key of the key (or memc_wait_all)
+ * if 'result' is NULL, 19.10.2026. */
+int  memc_wait_pending( MEMC *cm, uint keyhash, int cindx, char all, int *result ){
+	char waiting = 0, match = 0;
+	memc_completion *cpl = NULL, *prev = NULL, *next = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( (*cm).pending_created==0 ) return CBSUCCESS;
+	pthread_mutex_lock( &(*cm).pend );
+	do{
+		waiting = 0;
+		prev = NULL;
+		cpl = &(*(*cm).pending);
+		while( cpl!=NULL ){
+			next = &(*(*cpl).next);
+			match = ( all==1 || ( keyhash!=0 && (*cpl).keyhash==keyhash ) || ( cindx>=0 && (*cpl).cindx==cindx ) ) ? 1 : 0 ;
+			if( (*cpl).done!=0 && ( all==1 || (*cpl).keyhash==0 || ( match==1 && result!=NULL ) || (*cm).pending_count>MEMCPENDINGMAX ) ){
+				/*
+				 * Completed, the result to the connection and back to the free list. */
+				if( (*cpl).cindx>=0 && (*cpl).cindx<MEMCMAXREDUNDANTDBS ){
+					if( ( (*cm).reaped & ( 1 << (*cpl).cindx ) )==0 || (*cm).reaped_err[ (*cpl).cindx ]==CBSUCCESS )
+						(*cm).reaped_err[ (*cpl).cindx ] = (*cpl).err;
+					(*cm).reaped |= ( 1 << (*cpl).cindx );
+				}
+				if( match==1 )
+					memc_result_add( &(*result), (*cpl).err );
+				if( prev==NULL )
+					(*cm).pending = &(*next);
+				else
+					(*prev).next = &(*next);
+				(*cpl).next = (*cm).completion_pool;
+				(*cm).completion_pool = &(*cpl);
+				--(*cm).pending_count;
+			}else{
+				if( (*cpl).done==0 && match==1 )
+					waiting = 1;
+				prev = &(*cpl);
+			}
+			cpl = &(*next);
+		}
+		if( waiting==1 )
+			pthread_cond_wait( &(*cm).pend_cond, &(*cm).pend );
+	}while( waiting==1 );
+	pthread_mutex_unlock( &(*cm).pend );
+	return CBSUCCESS;
+}
 
 int  memc_free_param( MEMC_parameter *pm ){
+	MEMC *cm = NULL;
 	if( pm==NULL ) return CBSUCCESS;
+	cm = (*pm).cm;
 	(*pm).cm = NULL;
 	(*pm).key = NULL;
 	(*pm).msg = NULL;
 	(*pm).ptr1 = NULL;
 	(*pm).ptr2 = NULL;
-	free( pm );
+	/*
+	 * Free list, 19.10.2026. */
+	if( cm!=NULL && (*cm).param_created!=0 ){
+		pthread_mutex_lock( &(*cm).param );
+		if( (*cm).param_pooled<MEMCPARAMPOOLSIZE ){
+			(*pm).next = (*cm).param_pool;
+			(*cm).param_pool = &(*pm);
+			++(*cm).param_pooled;
+			pm = NULL;
+		}
+		pthread_mutex_unlock( &(*cm).param );
+	}
+	if( pm!=NULL )
+		free( pm );
 	pm = NULL;
 	return CBSUCCESS;
 }
 
-int  memc_get_param( MEMC_parameter **pm ){
+int  memc_get_param( MEMC *cm, MEMC_parameter **pm ){
 	if( pm==NULL ) return CBERRALLOC;
-	*pm = (MEMC_parameter *) malloc( sizeof( MEMC_parameter ) );
+	*pm = NULL;
+	if( cm!=NULL && (*cm).param_created!=0 ){
+		pthread_mutex_lock( &(*cm).param );
+		if( (*cm).param_pool!=NULL ){
+			*pm = &(*(*cm).param_pool);
+			(*cm).param_pool = (**pm).next;
+			--(*cm).param_pooled;
+		}else{
+			++(*cm).param_mallocs;
+		}
+		pthread_mutex_unlock( &(*cm).param );
+	}
+	if( *pm==NULL )
+		*pm = (MEMC_parameter *) malloc( sizeof( MEMC_parameter ) );
 	if( *pm==NULL ) return CBERRALLOC;
-	(**pm).cm = NULL;
+	(**pm).next = NULL;
+	(**pm).cm = &(*cm);
 	(**pm).key = NULL;
 	(**pm).msg = NULL;
 	(**pm).keylen = 0;
 	(**pm).msglen = 0;
 	(**pm).msgbuflen = 0;
 	(**pm).cas = 0x00;
+	(**pm).cas64 = 0x00; // 19.10.2026
 	(**pm).dbsindx = 0;	// Index of the connection parameters in '(*cm).sesdbparams'
 	(**pm).cindx = 0;	// Index of the connection in '(*(*cn).token).conn'
 	(**pm).vbucketid = 0;	// Virtual bucket id (the same number can be used everywhere)
@@ -98,6 +552,10 @@ int  memc_get_param( MEMC_parameter **pm ){
 	(**pm).errc = CBSUCCESS;
 	(**pm).errg = CBSUCCESS;
 	(**pm).special = 0x00; // 1.10.2018, replace
+	(**pm).completion = NULL; // 19.10.2026
+	(**pm).trace_id = 0;
+	(**pm).trace_fanout = NULL;
+	memset( &(**pm).trace_ts[0], 0x00, sizeof( (**pm).trace_ts ) );
 	return CBSUCCESS;
 }
 
@@ -113,12 +571,13 @@ int  memc_connect( MEMC *cm, uchar **key, int keylen ){
 	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
 	//13.9.2018, the same function with or without the key: if( key==NULL || *key==NULL ) return CBERRALLOC;
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_CONNECT"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_CONNECT"); MEMCFLUSHLOG();
 
 	/*
 	 * Wait for the socket initialization (call to 'memc_reinit'). */
 	err = memc_join_previous( &(*cm) );
-	if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_connect: memc_join_previous, error %i.", err ); }
+	if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_connect: memc_join_previous, error %i.", err ); }
+	memc_fork_reconnect( &(*cm), 0 ); // sockets in a forked child, 19.10.2026
 
 	/*
 	 * Index in session database array. */
@@ -146,54 +605,61 @@ int  memc_reconnect( MEMC *cm, int indx ){
 	if( cm==NULL || (*cm).token==NULL ) return CBERRALLOC;
 	if( indx>=(*cm).redundant_servers_count ) return CBINDEXOUTOFBOUNDS;
 
-	if( (*cm).reinit_in_process==1 ){ // 13.9.2018
-		err = pthread_join( (*cm).reinit_thr, NULL); // 13.9.2018 just in case, not needed here if memc_connect is the only function to use
-		if( err!=0 ){ cb_clog( CBLOGDEBUG, err, "\nmemc_reconnect: pthread_join %i, errno %i '%s'.", err, errno, strerror( errno ) ); }
-	}
+	err = memc_join_reinit( &(*cm) ); // 13.9.2018 just in case, not needed here if memc_connect is the only function to use, 19.10.2026
+	if( err!=CBSUCCESS ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_reconnect: memc_join_reinit, error %i.", err ); }
 	/* Debug 17.8.2018 */
 /***
 	if( (*cm).session_databases>=1 ){
-		cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_connect: getaddrinfo ip '");
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_connect: getaddrinfo ip '");
 		for( i=0; i<(*(*cm).sesdbparams[ 0 ]).iplen; ++i )
-			cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 0 ]).ip[i] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, "' port '");
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 0 ]).ip[i] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "' port '");
 		for( i=0; i<(*(*cm).sesdbparams[ 0 ]).portlen; ++i )
-			cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 0 ]).port[i] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, "', dbsindx 0" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 0 ]).port[i] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "', dbsindx 0" );
 	}
 	if( (*cm).session_databases>=2 ){
-		cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_connect: getaddrinfo ip '");
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_connect: getaddrinfo ip '");
 		for( i=0; i<(*(*cm).sesdbparams[ 1 ]).iplen; ++i )
-			cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 1 ]).ip[i] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, "' port '");
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 1 ]).ip[i] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "' port '");
 		for( i=0; i<(*(*cm).sesdbparams[ 1 ]).portlen; ++i )
-			cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 1 ]).port[i] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, "', dbsindx 1" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "%c", (*(*cm).sesdbparams[ 1 ]).port[i] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "', dbsindx 1" );
 	}
  ***/
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_RECONNECT"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_RECONNECT"); MEMCFLUSHLOG();
 
 	/*
 	 * One parameter to the thread call. */
-	pm = (void*) malloc( sizeof( void* ) ); // 9.8.2017, 31.10.2018
-	if( pm==NULL ) return CBERRALLOC;
-	memc_get_param( &pm );
+	if( memc_processing( &(*(*(*cm).token).conn[ indx ]) )>0 ) return MEMCUNINITIALIZED; // 13.9.2018, before the parameters 19.10.2026
+	if( memc_conn_transition( &(*(*(*cm).token).conn[ indx ]), MEMCCONNIDLE, MEMCCONNCONNECTING )==0 && \
+	    memc_conn_transition( &(*(*(*cm).token).conn[ indx ]), MEMCCONNREADY, MEMCCONNCONNECTING )==0 && \
+	    memc_conn_transition( &(*(*(*cm).token).conn[ indx ]), MEMCCONNFAILED, MEMCCONNCONNECTING )==0 )
+		return MEMCUNINITIALIZED; // busy, connecting or closing, 19.10.2026
+
+	err = memc_get_param( &(*cm), &pm ); // 19.10.2026
+	if( err>=CBERROR || pm==NULL ){
+		memc_conn_transition( &(*(*(*cm).token).conn[ indx ]), MEMCCONNCONNECTING, MEMCCONNFAILED );
+		return CBERRALLOC;
+	}
 	(*pm).cm = &(*cm);
   	//16.9.2018: (*pm).dbsindx = ((*(*cm).token).starting_index + indx)%(*cm).session_databases; // index of the IP and port address to use
   	(*pm).dbsindx = ((*(*cm).token).starting_index + indx + 1)%(*cm).session_databases; // index of the IP and port address to use
 	(*pm).cindx = indx; // connection index
-cb_clog( CBLOGDEBUG, CBSUCCESS, ", INDX %i, DBINDX %i (reconnect)", (*pm).cindx, (*pm).dbsindx );
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, ", INDX %i, DBINDX %i (reconnect)", (*pm).cindx, (*pm).dbsindx );
 
-	if( (*(*(*cm).token).conn[ indx ]).processing>0 ) return MEMCUNINITIALIZED; // 13.9.2018
 
-	++( (*(*(*cm).token).conn[ indx ]).processing ); // 19.7.2018, 9.8.2018
-	(*(*(*cm).token).conn[ (*pm).cindx ]).thr_created = 0;
-	err = pthread_create( &( (*(*(*cm).token).conn[ (*pm).cindx ]).thr ), NULL, &memc_connect_thr, pm ); // pointer pm is copied to free it at the end of thread, 8.7.2018
+	memc_stats_event( &(*cm), indx, MEMCSTATSRECONNECT ); // 19.10.2026
+	MEMCPROBE2( reconnect, indx, (*pm).dbsindx );
+	memc_processing_inc( &(*(*(*cm).token).conn[ indx ]) ); // 19.7.2018, 9.8.2018
+	err = memc_start_thread( &(*cm), &(*pm), &memc_connect_thr, 0 ); // pointer pm is copied to free it at the end of thread, 8.7.2018, 19.10.2026
 	if( err!=0 ){
-              cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_connect: pthread_create cindx %i, error %i, errno %i, '%s'", indx, err, errno, strerror( errno ) );
-        }else{
-	     (*(*(*cm).token).conn[ (*pm).cindx ]).thr_created = 1;
+              MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_connect: pthread_create cindx %i, error %i, errno %i, '%s'", indx, err, errno, strerror( errno ) );
+	      memc_processing_dec( &(*(*(*cm).token).conn[ indx ]) ); // 19.10.2026
+	      memc_conn_transition( &(*(*(*cm).token).conn[ indx ]), MEMCCONNCONNECTING, MEMCCONNFAILED );
+	      memc_free_param( pm );
         }
 	return err;
 }
@@ -202,8 +668,9 @@ void* memc_connect_thr( void *pm ){
 	struct addrinfo  hints;
 
 	if( pm==NULL || (* (MEMC_parameter*) pm).cm==NULL || (*(* (MEMC_parameter*) pm).cm).token==NULL ){ // 16.8.2018
-	  cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_connect_thr, error %i.", CBERRALLOCTHR );
-	  cb_flush_log();
+	  MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_connect_thr, error %i.", CBERRALLOCTHR );
+	  MEMCFLUSHLOG();
+	  memc_thread_done( (MEMC_parameter*) pm, CBERRALLOCTHR ); // 19.10.2026
 	  pthread_exit( NULL );
 	  return NULL;
 	}
@@ -230,18 +697,18 @@ void* memc_connect_thr( void *pm ){
 	/* Debug 17.8.2018 */
 	/***
 	if( (*(* (MEMC_parameter*) pm).cm).session_databases>=1 ){
-		cb_flush_log();
-		cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_connect: INDX %i, getaddrinfo ip '", (* (MEMC_parameter*) pm).dbsindx);
+		MEMCFLUSHLOG();
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_connect: INDX %i, getaddrinfo ip '", (* (MEMC_parameter*) pm).dbsindx);
 		for( i=0; i<(*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).iplen; ++i )
-			cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).ip[i] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, "' (last: 0x%.2x) port'", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ].ip[ (*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).iplen ] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, " ip length %i.", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).iplen );
-		cb_flush_log();
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "%c", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).ip[i] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "' (last: 0x%.2x) port'", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ].ip[ (*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).iplen ] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, " ip length %i.", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).iplen );
+		MEMCFLUSHLOG();
 		for( i=0; i<(*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).portlen; ++i )
-			cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).port[i] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, "', dbsindx %i (last: 0x%.2x)", (* (MEMC_parameter*) pm).dbsindx, (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (*(* (MEMC_parameter*) pm).dbsindx ]).port[ (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).portlen ] );
-		cb_clog( CBLOGDEBUG, CBNEGATION, " port length %i.", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).portlen );
-		cb_flush_log();
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "%c", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).port[i] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "', dbsindx %i (last: 0x%.2x)", (* (MEMC_parameter*) pm).dbsindx, (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (*(* (MEMC_parameter*) pm).dbsindx ]).port[ (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).portlen ] );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, " port length %i.", (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).portlen );
+		MEMCFLUSHLOG();
 	}
 	 ***/
 
@@ -251,17 +718,17 @@ void* memc_connect_thr( void *pm ){
 		&(* (const char *) (*(*(* (MEMC_parameter*) pm).cm).sesdbparams[ (* (MEMC_parameter*) pm).dbsindx ]).port), &hints, &(* (MEMC_parameter*) pm).ptr1 );
 
 	if( (* (MEMC_parameter*) pm).errg!=0 ){
-		cb_clog( CBLOGERR, CBNEGATION, "\nmemc_connect_thr: getaddrinfo, error %i '%s'.", (* (MEMC_parameter*) pm).errg, gai_strerror( (* (MEMC_parameter*) pm).errg ) );
+		MEMCLOG( CBLOGERR, CBNEGATION, "\nmemc_connect_thr: getaddrinfo, error %i '%s'.", (* (MEMC_parameter*) pm).errg, gai_strerror( (* (MEMC_parameter*) pm).errg ) );
 	}
 
 /***
 if( (*(* (MEMC_parameter*) pm).cm).token!=NULL ){
    if( (*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ].fd<0 )
-	cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_connect_thr: error, indx %i fd %i.", (* (MEMC_parameter*) pm).dbsindx, (*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ].fd );
+	MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_connect_thr: error, indx %i fd %i.", (* (MEMC_parameter*) pm).dbsindx, (*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ].fd );
    else
-	cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_connect_thr: ok, indx %i fd %i.", (* (MEMC_parameter*) pm).dbsindx, (*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ].fd );
+	MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_connect_thr: ok, indx %i fd %i.", (* (MEMC_parameter*) pm).dbsindx, (*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ].fd );
 }else{
-	cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_connect_thr: (*(* (MEMC_parameter*) pm).cm).token was NULL.");
+	MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_connect_thr: (*(* (MEMC_parameter*) pm).cm).token was NULL.");
 }
  ***/
 
@@ -292,14 +759,14 @@ if( (*(* (MEMC_parameter*) pm).cm).token!=NULL ){
 			 * Create the new socket, 30.8.2018. */
 			(* (MEMC_parameter*) pm).errs = memc_create_socket( &(*(* (MEMC_parameter*) pm).cm), (* (MEMC_parameter*) pm).cindx );
 			if( (* (MEMC_parameter*) pm).errs>=CBERROR ){ 
-				cb_clog( CBLOGERR, (* (MEMC_parameter*) pm).errs, "\nmemc_connect_thr: memc_create_socket, error %i.", (* (MEMC_parameter*) pm).errs );
+				MEMCLOG( CBLOGERR, (* (MEMC_parameter*) pm).errs, "\nmemc_connect_thr: memc_create_socket, error %i.", (* (MEMC_parameter*) pm).errs );
 			}
 			//13.9.2018: pthread_mutex_unlock( &(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ].mtx );
 		   }
 		   if( (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).connected==0 ){ // 30.8.2018
 		   	(* (MEMC_parameter*) pm).errc = connect( (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).fd, &(*(*(* (MEMC_parameter*) pm).ptr1).ai_addr), (*(* (MEMC_parameter*) pm).ptr1).ai_addrlen );
 		   	if( (* (MEMC_parameter*) pm).errc < 0) {
-	           	   cb_clog( CBLOGERR, MEMCERRCONNECT, "\nmemc_connect_thr: cindx %i error %i, errno %i, '%s'", (* (MEMC_parameter*) pm).cindx, (* (MEMC_parameter*) pm).errc, errno, strerror( errno ) );
+	           	   MEMCLOG( CBLOGERR, MEMCERRCONNECT, "\nmemc_connect_thr: cindx %i error %i, errno %i, '%s'", (* (MEMC_parameter*) pm).cindx, (* (MEMC_parameter*) pm).errc, errno, strerror( errno ) );
 		   	   (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).connected = 0;
 		   	   (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).dbsindx = -1; // 30.8.2018
 	           	}else{
@@ -310,10 +777,10 @@ if( (*(* (MEMC_parameter*) pm).cm).token!=NULL ){
 		}else{
 			//9.8.2018: if( (*(*(* (MEMC_parameter*) pm).cm).token).conn[(* (MEMC_parameter*) pm).dbsindx].fd<0 )
 			if( (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[(* (MEMC_parameter*) pm).cindx]).fd<0 )
-				cb_clog( CBLOGDEBUG, MEMCERRCONNECT, "\nmemc_connect_thr: fd was %i.", (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[(* (MEMC_parameter*) pm).cindx]).fd );
+				MEMCLOG( CBLOGDEBUG, MEMCERRCONNECT, "\nmemc_connect_thr: fd was %i.", (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[(* (MEMC_parameter*) pm).cindx]).fd );
 			if( (*(* (MEMC_parameter*) pm).ptr1).ai_addr==NULL )
-				cb_clog( CBLOGDEBUG, MEMCERRCONNECT, "\nmemc_connect_thr: (*(* (MEMC_parameter*) pm).ptr1).ai_addr was NULL.");
-			cb_flush_log();
+				MEMCLOG( CBLOGDEBUG, MEMCERRCONNECT, "\nmemc_connect_thr: (*(* (MEMC_parameter*) pm).ptr1).ai_addr was NULL.");
+			MEMCFLUSHLOG();
 		}
 
 		/*
@@ -328,88 +795,113 @@ if( (*(* (MEMC_parameter*) pm).cm).token!=NULL ){
 	}
 /***
         if( (* (MEMC_parameter*) pm).errc<0 ){
-          cb_clog( CBLOGERR, MEMCERRSOCKET, "\nmemc_connect_thr: CONNECT ERROR ERRC %i, errg %i, index %i, dbsindex %i, fd %i, errno %i '%s'.", (* (MEMC_parameter*) pm).errc, (* (MEMC_parameter*) pm).errg, (* (MEMC_parameter*) pm).cindx, (* (MEMC_parameter*) pm).dbsindx, \
+          MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_connect_thr: CONNECT ERROR ERRC %i, errg %i, index %i, dbsindex %i, fd %i, errno %i '%s'.", (* (MEMC_parameter*) pm).errc, (* (MEMC_parameter*) pm).errg, (* (MEMC_parameter*) pm).cindx, (* (MEMC_parameter*) pm).dbsindx, \
 	     (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).fd , errno, strerror( errno ));
           (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).lasterr = MEMCERRCONNECT;
         }else{
-          cb_clog( CBLOGERR, MEMCERRSOCKET, "\nmemc_connect_thr: CONNECT SUCCESS ERRC %i, errg %i, index %i, dbsindex %i, fd %i, errno %i '%s'.", (* (MEMC_parameter*) pm).errc, (* (MEMC_parameter*) pm).errg, (* (MEMC_parameter*) pm).cindx, (* (MEMC_parameter*) pm).dbsindx, \
+          MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_connect_thr: CONNECT SUCCESS ERRC %i, errg %i, index %i, dbsindex %i, fd %i, errno %i '%s'.", (* (MEMC_parameter*) pm).errc, (* (MEMC_parameter*) pm).errg, (* (MEMC_parameter*) pm).cindx, (* (MEMC_parameter*) pm).dbsindx, \
 	     (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).fd , errno, strerror( errno ));
           (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).lasterr = CBSUCCESS; // 19.8.2018
 	}
  ***/
 
-	--( (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).processing ); // 9.8.2018
-	if( (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).processing<0 )
-		(*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).processing = 0;
+	/*
+	 * Not changed if memc_reinit reset the state meanwhile, 19.10.2026. */
+	if( (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).connected==1 )
+		memc_conn_transition( &(*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]), MEMCCONNCONNECTING, MEMCCONNREADY );
+	else
+		memc_conn_transition( &(*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]), MEMCCONNCONNECTING, MEMCCONNFAILED );
+
+	MEMCPROBE4( connect, (* (MEMC_parameter*) pm).cindx, (* (MEMC_parameter*) pm).dbsindx, \
+		(*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).fd, (* (MEMC_parameter*) pm).errc ); // 19.10.2026
+	memc_processing_dec( &(*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]) ); // 9.8.2018, 19.10.2026
 	pthread_mutex_unlock( &(*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).mtxconn ); // 13.9.2018
 
-	memc_free_param( pm );
+	memc_thread_done( (MEMC_parameter*) pm, ( (*(*(*(* (MEMC_parameter*) pm).cm).token).conn[ (* (MEMC_parameter*) pm).cindx ]).connected==1 ) ? CBSUCCESS : MEMCERRCONNECT ); // 19.10.2026
 
-	cb_flush_log();
+	MEMCFLUSHLOG();
 	pthread_exit( NULL );
 
 	return NULL; // 10.7.2018
 }
 
-int  memc_join_previous( MEMC *cm ){
-	int indx = 0, cnt = 0, ret = CBSUCCESS, err = CBSUCCESS;
-	int  smallest_connection_error = CBSUCCESS;
-	char one_connection_succeeded = 0;
+int  memc_join_reinit( MEMC *cm ){
+	int indx = 0, ret = CBSUCCESS, err = CBSUCCESS, created = 1;
 	if( cm==NULL ) return CBERRALLOC;
-	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
-
 
 	/*
 	 * Reinit, moved here 7.8.2018. */
-	if( (*cm).reinit_in_process == 1 ){
+	if( __atomic_load_n( &(*cm).reinit_in_process, __ATOMIC_ACQUIRE )==1 ){
 
-		err = pthread_join( (*cm).reinit_thr, NULL);
+		/*
+		 * One caller joins the thread, the others wait for the end, 19.10.2026. */
+		if( __atomic_compare_exchange_n( &(*cm).reinit_thr_created, &created, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ){
+			err = pthread_join( (*cm).reinit_thr, NULL);
+		}else{
+			while( __atomic_load_n( &(*cm).reinit_in_process, __ATOMIC_ACQUIRE )==1 )
+				sched_yield();
+		}
 		// NEVER SET HERE: (*cm).reinit_in_process = 0;
 		// SET WHEN ALL THE SOCKETS ARE DONE, 7.8.2018
-		if( err!=0 ){ cb_clog( CBLOGERR, CBNEGATION, "\npthread_join (init): indx %i, err %i, errno %i '%s'", indx, err, errno, strerror( errno ) ); }
+		if( err!=0 ){ MEMCLOG( CBLOGERR, CBNEGATION, "\npthread_join (init): indx %i, err %i, errno %i '%s'", indx, err, errno, strerror( errno ) ); }
 
 		/*
 		 * Errors preventing the connections to succeed, 19.8.2018. */
 		if( (*cm).reinit_err==MEMCERRSOCKET || (*cm).reinit_err==MEMCERRTHREAD || (*cm).reinit_err==MEMCUNINITIALIZED ){ // 19.8.2018
 			// (*cm).reinit_err==MEMCERRSOCOPT ){ // 19.8.2018
-			cb_clog( CBLOGERR, CBNEGATION, "\npthread_join (init): reinit, error %i.", (*cm).reinit_err );
+			MEMCLOG( CBLOGERR, CBNEGATION, "\npthread_join (init): reinit, error %i.", (*cm).reinit_err );
 			//7.9.2018: ret = err;
 			ret = (*cm).reinit_err;
 		}
 	}
+	return ret;
+}
+/*
+ * Waits the previous requests of the same key, 19.10.2026. With 'result', returns the result of
+ * the requests of the key if the reinit succeeded. */
+int  memc_join_key( MEMC *cm, uint keyhash, int *result ){
+	int err = CBSUCCESS;
+	if( cm==NULL ) return CBERRALLOC;
+	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
+	err = memc_join_reinit( &(*cm) );
+	if( result!=NULL ) *result = -1;
+	memc_wait_pending( &(*cm), keyhash, -1, 0, &(*result) );
+	if( err==CBSUCCESS && result!=NULL && *result>CBSUCCESS )
+		return *result;
+	return err;
+}
+/*
+ * Waits all of the previous requests. */
+int  memc_join_previous( MEMC *cm ){
+	int indx = 0, cnt = 0, ret = CBSUCCESS, completed = 0, result = -1;
+	int  reaped_err[ MEMCMAXREDUNDANTDBS ];
+	if( cm==NULL ) return CBERRALLOC;
+	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
+
+	ret = memc_join_reinit( &(*cm) );
+
+	/*
+	 * Completions instead of joining the threads, 19.10.2026. The results of the
+	 * connections are kept from the completions waited after the previous call. */
+	memc_wait_pending( &(*cm), 0, -1, 1, NULL );
+	if( (*cm).pending_created!=0 ){
+		pthread_mutex_lock( &(*cm).pend );
+		completed = (*cm).reaped;
+		memcpy( &reaped_err[0], &(*cm).reaped_err[0], sizeof( reaped_err ) );
+		(*cm).reaped = 0;
+		pthread_mutex_unlock( &(*cm).pend );
+	}
 
 	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
 
 		/*
 		 * All the connections. */
 		if( (*(*cm).token).conn!=NULL && (*(*cm).token).conn[ indx ]!=NULL ){
-		   if( (*(*(*cm).token).conn[ indx ]).processing != 0 && (*(*(*cm).token).conn[ indx ]).thr!=NULL && \
-			(*(*(*cm).token).conn[ indx ]).thr_created==1 ){ // 7.8.2018, 9.8.2018
-/***
-cb_clog( CBLOGDEBUG, CBNEGATION, "\npthread_join (conn), indx %i", indx );
-if( (*(*cm).token).conn[ indx ].thr!=NULL )
-	cb_clog( CBLOGDEBUG, CBNEGATION, " thr not null, ");
-else
-	cb_clog( CBLOGDEBUG, CBNEGATION, " thr null, ");
-cb_clog( CBLOGDEBUG, CBNEGATION, "processing %i", (*(*cm).token).conn[ indx ].processing );
-cb_flush_log();
- ***/
-			err = pthread_join( (*(*(*cm).token).conn[ indx ]).thr, NULL);
-			//9.8.2018: (*(*cm).token).conn[ indx ].processing = 0;
-			if( err!=0 ){ cb_clog( CBLOGERR, CBNEGATION, "\npthread_join (conn): indx %i, err %i '%s', errno %i '%s'", indx, err, strerror( err ), errno, strerror( errno ) ); }
-
-			if( (*(*(*cm).token).conn[ indx ]).lasterr>=CBERROR ){
-				cb_clog( CBLOGERR, CBNEGATION, "\npthread_join (conn): connection %i, error %i.", indx, err );
-			}else if( (*(*(*cm).token).conn[ indx ]).lasterr<CBNEGATION ){
-				one_connection_succeeded = 1;
-			}
-			if( indx==0 ){
-				/* First. */
-				smallest_connection_error = (*(*(*cm).token).conn[ indx ]).lasterr;
-			}else if( smallest_connection_error>(*(*(*cm).token).conn[ indx ]).lasterr ){
-				/* Smallest. */
-				smallest_connection_error = (*(*(*cm).token).conn[ indx ]).lasterr;
+		   if( ( completed & ( 1 << indx ) )!=0 ){ // 7.8.2018, 9.8.2018, a request thread ended, 19.10.2026
+			if( reaped_err[ indx ]>=CBERROR ){
+				MEMCLOG( CBLOGERR, CBNEGATION, "\nmemc_join_previous: connection %i, error %i.", indx, reaped_err[ indx ] );
 			}
+			memc_result_add( &result, reaped_err[ indx ] );
 		   }
 		}
 
@@ -423,12 +915,12 @@ cb_flush_log();
 		return ret; // reinit error, 19.8.2018
 	if( (*cm).redundant_servers_count>(*cm).session_databases )
 		return CBINDEXOUTOFBOUNDS;
-	if( one_connection_succeeded==0 && smallest_connection_error>=CBNEGATION )
-		return smallest_connection_error; // 19.8.2018
+	if( result>CBSUCCESS )
+		return result; // 19.8.2018, a status of the server 19.10.2026
 
 	/*
-	 * If one connection succeeded, returns CBSUCCESS. Otherwice the smallest of the connection errors.
-	 * If reinit fails, 'ret'. 19.8.2018. */
+	 * If one connection succeeded, returns CBSUCCESS. Otherwice the status of the server or the
+	 * smallest of the connection errors. If reinit fails, 'ret'. 19.8.2018, 19.10.2026. */
 	return CBSUCCESS;
 }
 
@@ -440,6 +932,7 @@ int  memc_close_all( MEMC *cm ){
 			close( (*(*(*cm).token).conn[ indx ]).fd ); // Close in server after fork, shutdown at client
 			(*(*(*cm).token).conn[ indx ]).fd = -1;
 		}
+		memc_conn_store( &(*(*(*cm).token).conn[ indx ]), MEMCCONNIDLE ); // 19.10.2026
 	}
 	return CBSUCCESS;
 }
@@ -453,81 +946,68 @@ int  memc_close_mutexes( MEMC *cm ){
 			if( (*(*(*cm).token).conn[ indx ]).thr!=NULL ){ // 23.10.2018
 				errn = pthread_join( (*(*(*cm).token).conn[ indx ]).thr, NULL);
 		        	if( errn!=0 && errn!=ESRCH ){ 
-					cb_clog( CBLOGDEBUG, errn, "\nmemc_close_mutexes: pthread_join (1), error %i, errno %i '%s'", errn, errno, strerror( errno ) ); 
+					MEMCLOG( CBLOGDEBUG, errn, "\nmemc_close_mutexes: pthread_join (1), error %i, errno %i '%s'", errn, errno, strerror( errno ) ); 
 					if( errn==EDEADLK ) {
-						cb_clog( CBLOGDEBUG, errn, ", EDEADLK. A deadlock was detected or the value of thread specifies the calling thread.");
+						MEMCLOG( CBLOGDEBUG, errn, ", EDEADLK. A deadlock was detected or the value of thread specifies the calling thread.");
 					}
-					cb_clog( CBLOGDEBUG, errn, "." ); 
+					MEMCLOG( CBLOGDEBUG, errn, "." ); 
 				}
 			}
 			//if( (*(*(*cm).token).conn[ indx ]).mtx!=PTHREAD_MUTEX_INITIALIZER  ){
 			if( (*(*(*cm).token).conn[ indx ]).mtx_created!=0 ){
 				(*(*(*cm).token).conn[ indx ]).mtx_created = 0;
 	                        errn = pthread_mutex_destroy( &(*(*(*cm).token).conn[ indx ]).mtx );
-	                        if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (%i mtx), errno %i '%s'.", indx, errno, strerror( errno ) ); 
+	                        if( errn!=0 ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (%i mtx), errno %i '%s'.", indx, errno, strerror( errno ) ); 
 				}//else{ (*(*(*cm).token).conn[ indx ]).mtx = PTHREAD_MUTEX_INITIALIZER; }
 			}
 			//if( (*(*(*cm).token).conn[ indx ]).mtxconn!=PTHREAD_MUTEX_INITIALIZER  ){
 			if( (*(*(*cm).token).conn[ indx ]).mtxconn_created!=0  ){
 				(*(*(*cm).token).conn[ indx ]).mtxconn_created = 0;
 	                        errn = pthread_mutex_destroy( &(*(*(*cm).token).conn[ indx ]).mtxconn );
-        	                if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (%i mtxconn), errno %i '%s'.", indx, errno, strerror( errno ) ); 
+        	                if( errn!=0 ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (%i mtxconn), errno %i '%s'.", indx, errno, strerror( errno ) ); 
 				}//else{ (*(*(*cm).token).conn[ indx ]).mtxconn = PTHREAD_MUTEX_INITIALIZER; }
 			}
                 }
         }
 
-	//if( (*cm).send!=PTHREAD_MUTEX_INITIALIZER  ){
-	if( (*cm).send_created!=0 ){
-		(*cm).send_created = 0;
-	        errn = pthread_mutex_destroy( &(*cm).send );
-        	if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (1), errno %i '%s'", errno, strerror( errno ) ); 
-		}//else{ (*cm).send=PTHREAD_MUTEX_INITIALIZER; }
-	}
-	//if( (*cm).recv!=PTHREAD_MUTEX_INITIALIZER  ){
-	if( (*cm).recv_created!=0 ){
-		(*cm).recv_created = 0;
-	        errn = pthread_mutex_destroy( &(*cm).recv );
-	        if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (2), errno %i '%s'", errno, strerror( errno ) ); 
-		}//else{ (*cm).recv=PTHREAD_MUTEX_INITIALIZER; }
-	}
 	//if( (*cm).set!=PTHREAD_MUTEX_INITIALIZER  ){
 	if( (*cm).set_created!=0 ){
 		(*cm).set_created = 0;
 	        errn = pthread_mutex_destroy( &(*cm).set );
-	        if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (3), errno %i '%s'", errno, strerror( errno ) );  
+	        if( errn!=0 ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (3), errno %i '%s'", errno, strerror( errno ) );  
 		}//else{ (*cm).set=PTHREAD_MUTEX_INITIALIZER; }
 	}
 	//if( (*cm).delete!=PTHREAD_MUTEX_INITIALIZER  ){
 	if( (*cm).delete_created!=0 ){
 		(*cm).delete_created = 0;
 	        errn = pthread_mutex_destroy( &(*cm).delete );
-	        if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (4), errno %i '%s'", errno, strerror( errno ) );
+	        if( errn!=0 ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (4), errno %i '%s'", errno, strerror( errno ) );
 		}//else{ (*cm).delete=PTHREAD_MUTEX_INITIALIZER; }
 	}
 	//if( (*cm).quit!=PTHREAD_MUTEX_INITIALIZER  ){
 	if( (*cm).quit_created!=0 ){
 		(*cm).quit_created = 0;
 	        errn = pthread_mutex_destroy( &(*cm).quit );
-	        if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (5), errno %i '%s'", errno, strerror( errno ) );
+	        if( errn!=0 ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (5), errno %i '%s'", errno, strerror( errno ) );
 		}//else{ (*cm).quit=PTHREAD_MUTEX_INITIALIZER; }
 	}
 
-	if( (*cm).reinit_thr!=NULL && (*cm).reinit_thr_created==1 ){
+	errn = 1;
+	if( (*cm).reinit_thr!=NULL && __atomic_compare_exchange_n( &(*cm).reinit_thr_created, &errn, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ){ // 19.10.2026, once
 		errn = pthread_join( (*cm).reinit_thr, NULL); // 23.10.2018
         	if( errn!=0 && errn!=ESRCH ){ // "No such process." errno.h
-			cb_clog( CBLOGDEBUG, errn, "\nmemc_close_mutexes: pthread_join (2), error %i, errno %i '%s'", errn, errno, strerror( errno ) );
+			MEMCLOG( CBLOGDEBUG, errn, "\nmemc_close_mutexes: pthread_join (2), error %i, errno %i '%s'", errn, errno, strerror( errno ) );
 			if( errn==EDEADLK ) {
-				cb_clog( CBLOGDEBUG, errn, ", EDEADLK. A deadlock was detected or the value of thread specifies the calling thread.");
+				MEMCLOG( CBLOGDEBUG, errn, ", EDEADLK. A deadlock was detected or the value of thread specifies the calling thread.");
 			}
-			cb_clog( CBLOGDEBUG, errn, "." );
+			MEMCLOG( CBLOGDEBUG, errn, "." );
 		}
 	}
 	//if( (*cm).init!=PTHREAD_MUTEX_INITIALIZER  ){
 	if( (*cm).init_created!=0 ){
 		(*cm).init_created = 0;
 	        errn = pthread_mutex_destroy( &(*cm).init );
-	        if( errn!=0 ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (init), errno %i '%s'", errno, strerror( errno ) );
+	        if( errn!=0 ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_close_mutexes: pthread_mutex_destroy (init), errno %i '%s'", errno, strerror( errno ) );
 		}//else{ (*cm).init=PTHREAD_MUTEX_INITIALIZER; }
 	}
 
@@ -540,9 +1020,9 @@ int  memc_close_mutexes( MEMC *cm ){
 int  memc_init( MEMC *cm ){
 	if( cm==NULL ) return CBERRALLOC;
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_INIT"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_INIT"); MEMCFLUSHLOG();
 
-	(*cm).reinit_in_process = 1;
+	__atomic_store_n( &(*cm).reinit_in_process, 1, __ATOMIC_RELEASE );
 
 	return memc_init_inner( &(*cm) );
 }
@@ -551,64 +1031,599 @@ int  memc_init_inner( MEMC *cm ){
 	if( cm==NULL ) return CBERRALLOC;
 
 	/* Moved here 11.9.2018: */
-	//(*cm).send = PTHREAD_MUTEX_INITIALIZER;
-	err = pthread_mutex_init( &(*cm).send, NULL );
-	if( err!=0 ){ cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
-	(*cm).send_created = 1;
-	//(*cm).recv = PTHREAD_MUTEX_INITIALIZER;
-	err = pthread_mutex_init( &(*cm).recv, NULL );
-	if( err!=0 ){ cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
-	(*cm).recv_created = 1;
+	/*
+	 * The connection is owned by the request in state BUSY, the global send and
+	 * recv mutexes were removed, 19.10.2026. */
 	//(*cm).set = PTHREAD_MUTEX_INITIALIZER;
 	err = pthread_mutex_init( &(*cm).set, NULL );
-	if( err!=0 ){ cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
+	if( err!=0 ){ MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
 	(*cm).set_created = 1;
 	//(*cm).delete = PTHREAD_MUTEX_INITIALIZER;
 	err = pthread_mutex_init( &(*cm).delete, NULL );
-	if( err!=0 ){ cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
+	if( err!=0 ){ MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
 	(*cm).delete_created = 1;
 	//(*cm).quit = PTHREAD_MUTEX_INITIALIZER;
 	err = pthread_mutex_init( &(*cm).quit, NULL );
 	(*cm).quit_created = 1;
-	if( err!=0 ){ cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
+	if( err!=0 ){ MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
 	//(*cm).init = PTHREAD_MUTEX_INITIALIZER;
 	err = pthread_mutex_init( &(*cm).init, NULL );
-	if( err!=0 ){ cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
+	if( err!=0 ){ MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) ); }
 	(*cm).init_created = 1;
 	/* /Moved */
 
-	(*cm).reinit_in_process = 1;
+	__atomic_store_n( &(*cm).reinit_in_process, 1, __ATOMIC_RELEASE );
 	//(*cm).reinit_thr = PTHREAD_MUTEX_INITIALIZER;
 	err = pthread_create( &(*cm).reinit_thr, NULL, &memc_init_thr, &(*cm) );
 	if( err!=0 ){
 		(*cm).reinit_thr_created = 0;
-              	cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_create, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
+              	MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_init_inner: pthread_create, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
 		return MEMCUNINITIALIZED; // 7.9.2018
 	}
-	(*cm).reinit_thr_created = 1;
+	__atomic_store_n( &(*cm).reinit_thr_created, 1, __ATOMIC_RELEASE ); // 19.10.2026
 	return CBSUCCESS;
 }
 int  memc_wait_all( MEMC *cm ){
 	if( cm==NULL || (*cm).token==NULL ) return CBERRALLOC;
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_WAIT_ALL"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_WAIT_ALL"); MEMCFLUSHLOG();
 
 	return memc_join_previous( &(*cm) );
 }
+int  memc_wait_key( MEMC *cm, uchar **key, int keylen ){
+	int result = -1;
+	if( cm==NULL || key==NULL || *key==NULL || (*cm).token==NULL ) return CBERRALLOC;
+	return memc_join_key( &(*cm), memc_key_order( &(**key), keylen ), &result );
+}
 int  memc_reinit( MEMC *cm ){
 	int err = CBSUCCESS;
 	if( cm==NULL || (*cm).token==NULL ) return CBERRALLOC;
 
-	(*cm).reinit_in_process = 1;
+	MEMCPROBE2( reinit, getpid(), 0 ); // 19.10.2026
+	memc_wait_pending( &(*cm), 0, -1, 1, NULL ); // 19.10.2026, before closing the sockets
+	__atomic_store_n( &(*cm).reinit_in_process, 1, __ATOMIC_RELEASE );
 
 	err = memc_close_all( &(*cm) );
 	if( err>=CBERROR ) return err;
 
 	err = memc_close_mutexes( &(*cm) ); // 11.9.2018
-	if( err!=CBSUCCESS ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_reinit: memc_close_mutexes, error %i", err ); }
+	if( err!=CBSUCCESS ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_reinit: memc_close_mutexes, error %i", err ); }
 
 	return memc_init_inner( &(*cm) );
 }
+/*
+ * Fork handlers, 19.10.2026. The prepare handler does not wait the requests in
+ * progress. It locks the mutexes of every allocated MEMC kept only for a moment.
+ * The parent unlocks them. The child unlocks them as well, creates again the
+ * mutexes kept over the network (their owners are not in the child), closes the
+ * inherited sockets (shared with the parent) and marks the connections to be
+ * reconnected at the first use. */
+void  memc_fork_install( void ){
+	int err = 0;
+	err = pthread_atfork( &memc_fork_prepare, &memc_fork_parent, &memc_fork_child );
+	if( err!=0 ){ MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_fork_install: pthread_atfork, error %i.", err ); }
+}
+void  memc_fork_register( MEMC *cm ){
+	if( cm==NULL ) return;
+	pthread_once( &memc_fork_once, &memc_fork_install );
+	pthread_mutex_lock( &memc_fork_mtx );
+	(*cm).fork_next = memc_fork_list;
+	memc_fork_list = &(*cm);
+	pthread_mutex_unlock( &memc_fork_mtx );
+}
+void  memc_fork_unregister( MEMC *cm ){
+	MEMC *ptr = NULL, *prev = NULL;
+	if( cm==NULL ) return;
+	pthread_mutex_lock( &memc_fork_mtx );
+	for( ptr = memc_fork_list; ptr!=NULL; ptr = (*ptr).fork_next ){
+		if( ptr==cm ){
+			if( prev==NULL )
+				memc_fork_list = (*ptr).fork_next;
+			else
+				(*prev).fork_next = (*ptr).fork_next;
+			break;
+		}
+		prev = &(*ptr);
+	}
+	(*cm).fork_next = NULL;
+	pthread_mutex_unlock( &memc_fork_mtx );
+}
+void  memc_fork_prepare( void ){
+	int indx = 0;
+	MEMC *cm = NULL;
+	pthread_mutex_lock( &memc_fork_mtx );
+	for( cm = memc_fork_list; cm!=NULL; cm = (*cm).fork_next ){
+		(*cm).fork_locked = 0;
+
+		/*
+		 * In the order the threads lock them. Not 'init', 'quit' and 'mtxconn', the
+		 * requests in progress keep them over the network. */
+		if( (*cm).token!=NULL && (*(*cm).token).conn!=NULL ){
+			for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
+				if( (*(*cm).token).conn[ indx ]==NULL ) continue;
+				pthread_mutex_lock( &(*(*(*cm).token).conn[ indx ]).mtx );
+			}
+			(*cm).fork_locked |= MEMCFORKCONN;
+		}
+		if( (*cm).set_created!=0 ){ pthread_mutex_lock( &(*cm).set ); (*cm).fork_locked |= MEMCFORKSET; } // not taken by the requests
+		if( (*cm).delete_created!=0 ){ pthread_mutex_lock( &(*cm).delete ); (*cm).fork_locked |= MEMCFORKDELETE; }
+		if( (*cm).flight_created!=0 ){ pthread_mutex_lock( &(*cm).flight ); (*cm).fork_locked |= MEMCFORKFLIGHT; }
+		if( (*cm).param_created!=0 ){ pthread_mutex_lock( &(*cm).param ); (*cm).fork_locked |= MEMCFORKPARAM; }
+		if( (*cm).pending_created!=0 ){ pthread_mutex_lock( &(*cm).pend ); (*cm).fork_locked |= MEMCFORKPEND; }
+		if( (*cm).nearcache!=NULL && (*(*cm).nearcache).mtx_created!=0 ){
+			pthread_mutex_lock( &(*(*cm).nearcache).mtx ); (*cm).fork_locked |= MEMCFORKNEARCACHE; }
+		if( (*cm).negcache!=NULL && (*(*cm).negcache).mtx_created!=0 ){
+			pthread_mutex_lock( &(*(*cm).negcache).mtx ); (*cm).fork_locked |= MEMCFORKNEGCACHE; }
+		if( (*cm).prefork!=NULL && (*(*cm).prefork).mtx_created!=0 ){
+			pthread_mutex_lock( &(*(*cm).prefork).mtx ); (*cm).fork_locked |= MEMCFORKPREFORK;
+			if( (*(*cm).prefork).owner==(int) getpid() ){ // 19.10.2026
+				memc_prefork_reap( &(*(*cm).prefork) );
+				memc_prefork_choose( &(*(*cm).prefork) ); } }
+	}
+}
+void  memc_fork_unlock( MEMC *cm ){
+	int indx = 0;
+	if( cm==NULL ) return;
+	if( ( (*cm).fork_locked & MEMCFORKPREFORK )!=0 ) pthread_mutex_unlock( &(*(*cm).prefork).mtx );
+	if( ( (*cm).fork_locked & MEMCFORKNEGCACHE )!=0 ) pthread_mutex_unlock( &(*(*cm).negcache).mtx );
+	if( ( (*cm).fork_locked & MEMCFORKNEARCACHE )!=0 ) pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+	if( ( (*cm).fork_locked & MEMCFORKPEND )!=0 ) pthread_mutex_unlock( &(*cm).pend );
+	if( ( (*cm).fork_locked & MEMCFORKPARAM )!=0 ) pthread_mutex_unlock( &(*cm).param );
+	if( ( (*cm).fork_locked & MEMCFORKFLIGHT )!=0 ) pthread_mutex_unlock( &(*cm).flight );
+	if( ( (*cm).fork_locked & MEMCFORKDELETE )!=0 ) pthread_mutex_unlock( &(*cm).delete );
+	if( ( (*cm).fork_locked & MEMCFORKSET )!=0 ) pthread_mutex_unlock( &(*cm).set );
+	if( ( (*cm).fork_locked & MEMCFORKCONN )!=0 ){
+		for( indx=(*cm).redundant_servers_count-1; indx>=0; --indx ){
+			if( indx>=MEMCMAXREDUNDANTDBS || (*(*cm).token).conn[ indx ]==NULL ) continue;
+			pthread_mutex_unlock( &(*(*(*cm).token).conn[ indx ]).mtx );
+		}
+	}
+	(*cm).fork_locked = 0;
+}
+void  memc_fork_parent( void ){
+	int empty = 0;
+	MEMC *cm = NULL;
+	for( cm = memc_fork_list; cm!=NULL; cm = (*cm).fork_next ){
+		empty = 0;
+		if( ( (*cm).fork_locked & MEMCFORKPREFORK )!=0 )
+			empty = memc_prefork_parent( &(*(*cm).prefork) ); // 19.10.2026
+		memc_fork_unlock( &(*cm) );
+		if( empty>0 )
+			memc_prefork_refill( &(*cm) );
+	}
+	pthread_mutex_unlock( &memc_fork_mtx );
+}
+void  memc_fork_child( void ){
+	int indx = 0;
+	MEMC *cm = NULL;
+	memc_completion *cpl = NULL;
+	for( cm = memc_fork_list; cm!=NULL; cm = (*cm).fork_next ){
+
+		/*
+		 * The threads of the parent are not in the child. Their completions
+		 * and flights are not signalled here (the flights leak in the child). */
+		while( (*cm).pending!=NULL ){
+			cpl = &(*(*cm).pending);
+			(*cm).pending = (*cpl).next;
+			(*cpl).next = (*cm).completion_pool;
+			(*cm).completion_pool = &(*cpl);
+		}
+		(*cm).pending_count = 0;
+		(*cm).reaped = 0;
+		(*cm).flights = NULL;
+		__atomic_store_n( &(*cm).reinit_thr_created, 0, __ATOMIC_RELEASE );
+		__atomic_store_n( &(*cm).reinit_in_process, 0, __ATOMIC_RELEASE );
+
+		/*
+		 * Not locked in the prepare handler, fork would wait the network. A thread of the
+		 * parent may have them locked. POSIX leaves pthread_mutex_init of a locked mutex
+		 * undefined; this depends on glibc, where the default (non-robust) mutex is a plain
+		 * word and the init writes it unlocked without looking at the owner. */
+		if( (*cm).init_created!=0 ) pthread_mutex_init( &(*cm).init, NULL );
+		if( (*cm).quit_created!=0 ) pthread_mutex_init( &(*cm).quit, NULL );
+
+		/*
+		 * The sockets are shared with the parent. Closed, not shut down. */
+		if( (*cm).token!=NULL && (*(*cm).token).conn!=NULL ){
+			for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
+				if( (*(*cm).token).conn[ indx ]==NULL ) continue;
+				if( (*(*(*cm).token).conn[ indx ]).fd>=0 )
+					close( (*(*(*cm).token).conn[ indx ]).fd );
+				(*(*(*cm).token).conn[ indx ]).fd = -1;
+				(*(*(*cm).token).conn[ indx ]).connected = 0;
+				(*(*(*cm).token).conn[ indx ]).dbsindx = -1;
+				(*(*(*cm).token).conn[ indx ]).thr_created = 0;
+				__atomic_store_n( &(*(*(*cm).token).conn[ indx ]).processing, 0, __ATOMIC_RELEASE );
+				__atomic_store_n( &(*(*(*cm).token).conn[ indx ]).state, MEMCCONNFAILED, __ATOMIC_RELEASE );
+				__atomic_store_n( &(*(*(*cm).token).conn[ indx ]).waiters, 0, __ATOMIC_RELEASE ); // the threads were not forked
+				if( (*(*(*cm).token).conn[ indx ]).mtxconn_created!=0 )
+					pthread_mutex_init( &(*(*(*cm).token).conn[ indx ]).mtxconn, NULL ); // glibc, as above
+			}
+			/*
+			 * The offered set of the pre-fork pool is taken at the first use, 19.10.2026. */
+			__atomic_store_n( &(*cm).forked, 1, __ATOMIC_RELEASE );
+		}
+		if( (*cm).prefork!=NULL )
+			__atomic_store_n( &(*(*cm).prefork).refilling, 0, __ATOMIC_RELEASE ); // not in the child
+		memc_fork_unlock( &(*cm) );
+	}
+	memc_log_forked(); // 19.10.2026
+	MEMCPROBE2( reinit, getpid(), 1 ); // 19.10.2026
+	pthread_mutex_unlock( &memc_fork_mtx );
+}
+/*
+ * First use after fork: new sockets and, if 'reconnect' is 1, the connect threads
+ * (memc_connect reconnects itself). The other callers wait until done, 19.10.2026. */
+int  memc_fork_reconnect( MEMC *cm, char reconnect ){
+	int indx = 0, err = CBSUCCESS, forked = 1;
+	if( cm==NULL || (*cm).token==NULL ) return CBERRALLOC;
+	if( __atomic_load_n( &(*cm).forked, __ATOMIC_ACQUIRE )==0 ) return CBSUCCESS;
+	if( ! __atomic_compare_exchange_n( &(*cm).forked, &forked, 2, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ){
+		while( __atomic_load_n( &(*cm).forked, __ATOMIC_ACQUIRE )==2 )
+			sched_yield();
+		return CBSUCCESS;
+	}
+
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_FORK_RECONNECT"); MEMCFLUSHLOG();
+
+	err = memc_join_reinit( &(*cm) ); // if memc_reinit was called in the child
+	if( err!=CBSUCCESS ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_fork_reconnect: memc_join_reinit, error %i.", err ); }
+	memc_prefork_child( &(*cm) ); // 19.10.2026
+	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
+		err = CBSUCCESS;
+		if( memc_conn_state( &(*(*(*cm).token).conn[ indx ]) )==MEMCCONNREADY && (*(*(*cm).token).conn[ indx ]).fd>=0 )
+			continue; // from the pre-fork pool
+		pthread_mutex_lock( &(*(*(*cm).token).conn[ indx ]).mtx );
+		if( (*(*(*cm).token).conn[ indx ]).fd<0 )
+			err = memc_create_socket( &(*cm), indx );
+		pthread_mutex_unlock( &(*(*(*cm).token).conn[ indx ]).mtx );
+		if( err>=CBERROR ){ MEMCLOG( CBLOGERR, err, "\nmemc_fork_reconnect: memc_create_socket %i, error %i.", indx, err ); continue; }
+		if( reconnect==1 ){
+			err = memc_reconnect( &(*cm), indx );
+			if( err!=CBSUCCESS ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_fork_reconnect: memc_reconnect %i, error %i.", indx, err ); }
+		}
+	}
+	__atomic_store_n( &(*cm).forked, 0, __ATOMIC_RELEASE );
+	return CBSUCCESS;
+}
+/*
+ * Pre-fork pool, 19.10.2026. */
+int  memc_prefork_pool( MEMC *cm, int sets ){
+	int err = CBSUCCESS, indx = 0;
+	memc_prefork *pf = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
+	if( sets<=0 || (*cm).redundant_servers_count<=0 || (*cm).redundant_servers_count>MEMCMAXREDUNDANTDBS ) return CBOVERFLOW;
+	if( (*cm).session_databases<=0 ) return MEMCADDRESSMISSING;
+	if( (*cm).prefork!=NULL ) memc_prefork_free( &(*cm) );
+
+	pf = (memc_prefork*) malloc( sizeof( memc_prefork ) );
+	if( pf==NULL ) return CBERRALLOC;
+	(*pf).sets = sets;
+	(*pf).conns = (*cm).redundant_servers_count;
+	(*pf).handed = -1;
+	(*pf).offered = 0;
+	(*pf).next = 0;
+	(*pf).owner = (int) getpid();
+	(*pf).refilling = 0;
+	(*pf).handouts = 0;
+	(*pf).refills = 0;
+	(*pf).mtx_created = 0;
+	(*pf).fd = (int*) malloc( sizeof( int ) * (size_t) ( sets * (*pf).conns ) );
+	(*pf).dbsindx = (int*) malloc( sizeof( int ) * (size_t) ( sets * (*pf).conns ) );
+	(*pf).claim = (uint*) mmap( NULL, sizeof( uint ) * (size_t) sets, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 ); // zeroed
+	if( (*pf).fd==NULL || (*pf).dbsindx==NULL || (*pf).claim==MAP_FAILED ){
+		if( (*pf).fd!=NULL ) free( (*pf).fd );
+		if( (*pf).dbsindx!=NULL ) free( (*pf).dbsindx );
+		if( (*pf).claim!=MAP_FAILED ) munmap( (*pf).claim, sizeof( uint ) * (size_t) sets );
+		free( pf );
+		return CBERRALLOC;
+	}
+	for( indx=0; indx<sets*(*pf).conns; ++indx ){
+		(*pf).fd[ indx ] = -1;
+		(*pf).dbsindx[ indx ] = ( (*(*cm).token).starting_index + ( indx % (*pf).conns ) + 1 ) % (*cm).session_databases; // as in memc_reconnect
+	}
+	err = pthread_mutex_init( &(*pf).mtx, NULL );
+	if( err!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_prefork_pool: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) );
+		munmap( (*pf).claim, sizeof( uint ) * (size_t) sets );
+		free( (*pf).fd ); free( (*pf).dbsindx ); free( pf );
+		return MEMCERRTHREAD;
+	}
+	(*pf).mtx_created = 1;
+	(*cm).prefork = &(*pf);
+
+	/*
+	 * The first sets before the first fork, in this thread. */
+	if( memc_prefork_fill( &(*cm) )==0 ){
+		MEMCLOG( CBLOGERR, MEMCERRCONNECT, "\nmemc_prefork_pool: no connections, error %i.", MEMCERRCONNECT );
+		return MEMCERRCONNECT;
+	}
+	return CBSUCCESS;
+}
+int  memc_prefork_free( MEMC *cm ){
+	int indx = 0;
+	memc_prefork *pf = NULL;
+	if( cm==NULL || (*cm).prefork==NULL ) return CBSUCCESS;
+	pf = &(*(*cm).prefork);
+	/*
+	 * Not in the middle of a fork and no refill thread (started in the parent handler). */
+	pthread_mutex_lock( &memc_fork_mtx );
+	while( __atomic_load_n( &(*pf).refilling, __ATOMIC_ACQUIRE )!=0 ){
+		pthread_mutex_unlock( &memc_fork_mtx );
+		sched_yield();
+		pthread_mutex_lock( &memc_fork_mtx );
+	}
+	(*cm).prefork = NULL;
+	pthread_mutex_unlock( &memc_fork_mtx );
+	for( indx=0; indx<(*pf).sets*(*pf).conns; ++indx ){
+		if( (*pf).fd[ indx ]>=0 )
+			close( (*pf).fd[ indx ] );
+	}
+	if( (*pf).mtx_created!=0 ){
+		(*pf).mtx_created = 0;
+		pthread_mutex_destroy( &(*pf).mtx );
+	}
+	munmap( (*pf).claim, sizeof( uint ) * (size_t) (*pf).sets ); // only the mapping of this process
+	free( (*pf).fd );
+	free( (*pf).dbsindx );
+	free( pf );
+	return CBSUCCESS;
+}
+/*
+ * Lent sockets, 19.10.2026. */
+int  memc_server_index( MEMC *cm, int cindx ){
+	if( cm==NULL || (*cm).token==NULL || (*cm).session_databases<=0 ) return -1;
+	if( cindx<0 || cindx>=(*cm).redundant_servers_count || cindx>=MEMCMAXREDUNDANTDBS ) return -1;
+	return ( (*(*cm).token).starting_index + cindx + 1 ) % (*cm).session_databases; // as in memc_reconnect
+}
+int  memc_server_socket( MEMC *cm, int dbsindx, int *fd ){
+	return memc_prefork_connect( &(*cm), dbsindx, &(*fd) );
+}
+int  memc_adopt_socket( MEMC *cm, int cindx, int dbsindx, int fd ){
+	int indx = 0, forked = 1;
+	dbs_conn *conn = NULL;
+	if( cm==NULL || (*cm).token==NULL || fd<0 ) return CBERRALLOC;
+	if( cindx<0 || cindx>=(*cm).redundant_servers_count || cindx>=MEMCMAXREDUNDANTDBS || (*(*cm).token).conn[ cindx ]==NULL ) return CBOVERFLOW;
+	if( dbsindx<0 || dbsindx>=(*cm).session_databases ) return CBOVERFLOW;
+	memc_join_previous( &(*cm) ); // not in use
+	conn = &(*(*(*cm).token).conn[ cindx ]);
+	pthread_mutex_lock( &(*conn).mtx );
+	if( (*conn).fd>=0 && (*conn).fd!=fd )
+		close( (*conn).fd );
+	(*conn).fd = fd;
+	(*conn).dbsindx = dbsindx;
+	(*conn).connected = 1;
+	(*conn).lasterr = CBSUCCESS;
+	memc_conn_store( &(*conn), MEMCCONNREADY );
+	pthread_mutex_unlock( &(*conn).mtx );
+	/*
+	 * All connections have a socket, no reconnect at the next request. */
+	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx )
+		if( (*(*cm).token).conn[ indx ]==NULL || (*(*(*cm).token).conn[ indx ]).fd<0 )
+			return CBSUCCESS;
+	__atomic_compare_exchange_n( &(*cm).forked, &forked, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+	return CBSUCCESS;
+}
+int  memc_surrender_socket( MEMC *cm, int cindx, int *dbsindx, int *fd ){
+	dbs_conn *conn = NULL;
+	if( cm==NULL || (*cm).token==NULL || fd==NULL || dbsindx==NULL ) return CBERRALLOC;
+	if( cindx<0 || cindx>=(*cm).redundant_servers_count || cindx>=MEMCMAXREDUNDANTDBS || (*(*cm).token).conn[ cindx ]==NULL ) return CBOVERFLOW;
+	memc_join_previous( &(*cm) );
+	conn = &(*(*(*cm).token).conn[ cindx ]);
+	pthread_mutex_lock( &(*conn).mtx );
+	*fd = ( (*conn).connected!=0 ) ? (*conn).fd : -1;
+	*dbsindx = (*conn).dbsindx;
+	if( *fd<0 && (*conn).fd>=0 )
+		close( (*conn).fd );
+	(*conn).fd = -1;
+	(*conn).connected = 0;
+	memc_conn_store( &(*conn), MEMCCONNFAILED );
+	pthread_mutex_unlock( &(*conn).mtx );
+	__atomic_store_n( &(*cm).forked, 1, __ATOMIC_RELEASE ); // reconnects at the next request if not adopted
+	return ( *fd>=0 ) ? CBSUCCESS : MEMCERRCONNECT;
+}
+/*
+ * Connects a socket to the server 'dbsindx'. The same as in memc_connect_thr. */
+int  memc_prefork_connect( MEMC *cm, int dbsindx, int *fd ){
+	int err = CBSUCCESS, errc = -1;
+	struct addrinfo  hints;
+	struct addrinfo *res = NULL, *ptr1 = NULL;
+	db_conn_param *dbp = NULL;
+	if( cm==NULL || fd==NULL || dbsindx<0 || dbsindx>=MEMCMAXSESSIONDBS || (*cm).sesdbparams[ dbsindx ]==NULL ) return CBERRALLOC;
+	*fd = -1;
+	dbp = &(*(*cm).sesdbparams[ dbsindx ]);
+	if( (*dbp).ip==NULL || (*dbp).port==NULL ) return MEMCADDRESSMISSING;
+
+	memset( &hints, 0x00, sizeof( struct addrinfo ) );
+        hints.ai_family = PF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM; hints.ai_protocol = IPPROTO_TCP;
+        hints.ai_flags = ( 0x00 & !AI_PASSIVE ) & AI_NUMERICSERV;
+	(*dbp).ip[ (*dbp).iplen ] = '\0';
+	(*dbp).port[ (*dbp).portlen ] = '\0';
+	err = getaddrinfo( &(* (const char *) (*dbp).ip), &(* (const char *) (*dbp).port), &hints, &res );
+	if( err!=0 ){
+		MEMCLOG( CBLOGERR, CBNEGATION, "\nmemc_prefork_connect: getaddrinfo, error %i '%s'.", err, gai_strerror( err ) );
+		return MEMCERRCONNECT;
+	}
+	for( ptr1 = res; ptr1!=NULL && errc<0; ptr1 = (*ptr1).ai_next ){
+		if( *fd<0 ){
+			err = memc_create_socket_fd( &(*cm), &(*fd), SOCK_CLOEXEC ); // not to the programs the children execute
+			if( *fd<0 ) break;
+		}
+		if( (*ptr1).ai_addr==NULL ) continue;
+		errc = connect( *fd, &(*(*ptr1).ai_addr), (*ptr1).ai_addrlen );
+		if( errc<0 ){
+			MEMCLOG( CBLOGERR, MEMCERRCONNECT, "\nmemc_prefork_connect: dbsindx %i, errno %i, '%s'", dbsindx, errno, strerror( errno ) );
+			close( *fd ); // a failed connect leaves the socket unspecified
+			*fd = -1;
+		}
+	}
+	freeaddrinfo( res );
+	if( errc<0 ){
+		if( *fd>=0 ) close( *fd );
+		*fd = -1;
+		return MEMCERRCONNECT;
+	}
+	return CBSUCCESS;
+}
+/*
+ * Connects the empty places of the pool, returns the number of connected sockets in the pool.
+ * The mutex is not kept while connecting. */
+int  memc_prefork_fill( MEMC *cm ){
+	int indx = 0, fd = -1, dbsindx = 0, connected = 0;
+	memc_prefork *pf = NULL;
+	if( cm==NULL || (*cm).prefork==NULL ) return 0;
+	pf = &(*(*cm).prefork);
+	pthread_mutex_lock( &(*pf).mtx );
+	memc_prefork_reap( &(*pf) ); // taken after the last fork
+	pthread_mutex_unlock( &(*pf).mtx );
+	for( indx=0; indx<(*pf).sets*(*pf).conns; ++indx ){
+		pthread_mutex_lock( &(*pf).mtx );
+		fd = (*pf).fd[ indx ];
+		dbsindx = (*pf).dbsindx[ indx ];
+		pthread_mutex_unlock( &(*pf).mtx );
+		if( fd>=0 ){ ++connected; continue; }
+		if( memc_prefork_connect( &(*cm), dbsindx, &fd )!=CBSUCCESS )
+			continue;
+		pthread_mutex_lock( &(*pf).mtx );
+		if( (*pf).fd[ indx ]<0 ){
+			(*pf).fd[ indx ] = fd;
+			++(*pf).refills;
+			fd = -1;
+			++connected;
+		}
+		pthread_mutex_unlock( &(*pf).mtx );
+		if( fd>=0 ) close( fd );
+	}
+	return connected;
+}
+void* memc_prefork_thr( void *prm ){
+	MEMC *cm = NULL;
+	memc_prefork *pf = NULL;
+	if( prm==NULL ){ pthread_exit( NULL ); return NULL; }
+	cm = &(* (MEMC*) prm);
+	pf = &(*(*cm).prefork);
+	memc_prefork_fill( &(*cm) );
+	__atomic_store_n( &(*pf).refilling, 0, __ATOMIC_RELEASE ); // the last use of 'cm'
+	pthread_exit( NULL );
+	return NULL;
+}
+/*
+ * In the parent after fork. */
+void  memc_prefork_refill( MEMC *cm ){
+	int err = 0, refilling = 0;
+	pthread_t thr;
+	pthread_attr_t attr;
+	if( cm==NULL || (*cm).prefork==NULL ) return;
+	if( ! __atomic_compare_exchange_n( &(*(*cm).prefork).refilling, &refilling, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+		return; // already running
+	err = pthread_attr_init( &attr );
+	if( err==0 ){
+		err = pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+		if( err==0 )
+			err = pthread_create( &thr, &attr, &memc_prefork_thr, &(*cm) );
+		pthread_attr_destroy( &attr );
+	}
+	if( err!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_prefork_refill: pthread_create, error %i.", err );
+		__atomic_store_n( &(*(*cm).prefork).refilling, 0, __ATOMIC_RELEASE );
+	}
+}
+/*
+ * Sets taken by the children since the last fork. The copies of the parent are
+ * closed and the set gets a new generation, a late child of an earlier fork can
+ * not take it anymore. With the mutex. */
+int  memc_prefork_reap( memc_prefork *pf ){
+	int set = 0, indx = 0, reaped = 0;
+	uint claim = 0;
+	if( pf==NULL || (*pf).claim==NULL ) return 0;
+	for( set=0; set<(*pf).sets; ++set ){
+		claim = __atomic_load_n( &(*pf).claim[ set ], __ATOMIC_ACQUIRE );
+		if( ( claim & 1 )==0 ) continue;
+		for( indx=set*(*pf).conns; indx<(set+1)*(*pf).conns; ++indx ){
+			if( (*pf).fd[ indx ]>=0 )
+				close( (*pf).fd[ indx ] );
+			(*pf).fd[ indx ] = -1;
+		}
+		__atomic_store_n( &(*pf).claim[ set ], claim + 1, __ATOMIC_RELEASE );
+		++(*pf).handouts;
+		++reaped;
+	}
+	return reaped;
+}
+/*
+ * Chooses the set with the most connected sockets to offer to the child, locked
+ * in the prepare handler. The offers go round the sets not taken. The missing
+ * sockets are connected in the child. */
+void  memc_prefork_choose( memc_prefork *pf ){
+	int num = 0, set = 0, indx = 0, cnt = 0, most = 0;
+	uint claim = 0;
+	if( pf==NULL || (*pf).claim==NULL ) return;
+	(*pf).handed = -1;
+	for( num=0; num<(*pf).sets && most<(*pf).conns; ++num ){
+		set = ( (*pf).next + num ) % (*pf).sets;
+		claim = __atomic_load_n( &(*pf).claim[ set ], __ATOMIC_ACQUIRE );
+		if( ( claim & 1 )!=0 ) continue; // taken after the reap
+		cnt = 0;
+		for( indx=0; indx<(*pf).conns; ++indx )
+			if( (*pf).fd[ set*(*pf).conns + indx ]>=0 )
+				++cnt;
+		if( cnt>most ){
+			most = cnt;
+			(*pf).handed = set;
+			(*pf).offered = claim;
+		}
+	}
+	if( (*pf).handed>=0 )
+		(*pf).next = ( (*pf).handed + 1 ) % (*pf).sets;
+}
+/*
+ * Parent. The offered set stays in the pool until a child takes it. Returns the
+ * number of empty places to connect. */
+int  memc_prefork_parent( memc_prefork *pf ){
+	int indx = 0, empty = 0;
+	if( pf==NULL || (*pf).owner!=(int) getpid() ) return 0;
+	(*pf).handed = -1;
+	for( indx=0; indx<(*pf).sets*(*pf).conns; ++indx )
+		if( (*pf).fd[ indx ]<0 )
+			++empty;
+	return empty;
+}
+/*
+ * Child, at the first use. Takes the offered set if no other child took it and
+ * closes the copies of the rest. The pool stays in the parent. Returns the number
+ * of connections taken from the pool. */
+int  memc_prefork_child( MEMC *cm ){
+	int indx = 0, cindx = 0, taken = 0;
+	uint offered = 0;
+	char claimed = 0;
+	memc_prefork *pf = NULL;
+	if( cm==NULL || (*cm).prefork==NULL || (*cm).token==NULL ) return 0;
+	pf = &(*(*cm).prefork);
+	if( (*pf).owner==(int) getpid() ) return 0;
+	pthread_mutex_lock( &(*pf).mtx );
+	if( (*pf).handed>=0 && (*pf).handed<(*pf).sets ){
+		offered = (*pf).offered;
+		claimed = __atomic_compare_exchange_n( &(*pf).claim[ (*pf).handed ], &offered, (*pf).offered + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ? 1 : 0 ;
+	}
+	for( indx=0; claimed==1 && indx<(*pf).sets*(*pf).conns; ++indx ){
+		cindx = indx % (*pf).conns;
+		if( indx/(*pf).conns==(*pf).handed && (*pf).fd[ indx ]>=0 && \
+		    cindx<(*cm).redundant_servers_count && (*(*cm).token).conn[ cindx ]!=NULL ){
+			(*(*(*cm).token).conn[ cindx ]).fd = (*pf).fd[ indx ];
+			(*(*(*cm).token).conn[ cindx ]).dbsindx = (*pf).dbsindx[ indx ];
+			(*(*(*cm).token).conn[ cindx ]).connected = 1;
+			memc_conn_store( &(*(*(*cm).token).conn[ cindx ]), MEMCCONNREADY );
+			(*pf).fd[ indx ] = -1;
+			++taken;
+		}
+	}
+	(*pf).handed = -1;
+	pthread_mutex_unlock( &(*pf).mtx );
+	memc_prefork_free( &(*cm) ); // closes the rest
+	return taken;
+}
 /*
  * Reinit in parallel. Note 10.11.2018: One thread at a time. */
 void* memc_init_thr( void *prm ){
@@ -618,16 +1633,16 @@ void* memc_init_thr( void *prm ){
 	pthread_mutex_lock( &(* (MEMC*) prm).init );
 	cm = &(* (MEMC *) prm);
 	if( cm==NULL || (*cm).token==NULL ){
-		cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_init_thr: error %i.", CBERRALLOCTHR );
+		MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_init_thr: error %i.", CBERRALLOCTHR );
 		pthread_mutex_unlock( &(* (MEMC*) prm).init );
 		if( cm!=NULL )
-			(*cm).reinit_in_process = 0; // 25.8.2018
+			__atomic_store_n( &(*cm).reinit_in_process, 0, __ATOMIC_RELEASE ); // 25.8.2018
 		pthread_exit( NULL );
 		return NULL;
 	}
 	(*cm).indx = 0; (*cm).err = 0;
 
-	(*cm).reinit_in_process = 1; // 19.7.2018, should be set before pthread_create (doubled here to be sure)
+	__atomic_store_n( &(*cm).reinit_in_process, 1, __ATOMIC_RELEASE ); // 19.7.2018, should be set before pthread_create (doubled here to be sure)
 
 	/*
 	 * Allocate MEMC_token (if not a call to 'reinit'). */
@@ -635,9 +1650,9 @@ void* memc_init_thr( void *prm ){
 		(*cm).token = (MEMC_token*) malloc( sizeof( MEMC_token ) );
 		if( (*cm).token == NULL ){
 			(*cm).reinit_err = CBERRALLOC;
-			(*cm).reinit_in_process = 0;
-			cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_init_thr: error %i.", CBERRALLOCTHR );
-			cb_flush_log();
+			__atomic_store_n( &(*cm).reinit_in_process, 0, __ATOMIC_RELEASE );
+			MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_init_thr: error %i.", CBERRALLOCTHR );
+			MEMCFLUSHLOG();
 			pthread_mutex_unlock( &(* (MEMC*) prm).init );
 			pthread_exit( NULL );
 			return NULL;
@@ -652,7 +1667,8 @@ void* memc_init_thr( void *prm ){
 		(*(*(*cm).token).conn[(*cm).indx]).last_thread_status = 0x00;
 		(*(*(*cm).token).conn[(*cm).indx]).lasterr = CBSUCCESS;
 		(*(*(*cm).token).conn[(*cm).indx]).connected = 0x00;
-		(*(*(*cm).token).conn[(*cm).indx]).processing = 0;
+		memc_conn_store( &(*(*(*cm).token).conn[(*cm).indx]), MEMCCONNIDLE ); // 19.10.2026
+		__atomic_store_n( &(*(*(*cm).token).conn[(*cm).indx]).processing, 0, __ATOMIC_RELEASE ); // 19.10.2026
 		(*(*(*cm).token).conn[(*cm).indx]).fd = -1;
 		(*(*(*cm).token).conn[(*cm).indx]).last_cas = 0x00;
 		(*(*(*cm).token).conn[(*cm).indx]).thr = NULL; // 7.8.2018
@@ -663,11 +1679,11 @@ void* memc_init_thr( void *prm ){
 	 * Create sockets. */
 	if( (*cm).server_address_list==NULL ){ 
 		(*cm).reinit_err = MEMCADDRESSMISSING; 
-		cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_init_thr: error %i.", MEMCADDRESSMISSING );
-		cb_flush_log();
+		MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_init_thr: error %i.", MEMCADDRESSMISSING );
+		MEMCFLUSHLOG();
 		/* 30.8.2018: Continue to create the socket to the defautl address. */
 		/***
-		(*cm).reinit_in_process = 0;
+		__atomic_store_n( &(*cm).reinit_in_process, 0, __ATOMIC_RELEASE );
 		pthread_mutex_unlock( &(* (MEMC*) prm).init );
 		pthread_exit( NULL );
 		return NULL;
@@ -675,24 +1691,24 @@ void* memc_init_thr( void *prm ){
 	}
 	(*cm).err = memc_create_all_sockets( &(*cm) );
         if( (*cm).err>=CBNEGATION ){ // 30.8.2018
-		cb_clog( CBLOGERR, MEMCERRSOCKET, "\nmemc_init_thr: No sockets, socket error %i, errno %i '%s'.", \
+		MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_init_thr: No sockets, socket error %i, errno %i '%s'.", \
 			(*(*(*cm).token).conn[(*cm).indx]).fd, errno, strerror( errno ));
 		(*cm).reinit_err = MEMCERRSOCKET;
-		cb_flush_log();
-		(*cm).reinit_in_process = 0; // 19.7.2018
+		MEMCFLUSHLOG();
+		__atomic_store_n( &(*cm).reinit_in_process, 0, __ATOMIC_RELEASE ); // 19.7.2018
 		pthread_mutex_unlock( &(* (MEMC*) prm).init );
 		pthread_exit( NULL );
         }
 
-	(*cm).reinit_in_process = 0;
-	cb_flush_log();
+	__atomic_store_n( &(*cm).reinit_in_process, 0, __ATOMIC_RELEASE );
+	MEMCFLUSHLOG();
 	pthread_mutex_unlock( &(* (MEMC*) prm).init );
 	pthread_exit( NULL );
 	return NULL;
 }
 static int    memc_create_all_sockets( MEMC *cm ){
 	if( cm==NULL || (*cm).token==NULL ){
-		cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_create_all_sockets: error %i.", CBERRALLOC );
+		MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_create_all_sockets: error %i.", CBERRALLOC );
 		return CBERRALLOC;
 	}
 	(*cm).err = CBSUCCESS; (*cm).indx = 0; (*cm).some_socket_succeeded = 0;
@@ -710,6 +1726,15 @@ static int    memc_create_all_sockets( MEMC *cm ){
 /*
  * Must be locked, 11.10.2018. */
 static int    memc_create_socket( MEMC *cm, int indx ){
+	if( cm==NULL || (*cm).token==NULL ){
+		MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_create_socket: error %i.", CBERRALLOC );
+		return CBERRALLOC;
+	}
+	return memc_create_socket_fd( &(*cm), &(*(*(*cm).token).conn[indx]).fd, 0 );
+}
+/*
+ * Socket to 'fd', also for the pre-fork pool, 19.10.2026. */
+static int    memc_create_socket_fd( MEMC *cm, int *fd, int flags ){
 	int err = CBSUCCESS, one = 1, tmp = 0;
         int socoutmemsize = SOCOUTMEMSIZECLIENT;
         int socinmemsize = SOCINMEMSIZECLIENT;
@@ -717,8 +1742,8 @@ static int    memc_create_socket( MEMC *cm, int indx ){
         struct addrinfo       hints;
         struct addrinfo      *ptr1 = NULL;
 	struct addrinfo      *ptr2 = NULL;
-	if( cm==NULL || (*cm).token==NULL ){
-		cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_create_socket: error %i.", CBERRALLOC );
+	if( cm==NULL || fd==NULL ){
+		MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_create_socket: error %i.", CBERRALLOC );
 		return CBERRALLOC;
 	}
         lng.l_onoff = 1;
@@ -736,70 +1761,70 @@ static int    memc_create_socket( MEMC *cm, int indx ){
 
 		/*
 		 * Socket, 10.7.2018. */
-                (*(*(*cm).token).conn[indx]).fd = socket( PF_UNSPEC, SOCK_STREAM&(0xFF^SOCK_NONBLOCK), IPPROTO_TCP ); // PF_INET
-		if( (*(*(*cm).token).conn[indx]).fd>=0 ){
+                *fd = socket( PF_UNSPEC, ( SOCK_STREAM&(0xFF^SOCK_NONBLOCK) ) | flags, IPPROTO_TCP ); // PF_INET
+		if( *fd>=0 ){
 			(*cm).some_socket_succeeded = 1;
 			/*
 			 * Set as blocking, 19.7.2018. */
-			err = fcntl( (*(*(*cm).token).conn[indx]).fd, F_GETFL );
+			err = fcntl( *fd, F_GETFL );
 			if( err>=0 ){
 				/*
 				 * Set as blocking (threads are used with join). */
 				err = err & ( ( (int) 0xFF ) | O_NONBLOCK );
-				fcntl( (*(*(*cm).token).conn[indx]).fd, F_SETFL, err );
+				fcntl( *fd, F_SETFL, err );
 				err = CBSUCCESS;
 			}
 		}else{
-        	  	cb_clog( CBLOGERR, MEMCERRSOCKET, "\nmemc_init_thr: Host IP was not given, socket error %i, errno %i '%s'.", \
-				(*(*(*cm).token).conn[indx]).fd, errno, strerror( errno ));
+        	  	MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_init_thr: Host IP was not given, socket error %i, errno %i '%s'.", \
+				*fd, errno, strerror( errno ));
 		}
 	}else{
 		//30.8.2018: for( indx=0; indx<(*cm).redundant_servers_count && (*cm).server_address_list!=NULL; ++indx ){
-		(*(*(*cm).token).conn[indx]).fd = -1;
+		*fd = -1;
 		ptr1 = &(*(*cm).server_address_list);
 /***
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nCreating socket, indx %i", indx );
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nCreating socket, indx %i", indx );
 if( ptr1!=NULL )
-	cb_clog( CBLOGDEBUG, CBSUCCESS, ", ptr1 not null.");
+	MEMCLOG( CBLOGDEBUG, CBSUCCESS, ", ptr1 not null.");
 else
-	cb_clog( CBLOGDEBUG, CBSUCCESS, ", ptr1 was null.");
-cb_flush_log();
+	MEMCLOG( CBLOGDEBUG, CBSUCCESS, ", ptr1 was null.");
+MEMCFLUSHLOG();
  ***/
-		while( ptr1 != NULL && (*(*(*cm).token).conn[indx]).fd<0 ) {
+		while( ptr1 != NULL && *fd<0 ) {
 
 			/*
 			 * Socket. */
-			(*(*(*cm).token).conn[indx]).fd = socket( (*ptr1).ai_family, (*ptr1).ai_socktype&(0xFF^SOCK_NONBLOCK), (*ptr1).ai_protocol );
+			*fd = socket( (*ptr1).ai_family, ( (*ptr1).ai_socktype&(0xFF^SOCK_NONBLOCK) ) | flags, (*ptr1).ai_protocol );
 
-			if( (*(*(*cm).token).conn[indx]).fd>=0 ){
+			if( *fd>=0 ){
 				/*
 				 * Set as blocking (threads are used with join), 19.7.2018. */
-				err = fcntl( (*(*(*cm).token).conn[indx]).fd, F_GETFL );
+				err = fcntl( *fd, F_GETFL );
 				if( err>=0 ){
 					/*
 					 * Set as blocking (threads are used with join). */
 					err = err & ( ( (int) 0xFF ) | O_NONBLOCK );
-					fcntl( (*(*(*cm).token).conn[indx]).fd, F_SETFL, err );
+					fcntl( *fd, F_SETFL, err );
 					err = CBSUCCESS;
 				}
 			}
 
 			/*
 			 * Bind socket to the server address. */
-			if( (*(*(*cm).token).conn[indx]).fd>=0 && (*ptr1).ai_addr!=NULL ){
-				err = bind( (*(*(*cm).token).conn[indx]).fd, &(*(*ptr1).ai_addr), (*ptr1).ai_addrlen );
+			if( *fd>=0 && (*ptr1).ai_addr!=NULL ){
+				err = bind( *fd, &(*(*ptr1).ai_addr), (*ptr1).ai_addrlen );
 				if( err < 0) {
-					cb_clog( CBLOGERR, MEMCERRBIND, "\nmemc_init: error %i, errno %i, '%s'", err, errno, strerror( errno ) ); 
+					MEMCLOG( CBLOGERR, MEMCERRBIND, "\nmemc_init: error %i, errno %i, '%s'", err, errno, strerror( errno ) ); 
 				}else{
 					(*cm).some_socket_succeeded = 1;
 					/*
 					 * Set as blocking, 19.7.2018. */
-					err = fcntl( (*(*(*cm).token).conn[indx]).fd, F_GETFL );
+					err = fcntl( *fd, F_GETFL );
 					if( err>=0 ){
 						/*
 						 * Set as blocking (threads are used with join). */
 						err = err & ( ( (int) 0xFF ) | O_NONBLOCK );
-						fcntl( (*(*(*cm).token).conn[indx]).fd, F_SETFL, err );
+						fcntl( *fd, F_SETFL, err );
 						err = CBSUCCESS;
 					}
 				}
@@ -814,34 +1839,34 @@ cb_flush_log();
 				ptr1 = NULL; ptr2 = NULL;
 			}
 		} // WHILE
-		if( (*(*(*cm).token).conn[indx]).fd < 0 ){
-			cb_clog( CBLOGERR, MEMCERRSOCKET, "\nmemc_init_thr: socket error %i, errno %i '%s'.", (*(*(*cm).token).conn[indx]).fd, errno, strerror( errno ));
+		if( *fd < 0 ){
+			MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_init_thr: socket error %i, errno %i '%s'.", *fd, errno, strerror( errno ));
 		}
 
 		/*
 		 * Socket options. */
-		tmp = (*(*(*cm).token).conn[indx]).fd ;
+		tmp = *fd ;
 		err = setsockopt( tmp, SOL_SOCKET, SO_RCVBUF, &socinmemsize, sizeof( int ) );
-		if( err<0 ){ cb_clog( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_RCVBUF, %i, errno %i.", err, errno ); }
+		if( err<0 ){ MEMCLOG( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_RCVBUF, %i, errno %i.", err, errno ); }
 		err = setsockopt( tmp, SOL_SOCKET, SO_SNDBUF, &socoutmemsize, sizeof( int ) );
-		if( err<0 ){ cb_clog( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_SNDBUF, %i, errno %i.", err, errno ); }
+		if( err<0 ){ MEMCLOG( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_SNDBUF, %i, errno %i.", err, errno ); }
 		err = setsockopt( tmp, SOL_SOCKET, SO_LINGER, &lng, sizeof( struct linger ) ); // close wait if data in transfer
-		if( err<0 ){ cb_clog( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_LINGER, %i, errno %i.", err, errno ); }
+		if( err<0 ){ MEMCLOG( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_LINGER, %i, errno %i.", err, errno ); }
 		err = setsockopt( tmp, SOL_SOCKET, SO_REUSEADDR, &one, (socklen_t) sizeof( int ) );
-		if( err<0 ) cb_clog( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_REUSEADDR returned %i, errno %i '%s'.", err, errno,strerror( errno ) );
+		if( err<0 ) MEMCLOG( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_REUSEADDR returned %i, errno %i '%s'.", err, errno,strerror( errno ) );
 		err = setsockopt( tmp, SOL_SOCKET, SO_REUSEPORT, &one, (socklen_t) sizeof( int ) ); // enables duplicate address and port bindings
-		if( err<0 ) cb_clog( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_REUSEPORT returned %i, errno %i '%s'.", err, errno,strerror( errno ) );
+		if( err<0 ) MEMCLOG( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_REUSEPORT returned %i, errno %i '%s'.", err, errno,strerror( errno ) );
 		err = setsockopt( tmp, SOL_SOCKET, SO_RCVBUF, &socinmemsize, (socklen_t) sizeof( int ) );
-		if( err<0 ) cb_clog( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_REUSEPORT returned %i, errno %i '%s'.", err, errno,strerror( errno ) );
+		if( err<0 ) MEMCLOG( CBLOGWARNING, MEMCERRSOCOPT, "\nmemc_init_thr: setsockopt SO_REUSEPORT returned %i, errno %i '%s'.", err, errno,strerror( errno ) );
 
 		/*
 		 * Set as blocking, 19.7.2018. */
-		err = fcntl( (*(*(*cm).token).conn[indx]).fd, F_GETFL );
+		err = fcntl( *fd, F_GETFL );
 		if( err>=0 ){
 			/*
 			 * Set as blocking (threads are used with join). */
 			err = err & ( ( (int) 0xFF ) | O_NONBLOCK );
-			tmp = fcntl( (*(*(*cm).token).conn[indx]).fd, F_SETFL, err );
+			tmp = fcntl( *fd, F_SETFL, err );
 			tmp = CBSUCCESS;
 			err = CBSUCCESS;
 		}
@@ -852,103 +1877,198 @@ cb_flush_log();
 } // 30.8.2018
 
 int   memc_get_any_connection( MEMC *cm ){
-	int indx = 0, err = CBSUCCESS;
+	int indx = 0, err = CBSUCCESS, state = MEMCCONNIDLE, busy = -1;
+	char connecting = 0;
 	if( cm==NULL || (*cm).token==NULL ) return -1;
 	/*
 	 * Any ready connection. */
-	if( (*cm).reinit_in_process==1 ){
-		err = pthread_join( (*cm).reinit_thr, NULL);
-		if( err!=0 ){ cb_clog( CBLOGERR, CBNEGATION, "\nmemc_get_any_connection: pthread_join (get any connection): err %i, errno %i '%s'", err, errno, strerror( errno ) ); }
-	}
-	for( indx=0; indx<(*cm).redundant_servers_count; ++indx ){
-		if( (*(*(*cm).token).conn[ indx ]).processing==0 ){
-			if( (*(*(*cm).token).conn[ indx ]).connected==1 )
-				return indx;
-		}
-	}
+	err = memc_join_reinit( &(*cm) ); // 19.10.2026
+	if( err!=CBSUCCESS ){ MEMCLOG( CBLOGERR, CBNEGATION, "\nmemc_get_any_connection: memc_join_reinit, error %i.", err ); }
 	/*
-	 * Any after processing is over starting from first. */
-	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
-		//if( (*(*cm).token).conn[ indx ].processing==1 ){
-		if( (*(*(*cm).token).conn[ indx ]).processing!=0 && (*(*(*cm).token).conn[ indx ]).thr!=NULL ){ // 7.8.2018, 9.8.2018
-			err = pthread_join( (*(*(*cm).token).conn[ indx ]).thr, NULL);
-			if( err!=0 ){ cb_clog( CBLOGERR, CBNEGATION, "\nmemc_get_any_connection: pthread_join (get any connection 2): indx %i, err %i, errno %i '%s'", indx, err, errno, strerror( errno ) ); }
-			if( (*(*(*cm).token).conn[ indx ]).connected==1 )
-				return indx;
-		}else{
-			if( (*(*(*cm).token).conn[ indx ]).connected==1 )
-				return indx;
-		}
-	}
-	/*
-	 * Reconnect, 19.7.2018. */
-	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
-		if( (*(*(*cm).token).conn[ indx ]).processing==0 ){
-			err = pthread_join( (*(*(*cm).token).conn[ indx ]).thr, NULL);
-			if( err!=0 ){ cb_clog( CBLOGERR, CBNEGATION, "\nmemc_get_any_connection: pthread_join (get any connection 3): indx %i, err %i, errno %i '%s'", indx, err, errno, strerror( errno ) ); }
-			if( (*(*(*cm).token).conn[ indx ]).connected==1 )
+	 * From the connection states without joining the threads, 19.10.2026. A busy
+	 * connection is taken when it is released (memc_conn_acquire). */
+	do{
+		connecting = 0; busy = -1;
+		for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
+			state = memc_conn_state( &(*(*(*cm).token).conn[ indx ]) );
+			if( state==MEMCCONNREADY )
 				return indx;
+			if( state==MEMCCONNBUSY && busy<0 )
+				busy = indx;
+			if( state==MEMCCONNCONNECTING )
+				connecting = 1;
 		}
-	}
+		if( busy>=0 )
+			return busy;
+		if( connecting==1 )
+			sched_yield();
+	}while( connecting==1 );
 	return -1;
 }
 
 int  memc_get( MEMC *cm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas, ushort vbucketid ){
-	int err = CBSUCCESS, cindx = -1, indx = 0;
-	char roundfull = 0;
-	MEMC_parameter *pm = NULL;
+	int err = CBSUCCESS;
+	unsigned long long int start = 0;
+	if( cm==NULL ) return CBERRALLOC;
+	if( (*cm).recorder==NULL ) // 19.10.2026
+		return memc_get_cached( &(*cm), &(*key), keylen, &(*msg), &(*msglen), msgbuflen, &(*cas), vbucketid );
+	start = memc_time_usec();
+	err = memc_get_cached( &(*cm), &(*key), keylen, &(*msg), &(*msglen), msgbuflen, &(*cas), vbucketid );
+	memc_record_put( &(*cm), MEMCGET, ( key!=NULL ) ? *key : NULL, keylen, ( err==MEMCSUCCESS && msglen!=NULL ) ? (uint) *msglen : 0, start, err );
+	return err;
+}
+/*
+ * Caches, single flight and the network. */
+int  memc_get_cached( MEMC *cm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas, ushort vbucketid ){
+	int err = CBSUCCESS, ncmsglen = 0;
+	uint shmseq = 1; // odd, nothing to update
+	char stale = 0, waited = 0;
+	unsigned long int ncgen = 0, neggen = 0;
+	unsigned long long int nccas = 0, cas64 = 0;
+	memc_flight *flight = NULL;
 	if( cm==NULL ) return CBERRALLOC;
 	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
 	if( cas==NULL || key==NULL || *key==NULL || msg==NULL || *msg==NULL || cm==NULL ) return CBERRALLOC;
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_GET BUFLEN %i", msgbuflen); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_GET BUFLEN %i", msgbuflen); MEMCFLUSHLOG();
 
 	if( keylen<=0 ){
-		cb_clog( CBLOGDEBUG, MEMCSENDKEYERR, "\nmemc_get: key may not be empty, error MEMCSENDKEYERR.");
+		MEMCLOG( CBLOGDEBUG, MEMCSENDKEYERR, "\nmemc_get: key may not be empty, error MEMCSENDKEYERR.");
 		return MEMCSENDKEYERR; // 21.8.2018
 	}
 
 	/*
-	 * Wait for the previous data to be updated. */
-	cindx = memc_get_any_connection( &(*cm) );
-	if( cindx<0 ){
-		cb_clog( CBLOGERR, MEMCERRCONNECT, "\nmemc_get: no available connections, error %i.", MEMCERRCONNECT );
+	 * Near-cache, revalidated later if stale, 19.10.2026. */
+	if( (*cm).nearcache!=NULL ){
+		err = memc_nearcache_get( &(*cm), &(**key), keylen, &(**msg), &ncmsglen, msgbuflen, &nccas, &stale, &ncgen );
+		if( err==MEMCSUCCESS && stale==0 ){
+			*msglen = ncmsglen;
+			*cas = (uint) nccas;
+			return MEMCSUCCESS;
+		}
+		if( err!=MEMCSUCCESS )
+			stale = 0; // not cached
 	}
 
 	/*
-	 * Get empty parameters. */
-	pm = (void*) malloc( sizeof( void* ) ); // 9.8.2017, 31.10.2018
-	if( pm==NULL ) return CBERRALLOC;
-	memc_get_param( &pm ); // 19.7.2018
-	if( pm==NULL ) return CBERRALLOC;
+	 * Key was not found a moment ago, 19.10.2026. */
+	if( (*cm).negcache!=NULL ){
+		if( memc_negcache_get( &(*cm), &(**key), keylen, &neggen )==MEMCSUCCESS && stale==0 )
+			return MEMCKEYNOTFOUND;
+	}
 
 	/*
-	 * Parameters. */
-	(*pm).cm = &(*cm); // 11.7.2018
-	(*pm).msg = &(**msg);
-	if( *msglen<0 ) return CBOVERFLOW;
-	(*pm).msglen = (uint) *msglen;
-	(*pm).msgbuflen = msgbuflen;
-	(*pm).key = &(**key);
-	if( keylen>65536 ) return CBOVERFLOW;
-	(*pm).keylen = (ushort) keylen;
+	 * Shared memory cache of the forked processes, 19.10.2026. */
+	if( (*cm).shmcache!=NULL && stale==0 ){
+		err = memc_shmcache_get( &(*cm), &(**key), keylen, &(**msg), &ncmsglen, msgbuflen, &nccas, &shmseq );
+		if( err==MEMCSUCCESS ){
+			*msglen = ncmsglen;
+			*cas = (uint) nccas;
+			return MEMCSUCCESS;
+		}
+	}
+
+	/*
+	 * Wait for the same key if some other thread is reading it, 19.10.2026. */
+	if( (*cm).flight_created!=0 ){
+		err = memc_flight_join( &(*cm), &(**key), keylen, &(**msg), &(*msglen), msgbuflen, &cas64, &flight, &waited );
+		if( waited==1 ){
+			*cas = (uint) cas64;
+			return err;
+		}
+	}
+
+	err = memc_get_network( &(*cm), &(*key), keylen, &(*msg), &(*msglen), msgbuflen, &(*cas), vbucketid, stale, nccas, ncmsglen, ncgen, neggen, shmseq, &cas64 );
+
+	if( flight!=NULL )
+		memc_flight_finish( &(*cm), &(*flight), err, &(**msg), *msglen, cas64 );
+	return err;
+}
+/*
+ * The rest of the memc_get after the caches. */
+int  memc_get_network( MEMC *cm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas, ushort vbucketid, \
+		char stale, unsigned long long int nccas, int ncmsglen, unsigned long int ncgen, unsigned long int neggen, uint shmseq, unsigned long long int *cas64 ){
+	int err = CBSUCCESS, cindx = -1, indx = 0;
+	char roundfull = 0;
+	MEMC_parameter *pm = NULL;
+	if( cm==NULL || (*cm).token==NULL || key==NULL || msg==NULL || msglen==NULL || cas==NULL || cas64==NULL ) return CBERRALLOC;
+
+	/*
+	 * New connections in a forked child, 19.10.2026. */
+	memc_fork_reconnect( &(*cm), 1 );
+
+	/*
+	 * Wait for the previous data to be updated. */
+	cindx = memc_get_any_connection( &(*cm) );
+	if( cindx<0 ){
+		MEMCLOG( CBLOGERR, MEMCERRCONNECT, "\nmemc_get: no available connections, error %i.", MEMCERRCONNECT );
+	}
+
+	/*
+	 * Get empty parameters. */
+	if( *msglen<0 || keylen>65536 ) return CBOVERFLOW;
+	err = memc_get_param( &(*cm), &pm ); // 19.7.2018, 19.10.2026
+	if( err>=CBERROR || pm==NULL ) return CBERRALLOC;
+
+	/*
+	 * Parameters. */
+	(*pm).cm = &(*cm); // 11.7.2018
+	(*pm).msg = &(**msg);
+	(*pm).msglen = (uint) *msglen;
+	(*pm).msgbuflen = msgbuflen;
+	(*pm).key = &(**key);
+	(*pm).keylen = (ushort) keylen;
 	(*pm).vbucketid = vbucketid;
 	(*pm).cas = (ushort) *cas;
 	(*pm).cindx = cindx;
+	if( (*cm).trace_hook!=NULL ) // 19.10.2026
+		(*pm).trace_id = __atomic_add_fetch( &(*cm).trace_ids, 1, __ATOMIC_RELAXED );
+	MEMCTRACE( cm, pm, MEMCTRACEROUTE, MEMCGET, CBSUCCESS );
+	MEMCPROBE4( submit, MEMCGET, keylen, 0, (*pm).trace_id );
 
 	/*
-	 * Wait for the connections (and the previous data to be updated), 19.7.2018. */
-	err = memc_join_previous( &(*cm) );
-	if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_get: memc_join_previous, error %i.", err ); }
+	 * Wait for the connections (and the previous data to be updated), 19.7.2018.
+	 * Only the previous requests of the same key, 19.10.2026. */
+	err = memc_join_key( &(*cm), memc_key_order( &(**key), keylen ), NULL );
+	if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_get: memc_join_key, error %i.", err ); }
+
+	/*
+	 * Stale near-cache entry. If the CAS has not changed, the value
+	 * is already in the buffer, 19.10.2026. */
+	if( stale==1 && cindx>=0 && (*cm).nearcache!=NULL && (*(*cm).nearcache).touch_expiration>0 && memc_conn_acquire( &(*(*(*cm).token).conn[ cindx ]) )==1 ){
+		MEMCTRACE( cm, pm, MEMCTRACEACQUIRE, MEMCTOUCH, CBSUCCESS );
+		err = memc_touch_seq( &(*pm), (*(*cm).nearcache).touch_expiration );
+		memc_conn_release( &(*(*(*cm).token).conn[ cindx ]), err );
+		if( err==MEMCSUCCESS && (*pm).cas64==nccas && memc_nearcache_validated( &(*cm), &(**key), keylen, nccas, ncgen )==MEMCSUCCESS ){
+			*msglen = ncmsglen;
+			*cas = (uint) nccas;
+			*cas64 = nccas;
+			memc_free_param( pm );
+			pm = NULL;
+			return MEMCSUCCESS;
+		}
+		(*pm).keylen = (ushort) keylen;
+	}
 
 	/*
 	 * Threads are not needed here. */
 	err = -1;
 	roundfull = 0;
+	if( cindx<0 )
+		cindx = 0; // none was ready, 19.10.2026
 	/* Start from the first known to be available, 30.8.2018 */
 	for( indx=cindx; indx<(*cm).redundant_servers_count && err!=MEMCSUCCESS && indx<=MEMCMAXREDUNDANTDBS; ++indx ){ // 30.8.2018
+		if( err!=-1 )
+			memc_stats_event( &(*cm), indx, MEMCSTATSRETRY ); // 19.10.2026
 		(*pm).cindx = indx;
-		err = memc_get_seq( &(*pm) );
+		(*pm).keylen = (ushort) keylen; // memc_recv sets the length of the key in the responce, 19.10.2026
+		if( memc_conn_acquire( &(*(*(*cm).token).conn[ indx ]) )==1 ){ // 19.10.2026
+			MEMCTRACE( cm, pm, MEMCTRACEACQUIRE, MEMCGET, CBSUCCESS );
+			err = memc_get_seq( &(*pm) );
+			memc_conn_release( &(*(*(*cm).token).conn[ indx ]), err );
+		}else{
+			err = MEMCERRCONNECT;
+		}
 		if( roundfull==0 ){
 			if( (indx+1)==(*cm).redundant_servers_count ){
 				roundfull = 1;
@@ -961,20 +2081,31 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_GET BUFLEN %i", msgbuflen); cb_flush_log
 	}
 	if( err==MEMCSUCCESS ){
 		*cas = (*pm).cas;
+		*cas64 = (*pm).cas64;
 		*msglen = (int) (*pm).msglen;
+		if( (*cm).nearcache!=NULL )
+			memc_nearcache_put( &(*cm), &(**key), keylen, &(**msg), *msglen, (*pm).cas64, ncgen ); // 19.10.2026
+		if( (*cm).shmcache!=NULL )
+			memc_shmcache_put( &(*cm), &(**key), keylen, &(**msg), *msglen, (*pm).cas64, shmseq ); // 19.10.2026
 
 /***
-cb_clog( CBLOGDEBUG, CBNEGATION, "\nFrom memc_get_seq: SUCCESS, msglen %i, status %.2X, msg: [", *msglen, err );
+MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nFrom memc_get_seq: SUCCESS, msglen %i, status %.2X, msg: [", *msglen, err );
 if( (*pm).msg!=NULL ){
   for( indx=0; indx< (int) (*pm).msglen && 0>(int)(*pm).msglen ; ++indx ){ // Debug
-	cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (unsigned char) (*pm).msg[ indx ] );
+	MEMCLOG( CBLOGDEBUG, CBNEGATION, "%c", (unsigned char) (*pm).msg[ indx ] );
   }
 }
-cb_clog( CBLOGDEBUG, CBNEGATION, "]"); 
+MEMCLOG( CBLOGDEBUG, CBNEGATION, "]"); 
  ***/
+	}else if( ( err==MEMCKEYNOTFOUND || err==MEMCRECVKEYNOTFOUND ) && (*cm).negcache!=NULL ){
+		memc_negcache_put( &(*cm), &(**key), keylen, neggen ); // 19.10.2026
 	}else{
 		; // fail
 	}
+	if( (*cm).trace_hook!=NULL ){ // 19.10.2026
+		(*pm).cindx = -1;
+		memc_trace( &(*cm), &(*pm), MEMCTRACEFANOUT, MEMCGET, err );
+	}
 
 	/***
 	if( (*pm).cindx==((*cm).redundant_servers_count-1) && ( some_was_not_connected==1 || 
@@ -983,10 +2114,10 @@ cb_clog( CBLOGDEBUG, CBNEGATION, "]");
 		// Last without results. Try reconnecting. 
 		//memc_reinit( &(*cm) );
 		err = memc_connect( &(*cm), &(*key), keylen );
-		if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_get: memc_connect, error %i (2).", err ); }
+		if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_get: memc_connect, error %i (2).", err ); }
 		err = memc_join_previous( &(*cm) );
-		if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_get: memc_join_previous, error %i (2).", err ); }
-		cb_clog( CBLOGDEBUG, err, "\nmemc_get: warning, reinit of connections.");
+		if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_get: memc_join_previous, error %i (2).", err ); }
+		MEMCLOG( CBLOGDEBUG, err, "\nmemc_get: warning, reinit of connections.");
 		(*pm).cindx=0;
 		continue;
 	}
@@ -994,12 +2125,14 @@ cb_clog( CBLOGDEBUG, CBNEGATION, "]");
 
 	memc_free_param( pm ); // 19.7.2018
 	pm = NULL;
-	cb_flush_log();
+	MEMCFLUSHLOG();
 
 	return err;
 }
 int  memc_get_seq( MEMC_parameter *pm ){
-	int err = CBSUCCESS; // , indx = 0;
+	int err = CBSUCCESS, keylen = 0; // , indx = 0;
+	unsigned long int in = 0;
+	unsigned long long int start = 0;
 	memc_msg    hdr;
 	memc_extras ext;
 	if( pm==NULL || (*pm).key==NULL || (*pm).msg==NULL || (*pm).cm==NULL || (*(*pm).cm).token==NULL ) return CBERRALLOC;
@@ -1011,48 +2144,46 @@ int  memc_get_seq( MEMC_parameter *pm ){
 		(*pm).msglen = 0;
 		return CBERRFILEOP; // pthread_exit( NULL );
 	}
-	hdr.magic = MEMCREQUEST; hdr.opcode = MEMCGET; hdr.data_type = MEMCDATATYPE; hdr.vbucket_id = (*pm).vbucketid;
-	hdr.key_length = (*pm).keylen;
-	hdr.extras_length = 0 ;         // request
-	hdr.body_length = (*pm).keylen; // get, 9.8.2018
-	hdr.opaque = 0x02; hdr.cas = 0x00;
-
-	if( pm==NULL ) cb_clog( CBLOGDEBUG, CBSUCCESS, " pm NULL ");
-	cb_flush_log();
-	if( (*pm).cm==NULL ) cb_clog( CBLOGDEBUG, CBSUCCESS, " cm NULL ");
-	cb_flush_log();
-	if( (*(*pm).cm).token==NULL ) cb_clog( CBLOGDEBUG, CBSUCCESS, " token NULL ");
-	cb_flush_log();
-	pthread_mutex_lock( &(*(*pm).cm).send );
+	if( (*pm).msgbuflen<0 ) return CBOVERFLOW; // before sending, 19.10.2026
+	keylen = (int) (*pm).keylen; // memc_recv sets the key length of the responce
+	memc_hdr_request( &hdr, MEMCGET, (*pm).keylen, (*pm).keylen, (*pm).vbucketid, 0x00 ); // get, 9.8.2018, 19.10.2026
+
+	start = memc_stats_begin( &(*(*pm).cm), (*pm).cindx ); // 19.10.2026
 	err = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, &(*pm).key, (*pm).keylen, NULL, 0 );
-	pthread_mutex_unlock( &(*(*pm).cm).send );
+	MEMCTRACE( (*pm).cm, pm, MEMCTRACESENT, MEMCGET, err );
 	if( err<CBNEGATION ){
-		if( (*pm).msgbuflen<0 ) return CBOVERFLOW;
+		memc_trace_first_byte( &(*pm), MEMCGET );
 		(*pm).msglen = (uint) (*pm).msgbuflen;
 		hdr.body_length = 0;
 		hdr.extras_length = 0x04;
 		hdr.key_length = 0;
-		pthread_mutex_lock( &(*(*pm).cm).recv );
 		err = memc_recv( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, &ext, &(*pm).key, &(*pm).keylen, (*pm).keylen, &(*pm).msg, &(*pm).msglen, (*pm).msgbuflen );
-		pthread_mutex_unlock( &(*(*pm).cm).recv );
+		MEMCTRACE( (*pm).cm, pm, MEMCTRACEPARSED, MEMCGET, err );
+		if( err==CBSUCCESS && hdr.magic==MEMCRESPONCE ) in = 24 + hdr.body_length; // not a header out of sync
+	}else{
+		hdr.status = 0x00;
 	}
+	memc_stats_end( &(*(*pm).cm), (*pm).cindx, MEMCSTATSGET, start, err, hdr.status, 24 + (unsigned long int) (*pm).keylen, in );
+	if( (*(*pm).cm).slowlog!=NULL )
+		memc_slowlog_put( &(*pm), MEMCGET, ( err!=CBSUCCESS ) ? err : (int) hdr.status, keylen, ( err==CBSUCCESS ) ? (*pm).msglen : 0 );
 	if( err<CBNEGATION ){
+		(*pm).cas64 = hdr.cas; // near-cache, 19.10.2026
 		if( hdr.cas>4294967296 ) return CBOVERFLOW; 
 		(*pm).cas = (unsigned int) hdr.cas;
 		// Debug
 		/***
-		cb_clog( CBLOGDEBUG, CBSUCCESS, "\nGet: 10 msg [");
+		MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nGet: 10 msg [");
 		for( indx=0; indx<(*pm).msglen; ++indx )
-				cb_clog( CBLOGDEBUG, CBSUCCESS, "%c", (char) (*pm).msg[indx] ); // incorrect pointer tms. 9.8.2018
-		cb_clog( CBLOGDEBUG, CBSUCCESS, "]");
+				MEMCLOG( CBLOGDEBUG, CBSUCCESS, "%c", (char) (*pm).msg[indx] ); // incorrect pointer tms. 9.8.2018
+		MEMCLOG( CBLOGDEBUG, CBSUCCESS, "]");
 		 ***/
 	}else{
 		// Debug
-		cb_clog( CBLOGDEBUG, CBSUCCESS, "\nGet returned %i, key or value was not found.", err );
+		MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nGet returned %i, key or value was not found.", err );
 		if( err==MEMCSENDEXTERR )
 			err = MEMCRECVKEYNOTFOUND;
 	}
-	cb_flush_log();
+	MEMCFLUSHLOG();
 	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = err;
 	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).laststatus = hdr.status;
 	if( err!=CBSUCCESS || hdr.status==MEMCSUCCESS ) // 16.9.2018
@@ -1060,6 +2191,1810 @@ int  memc_get_seq( MEMC_parameter *pm ){
 	return (int) hdr.status;
 }
 
+/*
+ * TOUCH, the responce has the CAS but not the value, 19.10.2026. */
+int  memc_touch_seq( MEMC_parameter *pm, ushort expiration ){
+	int err = CBSUCCESS, len = 0;
+	uint remaining = 0;
+	unsigned long int in = 0;
+	unsigned long long int start = 0;
+	uchar scratch[ 64 ];
+	memc_msg    hdr;
+	memc_extras ext;
+	if( pm==NULL || (*pm).key==NULL || (*pm).cm==NULL || (*(*pm).cm).token==NULL ) return CBERRALLOC;
+	if( (*pm).cindx<0 || (*(*(*pm).cm).token).conn==NULL || (*(*(*pm).cm).token).conn[ (*pm).cindx ]==NULL ) return CBERRALLOC;
+	if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd<0 ) return CBERRFILEOP;
+
+	memc_hdr_request( &hdr, MEMCTOUCH, (*pm).keylen, (uint) (*pm).keylen + 0x04, (*pm).vbucketid, 0x00 ); // expiration only, written from the first field
+	ext.flags = expiration;
+	ext.expiration = 0x00;
+
+	start = memc_stats_begin( &(*(*pm).cm), (*pm).cindx ); // 19.10.2026
+	err = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, &ext, &(*pm).key, (*pm).keylen, NULL, 0 );
+	MEMCTRACE( (*pm).cm, pm, MEMCTRACESENT, MEMCTOUCH, err );
+	if( err<CBNEGATION ){
+		memc_trace_first_byte( &(*pm), MEMCTOUCH );
+		err = memc_recv( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, &ext, NULL, NULL, 0, NULL, NULL, 0 );
+		/*
+		 * Error text in the body. */
+		if( err<CBNEGATION && hdr.body_length > (uint) ( hdr.extras_length + hdr.key_length ) )
+			remaining = hdr.body_length - hdr.extras_length - hdr.key_length;
+		while( remaining>0 ){
+			len = memc_read( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &scratch[0], ( remaining<sizeof( scratch ) ) ? remaining : sizeof( scratch ) );
+			if( len<=0 ){ err = MEMCRECVMSGERR; break; }
+			remaining -= (uint) len;
+		}
+		MEMCTRACE( (*pm).cm, pm, MEMCTRACEPARSED, MEMCTOUCH, err );
+		if( err==CBSUCCESS && hdr.magic==MEMCRESPONCE ) in = 24 + hdr.body_length;
+	}else{
+		hdr.status = 0x00;
+	}
+	memc_stats_end( &(*(*pm).cm), (*pm).cindx, MEMCSTATSTOUCH, start, err, hdr.status, 28 + (unsigned long int) (*pm).keylen, in );
+	if( (*(*pm).cm).slowlog!=NULL )
+		memc_slowlog_put( &(*pm), MEMCTOUCH, ( err!=CBSUCCESS ) ? err : (int) hdr.status, (int) (*pm).keylen, 0 );
+	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = err;
+	if( err>=CBNEGATION )
+		return err;
+	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).laststatus = hdr.status;
+	(*pm).cas64 = hdr.cas;
+	return (int) hdr.status;
+}
+
+/*
+ * TOUCH of every redundant server in sequence, MEMCSUCCESS if one of them had the key, 19.10.2026. */
+int  memc_touch( MEMC *cm, uchar **key, int keylen, ushort expiration, ushort vbucketid ){
+	int err = CBSUCCESS, ret = -1, indx = 0;
+	MEMC_parameter *pm = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
+	if( key==NULL || *key==NULL ) return CBERRALLOC;
+	if( keylen<=0 || keylen>65535 ) return MEMCSENDKEYERR;
+
+	memc_fork_reconnect( &(*cm), 1 );
+	err = memc_join_key( &(*cm), memc_key_order( &(**key), keylen ), NULL ); // after the previous SET of the key
+	if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_touch: memc_join_key, error %i.", err ); }
+	err = memc_get_param( &(*cm), &pm );
+	if( err>=CBERROR || pm==NULL ) return CBERRALLOC;
+	(*pm).cm = &(*cm);
+	(*pm).key = &(**key);
+	(*pm).vbucketid = vbucketid;
+	if( (*cm).trace_hook!=NULL )
+		(*pm).trace_id = __atomic_add_fetch( &(*cm).trace_ids, 1, __ATOMIC_RELAXED );
+	MEMCPROBE4( submit, MEMCTOUCH, keylen, 0, (*pm).trace_id );
+
+	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
+		(*pm).cindx = indx;
+		(*pm).keylen = (ushort) keylen;
+		MEMCTRACE( cm, pm, MEMCTRACEROUTE, MEMCTOUCH, CBSUCCESS );
+		if( memc_conn_acquire( &(*(*(*cm).token).conn[ indx ]) )==1 ){
+			MEMCTRACE( cm, pm, MEMCTRACEACQUIRE, MEMCTOUCH, CBSUCCESS );
+			err = memc_touch_seq( &(*pm), expiration );
+			memc_conn_release( &(*(*(*cm).token).conn[ indx ]), err );
+		}else{
+			err = MEMCERRCONNECT;
+		}
+		if( ret!=MEMCSUCCESS )
+			ret = err;
+	}
+	memc_free_param( pm );
+	pm = NULL;
+	return ( ret==-1 ) ? MEMCERRCONNECT : ret;
+}
+
+/*
+ * Near-cache. */
+unsigned long long int  memc_time_usec( void ){
+	struct timespec ts;
+	if( clock_gettime( CLOCK_MONOTONIC, &ts )!=0 ) return 0;
+	return ( (unsigned long long int) ts.tv_sec * 1000000 ) + ( (unsigned long long int) ts.tv_nsec / 1000 );
+}
+uint  memc_hash_key( uchar *key, int keylen ){ // FNV-1a
+	int indx = 0;
+	uint hash = 2166136261U;
+	if( key==NULL ) return 0;
+	for( indx=0; indx<keylen; ++indx ){
+		hash ^= (uint) key[ indx ];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+int  memc_nearcache_create( MEMC *cm, int entries, int soft_ttl_ms, int max_value_length, ushort touch_expiration ){
+	int err = CBSUCCESS;
+	memc_nearcache *nc = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( entries<=0 || soft_ttl_ms<0 || max_value_length<=0 ) return CBOVERFLOW;
+	if( (*cm).nearcache!=NULL )
+		memc_nearcache_free( &(*cm) );
+
+	nc = (memc_nearcache*) malloc( sizeof( memc_nearcache ) );
+	if( nc==NULL ) return CBERRALLOC;
+	(*nc).entries = (memc_nearcache_entry*) calloc( (size_t) entries, sizeof( memc_nearcache_entry ) );
+	if( (*nc).entries==NULL ){ free( nc ); return CBERRALLOC; }
+	(*nc).size = entries;
+	(*nc).max_value_length = max_value_length;
+	(*nc).soft_ttl = (unsigned long long int) soft_ttl_ms * 1000;
+	(*nc).touch_expiration = touch_expiration;
+	(*nc).emptypad = 0;
+	(*nc).hits = 0;
+	(*nc).revalidations = 0;
+	(*nc).refetches = 0;
+	err = pthread_mutex_init( &(*nc).mtx, NULL );
+	if( err!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_nearcache_create: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) );
+		free( (*nc).entries );
+		free( nc );
+		return MEMCERRTHREAD;
+	}
+	(*nc).mtx_created = 1;
+	(*cm).nearcache = &(*nc);
+	return CBSUCCESS;
+}
+int  memc_nearcache_free( MEMC *cm ){
+	int indx = 0;
+	memc_nearcache *nc = NULL;
+	if( cm==NULL || (*cm).nearcache==NULL ) return CBSUCCESS;
+	nc = &(*(*cm).nearcache);
+	(*cm).nearcache = NULL;
+	for( indx=0; indx<(*nc).size; ++indx ){
+		if( (*nc).entries[ indx ].key!=NULL ) free( (*nc).entries[ indx ].key );
+		if( (*nc).entries[ indx ].msg!=NULL ) free( (*nc).entries[ indx ].msg );
+	}
+	free( (*nc).entries );
+	if( (*nc).mtx_created!=0 ){
+		(*nc).mtx_created = 0;
+		pthread_mutex_destroy( &(*nc).mtx );
+	}
+	free( nc );
+	return CBSUCCESS;
+}
+memc_nearcache_entry* memc_nearcache_find( memc_nearcache *nc, uchar *key, int keylen ){
+	memc_nearcache_entry *ent = NULL;
+	if( nc==NULL || key==NULL || keylen<=0 ) return NULL;
+	ent = &(*nc).entries[ memc_hash_key( &(*key), keylen ) % (uint) (*nc).size ];
+	if( (*ent).key==NULL || (*ent).keylen!=(uint) keylen || memcmp( (*ent).key, key, (size_t) keylen )!=0 )
+		return NULL;
+	return ent;
+}
+int  memc_nearcache_get( MEMC *cm, uchar *key, int keylen, uchar *msg, int *msglen, int msgbuflen, unsigned long long int *cas, char *stale, unsigned long int *generation ){
+	int err = MEMCKEYNOTFOUND;
+	memc_nearcache_entry *ent = NULL;
+	if( cm==NULL || (*cm).nearcache==NULL || msg==NULL || msglen==NULL || cas==NULL || stale==NULL || generation==NULL ) return CBERRALLOC;
+	if( keylen<=0 ) return MEMCKEYNOTFOUND;
+	pthread_mutex_lock( &(*(*cm).nearcache).mtx );
+	*generation = (*(*cm).nearcache).entries[ memc_hash_key( &(*key), keylen ) % (uint) (*(*cm).nearcache).size ].generation;
+	ent = memc_nearcache_find( &(*(*cm).nearcache), &(*key), keylen );
+	if( ent!=NULL && (int) (*ent).msglen<msgbuflen ){
+		memcpy( &(*msg), (*ent).msg, (size_t) (*ent).msglen );
+		*msglen = (int) (*ent).msglen;
+		*cas = (*ent).cas;
+		*stale = 0;
+		if( ( memc_time_usec() - (*ent).validated ) > (*(*cm).nearcache).soft_ttl )
+			*stale = 1;
+		else
+			++(*(*cm).nearcache).hits;
+		err = MEMCSUCCESS;
+	}
+	pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+	return err;
+}
+int  memc_nearcache_put( MEMC *cm, uchar *key, int keylen, uchar *msg, int msglen, unsigned long long int cas, unsigned long int generation ){
+	uchar *newkey = NULL, *newmsg = NULL;
+	memc_nearcache_entry *ent = NULL;
+	if( cm==NULL || (*cm).nearcache==NULL || key==NULL || msg==NULL ) return CBERRALLOC;
+	if( keylen<=0 || msglen<0 || msglen>(*(*cm).nearcache).max_value_length ) return CBSUCCESS; // not cached
+
+	pthread_mutex_lock( &(*(*cm).nearcache).mtx );
+	if( (*(*cm).nearcache).entries[ memc_hash_key( &(*key), keylen ) % (uint) (*(*cm).nearcache).size ].generation!=generation ){
+		pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+		return CBSUCCESS; // written during the GET, the value may be the old one
+	}
+	ent = memc_nearcache_find( &(*(*cm).nearcache), &(*key), keylen );
+	if( ent!=NULL )
+		++(*(*cm).nearcache).refetches; // the value was transferred again
+	if( ent!=NULL && (*ent).cas==cas && (*ent).msglen==(uint) msglen ){
+		(*ent).validated = memc_time_usec(); // not changed, the copy is kept
+		pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+		return CBSUCCESS;
+	}
+	newkey = (uchar*) malloc( (size_t) keylen );
+	newmsg = (uchar*) malloc( (size_t) msglen + 1 );
+	if( newkey==NULL || newmsg==NULL ){
+		pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+		if( newkey!=NULL ) free( newkey );
+		if( newmsg!=NULL ) free( newmsg );
+		return CBERRALLOC;
+	}
+	memcpy( &(*newkey), key, (size_t) keylen );
+	memcpy( &(*newmsg), msg, (size_t) msglen );
+	ent = &(*(*cm).nearcache).entries[ memc_hash_key( &(*key), keylen ) % (uint) (*(*cm).nearcache).size ];
+	if( (*ent).key!=NULL ) free( (*ent).key );
+	if( (*ent).msg!=NULL ) free( (*ent).msg );
+	(*ent).key = &(*newkey);
+	(*ent).keylen = (uint) keylen;
+	(*ent).msg = &(*newmsg);
+	(*ent).msglen = (uint) msglen;
+	(*ent).cas = cas;
+	(*ent).validated = memc_time_usec();
+	pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+	return CBSUCCESS;
+}
+/*
+ * TOUCH returned the same CAS. Not if the key was written after memc_nearcache_get. */
+int  memc_nearcache_validated( MEMC *cm, uchar *key, int keylen, unsigned long long int cas, unsigned long int generation ){
+	int err = CBNEGATION;
+	memc_nearcache_entry *ent = NULL;
+	if( cm==NULL || (*cm).nearcache==NULL || key==NULL ) return CBERRALLOC;
+	if( keylen<=0 ) return CBNEGATION;
+	pthread_mutex_lock( &(*(*cm).nearcache).mtx );
+	ent = memc_nearcache_find( &(*(*cm).nearcache), &(*key), keylen );
+	if( ent!=NULL && (*ent).cas==cas && (*ent).generation==generation ){
+		(*ent).validated = memc_time_usec();
+		++(*(*cm).nearcache).revalidations;
+		err = MEMCSUCCESS;
+	}
+	pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+	return err;
+}
+int  memc_nearcache_invalidate( MEMC *cm, uchar **key, int keylen ){
+	memc_nearcache_entry *ent = NULL;
+	if( cm==NULL || key==NULL || *key==NULL ) return CBERRALLOC;
+	if( (*cm).nearcache==NULL || keylen<=0 ) return CBSUCCESS;
+	pthread_mutex_lock( &(*(*cm).nearcache).mtx );
+	++(*(*cm).nearcache).entries[ memc_hash_key( &(**key), keylen ) % (uint) (*(*cm).nearcache).size ].generation;
+	ent = memc_nearcache_find( &(*(*cm).nearcache), &(**key), keylen );
+	if( ent!=NULL ){
+		free( (*ent).key );
+		if( (*ent).msg!=NULL ) free( (*ent).msg );
+		(*ent).key = NULL;
+		(*ent).msg = NULL;
+		(*ent).keylen = 0;
+		(*ent).msglen = 0;
+		(*ent).cas = 0;
+	}
+	pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+	return CBSUCCESS;
+}
+int  memc_nearcache_stats( MEMC *cm, unsigned long int *hits, unsigned long int *revalidations, unsigned long int *refetches ){
+	if( cm==NULL || hits==NULL || revalidations==NULL || refetches==NULL ) return CBERRALLOC;
+	*hits = 0; *revalidations = 0; *refetches = 0;
+	if( (*cm).nearcache==NULL ) return MEMCUNINITIALIZED;
+	pthread_mutex_lock( &(*(*cm).nearcache).mtx );
+	*hits = (*(*cm).nearcache).hits;
+	*revalidations = (*(*cm).nearcache).revalidations;
+	*refetches = (*(*cm).nearcache).refetches;
+	pthread_mutex_unlock( &(*(*cm).nearcache).mtx );
+	return CBSUCCESS;
+}
+
+/*
+ * Shared memory cache. */
+int  memc_shmcache_create( MEMC *cm, int buckets, int max_key_length, int max_value_length, int ttl_ms ){
+	size_t bucket_size = 0, header_size = 0, region_size = 0;
+	void *region = NULL;
+	memc_shmcache *sc = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( buckets<=0 || max_key_length<=0 || max_key_length>65535 || max_value_length<=0 || ttl_ms<=0 ) return CBOVERFLOW;
+	if( (*cm).shmcache!=NULL )
+		memc_shmcache_free( &(*cm) );
+
+	header_size = ( sizeof( memc_shmcache ) + 63 ) & ~( (size_t) 63 );
+	bucket_size = ( sizeof( memc_shmcache_bucket ) + (size_t) max_key_length + (size_t) max_value_length + 63 ) & ~( (size_t) 63 );
+	region_size = header_size + ( bucket_size * (size_t) buckets );
+
+	/*
+	 * Anonymous shared mapping is inherited in fork and is zero filled. */
+	region = mmap( NULL, region_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+	if( region==MAP_FAILED ){
+		MEMCLOG( CBLOGERR, CBERRALLOC, "\nmemc_shmcache_create: mmap, errno %i '%s'.", errno, strerror( errno ) );
+		return CBERRALLOC;
+	}
+	sc = (memc_shmcache*) region;
+	(*sc).magic = MEMCSHMMAGIC;
+	(*sc).buckets = buckets;
+	(*sc).max_key_length = max_key_length;
+	(*sc).max_value_length = max_value_length;
+	(*sc).bucket_size = bucket_size;
+	(*sc).region_size = region_size;
+	(*sc).ttl = (unsigned long long int) ttl_ms * 1000;
+	(*cm).shmcache = &(*sc);
+	return CBSUCCESS;
+}
+int  memc_shmcache_free( MEMC *cm ){
+	memc_shmcache *sc = NULL;
+	if( cm==NULL || (*cm).shmcache==NULL ) return CBSUCCESS;
+	sc = &(*(*cm).shmcache);
+	(*cm).shmcache = NULL;
+	if( munmap( (void*) sc, (*sc).region_size )!=0 ){
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_shmcache_free: munmap, errno %i '%s'.", errno, strerror( errno ) );
+	}
+	return CBSUCCESS;
+}
+memc_shmcache_bucket* memc_shmcache_bucket_at( memc_shmcache *sc, uchar *key, int keylen ){
+	size_t offset = 0;
+	if( sc==NULL || (*sc).magic!=MEMCSHMMAGIC ) return NULL;
+	offset = ( sizeof( memc_shmcache ) + 63 ) & ~( (size_t) 63 );
+	offset += (*sc).bucket_size * (size_t) ( memc_hash_key( &(*key), keylen ) % (uint) (*sc).buckets );
+	return (memc_shmcache_bucket*) ( (void*) ( (uchar*) sc + offset ) );
+}
+/*
+ * Returns the sequence number to use in memc_shmcache_put if the key was not found. */
+int  memc_shmcache_get( MEMC *cm, uchar *key, int keylen, uchar *msg, int *msglen, int msgbuflen, unsigned long long int *cas, uint *seq ){
+	int tries = 0;
+	char found = 0;
+	uint seq1 = 0, seq2 = 0, bkeylen = 0, bmsglen = 0;
+	unsigned long long int bcas = 0, now = 0;
+	memc_shmcache_bucket *bkt = NULL;
+	uchar *data = NULL;
+	if( cm==NULL || key==NULL || msg==NULL || msglen==NULL || cas==NULL || seq==NULL ) return CBERRALLOC;
+	*seq = 1;
+	bkt = memc_shmcache_bucket_at( &(*(*cm).shmcache), &(*key), keylen );
+	if( bkt==NULL || keylen<=0 ) return MEMCKEYNOTFOUND;
+	data = (uchar*) bkt + sizeof( memc_shmcache_bucket );
+	now = memc_time_usec();
+	for( tries=0; tries<MEMCSHMRETRIES; ++tries ){
+		seq1 = __atomic_load_n( &(*bkt).seq, __ATOMIC_ACQUIRE );
+		if( ( seq1 & 0x01 )!=0 ){ // writer
+			if( tries==MEMCSHMRETRIES/2 && memc_shmcache_lock( &(*bkt) )==1 )
+				memc_shmcache_unlock( &(*bkt) ); // the writer had exited, cleared
+			else
+				sched_yield();
+			continue;
+		}
+		found = 0;
+		bkeylen = (*bkt).keylen;
+		bmsglen = (*bkt).msglen;
+		bcas = (*bkt).cas;
+		if( bkeylen==(uint) keylen && bkeylen<=(uint) (*(*cm).shmcache).max_key_length && \
+		    bmsglen<=(uint) (*(*cm).shmcache).max_value_length && (int) bmsglen<msgbuflen && \
+		    (*bkt).expires>now && memcmp( &(*data), key, (size_t) keylen )==0 ){
+			memcpy( &(*msg), &data[ bkeylen ], (size_t) bmsglen );
+			found = 1;
+		}
+		__atomic_thread_fence( __ATOMIC_ACQUIRE );
+		seq2 = __atomic_load_n( &(*bkt).seq, __ATOMIC_RELAXED );
+		if( seq1==seq2 ){
+			*seq = seq1;
+			if( found==0 )
+				return MEMCKEYNOTFOUND;
+			*msglen = (int) bmsglen;
+			*cas = bcas;
+			return MEMCSUCCESS;
+		}
+	}
+	return MEMCKEYNOTFOUND;
+}
+/*
+ * Updates only if nobody has written the bucket after the 'seq' was read. The value
+ * read from the servers is not written over a newer invalidation. */
+int  memc_shmcache_put( MEMC *cm, uchar *key, int keylen, uchar *msg, int msglen, unsigned long long int cas, uint seq ){
+	memc_shmcache_bucket *bkt = NULL;
+	uchar *data = NULL;
+	if( cm==NULL || (*cm).shmcache==NULL || key==NULL || msg==NULL ) return CBERRALLOC;
+	if( ( seq & 0x01 )!=0 || keylen<=0 || msglen<0 ) return CBSUCCESS;
+	if( keylen>(*(*cm).shmcache).max_key_length || msglen>(*(*cm).shmcache).max_value_length ) return CBSUCCESS; // not cached
+	bkt = memc_shmcache_bucket_at( &(*(*cm).shmcache), &(*key), keylen );
+	if( bkt==NULL ) return CBERRALLOC;
+	if( memc_shmcache_lock( &(*bkt) )==0 )
+		return CBSUCCESS; // being written by some other process
+	if( __atomic_load_n( &(*bkt).seq, __ATOMIC_RELAXED )!=seq ){
+		memc_shmcache_unlock( &(*bkt) );
+		return CBSUCCESS; // written by some other process
+	}
+	__atomic_store_n( &(*bkt).seq, seq+1, __ATOMIC_RELAXED );
+	__atomic_thread_fence( __ATOMIC_RELEASE );
+	data = (uchar*) bkt + sizeof( memc_shmcache_bucket );
+	(*bkt).keylen = (uint) keylen;
+	(*bkt).msglen = (uint) msglen;
+	(*bkt).cas = cas;
+	(*bkt).expires = memc_time_usec() + (*(*cm).shmcache).ttl;
+	memcpy( &(*data), key, (size_t) keylen );
+	memcpy( &data[ keylen ], msg, (size_t) msglen );
+	__atomic_store_n( &(*bkt).seq, seq+2, __ATOMIC_RELEASE );
+	memc_shmcache_unlock( &(*bkt) );
+	return CBSUCCESS;
+}
+/*
+ * Always advances the sequence number to fail the puts that started before. */
+int  memc_shmcache_invalidate( MEMC *cm, uchar *key, int keylen ){
+	int tries = 0;
+	uint seq = 0;
+	memc_shmcache_bucket *bkt = NULL;
+	if( cm==NULL || (*cm).shmcache==NULL || key==NULL ) return CBERRALLOC;
+	bkt = memc_shmcache_bucket_at( &(*(*cm).shmcache), &(*key), keylen );
+	if( bkt==NULL ) return CBERRALLOC;
+	for( tries=0; tries<MEMCSHMRETRIES; ++tries ){
+		if( memc_shmcache_lock( &(*bkt) )==1 ){
+			seq = __atomic_load_n( &(*bkt).seq, __ATOMIC_RELAXED );
+			__atomic_store_n( &(*bkt).seq, seq+1, __ATOMIC_RELAXED );
+			__atomic_thread_fence( __ATOMIC_RELEASE );
+			if( (*bkt).keylen==(uint) keylen && memcmp( (uchar*) bkt + sizeof( memc_shmcache_bucket ), key, (size_t) keylen )==0 ){
+				(*bkt).keylen = 0;
+				(*bkt).msglen = 0;
+				(*bkt).expires = 0;
+			}
+			__atomic_store_n( &(*bkt).seq, seq+2, __ATOMIC_RELEASE );
+			memc_shmcache_unlock( &(*bkt) );
+			return CBSUCCESS;
+		}
+		sched_yield();
+	}
+	/*
+	 * A writer of a living process did not finish, the entry expires with the TTL. */
+	MEMCLOG( CBLOGWARNING, CBNEGATION, "\nmemc_shmcache_invalidate: bucket was locked by %i, sequence %u.", \
+		__atomic_load_n( &(*bkt).owner, __ATOMIC_RELAXED ), __atomic_load_n( &(*bkt).seq, __ATOMIC_RELAXED ) );
+	return CBNEGATION;
+}
+/*
+ * Takes the bucket from a writer that has exited. Its sequence number may be odd and
+ * the value half written: the bucket is cleared and the sequence number made even. */
+int  memc_shmcache_lock( memc_shmcache_bucket *bkt ){
+	int owner = 0, pid = 0;
+	uint seq = 0;
+	if( bkt==NULL ) return 0;
+	pid = (int) getpid();
+	if( __atomic_compare_exchange_n( &(*bkt).owner, &owner, pid, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+		return 1;
+	if( owner==pid || kill( (pid_t) owner, 0 )==0 || errno!=ESRCH )
+		return 0; // an other thread of this process or a living process
+	if( ! __atomic_compare_exchange_n( &(*bkt).owner, &owner, pid, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+		return 0;
+	seq = __atomic_load_n( &(*bkt).seq, __ATOMIC_RELAXED );
+	if( ( seq & 0x01 )!=0 ){
+		(*bkt).keylen = 0;
+		(*bkt).msglen = 0;
+		(*bkt).expires = 0;
+		__atomic_store_n( &(*bkt).seq, seq+1, __ATOMIC_RELEASE );
+	}
+	MEMCLOG( CBLOGWARNING, CBNEGATION, "\nmemc_shmcache_lock: writer %i had exited, sequence %u, bucket cleared.", owner, seq );
+	return 1;
+}
+void  memc_shmcache_unlock( memc_shmcache_bucket *bkt ){
+	if( bkt!=NULL )
+		__atomic_store_n( &(*bkt).owner, 0, __ATOMIC_RELEASE );
+}
+
+/*
+ * Negative cache. */
+int  memc_negcache_create( MEMC *cm, int entries, int ttl_ms, int bloom_counters ){
+	int err = CBSUCCESS;
+	memc_negcache *ng = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( entries<=0 || ttl_ms<=0 || bloom_counters<0 ) return CBOVERFLOW;
+	if( (*cm).negcache!=NULL )
+		memc_negcache_free( &(*cm) );
+
+	ng = (memc_negcache*) calloc( 1, sizeof( memc_negcache ) );
+	if( ng==NULL ) return CBERRALLOC;
+	(*ng).entries = (memc_negcache_entry*) calloc( (size_t) entries, sizeof( memc_negcache_entry ) );
+	if( (*ng).entries==NULL ){ free( ng ); return CBERRALLOC; }
+	(*ng).size = entries;
+	(*ng).ttl = (unsigned long long int) ttl_ms * 1000;
+	if( bloom_counters>0 ){
+		(*ng).bloom[0] = (uchar*) calloc( (size_t) bloom_counters, sizeof( uchar ) );
+		(*ng).bloom[1] = (uchar*) calloc( (size_t) bloom_counters, sizeof( uchar ) );
+		if( (*ng).bloom[0]==NULL || (*ng).bloom[1]==NULL ){
+			if( (*ng).bloom[0]!=NULL ) free( (*ng).bloom[0] );
+			if( (*ng).bloom[1]!=NULL ) free( (*ng).bloom[1] );
+			free( (*ng).entries ); free( ng );
+			return CBERRALLOC;
+		}
+		(*ng).bloom_size = bloom_counters;
+		(*ng).bloom_epoch[0] = 1;
+		(*ng).bloom_epoch[1] = 1;
+		(*ng).bloom_rotated = memc_time_usec();
+	}
+	err = pthread_mutex_init( &(*ng).mtx, NULL );
+	if( err!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_negcache_create: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) );
+		if( (*ng).bloom[0]!=NULL ) free( (*ng).bloom[0] );
+		if( (*ng).bloom[1]!=NULL ) free( (*ng).bloom[1] );
+		free( (*ng).entries ); free( ng );
+		return MEMCERRTHREAD;
+	}
+	(*ng).mtx_created = 1;
+	(*cm).negcache = &(*ng);
+	return CBSUCCESS;
+}
+int  memc_negcache_free( MEMC *cm ){
+	memc_negcache *ng = NULL;
+	if( cm==NULL || (*cm).negcache==NULL ) return CBSUCCESS;
+	ng = &(*(*cm).negcache);
+	(*cm).negcache = NULL;
+	if( (*ng).bloom[0]!=NULL ) free( (*ng).bloom[0] );
+	if( (*ng).bloom[1]!=NULL ) free( (*ng).bloom[1] );
+	free( (*ng).entries );
+	if( (*ng).mtx_created!=0 ){
+		(*ng).mtx_created = 0;
+		pthread_mutex_destroy( &(*ng).mtx );
+	}
+	free( ng );
+	return CBSUCCESS;
+}
+/*
+ * The older generation is cleared and used as the current. */
+void  memc_negcache_rotate( memc_negcache *ng, unsigned long long int now ){
+	if( ng==NULL || (*ng).bloom_size<=0 ) return;
+	if( ( now - (*ng).bloom_rotated ) < (*ng).ttl ) return;
+	(*ng).bloom_current = ( (*ng).bloom_current + 1 ) % 2;
+	memset( (*ng).bloom[ (*ng).bloom_current ], 0x00, (size_t) (*ng).bloom_size );
+	++(*ng).bloom_epoch[ (*ng).bloom_current ];
+	(*ng).bloom_rotated = now;
+}
+/*
+ * MEMCSUCCESS if the key is known to be missing. 'generation' is given to memc_negcache_put. */
+int  memc_negcache_get( MEMC *cm, uchar *key, int keylen, unsigned long int *generation ){
+	int err = MEMCKEYNOTFOUND, gen = 0, indx = 0;
+	uint hash = 0, hash2 = 0;
+	unsigned long long int now = 0;
+	memc_negcache_entry *ent = NULL;
+	if( cm==NULL || (*cm).negcache==NULL || key==NULL || generation==NULL ) return CBERRALLOC;
+	if( keylen<=0 || keylen>MEMCNEGKEYMAX ) return MEMCKEYNOTFOUND;
+	hash = memc_hash_key( &(*key), keylen ) | 0x01; // 0 is empty
+	hash2 = ( ( hash>>16 ) | ( hash<<16 ) ) | 0x01;
+	now = memc_time_usec();
+	pthread_mutex_lock( &(*(*cm).negcache).mtx );
+	ent = &(*(*cm).negcache).entries[ hash % (uint) (*(*cm).negcache).size ];
+	*generation = (*ent).generation;
+	if( (*ent).hash==hash && (*ent).keylen==(uint) keylen && memcmp( &(*ent).key[0], key, (size_t) keylen )==0 ){
+		if( (*ent).expires>now )
+			err = MEMCSUCCESS;
+	}else if( (*(*cm).negcache).bloom_size>0 ){
+		memc_negcache_rotate( &(*(*cm).negcache), now );
+		for( gen=0; gen<2 && err!=MEMCSUCCESS; ++gen ){
+			for( indx=0; indx<MEMCNEGBLOOMHASHES; ++indx ){
+				if( (*(*cm).negcache).bloom[ gen ][ ( hash + (uint) indx * hash2 ) % (uint) (*(*cm).negcache).bloom_size ]==0 )
+					break;
+			}
+			if( indx==MEMCNEGBLOOMHASHES )
+				err = MEMCSUCCESS;
+		}
+	}
+	if( err==MEMCSUCCESS )
+		++(*(*cm).negcache).hits;
+	pthread_mutex_unlock( &(*(*cm).negcache).mtx );
+	return err;
+}
+/*
+ * Not stored if the key was written after memc_negcache_get returned 'generation'. */
+int  memc_negcache_put( MEMC *cm, uchar *key, int keylen, unsigned long int generation ){
+	int indx = 0, cur = 0;
+	uint hash = 0, hash2 = 0, bit = 0;
+	unsigned long long int now = 0;
+	memc_negcache_entry *ent = NULL;
+	memc_negcache *ng = NULL;
+	if( cm==NULL || (*cm).negcache==NULL || key==NULL ) return CBERRALLOC;
+	if( keylen<=0 || keylen>MEMCNEGKEYMAX ) return CBSUCCESS; // not cached
+	hash = memc_hash_key( &(*key), keylen ) | 0x01;
+	hash2 = ( ( hash>>16 ) | ( hash<<16 ) ) | 0x01;
+	now = memc_time_usec();
+	ng = &(*(*cm).negcache);
+	pthread_mutex_lock( &(*ng).mtx );
+	ent = &(*ng).entries[ hash % (uint) (*ng).size ];
+	if( (*ent).generation!=generation ){
+		pthread_mutex_unlock( &(*ng).mtx );
+		return CBSUCCESS; // written during the GET
+	}
+	if( (*ent).hash!=hash || (*ent).keylen!=(uint) keylen || memcmp( &(*ent).key[0], key, (size_t) keylen )!=0 ){
+		(*ent).hash = hash; // the previous key stays in the Bloom filter without the table
+		(*ent).keylen = (uint) keylen;
+		memcpy( &(*ent).key[0], key, (size_t) keylen );
+		(*ent).inserted[0] = 0;
+		(*ent).inserted[1] = 0;
+	}
+	(*ent).expires = now + (*ng).ttl;
+	if( (*ng).bloom_size>0 ){
+		memc_negcache_rotate( &(*ng), now );
+		cur = (*ng).bloom_current;
+		if( (*ent).inserted[ cur ]!=(*ng).bloom_epoch[ cur ] ){ // once in a generation
+			for( indx=0; indx<MEMCNEGBLOOMHASHES; ++indx ){
+				bit = ( hash + (uint) indx * hash2 ) % (uint) (*ng).bloom_size;
+				if( (*ng).bloom[ cur ][ bit ]<0xFF ) // saturates
+					++(*ng).bloom[ cur ][ bit ];
+			}
+			(*ent).inserted[ cur ] = (*ng).bloom_epoch[ cur ];
+		}
+	}
+	pthread_mutex_unlock( &(*ng).mtx );
+	return CBSUCCESS;
+}
+/*
+ * The counters of a key added to the generation are decremented. */
+void  memc_negcache_bloom_remove( memc_negcache *ng, int gen, uint hash, uint hash2 ){
+	int indx = 0;
+	uint bit = 0;
+	if( ng==NULL || (*ng).bloom_size<=0 ) return;
+	for( indx=0; indx<MEMCNEGBLOOMHASHES; ++indx ){
+		bit = ( hash + (uint) indx * hash2 ) % (uint) (*ng).bloom_size;
+		if( (*ng).bloom[ gen ][ bit ]>0 && (*ng).bloom[ gen ][ bit ]<0xFF ) // a saturated counter stays
+			--(*ng).bloom[ gen ][ bit ];
+	}
+}
+int  memc_negcache_invalidate( MEMC *cm, uchar *key, int keylen ){
+	int gen = 0, indx = 0;
+	uint hash = 0, hash2 = 0;
+	memc_negcache_entry *ent = NULL;
+	memc_negcache *ng = NULL;
+	if( cm==NULL || (*cm).negcache==NULL || key==NULL ) return CBERRALLOC;
+	if( keylen<=0 ) return CBSUCCESS;
+	hash = memc_hash_key( &(*key), keylen ) | 0x01;
+	hash2 = ( ( hash>>16 ) | ( hash<<16 ) ) | 0x01;
+	ng = &(*(*cm).negcache);
+	pthread_mutex_lock( &(*ng).mtx );
+	ent = &(*ng).entries[ hash % (uint) (*ng).size ];
+	++(*ent).generation;
+	if( (*ent).hash==hash && (*ent).keylen==(uint) keylen && memcmp( &(*ent).key[0], key, (size_t) keylen )==0 ){
+		for( gen=0; gen<2 && (*ng).bloom_size>0; ++gen ){
+			if( (*ent).inserted[ gen ]==(*ng).bloom_epoch[ gen ] )
+				memc_negcache_bloom_remove( &(*ng), gen, hash, hash2 );
+		}
+		(*ent).hash = 0;
+		(*ent).keylen = 0;
+		(*ent).expires = 0;
+		(*ent).inserted[0] = 0;
+		(*ent).inserted[1] = 0;
+	}
+	for( gen=0; gen<2 && (*ng).bloom_size>0; ++gen ){
+		/*
+		 * If the key still matches, it was added without the table (the entry was
+		 * replaced) or it is a false positive. The counters of the key can not be
+		 * decremented without a false negative of an other key: the generation is
+		 * cleared. */
+		for( indx=0; indx<MEMCNEGBLOOMHASHES; ++indx ){
+			if( (*ng).bloom[ gen ][ ( hash + (uint) indx * hash2 ) % (uint) (*ng).bloom_size ]==0 )
+				break;
+		}
+		if( indx<MEMCNEGBLOOMHASHES )
+			continue;
+		memset( (*ng).bloom[ gen ], 0x00, (size_t) (*ng).bloom_size );
+		++(*ng).bloom_epoch[ gen ];
+	}
+	pthread_mutex_unlock( &(*ng).mtx );
+	return CBSUCCESS;
+}
+
+/*
+ * Coalescing of the concurrent GETs of the same key. */
+int  memc_singleflight( MEMC *cm, char on ){
+	int err = CBSUCCESS, indx = 0;
+	memc_flight *ptr = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( on!=0 && (*cm).flight_created==0 ){
+		err = pthread_mutex_init( &(*cm).flight, NULL );
+		if( err!=0 ){
+			MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_singleflight: pthread_mutex_init, error %i errno %i '%s'.", err, errno, strerror( errno ) );
+			return MEMCERRTHREAD;
+		}
+		(*cm).flights = NULL;
+		(*cm).flight_pool = NULL;
+		(*cm).flight_mallocs = 0;
+		for( indx=0; indx<MEMCFLIGHTPOOLSIZE; ++indx ){
+			ptr = (memc_flight*) malloc( sizeof( memc_flight ) );
+			if( ptr==NULL ) break;
+			if( pthread_cond_init( &(*ptr).cond, NULL )!=0 ){
+				free( ptr );
+				break;
+			}
+			(*ptr).pooled = 1;
+			(*ptr).msg = NULL;
+			(*ptr).msgbufsize = 0;
+			(*ptr).next = (*cm).flight_pool;
+			(*cm).flight_pool = &(*ptr);
+			ptr = NULL;
+		}
+		(*cm).flight_created = 1;
+	}else if( on==0 && (*cm).flight_created!=0 ){
+		if( (*cm).flights!=NULL ) return CBNEGATION; // reads in progress
+		(*cm).flight_created = 0;
+		while( (*cm).flight_pool!=NULL ){
+			ptr = &(*(*cm).flight_pool);
+			(*cm).flight_pool = (*ptr).next;
+			if( (*ptr).msg!=NULL ) free( (*ptr).msg );
+			pthread_cond_destroy( &(*ptr).cond );
+			free( ptr );
+		}
+		pthread_mutex_destroy( &(*cm).flight );
+	}
+	return CBSUCCESS;
+}
+/*
+ * A flight of the free list keeps its condition and the buffer of the copy. The
+ * keys longer than MEMCPOOLKEYLEN and an empty free list are allocated and counted. */
+memc_flight*  memc_flight_get( MEMC *cm, int keylen ){
+	memc_flight *ptr = NULL;
+	if( cm==NULL || keylen<0 ) return NULL;
+	if( (*cm).flight_pool!=NULL && keylen<=MEMCPOOLKEYLEN ){
+		ptr = &(*(*cm).flight_pool);
+		(*cm).flight_pool = (*ptr).next;
+		(*ptr).key = &(*ptr).keybuf[0];
+		return ptr;
+	}
+	++(*cm).flight_mallocs;
+	ptr = (memc_flight*) malloc( sizeof( memc_flight ) + (size_t) keylen );
+	if( ptr==NULL ) return NULL;
+	if( pthread_cond_init( &(*ptr).cond, NULL )!=0 ){
+		free( ptr );
+		return NULL;
+	}
+	(*ptr).pooled = 0;
+	(*ptr).msg = NULL;
+	(*ptr).msgbufsize = 0;
+	(*ptr).key = (uchar*) ptr + sizeof( memc_flight );
+	return ptr;
+}
+void  memc_flight_put( MEMC *cm, memc_flight *flight ){
+	if( cm==NULL || flight==NULL ) return;
+	if( (*flight).pooled==1 ){
+		(*flight).next = (*cm).flight_pool;
+		(*cm).flight_pool = &(*flight);
+		return;
+	}
+	if( (*flight).msg!=NULL ) free( (*flight).msg );
+	pthread_cond_destroy( &(*flight).cond );
+	free( flight );
+}
+/*
+ * Returns the flight in 'flight' if the caller has to read the value and call memc_flight_finish.
+ * Otherwise waits for the first reader, copies the result and sets 'waited'. If both are not set,
+ * the value is read without coalescing. */
+int  memc_flight_join( MEMC *cm, uchar *key, int keylen, uchar *msg, int *msglen, int msgbuflen, unsigned long long int *cas, memc_flight **flight, char *waited ){
+	int err = CBSUCCESS;
+	memc_flight *ptr = NULL;
+	if( cm==NULL || key==NULL || msg==NULL || msglen==NULL || cas==NULL || flight==NULL || waited==NULL ) return CBERRALLOC;
+	*flight = NULL;
+	*waited = 0;
+	pthread_mutex_lock( &(*cm).flight );
+	for( ptr=(*cm).flights; ptr!=NULL; ptr=(*ptr).next ){
+		if( (*ptr).keylen==(uint) keylen && memcmp( (*ptr).key, key, (size_t) keylen )==0 )
+			break;
+	}
+	if( ptr==NULL ){
+		/*
+		 * Leader. */
+		ptr = memc_flight_get( &(*cm), keylen );
+		if( ptr==NULL ){
+			pthread_mutex_unlock( &(*cm).flight );
+			return CBERRALLOC;
+		}
+		memcpy( (*ptr).key, key, (size_t) keylen );
+		(*ptr).keylen = (uint) keylen;
+		(*ptr).msglen = 0;
+		(*ptr).cas = 0;
+		(*ptr).err = CBSUCCESS;
+		(*ptr).waiters = 0;
+		(*ptr).done = 0;
+		(*ptr).copied = 0;
+		(*ptr).next = (*cm).flights;
+		(*cm).flights = &(*ptr);
+		*flight = &(*ptr);
+		pthread_mutex_unlock( &(*cm).flight );
+		return CBSUCCESS;
+	}
+
+	/*
+	 * Waiter. */
+	*waited = 1;
+	++(*ptr).waiters;
+	while( (*ptr).done==0 )
+		pthread_cond_wait( &(*ptr).cond, &(*cm).flight );
+	err = (*ptr).err;
+	if( err==CBOVERFLOW || err==MEMCRECVKEYERR || err==CBERRALLOC ){
+		/*
+		 * The buffer (MEMCRECVKEYERR from memc_recv) or the copy of the first reader, read
+		 * with the own buffer. */
+		*waited = 0;
+		err = CBSUCCESS;
+	}else if( err==MEMCSUCCESS ){
+		if( (*ptr).copied==0 || (int) (*ptr).msglen>=msgbuflen ){
+			err = CBOVERFLOW;
+		}else{
+			memcpy( &(*msg), (*ptr).msg, (size_t) (*ptr).msglen );
+			*msglen = (int) (*ptr).msglen;
+			*cas = (*ptr).cas;
+		}
+	}
+	--(*ptr).waiters;
+	if( (*ptr).waiters==0 ) // last, already removed from the list
+		memc_flight_put( &(*cm), &(*ptr) );
+	pthread_mutex_unlock( &(*cm).flight );
+	return err;
+}
+int  memc_flight_finish( MEMC *cm, memc_flight *flight, int err, uchar *msg, int msglen, unsigned long long int cas ){
+	memc_flight **prev = NULL;
+	if( cm==NULL || flight==NULL ) return CBERRALLOC;
+	pthread_mutex_lock( &(*cm).flight );
+	for( prev=&(*cm).flights; *prev!=NULL; prev=&(**prev).next ){
+		if( *prev==flight ){
+			*prev = (*flight).next;
+			break;
+		}
+	}
+	if( (*flight).waiters==0 ){
+		memc_flight_put( &(*cm), &(*flight) );
+		pthread_mutex_unlock( &(*cm).flight );
+		return CBSUCCESS;
+	}
+	(*flight).err = err;
+	if( err==MEMCSUCCESS && msg!=NULL && msglen>=0 ){
+		if( (*flight).msg==NULL || (*flight).msgbufsize<(uint) msglen + 1 ){
+			/*
+			 * The buffer of a pooled flight grows to the longest value copied. */
+			if( (*flight).msg!=NULL ) free( (*flight).msg );
+			++(*cm).flight_mallocs;
+			(*flight).msg = (uchar*) malloc( (size_t) msglen + 1 );
+			(*flight).msgbufsize = ( (*flight).msg!=NULL ) ? (uint) msglen + 1 : 0;
+		}
+		if( (*flight).msg==NULL ){
+			(*flight).err = CBERRALLOC;
+		}else{
+			memcpy( (*flight).msg, msg, (size_t) msglen );
+			(*flight).msglen = (uint) msglen;
+			(*flight).cas = cas;
+			(*flight).copied = 1;
+		}
+	}
+	(*flight).done = 1;
+	pthread_cond_broadcast( &(*flight).cond );
+	pthread_mutex_unlock( &(*cm).flight );
+	return CBSUCCESS;
+}
+/*
+ * A read of the key in progress may have started before the write. It is removed from
+ * the list, the readers already waiting get its result and the next ones read again. */
+void  memc_flight_invalidate( MEMC *cm, uchar *key, int keylen ){
+	memc_flight **prev = NULL;
+	if( cm==NULL || key==NULL || keylen<=0 || (*cm).flight_created==0 ) return;
+	pthread_mutex_lock( &(*cm).flight );
+	for( prev=&(*cm).flights; *prev!=NULL; prev=&(**prev).next ){
+		if( (**prev).keylen==(uint) keylen && memcmp( (**prev).key, key, (size_t) keylen )==0 ){
+			*prev = (**prev).next; // memc_flight_finish of the first reader frees it
+			break;
+		}
+	}
+	pthread_mutex_unlock( &(*cm).flight );
+}
+
+/*
+ * The server the connection is connected to. The failover may have connected
+ * another server than memc_server_index, 19.10.2026. */
+int  memc_conn_server( MEMC *cm, int cindx ){
+	int dbsindx = -1;
+	if( cm==NULL || (*cm).token==NULL || (*(*cm).token).conn==NULL ) return -1;
+	if( cindx<0 || cindx>=(*cm).redundant_servers_count || cindx>=MEMCMAXREDUNDANTDBS ) return -1;
+	if( (*(*cm).token).conn[ cindx ]!=NULL )
+		dbsindx = __atomic_load_n( &(*(*(*cm).token).conn[ cindx ]).dbsindx, __ATOMIC_RELAXED );
+	if( dbsindx<0 )
+		return memc_server_index( &(*cm), cindx ); // not connected yet
+	return dbsindx;
+}
+/*
+ * Statistics, 19.10.2026. The threads are given the shards in turn and add to them
+ * with relaxed atomics. The counters of a server are allocated at its first request. */
+memc_stats_server* memc_stats_cell( MEMC *cm, int cindx ){
+	int dbsindx = 0;
+	memc_stats_server *cell = NULL, *ptr = NULL;
+	if( cm==NULL || (*cm).stats==NULL ) return NULL;
+	dbsindx = memc_conn_server( &(*cm), cindx );
+	if( dbsindx<0 || dbsindx>=MEMCMAXSESSIONDBS ) return NULL;
+	if( memc_stats_thread_shard<0 )
+		memc_stats_thread_shard = (int) ( __atomic_fetch_add( &memc_stats_shards_given, 1, __ATOMIC_RELAXED ) % MEMCSTATSSHARDS );
+	cell = __atomic_load_n( &(*(*cm).stats).shard[ memc_stats_thread_shard ].server[ dbsindx ], __ATOMIC_ACQUIRE );
+	if( cell!=NULL ) return cell;
+	ptr = (memc_stats_server*) calloc( 1, sizeof( memc_stats_server ) );
+	if( ptr==NULL ) return NULL;
+	if( __atomic_compare_exchange_n( &(*(*cm).stats).shard[ memc_stats_thread_shard ].server[ dbsindx ], &cell, ptr, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+		return ptr;
+	free( ptr ); // an other thread of the shard was first
+	return cell;
+}
+int  memc_stats_bucket( unsigned long long int usec ){
+	int bits = 0;
+	if( usec<( 1ULL << MEMCSTATSSUBBITS ) ) return (int) usec;
+	bits = 63 - __builtin_clzll( usec );
+	if( bits>MEMCSTATSMAXBITS ) return MEMCSTATSBUCKETS - 1;
+	return ( ( bits - MEMCSTATSSUBBITS + 1 ) << MEMCSTATSSUBBITS ) + (int) ( ( usec >> ( bits - MEMCSTATSSUBBITS ) ) & ( ( 1ULL << MEMCSTATSSUBBITS ) - 1 ) );
+}
+unsigned long long int  memc_stats_begin( MEMC *cm, int cindx ){
+	unsigned long long int now = 0;
+	memc_stats_server *cell = NULL;
+	memc_io_errno = 0; // of this request
+	cell = memc_stats_cell( &(*cm), cindx );
+	if( cell==NULL ) return 0;
+	__atomic_add_fetch( &(*cell).inflight, 1, __ATOMIC_RELAXED );
+	now = memc_time_usec();
+	return ( now==0 ) ? 1 : now; // 0 is not sent
+}
+/*
+ * 'start' 0 if the request was not sent. */
+void  memc_stats_end( MEMC *cm, int cindx, int op, unsigned long long int start, int err, ushort status, unsigned long int out, unsigned long int in ){
+	unsigned long int usec = 0, max = 0;
+	memc_stats_server *cell = memc_stats_cell( &(*cm), cindx );
+	if( cell==NULL || op<0 || op>=MEMCSTATSOPS ) return;
+	if( start!=0 ){
+		usec = (unsigned long int) ( memc_time_usec() - start );
+		__atomic_sub_fetch( &(*cell).inflight, 1, __ATOMIC_RELAXED );
+		__atomic_add_fetch( &(*cell).op[ op ].count, 1, __ATOMIC_RELAXED );
+		__atomic_add_fetch( &(*cell).op[ op ].sum, usec, __ATOMIC_RELAXED );
+		__atomic_add_fetch( &(*cell).op[ op ].buckets[ memc_stats_bucket( usec ) ], 1, __ATOMIC_RELAXED );
+		max = __atomic_load_n( &(*cell).op[ op ].max, __ATOMIC_RELAXED );
+		while( usec>max && ! __atomic_compare_exchange_n( &(*cell).op[ op ].max, &max, usec, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+			;
+	}
+	MEMCPROBE5( done, op, cindx, err, status, usec ); // 19.10.2026
+	if( out>0 ) __atomic_add_fetch( &(*cell).bytes_out, out, __ATOMIC_RELAXED );
+	if( in>0 ) __atomic_add_fetch( &(*cell).bytes_in, in, __ATOMIC_RELAXED );
+	if( status==MEMCKEYNOTFOUND || err==MEMCKEYNOTFOUND || err==MEMCRECVKEYNOTFOUND ){
+		__atomic_add_fetch( &(*cell).misses, 1, __ATOMIC_RELAXED );
+	}else if( err>=CBNEGATION || ( status!=MEMCSUCCESS && status!=MEMCKEYEXISTS && status!=MEMCITEMNOTSTORED ) ){
+		__atomic_add_fetch( &(*cell).errors, 1, __ATOMIC_RELAXED );
+		if( err>=CBNEGATION && ( memc_io_errno==EAGAIN || memc_io_errno==EWOULDBLOCK || memc_io_errno==ETIMEDOUT ) )
+			__atomic_add_fetch( &(*cell).timeouts, 1, __ATOMIC_RELAXED );
+	}else if( status==MEMCSUCCESS && op==MEMCSTATSGET ){
+		__atomic_add_fetch( &(*cell).hits, 1, __ATOMIC_RELAXED );
+	}
+}
+void  memc_stats_event( MEMC *cm, int cindx, int event ){
+	memc_stats_server *cell = memc_stats_cell( &(*cm), cindx );
+	if( cell==NULL ) return;
+	if( event==MEMCSTATSRETRY )
+		__atomic_add_fetch( &(*cell).retries, 1, __ATOMIC_RELAXED );
+	else if( event==MEMCSTATSRECONNECT )
+		__atomic_add_fetch( &(*cell).reconnects, 1, __ATOMIC_RELAXED );
+}
+int  memc_stats_snapshot( MEMC *cm, int dbsindx, memc_stats_server *snap ){
+	int shard = 0, srv = 0, op = 0, bkt = 0;
+	unsigned long int max = 0;
+	memc_stats_server *cell = NULL;
+	if( cm==NULL || snap==NULL ) return CBERRALLOC;
+	if( (*cm).stats==NULL ) return MEMCUNINITIALIZED;
+	if( dbsindx<-1 || dbsindx>=MEMCMAXSESSIONDBS ) return CBINDEXOUTOFBOUNDS;
+	memset( &(*snap), 0x00, sizeof( memc_stats_server ) );
+	for( shard=0; shard<MEMCSTATSSHARDS; ++shard ){
+		for( srv=( dbsindx<0 ) ? 0 : dbsindx; srv<MEMCMAXSESSIONDBS && ( dbsindx<0 || srv==dbsindx ); ++srv ){
+			cell = __atomic_load_n( &(*(*cm).stats).shard[ shard ].server[ srv ], __ATOMIC_ACQUIRE );
+			if( cell==NULL ) continue;
+			for( op=0; op<MEMCSTATSOPS; ++op ){
+				(*snap).op[ op ].count += __atomic_load_n( &(*cell).op[ op ].count, __ATOMIC_RELAXED );
+				(*snap).op[ op ].sum += __atomic_load_n( &(*cell).op[ op ].sum, __ATOMIC_RELAXED );
+				max = __atomic_load_n( &(*cell).op[ op ].max, __ATOMIC_RELAXED );
+				if( max>(*snap).op[ op ].max )
+					(*snap).op[ op ].max = max;
+				for( bkt=0; bkt<MEMCSTATSBUCKETS; ++bkt )
+					(*snap).op[ op ].buckets[ bkt ] += __atomic_load_n( &(*cell).op[ op ].buckets[ bkt ], __ATOMIC_RELAXED );
+			}
+			(*snap).hits += __atomic_load_n( &(*cell).hits, __ATOMIC_RELAXED );
+			(*snap).misses += __atomic_load_n( &(*cell).misses, __ATOMIC_RELAXED );
+			(*snap).errors += __atomic_load_n( &(*cell).errors, __ATOMIC_RELAXED );
+			(*snap).timeouts += __atomic_load_n( &(*cell).timeouts, __ATOMIC_RELAXED );
+			(*snap).retries += __atomic_load_n( &(*cell).retries, __ATOMIC_RELAXED );
+			(*snap).reconnects += __atomic_load_n( &(*cell).reconnects, __ATOMIC_RELAXED );
+			(*snap).bytes_in += __atomic_load_n( &(*cell).bytes_in, __ATOMIC_RELAXED );
+			(*snap).bytes_out += __atomic_load_n( &(*cell).bytes_out, __ATOMIC_RELAXED );
+			(*snap).inflight += __atomic_load_n( &(*cell).inflight, __ATOMIC_RELAXED );
+		}
+	}
+	if( (*snap).inflight<0 )
+		(*snap).inflight = 0; // read while an other shard was updated
+	return CBSUCCESS;
+}
+unsigned long int  memc_stats_percentile( memc_stats_op *op, double pct ){
+	int bkt = 0, group = 0, bits = 0;
+	unsigned long int target = 0, seen = 0, upper = 0;
+	if( op==NULL || (*op).count==0 ) return 0;
+	if( pct<0.0 ) pct = 0.0;
+	if( pct>100.0 ) pct = 100.0;
+	target = (unsigned long int) ( ( (double) (*op).count * pct ) / 100.0 + 0.999999 );
+	if( target==0 ) target = 1;
+	for( bkt=0; bkt<MEMCSTATSBUCKETS; ++bkt ){
+		seen += (*op).buckets[ bkt ];
+		if( seen>=target ) break;
+	}
+	if( bkt>=MEMCSTATSBUCKETS ) return (*op).max;
+	group = bkt >> MEMCSTATSSUBBITS;
+	if( group==0 ){
+		upper = (unsigned long int) bkt;
+	}else{
+		bits = group + MEMCSTATSSUBBITS - 1;
+		upper = ( 1UL << bits ) + ( (unsigned long int) ( bkt & ( ( 1 << MEMCSTATSSUBBITS ) - 1 ) ) << ( bits - MEMCSTATSSUBBITS ) );
+		upper += ( 1UL << ( bits - MEMCSTATSSUBBITS ) ) - 1;
+	}
+	return ( upper>(*op).max ) ? (*op).max : upper;
+}
+
+/*
+ * Tracing, 19.10.2026. */
+int  memc_set_trace_hook( MEMC *cm, memc_trace_hook hook, void *arg ){
+	if( cm==NULL ) return CBERRALLOC;
+	(*cm).trace_arg = arg;
+	__atomic_store_n( &(*cm).trace_hook, hook, __ATOMIC_RELEASE );
+	return CBSUCCESS;
+}
+void  memc_trace( MEMC *cm, MEMC_parameter *pm, int phase, int opcode, int err ){
+	struct timespec ts;
+	memc_trace_event ev;
+	memc_trace_hook hook = NULL;
+	if( cm==NULL || pm==NULL ) return;
+	hook = __atomic_load_n( &(*cm).trace_hook, __ATOMIC_ACQUIRE );
+	if( hook==NULL && (*cm).slowlog==NULL ) return;
+	if( clock_gettime( CLOCK_MONOTONIC, &ts )!=0 ) return;
+	ev.timestamp = ( (unsigned long long int) ts.tv_sec * 1000000000 ) + (unsigned long long int) ts.tv_nsec;
+	if( phase>=0 && phase<MEMCTRACEPHASES )
+		(*pm).trace_ts[ phase ] = ev.timestamp; // slow log
+	if( hook==NULL ) return;
+	ev.id = (*pm).trace_id;
+	ev.phase = phase;
+	ev.opcode = opcode;
+	ev.cindx = (*pm).cindx;
+	ev.dbsindx = memc_conn_server( &(*cm), (*pm).cindx );
+	ev.err = err;
+	hook( (*cm).trace_arg, &ev );
+}
+void  memc_trace_first_byte( MEMC_parameter *pm, int opcode ){
+	uchar byte = 0;
+	if( pm==NULL || (*pm).cm==NULL || (*(*pm).cm).trace_hook==NULL || (*(*pm).cm).token==NULL ) return;
+	if( recv( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &byte, 1, MSG_PEEK )==1 )
+		memc_trace( &(*(*pm).cm), &(*pm), MEMCTRACEFIRSTBYTE, opcode, CBSUCCESS );
+}
+memc_trace_fanout*  memc_trace_fanout_start( MEMC *cm, int opcode, uint *id, uchar *key, int keylen, uint msglen ){
+	int len = 0;
+	memc_trace_fanout *fo = NULL;
+	if( cm==NULL || id==NULL ) return NULL;
+	*id = 0;
+	if( (*cm).trace_hook==NULL && (*cm).recorder==NULL ) return NULL;
+	if( (*cm).trace_hook!=NULL )
+		*id = __atomic_add_fetch( &(*cm).trace_ids, 1, __ATOMIC_RELAXED );
+	if( (*cm).recorder!=NULL && key!=NULL && keylen>0 && keylen<=65535 )
+		len = keylen;
+	if( (*cm).param_created!=0 ){
+		pthread_mutex_lock( &(*cm).param );
+		if( (*cm).fanout_pool!=NULL && len<=MEMCPOOLKEYLEN ){
+			fo = &(*(*cm).fanout_pool);
+			(*cm).fanout_pool = (*fo).next;
+		}else{
+			++(*cm).fanout_mallocs;
+		}
+		pthread_mutex_unlock( &(*cm).param );
+	}
+	if( fo==NULL ){
+		fo = (memc_trace_fanout*) malloc( sizeof( memc_trace_fanout ) + (size_t) len );
+		if( fo==NULL ) return NULL;
+		(*fo).pooled = 0;
+	}
+	(*fo).next = NULL;
+	(*fo).pending = 1; // the caller
+	(*fo).opcode = opcode;
+	(*fo).id = *id;
+	(*fo).err = CBSUCCESS;
+	(*fo).start = ( (*cm).recorder!=NULL ) ? memc_time_usec() : 0; // 19.10.2026
+	(*fo).key = NULL;
+	(*fo).keylen = len;
+	(*fo).msglen = msglen;
+	if( len>0 ){
+		(*fo).key = ( (*fo).pooled==1 ) ? &(*fo).keybuf[0] : (uchar*) &fo[1];
+		memcpy( &(*fo).key[0], &(*key), (size_t) len );
+	}
+	return fo;
+}
+void  memc_trace_fanout_done( MEMC *cm, memc_trace_fanout *fo, int err ){
+	MEMC_parameter pm;
+	if( fo==NULL ) return;
+	if( err!=CBSUCCESS )
+		__atomic_store_n( &(*fo).err, err, __ATOMIC_RELAXED );
+	if( __atomic_sub_fetch( &(*fo).pending, 1, __ATOMIC_ACQ_REL )>0 )
+		return;
+	if( cm!=NULL ){
+		pm.trace_id = (*fo).id;
+		pm.cindx = -1;
+		memc_trace( &(*cm), &pm, MEMCTRACEFANOUT, (*fo).opcode, __atomic_load_n( &(*fo).err, __ATOMIC_RELAXED ) );
+		/*
+		 * The latency of the capture ends at the last responce. */
+		if( (*fo).start!=0 )
+			memc_record_put( &(*cm), (*fo).opcode, (*fo).key, (*fo).keylen, (*fo).msglen, (*fo).start, __atomic_load_n( &(*fo).err, __ATOMIC_RELAXED ) );
+		if( (*fo).pooled==1 && (*cm).param_created!=0 ){
+			pthread_mutex_lock( &(*cm).param );
+			(*fo).next = (*cm).fanout_pool;
+			(*cm).fanout_pool = &(*fo);
+			pthread_mutex_unlock( &(*cm).param );
+			return;
+		}
+	}
+	free( fo );
+}
+
+/*
+ * Slow requests, 19.10.2026. */
+int  memc_slowlog_create( MEMC *cm, int entries, int threshold_us ){
+	uint size = 1;
+	memc_slowlog *sl = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( entries<=0 || threshold_us<0 ) return CBINDEXOUTOFBOUNDS;
+	if( (*cm).slowlog!=NULL ) memc_slowlog_free( &(*cm) );
+	while( size<(uint) entries && size<( 1U << 20 ) ) size <<= 1;
+	sl = (memc_slowlog*) malloc( sizeof( memc_slowlog ) );
+	if( sl==NULL ) return CBERRALLOC;
+	(*sl).entries = (memc_slowlog_entry*) calloc( size, sizeof( memc_slowlog_entry ) );
+	if( (*sl).entries==NULL ){ free( sl ); return CBERRALLOC; }
+	(*sl).size = size;
+	(*sl).next = 0;
+	(*sl).threshold = (unsigned long long int) threshold_us * 1000;
+	(*sl).recorded = 0;
+	(*sl).dropped = 0;
+	__atomic_store_n( &(*cm).slowlog, sl, __ATOMIC_RELEASE );
+	return CBSUCCESS;
+}
+/*
+ * The users count themselves before loading the pointer. After the exchange, a
+ * user either has seen NULL or is counted and is waited here. */
+int  memc_slowlog_free( MEMC *cm ){
+	memc_slowlog *sl = NULL;
+	if( cm==NULL || (*cm).slowlog==NULL ) return CBSUCCESS;
+	sl = __atomic_exchange_n( &(*cm).slowlog, NULL, __ATOMIC_SEQ_CST );
+	if( sl==NULL ) return CBSUCCESS; // an other thread freed it
+	while( __atomic_load_n( &(*cm).slowlog_users, __ATOMIC_SEQ_CST )>0 )
+		sched_yield();
+	free( (*sl).entries );
+	free( sl );
+	return CBSUCCESS;
+}
+void  memc_slowlog_put( MEMC_parameter *pm, int opcode, int status, int keylen, uint msglen ){
+	int phase = 0;
+	uint seq = 0, slot = 0;
+	unsigned long long int now = 0, start = 0;
+	struct timespec ts;
+	memc_slowlog *sl = NULL;
+	memc_slowlog_entry *ent = NULL;
+	if( pm==NULL || (*pm).cm==NULL ) return;
+	start = (*pm).trace_ts[ MEMCTRACEROUTE ];
+	if( start==0 ) return;
+	__atomic_add_fetch( &(*(*pm).cm).slowlog_users, 1, __ATOMIC_SEQ_CST );
+	sl = __atomic_load_n( &(*(*pm).cm).slowlog, __ATOMIC_SEQ_CST );
+	if( sl==NULL || clock_gettime( CLOCK_MONOTONIC, &ts )!=0 ){
+		__atomic_sub_fetch( &(*(*pm).cm).slowlog_users, 1, __ATOMIC_RELEASE );
+		return;
+	}
+	now = ( (unsigned long long int) ts.tv_sec * 1000000000 ) + (unsigned long long int) ts.tv_nsec;
+	if( now<start || now - start < (*sl).threshold ){
+		__atomic_sub_fetch( &(*(*pm).cm).slowlog_users, 1, __ATOMIC_RELEASE );
+		return;
+	}
+
+	slot = __atomic_fetch_add( &(*sl).next, 1, __ATOMIC_RELAXED ) & ( (*sl).size - 1 );
+	ent = &(*sl).entries[ slot ];
+	seq = __atomic_load_n( &(*ent).seq, __ATOMIC_ACQUIRE );
+	if( ( seq & 1 )!=0 || ! __atomic_compare_exchange_n( &(*ent).seq, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) ){
+		__atomic_add_fetch( &(*sl).dropped, 1, __ATOMIC_RELAXED );
+		__atomic_sub_fetch( &(*(*pm).cm).slowlog_users, 1, __ATOMIC_RELEASE );
+		return;
+	}
+	(*ent).keyhash = ( (*pm).key!=NULL && keylen>0 ) ? memc_hash_key( &(*(*pm).key), keylen ) : 0;
+	(*ent).timestamp = start;
+	(*ent).total = now - start;
+	for( phase=0; phase<MEMCTRACEPHASES; ++phase )
+		(*ent).phase[ phase ] = ( (*pm).trace_ts[ phase ]>=start ) ? (*pm).trace_ts[ phase ] - start : 0;
+	(*ent).msglen = msglen;
+	(*ent).opcode = opcode;
+	(*ent).cindx = (*pm).cindx;
+	(*ent).dbsindx = memc_conn_server( &(*(*pm).cm), (*pm).cindx );
+	(*ent).status = status;
+	__atomic_store_n( &(*ent).seq, seq + 2, __ATOMIC_RELEASE );
+	__atomic_add_fetch( &(*sl).recorded, 1, __ATOMIC_RELAXED );
+	__atomic_sub_fetch( &(*(*pm).cm).slowlog_users, 1, __ATOMIC_RELEASE );
+}
+int  memc_slowlog_dump( MEMC *cm, memc_slowlog_entry *entries, int max, int *count ){
+	uint indx = 0, seq = 0;
+	int cnt = 0, pos = 0;
+	memc_slowlog *sl = NULL;
+	memc_slowlog_entry ent;
+	if( cm==NULL || entries==NULL || count==NULL ) return CBERRALLOC;
+	*count = 0;
+	__atomic_add_fetch( &(*cm).slowlog_users, 1, __ATOMIC_SEQ_CST );
+	sl = __atomic_load_n( &(*cm).slowlog, __ATOMIC_SEQ_CST );
+	if( sl==NULL ){
+		__atomic_sub_fetch( &(*cm).slowlog_users, 1, __ATOMIC_RELEASE );
+		return MEMCUNINITIALIZED;
+	}
+	for( indx=0; indx<(*sl).size; ++indx ){
+		seq = __atomic_load_n( &(*sl).entries[ indx ].seq, __ATOMIC_ACQUIRE );
+		if( seq==0 || ( seq & 1 )!=0 ) continue;
+		memcpy( &ent, &(*sl).entries[ indx ], sizeof( memc_slowlog_entry ) );
+		__atomic_thread_fence( __ATOMIC_ACQUIRE );
+		if( __atomic_load_n( &(*sl).entries[ indx ].seq, __ATOMIC_RELAXED )!=seq ) continue; // written while copied
+		/*
+		 * Slowest first, insertion to the 'max' slowest. */
+		if( cnt==max && ( max<=0 || ent.total<=entries[ cnt-1 ].total ) ) continue;
+		pos = ( cnt<max ) ? cnt++ : cnt - 1;
+		while( pos>0 && entries[ pos-1 ].total<ent.total ){
+			entries[ pos ] = entries[ pos-1 ];
+			--pos;
+		}
+		entries[ pos ] = ent;
+	}
+	__atomic_sub_fetch( &(*cm).slowlog_users, 1, __ATOMIC_RELEASE );
+	*count = cnt;
+	return CBSUCCESS;
+}
+
+/*
+ * Capture of the operations, 19.10.2026. */
+int  memc_record_start( MEMC *cm, int fd, int flags ){
+	int err = CBSUCCESS;
+	ssize_t wrote = 0;
+	struct timespec ts;
+	memc_record_header hdr;
+	memc_recorder *rc = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	if( fd<0 ) return CBINDEXOUTOFBOUNDS;
+	if( (*cm).recorder!=NULL ) memc_record_stop( &(*cm), NULL, NULL );
+
+	memset( &hdr, 0x00, sizeof( memc_record_header ) );
+	memcpy( &hdr.magic[0], MEMCRECORDMAGIC, 8 );
+	hdr.flags = (uint) ( flags & MEMCRECORDKEYS );
+	hdr.size = (uint) sizeof( memc_record );
+	if( clock_gettime( CLOCK_REALTIME, &ts )==0 )
+		hdr.start = ( (unsigned long long int) ts.tv_sec * 1000000 ) + ( (unsigned long long int) ts.tv_nsec / 1000 );
+
+	rc = (memc_recorder*) calloc( 1, sizeof( memc_recorder ) );
+	if( rc==NULL ) return CBERRALLOC;
+	(*rc).buf = (uchar*) malloc( MEMCRECORDBUFFER );
+	if( (*rc).buf==NULL ){ free( rc ); return CBERRALLOC; }
+	if( pthread_mutex_init( &(*rc).mtx, NULL )!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_record_start: pthread_mutex_init, errno %i '%s'.", errno, strerror( errno ) );
+		free( (*rc).buf ); free( rc );
+		return MEMCERRTHREAD;
+	}
+	(*rc).buflen = MEMCRECORDBUFFER;
+	(*rc).fd = fd;
+	(*rc).flags = (int) hdr.flags;
+	(*rc).start = memc_time_usec();
+
+	do{
+		wrote = write( fd, &hdr, sizeof( memc_record_header ) );
+	}while( wrote<0 && errno==EINTR );
+	if( wrote!=(ssize_t) sizeof( memc_record_header ) ){
+		err = ( wrote<0 ) ? errno : EIO;
+		MEMCLOG( CBLOGERR, CBERRFILEOP, "\nmemc_record_start: write, errno %i '%s'.", err, strerror( err ) );
+		pthread_mutex_destroy( &(*rc).mtx );
+		free( (*rc).buf ); free( rc );
+		return CBERRFILEOP;
+	}
+	__atomic_store_n( &(*cm).recorder, rc, __ATOMIC_RELEASE );
+	return CBSUCCESS;
+}
+int  memc_record_stop( MEMC *cm, unsigned long int *recorded, unsigned long int *lost ){
+	int err = CBSUCCESS;
+	memc_recorder *rc = NULL;
+	if( cm==NULL ) return CBERRALLOC;
+	rc = __atomic_exchange_n( &(*cm).recorder, NULL, __ATOMIC_SEQ_CST );
+	if( rc==NULL ) return MEMCUNINITIALIZED;
+	while( __atomic_load_n( &(*cm).recorder_users, __ATOMIC_SEQ_CST )>0 )
+		sched_yield();
+	pthread_mutex_lock( &(*rc).mtx );
+	err = memc_record_flush( &(*rc) );
+	pthread_mutex_unlock( &(*rc).mtx );
+	if( recorded!=NULL ) *recorded = (*rc).recorded;
+	if( lost!=NULL ) *lost = (*rc).lost;
+	pthread_mutex_destroy( &(*rc).mtx );
+	free( (*rc).buf );
+	free( rc );
+	return err;
+}
+/*
+ * Writes the buffer, the records are lost if the write fails. */
+int  memc_record_flush( memc_recorder *rc ){
+	uint done = 0;
+	ssize_t wrote = 0;
+	if( rc==NULL ) return CBERRALLOC;
+	while( done<(*rc).used ){
+		wrote = write( (*rc).fd, &(*rc).buf[ done ], (size_t) ( (*rc).used - done ) );
+		if( wrote<0 && errno==EINTR ) continue;
+		if( wrote<=0 ){
+			MEMCLOG( CBLOGERR, CBERRFILEOP, "\nmemc_record_flush: write, errno %i '%s', %u records lost.", errno, strerror( errno ), (*rc).buffered );
+			(*rc).lost += (*rc).buffered;
+			(*rc).recorded -= (*rc).buffered;
+			(*rc).used = 0;
+			(*rc).buffered = 0;
+			return CBERRFILEOP;
+		}
+		done += (uint) wrote;
+	}
+	(*rc).used = 0;
+	(*rc).buffered = 0;
+	return CBSUCCESS;
+}
+void  memc_record_put( MEMC *cm, int opcode, uchar *key, int keylen, uint msglen, unsigned long long int start, int err ){
+	uint need = 0, len = 0;
+	unsigned long long int now = 0;
+	memc_record rec;
+	memc_recorder *rc = NULL;
+	if( cm==NULL ) return;
+	__atomic_add_fetch( &(*cm).recorder_users, 1, __ATOMIC_SEQ_CST );
+	rc = __atomic_load_n( &(*cm).recorder, __ATOMIC_SEQ_CST );
+	if( rc==NULL ){
+		__atomic_sub_fetch( &(*cm).recorder_users, 1, __ATOMIC_RELEASE );
+		return;
+	}
+	now = memc_time_usec();
+	len = ( key!=NULL && keylen>0 && keylen<=65535 ) ? (uint) keylen : 0;
+
+	memset( &rec, 0x00, sizeof( memc_record ) );
+	rec.timestamp = ( start>(*rc).start ) ? start - (*rc).start : 0;
+	rec.latency = ( now>start ) ? (uint) ( ( now - start > 0xFFFFFFFFULL ) ? 0xFFFFFFFFULL : now - start ) : 0;
+	rec.keyhash = ( len>0 ) ? memc_hash_key( &(*key), (int) len ) : 0;
+	rec.msglen = msglen;
+	rec.err = err;
+	rec.keylen = (ushort) len;
+	rec.opcode = (uchar) opcode;
+	if( ( (*rc).flags & MEMCRECORDKEYS )==0 ) len = 0;
+	need = (uint) sizeof( memc_record ) + len;
+
+	/*
+	 * A record and its key are written together, the buffer holds the largest key. */
+	pthread_mutex_lock( &(*rc).mtx );
+	if( (*rc).used + need > (*rc).buflen )
+		memc_record_flush( &(*rc) );
+	if( need <= (*rc).buflen ){
+		memcpy( &(*rc).buf[ (*rc).used ], &rec, sizeof( memc_record ) );
+		if( len>0 )
+			memcpy( &(*rc).buf[ (*rc).used + sizeof( memc_record ) ], &(*key), len );
+		(*rc).used += need;
+		++(*rc).buffered;
+		++(*rc).recorded;
+	}else
+		++(*rc).lost;
+	pthread_mutex_unlock( &(*rc).mtx );
+	__atomic_sub_fetch( &(*cm).recorder_users, 1, __ATOMIC_RELEASE );
+}
+
+/*
+ * Bulk load, 19.10.2026. */
+int  memc_load( MEMC *cm, uchar *data, size_t datalen, int format, int window, ushort expiration, memc_load_stats *st, memc_load_progress progress, void *arg ){
+	int indx = 0, started = 0, err = CBSUCCESS;
+	memc_load_param prm[ MEMCMAXREDUNDANTDBS ];
+	if( cm==NULL || data==NULL || st==NULL ) return CBERRALLOC;
+	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
+	if( format!=MEMCLOADTSV && format!=MEMCLOADBINARY ) return CBINDEXOUTOFBOUNDS;
+	if( window<=0 ) window = MEMCLOADWINDOW;
+	memset( &(*st), 0x00, sizeof( memc_load_stats ) );
+	memset( &prm[0], 0x00, sizeof( prm ) );
+
+	memc_fork_reconnect( &(*cm), 1 );
+	memc_wait_all( &(*cm) ); // the previous requests, the connections are used in sequence
+
+	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
+		prm[ indx ].cm = &(*cm);
+		prm[ indx ].data = &data[0];
+		prm[ indx ].datalen = datalen;
+		prm[ indx ].st = &(*st);
+		prm[ indx ].progress = ( indx==0 ) ? progress : NULL;
+		prm[ indx ].arg = arg;
+		prm[ indx ].cindx = indx;
+		prm[ indx ].format = format;
+		prm[ indx ].window = window;
+		prm[ indx ].expiration = expiration;
+		if( pthread_create( &prm[ indx ].thr, NULL, &memc_load_thr, &prm[ indx ] )!=0 ){
+			MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_load: pthread_create, errno %i '%s'.", errno, strerror( errno ) );
+			prm[ indx ].err = MEMCERRTHREAD;
+			break;
+		}
+		++started;
+	}
+	for( indx=0; indx<started; ++indx )
+		pthread_join( prm[ indx ].thr, NULL );
+	for( indx=0; indx<(*cm).redundant_servers_count && indx<MEMCMAXREDUNDANTDBS; ++indx ){
+		if( indx<started && prm[ indx ].err==CBSUCCESS )
+			++(*st).connections;
+		else
+			err = ( prm[ indx ].err!=CBSUCCESS ) ? prm[ indx ].err : MEMCERRTHREAD; // not started
+	}
+	if( (*st).connections>0 && err!=CBSUCCESS ){
+		MEMCLOG( CBLOGWARNING, err, "\nmemc_load: %i of %i connections loaded, error %i.", (*st).connections, (*cm).redundant_servers_count, err );
+		if( (*st).lasterror==CBSUCCESS ) (*st).lasterror = err;
+		return MEMCPARTIAL; // some of the replicas have the data
+	}
+	return err;
+}
+/*
+ * The next record at 'pos'. CBSTREAMEND at the end, CBNOTFOUND if the line is
+ * empty and MEMCSENDINVALIDDATAERR if the record is skipped. */
+int  memc_load_next( uchar *data, size_t datalen, size_t *pos, int format, uchar **key, int *keylen, uchar **value, uint *valuelen ){
+	ushort klen = 0;
+	uint vlen = 0;
+	uchar *end = NULL, *tab = NULL;
+	size_t linelen = 0;
+	if( data==NULL || pos==NULL || key==NULL || keylen==NULL || value==NULL || valuelen==NULL ) return CBERRALLOC;
+	if( *pos>=datalen ) return CBSTREAMEND;
+
+	if( format==MEMCLOADBINARY ){
+		if( *pos==0 ){
+			if( datalen<8 || memcmp( &data[0], MEMCLOADMAGIC, 8 )!=0 ){
+				*pos = datalen;
+				return MEMCSENDINVALIDDATAERR;
+			}
+			*pos = 8;
+			if( *pos>=datalen ) return CBSTREAMEND;
+		}
+		if( *pos + 6 > datalen ){ *pos = datalen; return MEMCSENDINVALIDDATAERR; } // cut
+		memcpy( &klen, &data[ *pos ], 2 );
+		memcpy( &vlen, &data[ *pos + 2 ], 4 );
+		klen = MEMCHTON16( klen );
+		vlen = MEMCHTON32( vlen );
+		if( (size_t) klen + (size_t) vlen > datalen - *pos - 6 ){ *pos = datalen; return MEMCSENDINVALIDDATAERR; }
+		*key = &data[ *pos + 6 ];
+		*keylen = (int) klen;
+		*value = &data[ *pos + 6 + klen ];
+		*valuelen = vlen;
+		*pos += 6 + (size_t) klen + (size_t) vlen;
+		if( klen==0 ) return MEMCSENDINVALIDDATAERR;
+		return CBSUCCESS;
+	}
+
+	/*
+	 * TSV. */
+	end = (uchar*) memchr( &data[ *pos ], (int) '\n', datalen - *pos );
+	linelen = ( end!=NULL ) ? (size_t) ( end - &data[ *pos ] ) : datalen - *pos;
+	*key = &data[ *pos ];
+	*pos += linelen + ( ( end!=NULL ) ? 1 : 0 );
+	if( linelen>0 && (*key)[ linelen-1 ]=='\r' ) --linelen;
+	if( linelen==0 ) return CBNOTFOUND;
+	tab = (uchar*) memchr( &(*key)[0], (int) '\t', linelen );
+	if( tab==NULL || tab==&(*key)[0] || (size_t) ( tab - &(*key)[0] )>65535 ) return MEMCSENDINVALIDDATAERR;
+	*keylen = (int) ( tab - &(*key)[0] );
+	*value = &tab[1];
+	*valuelen = (uint) ( linelen - (size_t) *keylen - 1 );
+	return CBSUCCESS;
+}
+int  memc_load_write( int fd, uchar *buf, size_t len ){
+	ssize_t wrote = 0;
+	size_t done = 0;
+	while( done<len ){
+		wrote = write( fd, &buf[ done ], len - done );
+		if( wrote<0 && errno==EINTR ) continue;
+		if( wrote<=0 ){
+			MEMCLOG( CBLOGERR, MEMCSENDMSGERR, "\nmemc_load_write: write, errno %i '%s'.", errno, strerror( errno ) );
+			return MEMCSENDMSGERR;
+		}
+		done += (size_t) wrote;
+	}
+	return CBSUCCESS;
+}
+/*
+ * Responces of the failed SETQs and the NOOP at the end of the window. */
+int  memc_load_drain( int fd, memc_load_stats *st ){
+	int len = 0, got = 0;
+	uint remaining = 0;
+	uchar scratch[ 256 ];
+	memc_msg hdr;
+	for(;;){
+		for( got=0; got<24; got+=len ){
+			len = (int) read( fd, &( (uchar*) &hdr )[ got ], (size_t) ( 24 - got ) );
+			if( len<0 && errno==EINTR ){ len = 0; continue; }
+			if( len<=0 ) return MEMCRECVHDRERR;
+		}
+		memc_hdr_to_big_endian( &hdr );
+		if( hdr.magic!=MEMCRESPONCE ) return MEMCRECVINVALIDHDRERR;
+		for( remaining=hdr.body_length; remaining>0; remaining-=(uint) len ){
+			len = (int) read( fd, &scratch[0], ( remaining<sizeof( scratch ) ) ? remaining : sizeof( scratch ) );
+			if( len<0 && errno==EINTR ){ len = 0; continue; }
+			if( len<=0 ) return MEMCRECVMSGERR;
+		}
+		if( hdr.opcode==MEMCNOOP )
+			return CBSUCCESS;
+		__atomic_add_fetch( &(*st).failed, 1, __ATOMIC_RELAXED );
+		__atomic_store_n( &(*st).lasterror, (int) hdr.status, __ATOMIC_RELAXED );
+	}
+}
+void* memc_load_thr( void *prm ){
+	memc_load_param *lp = (memc_load_param*) prm;
+	dbs_conn *conn = NULL;
+	uchar *buf = NULL, *key = NULL, *value = NULL;
+	int err = CBSUCCESS, keylen = 0, fd = -1, noops = 0, inwindow = 0;
+	uint valuelen = 0, recno = 0;
+	size_t pos = 0, used = 0, reclen = 0;
+	unsigned long int records = 0, bytes = 0, skipped = 0, none = 0;
+	memc_msg hdr;
+	memc_extras ext;
+	if( lp==NULL || (*lp).cm==NULL ) return NULL;
+	conn = &(*(*(*(*lp).cm).token).conn[ (*lp).cindx ]);
+	if( memc_conn_acquire( &(*conn) )!=1 ){
+		(*lp).err = MEMCERRCONNECT;
+		__atomic_store_n( &(*(*lp).st).lasterror, MEMCERRCONNECT, __ATOMIC_RELAXED );
+		return NULL;
+	}
+	fd = (*conn).fd;
+	buf = (uchar*) malloc( MEMCLOADBUFFER );
+	if( buf==NULL || fd<0 ){
+		memc_conn_release( &(*conn), CBSUCCESS );
+		free( buf );
+		(*lp).err = ( fd<0 ) ? MEMCERRCONNECT : CBERRALLOC;
+		return NULL;
+	}
+
+	/*
+	 * The connection is reserved, the send and recv mutexes of the MEMC are not needed. */
+	for(;;){
+		err = memc_load_next( &(*lp).data[0], (*lp).datalen, &pos, (*lp).format, &key, &keylen, &value, &valuelen );
+		if( err==CBSTREAMEND ){
+			err = CBSUCCESS;
+			if( skipped>0 ) // every connection parses the same dump, the first one to the end counts
+				__atomic_compare_exchange_n( &(*(*lp).st).skipped, &none, skipped, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED );
+			break;
+		}
+		if( err==CBNOTFOUND ) continue;
+		if( err!=CBSUCCESS ){
+			++skipped;
+			continue;
+		}
+		reclen = 24 + 8 + (size_t) keylen + (size_t) valuelen;
+		memc_hdr_request( &hdr, MEMCSETQ, (ushort) keylen, 8 + (uint) keylen + valuelen, 0, 0 );
+		hdr.opaque = MEMCHTON32( ++recno );
+		ext.flags = 0;
+		ext.expiration = (*lp).expiration;
+		memc_ext_to_big_endian( &ext );
+
+		if( used + reclen > MEMCLOADBUFFER ){
+			err = memc_load_write( fd, &buf[0], used );
+			used = 0;
+			if( err!=CBSUCCESS ) break;
+		}
+		if( reclen > MEMCLOADBUFFER ){ // larger than the buffer, the value is written from the dump
+			memcpy( &buf[0], &hdr, 24 );
+			memcpy( &buf[24], &ext, 8 );
+			memcpy( &buf[32], &key[0], (size_t) keylen );
+			err = memc_load_write( fd, &buf[0], 32 + (size_t) keylen );
+			if( err==CBSUCCESS ) err = memc_load_write( fd, &value[0], (size_t) valuelen );
+			if( err!=CBSUCCESS ) break;
+		}else{
+			memcpy( &buf[ used ], &hdr, 24 );
+			memcpy( &buf[ used + 24 ], &ext, 8 );
+			memcpy( &buf[ used + 32 ], &key[0], (size_t) keylen );
+			if( valuelen>0 ) memcpy( &buf[ used + 32 + (size_t) keylen ], &value[0], (size_t) valuelen );
+			used += reclen;
+		}
+		++records;
+		bytes += reclen;
+
+		/*
+		 * End of the window. */
+		if( ++inwindow>=(*lp).window ){
+			memc_hdr_request( &hdr, MEMCNOOP, 0, 0, 0, 0 );
+			if( used + 24 > MEMCLOADBUFFER ){ // the record filled the buffer
+				err = memc_load_write( fd, &buf[0], used );
+				used = 0;
+				if( err!=CBSUCCESS ) break;
+			}
+			memcpy( &buf[ used ], &hdr, 24 );
+			err = memc_load_write( fd, &buf[0], used + 24 );
+			used = 0;
+			inwindow = 0;
+			if( err!=CBSUCCESS ) break;
+			if( ++noops==2 ){
+				err = memc_load_drain( fd, &(*(*lp).st) );
+				--noops;
+				if( err!=CBSUCCESS ) break;
+			}
+			__atomic_add_fetch( &(*(*lp).st).records, records, __ATOMIC_RELAXED );
+			__atomic_add_fetch( &(*(*lp).st).bytes, bytes, __ATOMIC_RELAXED );
+			records = 0; bytes = 0;
+			if( (*lp).progress!=NULL )
+				(*lp).progress( (*lp).arg, &(*(*lp).st) );
+		}
+	}
+
+	/*
+	 * The last window. */
+	if( err==CBSUCCESS ){
+		memc_hdr_request( &hdr, MEMCNOOP, 0, 0, 0, 0 );
+		if( used + 24 > MEMCLOADBUFFER ){
+			err = memc_load_write( fd, &buf[0], used );
+			used = 0;
+		}
+		memcpy( &buf[ used ], &hdr, 24 );
+		if( err==CBSUCCESS ) err = memc_load_write( fd, &buf[0], used + 24 );
+		for( ++noops; err==CBSUCCESS && noops>0; --noops )
+			err = memc_load_drain( fd, &(*(*lp).st) );
+	}
+	__atomic_add_fetch( &(*(*lp).st).records, records, __ATOMIC_RELAXED );
+	__atomic_add_fetch( &(*(*lp).st).bytes, bytes, __ATOMIC_RELAXED );
+	if( (*lp).progress!=NULL )
+		(*lp).progress( (*lp).arg, &(*(*lp).st) );
+	if( err!=CBSUCCESS ){
+		MEMCLOG( CBLOGERR, err, "\nmemc_load: connection %i, error %i.", (*lp).cindx, err );
+		__atomic_store_n( &(*(*lp).st).lasterror, err, __ATOMIC_RELAXED );
+	}
+	memc_conn_release( &(*conn), ( err!=CBSUCCESS ) ? MEMCRECVINVALIDDATAERR : CBSUCCESS ); // out of sequence after an error
+	(*lp).err = err;
+	free( buf );
+	return NULL;
+}
+
+/*
+ * Pipelined writes, 19.10.2026. The connections are acquired in the order of the index
+ * and written window by window, the previous window is drained after the next one is
+ * written. An operation failed on a connection if it has an error responce or if the
+ * connection failed before its NOOP was answered. */
+int  memc_write_batch( MEMC *cm, memc_batch_op *ops, int count ){
+	int indx = 0, op = 0, first = 0, last = 0, servers = 0, sent = 0, err = CBSUCCESS;
+	int conerr[ MEMCMAXREDUNDANTDBS ], done[ MEMCMAXREDUNDANTDBS ], written[ MEMCMAXREDUNDANTDBS ];
+	char acquired[ MEMCMAXREDUNDANTDBS ];
+	unsigned long long int start[ MEMCMAXREDUNDANTDBS ], recstart = 0;
+	dbs_conn *conn = NULL;
+	if( cm==NULL || ops==NULL ) return CBERRALLOC;
+	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
+	for( op=0; op<count; ++op ){
+		if( ops[ op ].key==NULL || ( ops[ op ].opcode!=MEMCDELETE && ops[ op ].msg==NULL ) ) return CBERRALLOC;
+		if( ops[ op ].opcode!=MEMCSET && ops[ op ].opcode!=MEMCREPLACE && ops[ op ].opcode!=MEMCDELETE ) return CBINDEXOUTOFBOUNDS;
+		if( ops[ op ].keylen<=0 || ops[ op ].keylen>65535 || ops[ op ].msglen<0 ) return CBOVERFLOW;
+	}
+	if( count<=0 ) return CBSUCCESS;
+
+	for( op=0; op<count; ++op ){
+		ops[ op ].status = -1; // memc_result_add
+		ops[ op ].failed = 0;
+		if( (*cm).nearcache!=NULL )
+			memc_nearcache_invalidate( &(*cm), &ops[ op ].key, ops[ op ].keylen );
+		if( (*cm).shmcache!=NULL )
+			memc_shmcache_invalidate( &(*cm), &ops[ op ].key[0], ops[ op ].keylen );
+		if( (*cm).negcache!=NULL )
+			memc_negcache_invalidate( &(*cm), &ops[ op ].key[0], ops[ op ].keylen );
+	}
+	memc_fork_reconnect( &(*cm), 1 );
+	for( op=0; op<count; ++op ){
+		err = memc_join_key( &(*cm), memc_key_order( &ops[ op ].key[0], ops[ op ].keylen ), NULL );
+		if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_write_batch: memc_join_key, error %i.", err ); }
+	}
+	recstart = ( (*cm).recorder!=NULL ) ? memc_time_usec() : 0;
+
+	servers = ( (*cm).redundant_servers_count<MEMCMAXREDUNDANTDBS ) ? (*cm).redundant_servers_count : MEMCMAXREDUNDANTDBS;
+	for( indx=0; indx<servers; ++indx ){
+		conerr[ indx ] = MEMCERRCONNECT;
+		acquired[ indx ] = 0;
+		done[ indx ] = 0;
+		written[ indx ] = 0;
+		start[ indx ] = 0;
+		if( (*(*cm).token).conn==NULL || (*(*cm).token).conn[ indx ]==NULL ) continue;
+		conn = &(*(*(*cm).token).conn[ indx ]);
+		if( memc_conn_acquire( &(*conn) )!=1 ) continue;
+		if( (*conn).fd<0 ){
+			memc_conn_release( &(*conn), CBSUCCESS );
+			continue;
+		}
+		memc_processing_inc( &(*conn) );
+		acquired[ indx ] = 1;
+		conerr[ indx ] = CBSUCCESS;
+		++sent;
+	}
+
+	/*
+	 * Two windows are in flight on each connection. */
+	for( first=0; first<count && sent>0; first=last ){
+		last = ( count - first > MEMCLOADWINDOW ) ? first + MEMCLOADWINDOW : count;
+		for( indx=0; indx<servers; ++indx )
+			if( conerr[ indx ]==CBSUCCESS )
+				conerr[ indx ] = memc_batch_write( &(*cm), indx, &ops[0], first, last, &start[ indx ], &written[ indx ] );
+		for( indx=0; indx<servers && first>0; ++indx ){
+			if( conerr[ indx ]!=CBSUCCESS ) continue;
+			conerr[ indx ] = memc_batch_drain( &(*cm), indx, &ops[0], count, start[ indx ] );
+			if( conerr[ indx ]==CBSUCCESS ) done[ indx ] = first;
+		}
+	}
+	for( indx=0; indx<servers && sent>0; ++indx ){
+		if( conerr[ indx ]!=CBSUCCESS ) continue;
+		conerr[ indx ] = memc_batch_drain( &(*cm), indx, &ops[0], count, start[ indx ] );
+		if( conerr[ indx ]==CBSUCCESS ) done[ indx ] = count;
+	}
+
+	/*
+	 * Results of the connections, the error responces were added in memc_batch_drain. */
+	for( indx=0; indx<servers; ++indx ){
+		for( op=0; op<count; ++op ){
+			if( ( ops[ op ].failed & ( 1U << indx ) )!=0 ) continue;
+			memc_result_add( &ops[ op ].status, ( op<done[ indx ] ) ? CBSUCCESS : conerr[ indx ] );
+			memc_stats_end( &(*cm), indx, ( ops[ op ].opcode==MEMCDELETE ) ? MEMCSTATSDELETE : ( ( ops[ op ].opcode==MEMCREPLACE ) ? MEMCSTATSREPLACE : MEMCSTATSSET ), \
+				( op<written[ indx ] ) ? start[ indx ] : 0, ( op<done[ indx ] ) ? CBSUCCESS : conerr[ indx ], MEMCSUCCESS, \
+				( op<written[ indx ] ) ? (unsigned long int) ( ( ops[ op ].opcode==MEMCDELETE ) ? 24 + ops[ op ].keylen : 32 + ops[ op ].keylen + ops[ op ].msglen ) : 0, 0 );
+		}
+		if( acquired[ indx ]==0 ) continue;
+		conn = &(*(*(*cm).token).conn[ indx ]);
+		(*conn).lasterr = conerr[ indx ]; // while acquired
+		memc_conn_release( &(*conn), ( conerr[ indx ]!=CBSUCCESS ) ? MEMCRECVINVALIDDATAERR : CBSUCCESS ); // out of sequence after an error
+		memc_processing_dec( &(*conn) );
+	}
+
+	for( op=0; op<count; ++op ){
+		if( (*cm).nearcache!=NULL )
+			memc_nearcache_invalidate( &(*cm), &ops[ op ].key, ops[ op ].keylen );
+		if( (*cm).shmcache!=NULL )
+			memc_shmcache_invalidate( &(*cm), &ops[ op ].key[0], ops[ op ].keylen );
+		if( (*cm).negcache!=NULL )
+			memc_negcache_invalidate( &(*cm), &ops[ op ].key[0], ops[ op ].keylen );
+		if( (*cm).flight_created!=0 )
+			memc_flight_invalidate( &(*cm), &ops[ op ].key[0], ops[ op ].keylen );
+		if( (*cm).recorder!=NULL )
+			memc_record_put( &(*cm), (int) ops[ op ].opcode, &ops[ op ].key[0], ops[ op ].keylen, ( ops[ op ].opcode!=MEMCDELETE ) ? (uint) ops[ op ].msglen : 0, recstart, ops[ op ].status );
+	}
+	if( sent==0 ) return MEMCERRCONNECT;
+	return CBSUCCESS;
+}
+/*
+ * The requests of 'first' to 'last' and a NOOP. The opaque is the index of the operation plus one. */
+int  memc_batch_write( MEMC *cm, int cindx, memc_batch_op *ops, int first, int last, unsigned long long int *start, int *written ){
+	int op = 0, fd = -1, err = CBSUCCESS;
+	size_t used = 0, reclen = 0, extlen = 0;
+	unsigned long long int now = 0;
+	uchar buf[ MEMCBATCHBUFFER ];
+	memc_msg hdr;
+	memc_extras ext;
+	if( cm==NULL || ops==NULL || start==NULL || written==NULL ) return CBERRALLOC;
+	fd = (*(*(*cm).token).conn[ cindx ]).fd;
+	for( op=first; op<last; ++op ){
+		extlen = ( ops[ op ].opcode==MEMCDELETE ) ? 0 : 8;
+		reclen = 24 + extlen + (size_t) ops[ op ].keylen + ( ( extlen>0 ) ? (size_t) ops[ op ].msglen : 0 );
+		memc_hdr_request( &hdr, ( ops[ op ].opcode==MEMCSET ) ? MEMCSETQ : ( ( ops[ op ].opcode==MEMCREPLACE ) ? MEMCREPLACEQ : MEMCDELETEQ ), \
+			(ushort) ops[ op ].keylen, (uint) ( reclen - 24 ), 0, ops[ op ].cas );
+		hdr.opaque = MEMCHTON32( (uint) op + 1 );
+		ext.flags = 0;
+		ext.expiration = ops[ op ].expiration;
+		memc_ext_to_big_endian( &ext );
+
+		if( used + reclen > MEMCBATCHBUFFER ){
+			err = memc_load_write( fd, &buf[0], used );
+			used = 0;
+			if( err!=CBSUCCESS ) return err;
+		}
+		now = memc_stats_begin( &(*cm), cindx );
+		if( *start==0 ) *start = now;
+		*written = op + 1;
+		if( reclen > MEMCBATCHBUFFER ){ // the value is written from the caller
+			memcpy( &buf[0], &hdr, 24 );
+			memcpy( &buf[24], &ext, extlen );
+			memcpy( &buf[ 24 + extlen ], &ops[ op ].key[0], (size_t) ops[ op ].keylen );
+			err = memc_load_write( fd, &buf[0], 24 + extlen + (size_t) ops[ op ].keylen );
+			if( err==CBSUCCESS && extlen>0 ) err = memc_load_write( fd, &ops[ op ].msg[0], (size_t) ops[ op ].msglen );
+			if( err!=CBSUCCESS ) return err;
+		}else{
+			memcpy( &buf[ used ], &hdr, 24 );
+			if( extlen>0 ) memcpy( &buf[ used + 24 ], &ext, extlen );
+			memcpy( &buf[ used + 24 + extlen ], &ops[ op ].key[0], (size_t) ops[ op ].keylen );
+			if( extlen>0 && ops[ op ].msglen>0 ) memcpy( &buf[ used + 24 + extlen + (size_t) ops[ op ].keylen ], &ops[ op ].msg[0], (size_t) ops[ op ].msglen );
+			used += reclen;
+		}
+	}
+	memc_hdr_request( &hdr, MEMCNOOP, 0, 0, 0, 0 );
+	if( used + 24 > MEMCBATCHBUFFER ){
+		err = memc_load_write( fd, &buf[0], used );
+		used = 0;
+		if( err!=CBSUCCESS ) return err;
+	}
+	memcpy( &buf[ used ], &hdr, 24 );
+	return memc_load_write( fd, &buf[0], used + 24 );
+}
+/*
+ * Responces of the failed requests and the NOOP at the end of the window. */
+int  memc_batch_drain( MEMC *cm, int cindx, memc_batch_op *ops, int count, unsigned long long int start ){
+	int len = 0, got = 0, op = 0, fd = -1;
+	memc_msg hdr;
+	if( cm==NULL || ops==NULL ) return CBERRALLOC;
+	fd = (*(*(*cm).token).conn[ cindx ]).fd;
+	for(;;){
+		for( got=0; got<24; got+=len ){
+			len = memc_read( fd, &( (uchar*) &hdr )[ got ], (size_t) ( 24 - got ) );
+			if( len<0 && errno==EINTR ){ len = 0; continue; }
+			if( len<=0 ) return MEMCRECVHDRERR;
+		}
+		memc_hdr_to_big_endian( &hdr );
+		if( hdr.magic!=MEMCRESPONCE ) return MEMCRECVINVALIDHDRERR;
+		if( hdr.body_length>0 && memc_recv_discard( fd, hdr.body_length )<0 ) return MEMCRECVMSGERR;
+		if( hdr.opcode==MEMCNOOP )
+			return CBSUCCESS;
+		op = (int) hdr.opaque - 1;
+		if( op<0 || op>=count ) return MEMCRECVINVALIDDATAERR;
+		if( hdr.status==MEMCSUCCESS ) continue; // not expected of a quiet request
+		ops[ op ].failed |= ( 1U << cindx );
+		memc_result_add( &ops[ op ].status, (int) hdr.status );
+		memc_stats_end( &(*cm), cindx, ( ops[ op ].opcode==MEMCDELETE ) ? MEMCSTATSDELETE : ( ( ops[ op ].opcode==MEMCREPLACE ) ? MEMCSTATSREPLACE : MEMCSTATSSET ), \
+			start, CBSUCCESS, hdr.status, (unsigned long int) ( ( ops[ op ].opcode==MEMCDELETE ) ? 24 + ops[ op ].keylen : 32 + ops[ op ].keylen + ops[ op ].msglen ), 24 + (unsigned long int) hdr.body_length );
+	}
+}
+
 int  memc_replace( MEMC *cm, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort vbucketid, ushort expiration ){
 	if( cm==NULL ) return CBERRALLOC;
 	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
@@ -1076,20 +4011,36 @@ int  memc_set( MEMC *cm, uchar **key, int keylen, uchar **msg, int msglen, uint
 }
 int  memc_set_common( MEMC *cm, uchar **key, uint keylen, uchar **msg, int msglen, uint cas, ushort vbucketid, ushort expiration, char replace ){
 	int err = CBSUCCESS, indx = 0, retries = 0;
+	uint keyhash = 0, traceid = 0;
 	char none_succeeded = 1, some_were_not_connected = 1;
 	MEMC_parameter *pm = NULL;
+	memc_trace_fanout *fanout = NULL;
 	if( cm==NULL ) return CBERRALLOC;
 	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
 	if( key==NULL || *key==NULL || msg==NULL || *msg==NULL ) return CBERRALLOC;
 
+	/*
+	 * The local copy is not valid after this. The request threads invalidate
+	 * again when the servers have answered, 19.10.2026. */
+	if( (*cm).nearcache!=NULL )
+		memc_nearcache_invalidate( &(*cm), &(*key), (int) keylen );
+	if( (*cm).shmcache!=NULL )
+		memc_shmcache_invalidate( &(*cm), &(**key), (int) keylen );
+	if( (*cm).negcache!=NULL )
+		memc_negcache_invalidate( &(*cm), &(**key), (int) keylen );
+
 	/*
 	 * All at once.
          */
 
+	memc_fork_reconnect( &(*cm), 1 ); // in a forked child, 19.10.2026
+
 	/*
-	 * Wait for the previous data to be updated. */
-	err = memc_join_previous( &(*cm) );
-	if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_set: memc_join_previous, error %i.", err ); }
+	 * Wait for the previous data of the key to be updated. */
+	keyhash = memc_key_order( &(**key), (int) keylen ); // 19.10.2026
+	err = memc_join_key( &(*cm), keyhash, NULL );
+	if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_set: memc_join_key, error %i.", err ); }
+	fanout = memc_trace_fanout_start( &(*cm), ( replace==1 ) ? MEMCREPLACE : MEMCSET, &traceid, &(**key), (int) keylen, ( msglen>0 ) ? (uint) msglen : 0 ); // NULL if not traced or captured, 19.10.2026
 
 	/*
 	 * Index in session database array. */
@@ -1107,19 +4058,17 @@ int  memc_set_common( MEMC *cm, uchar **key, uint keylen, uchar **msg, int msgle
 
 		/*
 		 * Get empty parameters. */
-		pm = (void*) malloc( sizeof( void* ) ); // 9.8.2017, 31.10.2018
-		if( pm==NULL ) return CBERRALLOC;
-		memc_get_param( &pm );
-		if( pm==NULL ) continue;
+		if( msglen<0 || keylen>65536 || memc_get_param( &(*cm), &pm )>=CBERROR || pm==NULL ){ // 19.10.2026
+			memc_trace_fanout_done( &(*cm), &(*fanout), CBERRALLOC );
+			return ( msglen<0 || keylen>65536 ) ? CBOVERFLOW : CBERRALLOC;
+		}
 
 		/*
 		 * Parameters. */
 		(*pm).msg = &(**msg);
-		if( msglen<0 ) return CBOVERFLOW;
 		(*pm).msglen = (unsigned int) msglen;
 		(*pm).msgbuflen = msglen;
 		(*pm).key = &(**key);
-		if( keylen>65536 ) return CBOVERFLOW;
 		(*pm).keylen = (unsigned short) keylen;
 		(*pm).vbucketid = vbucketid;
 		(*pm).expiration = expiration;
@@ -1131,25 +4080,34 @@ int  memc_set_common( MEMC *cm, uchar **key, uint keylen, uchar **msg, int msgle
 		(*pm).cindx = indx;
 		(*pm).dbsindx = (*(*cm).token).starting_index;
 		(*pm).cm = &(*cm);
+		(*pm).trace_id = traceid;
+		MEMCTRACE( cm, pm, MEMCTRACEROUTE, (*pm).special==MEMCREPLACE ? MEMCREPLACE : MEMCSET, CBSUCCESS );
+		MEMCPROBE4( submit, (*pm).special==MEMCREPLACE ? MEMCREPLACE : MEMCSET, keylen, msglen, traceid );
 
 
-		if( (*(*(*cm).token).conn[ indx ]).connected!=1 ){ // 7.8.2018
-			err = memc_join_previous( &(*cm) );
-			if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_set_thr: memc_join_previous, error %i (2).", err ); }
+		if( memc_conn_state( &(*(*(*cm).token).conn[ indx ]) )==MEMCCONNCONNECTING ){ // 7.8.2018, 19.10.2026
+			memc_wait_pending( &(*cm), 0, indx, 0, NULL ); // connect thread of the connection
 		}
-		if( (*(*(*cm).token).conn[ indx ]).connected==1 ){
+		if( memc_conn_state( &(*(*(*cm).token).conn[ indx ]) )==MEMCCONNREADY || memc_conn_state( &(*(*(*cm).token).conn[ indx ]) )==MEMCCONNBUSY ){ // 19.10.2026
 memc_set_retry:
-			++((*(*(*cm).token).conn[ indx ]).processing); // 19.7.2018, 9.8.2018
+			memc_processing_inc( &(*(*(*cm).token).conn[ indx ]) ); // 19.7.2018, 9.8.2018
 			// ORIG 1.10.2018 (the only one working): 
 			//err = pthread_create( &( (*(*(*cm).token).conn[ indx ]).thr ), NULL, &memc_set_thr, pm ); // pointer pm is copied to free it at the end of thread, 8.7.2018
-			err = pthread_create( &( (*(*(*cm).token).conn[ indx ]).thr ), NULL, &memc_set_thr, &(*pm) ); // pointer pm is copied to free it at the end of thread, 8.7.2018
 			// TEST 1.10.2018: err = pthread_create( &( (*(*(*cm).token).conn[ indx ]).thr ), NULL, &memc_set_thr, &(*pm) ); // pointer pm is copied to free it at the end of thread, 8.7.2018
+			if( fanout!=NULL && pm!=NULL ){
+				__atomic_add_fetch( &(*fanout).pending, 1, __ATOMIC_ACQ_REL ); // 19.10.2026
+				(*pm).trace_fanout = &(*fanout);
+			}
+			err = memc_start_thread( &(*cm), &(*pm), &memc_set_thr, keyhash ); // 19.10.2026
 			if( err!=0 ){
-	        	   cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_set_thr: pthread_create cindx %i, error %i, errno %i, '%s'", (*pm).cindx, err, errno, strerror( errno ) );
+	        	   MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_set_thr: pthread_create cindx %i, error %i, errno %i, '%s'", indx, err, errno, strerror( errno ) );
 			   (*(*(*cm).token).conn[ indx ]).last_thread_status = err;
+			   memc_processing_dec( &(*(*(*cm).token).conn[ indx ]) ); // 19.10.2026
+			   if( pm!=NULL && (*pm).trace_fanout!=NULL )
+				memc_trace_fanout_done( &(*cm), &(*fanout), MEMCERRTHREAD );
+			   memc_free_param( pm );
 			}else{
 			   none_succeeded = 0;
-			   (*(*(*cm).token).conn[ indx ]).thr_created = 1;
 			}
 		}else{
 			some_were_not_connected = 1;
@@ -1167,23 +4125,23 @@ memc_set_retry:
 			/*
 			 * Last without results. Try reconnecting. */
 			err = memc_join_previous( &(*cm) );
-			if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_set_thr: memc_join_previous, error %i (2).", err ); }
+			if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_set_thr: memc_join_previous, error %i (2).", err ); }
 			if( retries==2 ){
 
 				/*
 				 * Last chance, something is really wrong, 11.7.2018. */
 				err = memc_reinit( &(*cm) );
-				if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_set_thr: memc_reinit, error %i (retries %i).", err, retries ); }
+				if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_set_thr: memc_reinit, error %i (retries %i).", err, retries ); }
 				++retries; // 7.8.2018
 				goto memc_set_retry;
 			}
 			/***
 			if( err!=MEMCNOTHINGTOJOIN ){
 				err = memc_connect( &(*cm), &(*key), keylen );
-				if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_set_thr: memc_connect, error %i (2).", err ); }
+				if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_set_thr: memc_connect, error %i (2).", err ); }
 				err = memc_join_previous( &(*cm) );
-				if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_set_thr: memc_join_previous, error %i (2).", err ); }
-				cb_clog( CBLOGWARNING, err, "\nmemc_set_thr: warning, reinit of connections.");
+				if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_set_thr: memc_join_previous, error %i (2).", err ); }
+				MEMCLOG( CBLOGWARNING, err, "\nmemc_set_thr: warning, reinit of connections.");
 			}
 			 ***/
 			indx = 0;
@@ -1191,86 +4149,86 @@ memc_set_retry:
 			continue;
 		}
 	}
+	memc_trace_fanout_done( &(*cm), &(*fanout), ( none_succeeded==1 ) ? MEMCERRCONNECT : CBSUCCESS ); // 19.10.2026
+	if( none_succeeded==1 )
+		return MEMCERRCONNECT; // not sent to any of the servers, 19.10.2026
 	return CBSUCCESS;
 }
 
 void* memc_set_thr( void *prm ){
+	unsigned long int in = 0;
+	unsigned long long int start = 0;
 	memc_msg hdr;
 	memc_extras ext;
 	MEMC_parameter *pm;
 	if( prm==NULL || (* (MEMC_parameter*) prm).cm==NULL ) 
 		pthread_exit( NULL );
-	pthread_mutex_lock( &(*(* (MEMC_parameter*) prm ).cm).set ); // note 16.9.2018: code quality mutex
-	pm = &(* (MEMC_parameter*) prm);
+	pm = &(* (MEMC_parameter*) prm); // the connection is acquired, the MEMC is not locked, 19.10.2026
 	if( pm==NULL || (*pm).key==NULL ){
-	  cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_set_thr, error %i (1).", CBERRALLOCTHR );
-	  cb_flush_log();
-	  pthread_mutex_unlock( &(*(* (MEMC_parameter*) prm ).cm).set );
+	  MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_set_thr, error %i (1).", CBERRALLOCTHR );
+	  MEMCFLUSHLOG();
+	  memc_thread_done( (MEMC_parameter*) prm, CBERRALLOCTHR ); // 19.10.2026
 	  pthread_exit( NULL );
 	  return NULL;
 	}
 	(*pm).errc = 0; // 10.11.2018
 /**
 if( (*pm).special==MEMCREPLACE )
-  cb_clog( CBLOGDEBUG, CBSUCCESS, "\n *** MEMC_SET_THR (REPLACE) INDX %i, LOCK SET *** ", (*pm).cindx );
+  MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\n *** MEMC_SET_THR (REPLACE) INDX %i, LOCK SET *** ", (*pm).cindx );
 else
-  cb_clog( CBLOGDEBUG, CBSUCCESS, "\n *** MEMC_SET_THR INDX %i, LOCK SET *** ", (*pm).cindx );
-cb_flush_log();
-//cb_clog( CBLOGDEBUG, CBSUCCESS, "\n *** MEMC_SET_THR FD, %i *** ", (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd );
+  MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\n *** MEMC_SET_THR INDX %i, LOCK SET *** ", (*pm).cindx );
+MEMCFLUSHLOG();
+//MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\n *** MEMC_SET_THR FD, %i *** ", (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd );
  **/
 	if( (*pm).msg==NULL || (*pm).cm==NULL || (*(*pm).cm).token==NULL ){
-	  //18.8.2018: cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_set_thr, error %i (2) ", CBERRALLOCTHR );
-	  cb_clog( CBLOGERR, CBNEGATION, "\nmemc_set_thr, error %i (2) ", CBERRALLOCTHR );
+	  //18.8.2018: MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_set_thr, error %i (2) ", CBERRALLOCTHR );
+	  MEMCLOG( CBLOGERR, CBNEGATION, "\nmemc_set_thr, error %i (2) ", CBERRALLOCTHR );
 	  if( (*pm).msg==NULL )
-		cb_clog( CBLOGDEBUG, CBNEGATION, " (*pm).msg was NULL.");
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, " (*pm).msg was NULL.");
 	  else if( (*pm).cm==NULL )
-		cb_clog( CBLOGDEBUG, CBNEGATION, " (*pm).cm was NULL.");
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, " (*pm).cm was NULL.");
 	  else if( (*(*pm).cm).token==NULL )
-		cb_clog( CBLOGDEBUG, CBNEGATION, " (*(*pm).cm).token was NULL.");
-	  cb_flush_log();
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wthread-safety-analysis"
-	  pthread_mutex_unlock( &(*(*pm).cm).set );
-#pragma clang diagnostic pop
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, " (*(*pm).cm).token was NULL.");
+	  MEMCFLUSHLOG();
+	  memc_thread_done( pm, CBERRALLOCTHR ); // 19.10.2026
 	  pthread_exit( NULL );
 	  return NULL;
 	}
-	hdr.magic = MEMCREQUEST; hdr.data_type = MEMCDATATYPE; hdr.vbucket_id = (*pm).vbucketid;
-	hdr.opcode = MEMCSET; 
-	if( (*pm).special==MEMCREPLACE )
-		hdr.opcode = MEMCREPLACE;
-	hdr.key_length = (*pm).keylen; 
-	hdr.extras_length = 8 ; // 8.8.2018, 4 + 4 bytes, flags + expiration
-	hdr.body_length = (*pm).msglen ;
-	hdr.body_length += hdr.extras_length; // 8.8.2018
-	hdr.body_length += hdr.key_length; // 8.8.2018
-	hdr.opaque = 0x02; hdr.cas = (*pm).cas;
+	/*
+	 * 8.8.2018, 4 + 4 bytes, flags + expiration. */
+	memc_hdr_request( &hdr, ( (*pm).special==MEMCREPLACE ) ? MEMCREPLACE : MEMCSET, (*pm).keylen, (*pm).msglen + 8 + (*pm).keylen, (*pm).vbucketid, (*pm).cas );
 	ext.flags = 0x00;
 	ext.expiration = (*pm).expiration;
 
 /***
 if( (*pm).special==MEMCREPLACE )
-  cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_SET_THR: MEMC_REPLACE, LEN %i [", (*pm).msglen );
+  MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_SET_THR: MEMC_REPLACE, LEN %i [", (*pm).msglen );
 else
-  cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_SET_THR: MEMC_SET, LEN %i [", (*pm).msglen );
+  MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_SET_THR: MEMC_SET, LEN %i [", (*pm).msglen );
 for( indx=0; indx<(*pm).msglen; ++indx ){
-  //1.10.2018: cb_clog( CBLOGDEBUG, CBSUCCESS, "%c", (*(*pm).msg)[ indx ]);
-  cb_clog( CBLOGDEBUG, CBSUCCESS, "%c", (*pm).msg[ indx ] );
+  //1.10.2018: MEMCLOG( CBLOGDEBUG, CBSUCCESS, "%c", (*(*pm).msg)[ indx ]);
+  MEMCLOG( CBLOGDEBUG, CBSUCCESS, "%c", (*pm).msg[ indx ] );
 }
-cb_clog( CBLOGDEBUG, CBSUCCESS, "] [");
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "] [");
 for( indx=0; indx<(*pm).msglen; ++indx ){
-  //1.10.2018: cb_clog( CBLOGDEBUG, CBSUCCESS, "%.2X", (*(*pm).msg)[ indx ]);
-  cb_clog( CBLOGDEBUG, CBSUCCESS, "%.2X", (*pm).msg[ indx ]);
+  //1.10.2018: MEMCLOG( CBLOGDEBUG, CBSUCCESS, "%.2X", (*(*pm).msg)[ indx ]);
+  MEMCLOG( CBLOGDEBUG, CBSUCCESS, "%.2X", (*pm).msg[ indx ]);
 }
-cb_clog( CBLOGDEBUG, CBSUCCESS, "]");
-cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "]");
+MEMCFLUSHLOG();
 indx = 0;
  ***/
 
-	pthread_mutex_lock( &(*(*pm).cm).send );
- 	//1.10.2018: (*pm).errc = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, &ext, &(*(*pm).key), (*pm).keylen, &(*(*pm).msg), (*pm).msglen ); // 9.8.2018
- 	(*pm).errc = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, &ext, &(*pm).key, (*pm).keylen, &(*pm).msg, (*pm).msglen ); // 9.8.2018
-	pthread_mutex_unlock( &(*(*pm).cm).send );
+	if( memc_conn_acquire( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) )==1 ){ // 19.10.2026
+		MEMCTRACE( (*pm).cm, pm, MEMCTRACEACQUIRE, (*pm).special==MEMCREPLACE ? MEMCREPLACE : MEMCSET, CBSUCCESS );
+		start = memc_stats_begin( &(*(*pm).cm), (*pm).cindx );
+	 	//1.10.2018: (*pm).errc = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, &ext, &(*(*pm).key), (*pm).keylen, &(*(*pm).msg), (*pm).msglen ); // 9.8.2018
+	 	(*pm).errc = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, &ext, &(*pm).key, (*pm).keylen, &(*pm).msg, (*pm).msglen ); // 9.8.2018
+		MEMCTRACE( (*pm).cm, pm, MEMCTRACESENT, (*pm).special==MEMCREPLACE ? MEMCREPLACE : MEMCSET, (*pm).errc );
+	}else{
+		(*pm).errc = MEMCERRCONNECT;
+		hdr.status = 0x00;
+	}
 
 	if( (*pm).errc<CBNEGATION ){
 		/*
@@ -1278,10 +4236,19 @@ indx = 0;
 		hdr.body_length = 0;
 		hdr.extras_length = 0;
 		hdr.key_length = 0;
-		pthread_mutex_lock( &(*(*pm).cm).recv );
+		memc_trace_first_byte( &(*pm), (*pm).special==MEMCREPLACE ? MEMCREPLACE : MEMCSET ); // 19.10.2026
 		(*pm).errc = memc_recv( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, NULL, NULL, 0, NULL, NULL, 0 ); // 9.8.2018
-		pthread_mutex_unlock( &(*(*pm).cm).recv );
+		MEMCTRACE( (*pm).cm, pm, MEMCTRACEPARSED, (*pm).special==MEMCREPLACE ? MEMCREPLACE : MEMCSET, (*pm).errc );
+		if( (*pm).errc==CBSUCCESS && hdr.magic==MEMCRESPONCE ) in = 24 + hdr.body_length;
+	}else{
+		hdr.status = 0x00;
 	}
+	memc_stats_end( &(*(*pm).cm), (*pm).cindx, ( (*pm).special==MEMCREPLACE ) ? MEMCSTATSREPLACE : MEMCSTATSSET, start, (*pm).errc, \
+		hdr.status, ( start!=0 ) ? 32 + (unsigned long int) (*pm).keylen + (*pm).msglen : 0, in ); // 19.10.2026
+	if( (*(*pm).cm).slowlog!=NULL )
+		memc_slowlog_put( &(*pm), ( (*pm).special==MEMCREPLACE ) ? MEMCREPLACE : MEMCSET, ( (*pm).errc!=CBSUCCESS ) ? (*pm).errc : (int) hdr.status, (int) (*pm).keylen, (*pm).msglen );
+	if( (*pm).errc!=MEMCERRCONNECT )
+		memc_conn_release( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]), (*pm).errc ); // 19.10.2026
 	if( (*pm).errc<CBNEGATION ){
 		if( hdr.cas>4294967296 ) (*pm).errc = CBOVERFLOW;
 		(*pm).cas = (unsigned int) hdr.cas;
@@ -1289,35 +4256,53 @@ indx = 0;
 	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = (*pm).errc; // 9.8.2018
 	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).laststatus = hdr.status; // 9.8.2018
 
-	--( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing ); // 9.8.2018
-	if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing<0 )
-		(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing = 0;
-
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wthread-safety-analysis"
-	pthread_mutex_unlock( &(*(*pm).cm).set );
-#pragma clang diagnostic pop
-	memc_free_param( pm );
+	/*
+	 * Again after the server has the value, a GET during the write may have read the old one, 19.10.2026. */
+	if( (*(*pm).cm).nearcache!=NULL )
+		memc_nearcache_invalidate( &(*(*pm).cm), &(*pm).key, (int) (*pm).keylen );
+	if( (*(*pm).cm).shmcache!=NULL )
+		memc_shmcache_invalidate( &(*(*pm).cm), &(*pm).key[0], (int) (*pm).keylen );
+	if( (*(*pm).cm).negcache!=NULL )
+		memc_negcache_invalidate( &(*(*pm).cm), &(*pm).key[0], (int) (*pm).keylen );
+	if( (*(*pm).cm).flight_created!=0 )
+		memc_flight_invalidate( &(*(*pm).cm), &(*pm).key[0], (int) (*pm).keylen );
+
+	memc_processing_dec( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) ); // 9.8.2018, 19.10.2026
+
+	memc_thread_done( pm, ( (*pm).errc!=CBSUCCESS ) ? (*pm).errc : (int) hdr.status ); // the status of the server to memc_wait_key, 19.10.2026
 	pm = NULL;
-	cb_flush_log();
+	MEMCFLUSHLOG();
 	pthread_exit( NULL );
 	return NULL; // 10.7.2018
 }
 
 int  memc_delete( MEMC *cm, uchar **key, int keylen, uint cas, ushort vbucketid ){
 	int indx = 0, err = CBSUCCESS;
+	uint keyhash = 0, traceid = 0;
 	MEMC_parameter *pm = NULL;
+	memc_trace_fanout *fanout = NULL;
 	if( cm==NULL ) return CBERRALLOC;
 	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
 	if( key==NULL || *key==NULL ) return CBERRALLOC;
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_DELETE"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_DELETE"); MEMCFLUSHLOG();
+
+	if( (*cm).nearcache!=NULL )
+		memc_nearcache_invalidate( &(*cm), &(*key), keylen ); // 19.10.2026
+	if( (*cm).shmcache!=NULL )
+		memc_shmcache_invalidate( &(*cm), &(**key), keylen );
+	if( (*cm).negcache!=NULL )
+		memc_negcache_invalidate( &(*cm), &(**key), keylen );
 
 	/*
 	 * Join at start if needed. Every redundant server at
 	 * the same time. */
-	err = memc_join_previous( &(*cm) ); // from connect or from previous command
-	if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_delete: memc_join_previous, error %i.", err ); }
+	memc_fork_reconnect( &(*cm), 1 ); // in a forked child, 19.10.2026
+	keyhash = memc_key_order( &(**key), keylen ); // 19.10.2026
+	err = memc_join_key( &(*cm), keyhash, NULL ); // from connect or from previous command of the key
+	if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_delete: memc_join_key, error %i.", err ); }
+	if( keylen<0 || keylen>65536 ) return CBOVERFLOW;
+	fanout = memc_trace_fanout_start( &(*cm), MEMCDELETE, &traceid, &(**key), keylen, 0 ); // NULL if not traced or captured, 19.10.2026
 
 	/*
 	 * Delete the key from all of the connections. */
@@ -1325,15 +4310,15 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_DELETE"); cb_flush_log();
 
 	   /*
 	    * Parameters. */
-	   pm = (void*) malloc( sizeof( void* ) ); // 9.8.2017, 31.10.2018
-	   if( pm==NULL ) return CBERRALLOC;
-	   err = memc_get_param( &pm );
-	   if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_delete: memc_get_param, error %i.", err ); }
+	   err = memc_get_param( &(*cm), &pm ); // 19.10.2026
+	   if( err>=CBERROR || pm==NULL ){
+		MEMCLOG( CBLOGDEBUG, err, "\nmemc_delete: memc_get_param, error %i.", err );
+		memc_trace_fanout_done( &(*cm), &(*fanout), CBERRALLOC );
+		return CBERRALLOC;
+	   }
 
 	   (*pm).cm = &(*cm);
 	   (*pm).key = &(**key);
-	   if( keylen<0 ) return CBOVERFLOW;
-	   if( keylen>65536 ) return CBOVERFLOW;
 	   (*pm).keylen = (ushort) keylen;
 	   (*pm).msg = NULL;
 	   (*pm).msglen = 0;
@@ -1341,75 +4326,94 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_DELETE"); cb_flush_log();
 	   (*pm).cas = cas;
 	   (*pm).vbucketid = vbucketid;
 	   (*pm).cindx = indx; // 11.8.2018
+	   (*pm).trace_id = traceid; // 19.10.2026
+	   MEMCTRACE( cm, pm, MEMCTRACEROUTE, MEMCDELETE, CBSUCCESS );
+	   MEMCPROBE4( submit, MEMCDELETE, keylen, 0, traceid );
+	   if( fanout!=NULL ){
+		__atomic_add_fetch( &(*fanout).pending, 1, __ATOMIC_ACQ_REL );
+		(*pm).trace_fanout = &(*fanout);
+	   }
 
-	   ++( (*(*(*cm).token).conn[ indx ]).processing ); // 19.7.2018, 9.8.2018
-	   (*(*(*cm).token).conn[ (*pm).cindx ]).thr_created = 0;
-	   err = pthread_create( &(*(*(*cm).token).conn[ indx ]).thr, NULL, &memc_delete_thr, pm ); // pointer pm is copied, 9.7.2018
+	   memc_processing_inc( &(*(*(*cm).token).conn[ indx ]) ); // 19.7.2018, 9.8.2018
+	   err = memc_start_thread( &(*cm), &(*pm), &memc_delete_thr, keyhash ); // pointer pm is copied, 9.7.2018, 19.10.2026
 	   if( err!=0 ){
-              cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_delete: pthread_create, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
-	   }else{
-	      (*(*(*cm).token).conn[ (*pm).cindx ]).thr_created = 1;
+              MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_delete: pthread_create, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
+	      memc_processing_dec( &(*(*(*cm).token).conn[ indx ]) ); // 19.10.2026
+	      if( fanout!=NULL )
+		memc_trace_fanout_done( &(*cm), &(*fanout), MEMCERRTHREAD );
+	      memc_free_param( pm );
 	   }
+	   pm = NULL;
 	}
+	memc_trace_fanout_done( &(*cm), &(*fanout), CBSUCCESS ); // 19.10.2026
 	return CBSUCCESS;
 }
 void* memc_delete_thr( void *prm ){
+	int err = MEMCERRCONNECT;
+	unsigned long int in = 0;
+	unsigned long long int start = 0;
 	memc_msg hdr;
 	MEMC_parameter *pm;
 	if( prm==NULL && (* (MEMC_parameter*) prm).cm==NULL ) 
 		pthread_exit( NULL );
-	pthread_mutex_lock( &(*(* (MEMC_parameter*) prm).cm).set );
-	pm = &(* (MEMC_parameter*) prm);
+	pm = &(* (MEMC_parameter*) prm); // the connection is acquired, the MEMC is not locked, 19.10.2026
 	if( pm==NULL || (*pm).key==NULL ){
-	  cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_delete_thr, error %i.", CBERRALLOCTHR );
-	  cb_flush_log();
+	  MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_delete_thr, error %i.", CBERRALLOCTHR );
+	  MEMCFLUSHLOG();
 	  if( (*(*pm).cm).token!=NULL ){
-	     --( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing ); // 9.8.2018
-	     if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing<0 )
-	  	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing = 0;
+	     memc_processing_dec( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) ); // 9.8.2018, 19.10.2026
 	  }
+	  memc_thread_done( pm, CBERRALLOCTHR );
 	  pthread_exit( NULL );
 	  return NULL;
 	}
 	if( (*pm).cm==NULL || (*(*pm).cm).token==NULL ){
-	  cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_delete_thr, error %i.", CBERRALLOCTHR );
-	  cb_flush_log();
-	  --( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing ); // 9.8.2018
-	  if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing<0 )
-		(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing = 0;
+	  MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_delete_thr, error %i.", CBERRALLOCTHR );
+	  MEMCFLUSHLOG();
+	  memc_processing_dec( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) ); // 9.8.2018, 19.10.2026
+	  memc_thread_done( pm, CBERRALLOCTHR );
 	  pthread_exit( NULL );
 	  return NULL;
 	}
 
-	hdr.magic = MEMCREQUEST; hdr.opcode = MEMCDELETE; hdr.data_type = MEMCDATATYPE; hdr.vbucket_id = (*pm).vbucketid;
-	hdr.key_length = (*pm).keylen; 
-	hdr.extras_length = 0 ; // delete
-	hdr.body_length = (*pm).keylen ; // delete
-	hdr.opaque = 0x02; hdr.cas = (*pm).cas;
+	memc_hdr_request( &hdr, MEMCDELETE, (*pm).keylen, (*pm).keylen, (*pm).vbucketid, (*pm).cas ); // delete
 
 	if( (*(*(*pm).cm).token).conn==NULL || (*(*(*pm).cm).token).conn[ (*pm).cindx ]==NULL ) goto memc_delete_thr_exit; // 31.1.2019
 
-	if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).connected == 1 ){
-		pthread_mutex_lock( &(*(*pm).cm).send );
-		(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, &(*pm).key, (*pm).keylen, NULL, 0 );
-		pthread_mutex_unlock( &(*(*pm).cm).send );
-		if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr<CBNEGATION ){
-			pthread_mutex_lock( &(*(*pm).cm).recv );
-			(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = memc_recv( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, NULL, NULL, 0, NULL, NULL, 0 );
-			pthread_mutex_unlock( &(*(*pm).cm).recv );
+	if( memc_conn_acquire( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) )==1 ){ // 19.10.2026
+		MEMCTRACE( (*pm).cm, pm, MEMCTRACEACQUIRE, MEMCDELETE, CBSUCCESS );
+		start = memc_stats_begin( &(*(*pm).cm), (*pm).cindx );
+		err = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, &(*pm).key, (*pm).keylen, NULL, 0 );
+		MEMCTRACE( (*pm).cm, pm, MEMCTRACESENT, MEMCDELETE, err );
+		if( err<CBNEGATION ){
+			memc_trace_first_byte( &(*pm), MEMCDELETE );
+			err = memc_recv( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, NULL, NULL, 0, NULL, NULL, 0 );
+			MEMCTRACE( (*pm).cm, pm, MEMCTRACEPARSED, MEMCDELETE, err );
+			if( err==CBSUCCESS && hdr.magic==MEMCRESPONCE ) in = 24 + hdr.body_length;
+		}else{
+			hdr.status = 0x00;
 		}
-		--( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing ); // 9.8.2018
-		if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing<0 )
-			(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing = 0;
+		(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = err; // while acquired
+		memc_conn_release( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]), err );
+	}else{
+		(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = MEMCERRCONNECT; // 19.10.2026
+		hdr.status = 0x00;
 	}
+	memc_stats_end( &(*(*pm).cm), (*pm).cindx, MEMCSTATSDELETE, start, err, hdr.status, ( start!=0 ) ? 24 + (unsigned long int) (*pm).keylen : 0, in ); // 19.10.2026
+	if( (*(*pm).cm).slowlog!=NULL )
+		memc_slowlog_put( &(*pm), MEMCDELETE, ( err!=CBSUCCESS ) ? err : (int) hdr.status, (int) (*pm).keylen, 0 );
+	if( (*(*pm).cm).nearcache!=NULL )
+		memc_nearcache_invalidate( &(*(*pm).cm), &(*pm).key, (int) (*pm).keylen ); // after the server, 19.10.2026
+	if( (*(*pm).cm).shmcache!=NULL )
+		memc_shmcache_invalidate( &(*(*pm).cm), &(*pm).key[0], (int) (*pm).keylen );
+	if( (*(*pm).cm).negcache!=NULL )
+		memc_negcache_invalidate( &(*(*pm).cm), &(*pm).key[0], (int) (*pm).keylen );
+	if( (*(*pm).cm).flight_created!=0 )
+		memc_flight_invalidate( &(*(*pm).cm), &(*pm).key[0], (int) (*pm).keylen );
+	memc_processing_dec( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) ); // 9.8.2018, 19.10.2026
 memc_delete_thr_exit:
-// pointer is copied, thread-safety-analysis, 11.10.2018
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wthread-safety-analysis"
-	pthread_mutex_unlock( &(*(*pm).cm).set );
-#pragma clang diagnostic pop
-	memc_free_param( pm );
-	cb_flush_log();
+	memc_thread_done( pm, ( err!=CBSUCCESS ) ? err : (int) hdr.status ); // 19.10.2026
+	MEMCFLUSHLOG();
 	pm = NULL;
 	pthread_exit( NULL );
 	return NULL;
@@ -1424,26 +4428,24 @@ int  memc_quit( MEMC *cm ){
 	if( cm==NULL ) return CBERRALLOC;
 	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_QUIT"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_QUIT"); MEMCFLUSHLOG();
 
 	/*
 	 * Wait for the previous data to be updated. */
 	err = memc_join_previous( &(*cm) ); // from connect or from previous command
-	if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_quit: memc_join_previous, error %i.", err ); }
+	if( err>=CBERROR ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_quit: memc_join_previous, error %i.", err ); }
 
 	/*
 	 * Quit each. */
 	for( indx=0; indx<(*cm).redundant_servers_count; ++indx ){ // 20.7.2018
 
-	   if( (*(*cm).token).conn==NULL && (*(*cm).token).conn[ (*pm).cindx ]==NULL ){ // 31.1.2019
-	     if( (*(*(*cm).token).conn[ indx ]).connected==1 || (*(*(*cm).token).conn[ indx ]).fd>=0  ){
+	   if( (*(*cm).token).conn!=NULL && (*(*cm).token).conn[ indx ]!=NULL ){ // 31.1.2019, 19.10.2026
+	     if( memc_conn_state( &(*(*(*cm).token).conn[ indx ]) )!=MEMCCONNIDLE || (*(*(*cm).token).conn[ indx ]).fd>=0  ){
 
 	       /*
 	        * Parameters. */
-	       pm = (void*) malloc( sizeof( void* ) ); // 9.8.2017, 31.10.2018
-	       if( pm==NULL ) return CBERRALLOC;
-	       err = memc_get_param( &pm );
-	       if( err>=CBERROR ){ cb_clog( CBLOGDEBUG, err, "\nmemc_quit: memc_get_param, error %i.", err ); }
+	       err = memc_get_param( &(*cm), &pm ); // 19.10.2026
+	       if( err>=CBERROR || pm==NULL ){ MEMCLOG( CBLOGDEBUG, err, "\nmemc_quit: memc_get_param, error %i.", err ); return CBERRALLOC; }
 
 	       (*pm).cm = &(*cm);
 	       (*pm).key = NULL;
@@ -1455,16 +4457,15 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_QUIT"); cb_flush_log();
 	       (*pm).vbucketid = 0x00;
 	       (*pm).cindx = indx; // 9.8.2018
 
-	       ++( (*(*(*cm).token).conn[ indx ]).processing ); // 19.7.2018, 9.8.2018
-	       (*(*(*cm).token).conn[ (*pm).cindx ]).thr_created = 0;
-	       err = pthread_create( &(*(*(*cm).token).conn[ indx ]).thr, NULL, &memc_quit_thr, pm ); // pointer pm is copied, 9.7.2018
+	       memc_processing_inc( &(*(*(*cm).token).conn[ indx ]) ); // 19.7.2018, 9.8.2018
+	       err = memc_start_thread( &(*cm), &(*pm), &memc_quit_thr, 0 ); // pointer pm is copied, 9.7.2018, 19.10.2026
 	       if( err!=0 ){
-                  cb_clog( CBLOGERR, MEMCERRTHREAD, "\nmemc_quit: pthread_create, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
-	       }else{
-	          (*(*(*cm).token).conn[ (*pm).cindx ]).thr_created = 1;
+                  MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_quit: pthread_create, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
+	          memc_processing_dec( &(*(*(*cm).token).conn[ indx ]) ); // 19.10.2026
+	          memc_free_param( pm );
 	       }
 	     }else{
-	       cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_quit: fail: connected %i, fd %i.", (*(*(*cm).token).conn[ indx ]).connected, (*(*(*cm).token).conn[ indx ]).fd );
+	       MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_quit: fail: connected %i, fd %i.", (*(*(*cm).token).conn[ indx ]).connected, (*(*(*cm).token).conn[ indx ]).fd );
 	     }
 	     pm = NULL; // 20.7.2018
 	   }
@@ -1474,6 +4475,7 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_QUIT"); cb_flush_log();
 }
 void* memc_quit_thr( void *prm ){
 	ssize_t len;
+	unsigned long long int start = 0;
 	memc_msg hdr;
 	MEMC_parameter *pm = NULL;
 	if( prm==NULL || (* (MEMC_parameter*) prm).cm==NULL )
@@ -1482,41 +4484,41 @@ void* memc_quit_thr( void *prm ){
 	len = 0; // 11.10.2018
 	pm = &(* (MEMC_parameter*) prm);
 	if( pm==NULL || (*pm).cm==NULL || (*(*pm).cm).token==NULL ){
-	  cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_quit_thr, error CBERRALLOCTHR (1) " );
+	  MEMCLOG( CBLOGDEBUG, CBNEGATION, "\nmemc_quit_thr, error CBERRALLOCTHR (1) " );
 	  if( pm==NULL ){
-		cb_clog( CBLOGDEBUG, CBNEGATION, "pm was null." );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "pm was null." );
 	  }else if( (*pm).cm==NULL ){
-		cb_clog( CBLOGDEBUG, CBNEGATION, "cm was null." );
+		MEMCLOG( CBLOGDEBUG, CBNEGATION, "cm was null." );
 	  }else if( (*(*pm).cm).token==NULL ){
-		cb_clog( CBLOGDEBUG, MEMCUNINITIALIZED, "token was null, error MEMCUNINITIALIZED." );
+		MEMCLOG( CBLOGDEBUG, MEMCUNINITIALIZED, "token was null, error MEMCUNINITIALIZED." );
 	  }
-	  cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_quit_thr, error %i (1) ", CBERRALLOCTHR );
-	  cb_flush_log();
+	  MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_quit_thr, error %i (1) ", CBERRALLOCTHR );
+	  MEMCFLUSHLOG();
 	  pthread_mutex_unlock( &(*(* (MEMC_parameter*) prm).cm).quit );
+	  memc_thread_done( pm, CBERRALLOCTHR ); // 19.10.2026
 	  pthread_exit( NULL );
 	  return NULL;
 	}
 
-	if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).connected==1 && (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd>=0 ){ // 20.7.2018
-		hdr.magic = MEMCREQUEST; hdr.opcode = MEMCQUIT; hdr.data_type = MEMCDATATYPE; hdr.vbucket_id = (*pm).vbucketid;
-		hdr.key_length = (*pm).keylen;
-		hdr.extras_length = 0x00 ; // quit
-		hdr.body_length = (*pm).msglen ;
-		hdr.opaque = 0x02; hdr.cas = (*pm).cas;
+	if( memc_conn_acquire( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) )==1 && \
+	    memc_conn_transition( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]), MEMCCONNBUSY, MEMCCONNCLOSING )==1 && \
+	    (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd>=0 ){ // 20.7.2018, 19.10.2026
+		memc_hdr_request( &hdr, MEMCQUIT, (*pm).keylen, (*pm).msglen, (*pm).vbucketid, (*pm).cas ); // quit
 
-		pthread_mutex_lock( &(*(*pm).cm).send );
+		start = memc_stats_begin( &(*(*pm).cm), (*pm).cindx ); // 19.10.2026
 		(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = memc_send( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, NULL, 0, NULL, 0 );
-		pthread_mutex_unlock( &(*(*pm).cm).send );
 		if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr<CBNEGATION ){
 
 			hdr.body_length = 0;
 			hdr.extras_length = 0;
 			hdr.key_length = 0;
-			pthread_mutex_lock( &(*(*pm).cm).recv );
  			(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr = memc_recv( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd, &hdr, NULL, NULL, NULL, 0, NULL, NULL, 0 );
-			pthread_mutex_unlock( &(*(*pm).cm).recv );
 
+		}else{
+			hdr.status = 0x00;
 		}
+		memc_stats_end( &(*(*pm).cm), (*pm).cindx, MEMCSTATSQUIT, start, (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr, hdr.status, 24, \
+			( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr<CBNEGATION ) ? 24 + hdr.body_length : 0 );
 
 		/*
 		 * Shutdown connection. */
@@ -1533,9 +4535,8 @@ void* memc_quit_thr( void *prm ){
 	}
 	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).connected = 0;
 	(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).fd = -1;
-	--( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing ); // 9.8.2018
-	if( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing<0 )
-		(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).processing = 0;
+	memc_conn_store( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]), MEMCCONNIDLE ); // 19.10.2026
+	memc_processing_dec( &(*(*(*(*pm).cm).token).conn[ (*pm).cindx ]) ); // 9.8.2018, 19.10.2026
 
 // pointer is copied, thread-safety-analysis, 11.10.2018
 #pragma clang diagnostic push
@@ -1543,75 +4544,44 @@ void* memc_quit_thr( void *prm ){
 	pthread_mutex_unlock( &(*(*pm).cm).quit );
 #pragma clang diagnostic pop
 
-	memc_free_param( pm );
+	memc_thread_done( pm, ( (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr!=CBSUCCESS ) ? (*(*(*(*pm).cm).token).conn[ (*pm).cindx ]).lasterr : (int) hdr.status ); // 19.10.2026
 	pm = NULL;
 
-	cb_flush_log();
+	MEMCFLUSHLOG();
 	pthread_exit( NULL );
 	return NULL;
 }
 
 /*
- * Converts to 'memcached' big endian format, 8.8.2018. */
+ * Converts to 'memcached' big endian format, 8.8.2018. Both ways, byte order of
+ * the host at compile time, 19.10.2026. */
 int  memc_hdr_to_big_endian( memc_msg *hdr ){ // all shorts, ints and long ints
-	ushort new16 = 0;
-	uint   new32 = 0;
-	uint   tmp32 = 0;
-	unsigned long long int new64 = 0;
 	if( hdr==NULL ) return CBERRALLOC;
-	if( cb_test_cpu_endianness()==CBBIGENDIAN ){ 
-		cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_hdr_to_big_endian: was in big endian format, %i.", cb_test_cpu_endianness() );
-		return CBSUCCESS; 
-	}
-
-	new16 = (ushort) cb_reverse_two_bytes( (uint) (*hdr).key_length ) ;
-	(*hdr).key_length = (ushort) new16 ;
-
-	new16 = (ushort) cb_reverse_two_bytes( (uint) (*hdr).status ) ;
-	(*hdr).status = (ushort) new16;
-
-	// ends
-	new32 = (*hdr).body_length>>24;
-	tmp32 = (*hdr).body_length<<24; 
-	new64 = ( 0x000000FF & new32 ) | ( 0xFF000000 & tmp32 );
-	// middle
-	new32 = (*hdr).body_length>>8;
-	tmp32 = (*hdr).body_length<<8;
-	(*hdr).body_length = ( 0x0000FF00 & new32 ) | ( 0x00FF0000 & tmp32 );
-	// together
-	new32 = (*hdr).body_length;
-	(*hdr).body_length = (unsigned int) new64 | new32 ;
-	new32 = (uint) cb_reverse_four_bytes( (uint) (*hdr).opaque ) ;
-	(*hdr).opaque = (uint) new32;
-	
-	new64 = (uint) cb_reverse_four_bytes( (uint) (*hdr).cas ) ;
-	tmp32 = (uint) ( (*hdr).cas>>32 ) ;
-	new32 = (uint) cb_reverse_four_bytes( (uint) tmp32 ) ;
-	(*hdr).cas = new64<<32;
-	(*hdr).cas = ( (*hdr).cas ) | new32;
-
+	(*hdr).key_length = MEMCHTON16( (*hdr).key_length );
+	(*hdr).status = MEMCHTON16( (*hdr).status );
+	(*hdr).body_length = MEMCHTON32( (*hdr).body_length );
+	(*hdr).opaque = MEMCHTON32( (*hdr).opaque );
+	(*hdr).cas = MEMCHTON64( (*hdr).cas );
 	return CBSUCCESS;
 }
 int  memc_ext_to_big_endian( memc_extras *ext ){
-	ushort new32 = 0;
 	if( ext==NULL ) return CBERRALLOC;
-	if( cb_test_cpu_endianness()==CBBIGENDIAN ){ 
-		cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_ext_to_big_endian: was in big endian format, %i.", cb_test_cpu_endianness() );
-		return CBSUCCESS; 
-	}
-
-	new32 = (ushort) cb_reverse_four_bytes( (uint) (*ext).flags ) ;
-	(*ext).flags = new32;
-
-	new32 = (ushort) cb_reverse_four_bytes( (uint) (*ext).expiration ) ;
-	(*ext).expiration = new32;
-
+	(*ext).flags = MEMCHTON32( (*ext).flags );
+	(*ext).expiration = MEMCHTON32( (*ext).expiration );
 	return CBSUCCESS;
 }
+void  memc_hdr_request( memc_msg *hdr, uchar opcode, ushort keylen, uint bodylen, ushort vbucketid, unsigned long long int cas ){
+	memcpy( &(*hdr), &memc_hdr_templates[ opcode % MEMCTEMPLATES ], sizeof( memc_msg ) );
+	(*hdr).key_length = MEMCHTON16( keylen );
+	(*hdr).vbucket_id = MEMCHTON16( vbucketid );
+	(*hdr).body_length = MEMCHTON32( bodylen );
+	(*hdr).cas = MEMCHTON64( cas );
+}
 
 /*
- * Converts header and extras to memcached big endian format. Does not convert
- * the key or the value (because the encoding is not known). 
+ * 'hdr' is in the network byte order (memc_hdr_request), 19.10.2026. Converts the
+ * extras to memcached big endian format. Does not convert the key or the value
+ * (because the encoding is not known). 
  *
  *  - Convert your key and value in some appropriate big endian encoding or the
  *    network byte order encoding of the 'memcached' (to use big and little endian 
@@ -1619,77 +4589,56 @@ int  memc_ext_to_big_endian( memc_extras *ext ){
  *
  */
 int  memc_send( int sockfd, memc_msg *hdr, memc_extras *ext, uchar **key, ushort keylen, uchar **msg, uint msglen ){
-	int len = 0, total = 0; // , indx = 0;
+	int cnt = 0, indx = 0;
+	ssize_t len = 0;
+	size_t total = 0;
+	struct iovec iov[ 4 ];
 	if( sockfd<0 ) return CBERRFILEOP;
 	if( hdr==NULL ) return CBERRALLOC;
-	memc_hdr_to_big_endian( &(*hdr) );
-	//len = send( sockfd, &(*hdr), (size_t) 24, 0x00 );  // header
-	len = (int) write( sockfd, &(* (void*) hdr), (size_t) 24 );  // header
-	if( len>0 ) total+=len;
-	if( len>0 && len!=24 ) return MEMCSENDINVALIDHDRERR;
-	if( len>=0 && ext!=NULL ){
+	MEMCPROBE4( send, sockfd, (*hdr).opcode, keylen, msglen ); // 19.10.2026
+
+	/*
+	 * One write of the header, extras, key and message. Written separately, the key waited
+	 * for the acknowledgement of the header (Nagle and delayed ACK), 19.10.2026. */
+	iov[ cnt ].iov_base = &(* (void*) hdr);
+	iov[ cnt++ ].iov_len = 24;
+	if( ext!=NULL ){
 		memc_ext_to_big_endian( &(*ext) );
-		//len = send( sockfd, &(*ext), (size_t) (*hdr).extras_length, 0x00 );  // extras
-		len = (int) write( sockfd, &(* (void*) ext), (size_t) (*hdr).extras_length );  // extras
-		if( len>0 ) total+=len;
-		if( len!=(*hdr).extras_length ){
-			cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_send: write, written extras length %i was not the extras length %i.", len, (int) (*hdr).extras_length );
-			return MEMCSENDINVALIDEXTERR;
-		}
-	}else if( ext!=NULL ){ // 18.7.2018
-		return MEMCSENDHDRERR; 
-	}
-	if( len>=0 && key!=NULL && *key!=NULL && keylen>0 ){
-		//len = send( sockfd, &(**key), (size_t) keylen, 0x00 );    // key
-		len = (int) write( sockfd, &(**key), (size_t) keylen );    // key
-/***
-cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_send: write, WROTE %i LENGTH of THE KEY %i [", len, keylen );
-if( len>0 ){
-	for( indx=0; indx<len; ++indx )
-		cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*key)[indx] );
-}
-cb_clog( CBLOGDEBUG, CBNEGATION, "] [");
-if( len>0 ){
-	for( indx=0; indx<len; ++indx )
-		cb_clog( CBLOGDEBUG, CBNEGATION, "%.2X", (*key)[indx] );
-}
-cb_clog( CBLOGDEBUG, CBNEGATION, "]");
- ***/
-		if( len>0 ) total+=len;
-		if( len!=keylen ){
-			cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_send: write, written key length %i was not the key length %i.", len, keylen );
-			return MEMCSENDINVALIDKEYERR;
-		}
+		iov[ cnt ].iov_base = &(* (void*) ext);
+		iov[ cnt++ ].iov_len = (size_t) (*hdr).extras_length;
+	}
+	if( key!=NULL && *key!=NULL && keylen>0 ){
+		iov[ cnt ].iov_base = &(**key);
+		iov[ cnt++ ].iov_len = (size_t) keylen;
 	}else if( key!=NULL ){
 		return MEMCSENDEXTERR;
 	}
-	if( len>=0 && msg!=NULL && *msg!=NULL && msglen>0 ){
-		//len = send( sockfd, &(**msg), (size_t) msglen, MSG_EOR ); // message completes record (tested: does not work)
-		//len = send( sockfd, &(**msg), (size_t) msglen, MSG_EOF ); // message completes transaction
-		len = (int) write( sockfd, &(**msg), (size_t) msglen ); // 'message length bytes hopefully sent at this point'
-/***
-cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_send: write, WROTE %i LENGTH of THE MESSAGE %i [", len, (int) msglen );
-if( len>0 ){
-	for( indx=0; indx<len; ++indx )
-		cb_clog( CBLOGDEBUG, CBNEGATION, "%c", (*msg)[indx] );
-}
-cb_clog( CBLOGDEBUG, CBNEGATION, "]");
- ***/
-		if( len>0 ) total+=len;
-		if( len!=(int)msglen ){
-			cb_clog( CBLOGDEBUG, CBNEGATION, "\nmemc_send: write, written msg length %i was not the message length %i.", len, (int) msglen );
-			return MEMCSENDINVALIDMSGERR;
-		}
+	if( msg!=NULL && *msg!=NULL && msglen>0 ){
+		iov[ cnt ].iov_base = &(**msg);
+		iov[ cnt++ ].iov_len = (size_t) msglen;
 	}else if( msg!=NULL ){ 
 		return MEMCSENDKEYERR; 
 	}
-	if( len<0 ){ 
-		cb_clog( CBLOGDEBUG, CBERRFILEOP, "\nmemc_send:  %i errno %i '%s'.", len, errno, strerror( errno ) ); 
-		return MEMCSENDMSGERR; 
-	}else if( len!=(int)msglen && msg!=NULL ){ // 18.7.2018
-		cb_clog( CBLOGDEBUG, CBERRFILEOP, "\nmemc_send:  could not write the header length data, %i errno %i '%s'.", len, errno, strerror( errno ) ); 
-		return MEMCSENDINVALIDMSGERR;
+
+	while( indx<cnt ){
+		len = writev( sockfd, &iov[ indx ], cnt - indx );
+		if( len<0 && errno==EINTR ) continue;
+		if( len<=0 ){
+			memc_io_errno = ( len<0 ) ? errno : 0 ; // before the log
+			MEMCLOG( CBLOGDEBUG, CBERRFILEOP, "\nmemc_send: writev %zi, written %zu, errno %i '%s'.", len, total, errno, strerror( errno ) ); 
+			return ( total==0 ) ? MEMCSENDMSGERR : MEMCSENDINVALIDMSGERR;
+		}
+		total += (size_t) len;
+		while( indx<cnt && (size_t) len>=iov[ indx ].iov_len ){
+			len -= (ssize_t) iov[ indx ].iov_len;
+			++indx;
+		}
+		if( indx<cnt ){ // partly written
+			iov[ indx ].iov_base = &( (uchar*) iov[ indx ].iov_base )[ len ];
+			iov[ indx ].iov_len -= (size_t) len;
+		}
 	}
+	MEMCPROBE2( sent, sockfd, total ); // 19.10.2026
 	return CBSUCCESS; // 25.8.2018
 }
 
@@ -1699,29 +4648,30 @@ int  memc_recv( int sockfd, memc_msg *hdr, memc_extras *ext, uchar **key, ushort
 	if( hdr==NULL ) return CBERRALLOC;
 	if( msglen!=NULL)
 		*msglen = 0; // body length is zero before reading anything
+	MEMCPROBE1( recv, sockfd ); // 19.10.2026
 
 	//len = recv( sockfd, &(*hdr), (size_t) 24, MSG_WAITALL );  // header
-	len = (int) read( sockfd, &(* (void*) hdr), (size_t) 24 );  // header
+	len = memc_read( sockfd, &(* (void*) hdr), (size_t) 24 );  // header
 
 /***
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_recv: STATUS %.4X (vbucket %.4X) ", (*hdr).status, (*hdr).vbucket_id );
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_recv: STATUS %.4X (vbucket %.4X) ", (*hdr).status, (*hdr).vbucket_id );
 memc_print_err( (int) (*hdr).status ); // 30.8.2018
 memc_print_err( (int) (*hdr).vbucket_id ); // 30.8.2018, 16.9.2018
  ***/
 	memc_hdr_to_big_endian( &(*hdr) ); // to host byte order, 9.8.2018
 /***
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_recv: STATUS %.4X (vbucket %.4X) ", (*hdr).status, (*hdr).vbucket_id );
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_recv: STATUS %.4X (vbucket %.4X) ", (*hdr).status, (*hdr).vbucket_id );
 memc_print_err( (int) (*hdr).status ); // 30.8.2018
 memc_print_err( (int) (*hdr).vbucket_id ); // 30.8.2018, 16.9.2018
-cb_flush_log();
+MEMCFLUSHLOG();
  ***/
 	if( len>=0 ) total+=len;
 	if( len>=0 && ext!=NULL ){
 		//len = recv( sockfd, &(*ext), (*hdr).extras_length, MSG_WAITALL );  // extras
-		len = (int) read( sockfd, &(* (void*) ext), (*hdr).extras_length );  // extras
+		len = memc_read( sockfd, &(* (void*) ext), (*hdr).extras_length );  // extras
 		if( len>=0 ) total+=len;
 		if( (*hdr).extras_length!=len ){
-			cb_clog( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv: header data did not match to the extras length, %i errno %i '%s'.", len, errno, strerror( errno ) );
+			MEMCLOG( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv: header data did not match to the extras length, %i errno %i '%s'.", len, errno, strerror( errno ) );
 			return MEMCRECVINVALIDEXTERR;
 		}
 	}else if(ext!=NULL){
@@ -1729,7 +4679,7 @@ cb_flush_log();
 	}
 	if( len>=0 && key!=NULL && *key!=NULL && keylen!=NULL && *keylen>0 && (*hdr).key_length<keybuflen ){
 		//len = recv( sockfd, &(**key), (size_t) (*hdr).key_length, MSG_WAITALL );    // key
-		len = (int) read( sockfd, &(**key), (size_t) (*hdr).key_length );    // key
+		len = memc_read( sockfd, &(**key), (size_t) (*hdr).key_length );    // key
 		if( len>=0 ){ 
 			total+=len;
 			if( len>65536 ) return CBOVERFLOW;
@@ -1737,7 +4687,7 @@ cb_flush_log();
 		}else
 			*keylen = 0;
 		if( *keylen!=(*hdr).key_length ){ 
-			cb_clog( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv: header data did not match to the key length, %i errno %i '%s'.", len, errno, strerror( errno ) ); 
+			MEMCLOG( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv: header data did not match to the key length, %i errno %i '%s'.", len, errno, strerror( errno ) ); 
 			return MEMCRECVINVALIDKEYERR;
 		}
 	}else if( key!=NULL && *key!=NULL && keylen!=NULL ){
@@ -1745,41 +4695,69 @@ cb_flush_log();
 	}
 	if( len>=0 && msg!=NULL && *msg!=NULL && msglen!=NULL && (*hdr).body_length<(unsigned int)msgbuflen && (*hdr).body_length<2147483648 ){
 		//len = recv( sockfd, &(**msg), (size_t) (*hdr).body_length, MSG_WAITALL ); // message
-		len = (int) read( sockfd, &(**msg), (size_t) (*hdr).body_length ); // message
+		len = memc_read( sockfd, &(**msg), (size_t) (*hdr).body_length ); // message
 		if( len>=0 ){
 			total+=len;
 			*msglen = (unsigned int) len; // (*hdr).body_length;
 		}else
 			*msglen = 0;
 		if( *msglen!= ( ( (*hdr).body_length - (*hdr).extras_length ) - (*hdr).key_length ) ){ 
-			cb_clog( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv: header data did not match to the message length, %i errno %i '%s'.", len, errno, strerror( errno ) ); 
+			MEMCLOG( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv: header data did not match to the message length, %i errno %i '%s'.", len, errno, strerror( errno ) ); 
 			return MEMCRECVINVALIDMSGERR;
 		}
 	}else if( msg!=NULL && *msg!=NULL && msglen!=NULL ){
 		return MEMCRECVKEYERR;
+	}else if( len>=0 && key==NULL && (*hdr).body_length>( ( ext!=NULL ) ? (*hdr).extras_length : 0 ) ){
+		/*
+		 * The text of an error responce without a buffer, the next responce follows it. 19.10.2026 */
+		len = memc_recv_discard( sockfd, (*hdr).body_length - ( ( ext!=NULL ) ? (*hdr).extras_length : 0 ) );
+		if( len>=0 ) total+=len;
 	}
 	if( len<0 ){ 
-		cb_clog( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv:  %i errno %i '%s'.", len, errno, strerror( errno ) ); 
+		MEMCLOG( CBLOGDEBUG, CBERRFILEOP, "\nmemc_recv:  %i errno %i '%s'.", len, errno, strerror( errno ) ); 
 		return MEMCRECVMSGERR;
 	}
+	MEMCPROBE4( received, sockfd, (*hdr).opcode, (*hdr).status, total ); // 19.10.2026
 	return CBSUCCESS; // 19.8.2018
 }
 
+int  memc_read( int sockfd, void *buf, size_t len ){
+	ssize_t ret = read( sockfd, &(*buf), len );
+	if( ret<0 )
+		memc_io_errno = errno;
+	return (int) ret;
+}
+int  memc_recv_discard( int sockfd, uint len ){
+	int got = 0, total = 0;
+	uchar scratch[ 256 ];
+	if( len>=2147483648 ) return -1;
+	while( (uint) total<len ){
+		got = memc_read( sockfd, &scratch[0], ( len - (uint) total<sizeof( scratch ) ) ? len - (uint) total : sizeof( scratch ) );
+		if( got<0 && errno==EINTR ) continue;
+		if( got<=0 ) return -1;
+		total += got;
+	}
+	return total;
+}
+
 int  memc_allocate( MEMC **cm ){
 	int indx = 0;
 	MEMC *ptr = NULL;
 	db_conn_param *dbp = NULL;
 	dbs_conn *dbc = NULL;
+	MEMC_parameter *pm = NULL;
+	memc_completion *cpl = NULL;
+	memc_trace_fanout *fo = NULL;
 	if( cm==NULL ){
-		cb_clog( CBLOGERR, CBERRALLOC, "\nmemc_allocate: parameter was null, error %i.", CBERRALLOC );
+		MEMCLOG( CBLOGERR, CBERRALLOC, "\nmemc_allocate: parameter was null, error %i.", CBERRALLOC );
 		return CBERRALLOC;
 	}
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_ALLOCATE"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_ALLOCATE"); MEMCFLUSHLOG();
 
 	ptr = (MEMC *) malloc( sizeof( MEMC ) );
 	if( ptr==NULL ){ 
-		cb_clog( CBLOGERR, CBERRALLOC, "\nmemc_allocate: malloc returned NULL, error %i.", CBERRALLOC );
+		MEMCLOG( CBLOGERR, CBERRALLOC, "\nmemc_allocate: malloc returned NULL, error %i.", CBERRALLOC );
 		return CBERRALLOC;
 	}
 	*cm = &(*ptr);
@@ -1796,16 +4774,32 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_ALLOCATE"); cb_flush_log();
 
 	(**cm).err = 0; // 10.11.2018
 	(**cm).indx = 0; // 10.11.2018
+	(**cm).nearcache = NULL; // 19.10.2026
+	(**cm).shmcache = NULL;
+	(**cm).negcache = NULL;
+	(**cm).flights = NULL;
+	(**cm).flight_pool = NULL;
+	(**cm).flight_created = 0;
+	(**cm).flight_mallocs = 0;
+	(**cm).param_pool = NULL;
+	(**cm).param_pooled = 0;
+	(**cm).param_created = 0;
+	(**cm).param_mallocs = 0;
+	(**cm).fanout_pool = NULL;
+	(**cm).fanout_mallocs = 0;
+	(**cm).pending = NULL; // 19.10.2026
+	(**cm).completion_pool = NULL;
+	(**cm).completion_mallocs = 0;
+	(**cm).pending_created = 0;
+	(**cm).pending_count = 0;
+	(**cm).reaped = 0;
+	memset( &(**cm).reaped_err[0], 0x00, sizeof( (**cm).reaped_err ) );
 
-	//(**cm).send = PTHREAD_MUTEX_INITIALIZER;
-	//(**cm).recv = PTHREAD_MUTEX_INITIALIZER;
 	//(**cm).set = PTHREAD_MUTEX_INITIALIZER;
 	//(**cm).delete = PTHREAD_MUTEX_INITIALIZER;
 	//(**cm).quit = PTHREAD_MUTEX_INITIALIZER;
 	//(**cm).init = PTHREAD_MUTEX_INITIALIZER;
 
-	(**cm).send_created = 0;
-	(**cm).recv_created = 0;
 	(**cm).set_created = 0;
 	(**cm).delete_created = 0;
 	(**cm).quit_created = 0;
@@ -1819,7 +4813,7 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_ALLOCATE"); cb_flush_log();
 	for( indx=0; indx<MEMCMAXSESSIONDBS; ++indx ){
 		dbp = (db_conn_param*) malloc( sizeof( db_conn_param ) ); // data
 		//31.10.2018: (**cm).sesdbparams[ indx ] = (db_conn_param*) malloc( sizeof( db_conn_param ) ); // data
-		if( dbp==NULL ){ cb_clog( CBLOGERR, CBERRALLOC, "\nmemc_allocate: malloc, error %i.", CBERRALLOC); return CBERRALLOC; }
+		if( dbp==NULL ){ MEMCLOG( CBLOGERR, CBERRALLOC, "\nmemc_allocate: malloc, error %i.", CBERRALLOC); return CBERRALLOC; }
 		(*dbp).ip = NULL;
 		(*dbp).iplen = 0;
 		(*dbp).port = NULL;
@@ -1852,10 +4846,17 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_ALLOCATE"); cb_flush_log();
 		(*(**cm).token).conn[ indx ] = NULL;  
 	}
 	(*(**cm).token).conn[ MEMCMAXREDUNDANTDBS ] = NULL; // +1
+	/*
+	 * One table aligned to the cache line instead of separate mallocs, 19.10.2026. */
+	(*(**cm).token).conn_table = NULL;
+	if( posix_memalign( (void**) &(*(**cm).token).conn_table, MEMCCACHELINE, MEMCMAXREDUNDANTDBS * sizeof( dbs_conn ) )!=0 || (*(**cm).token).conn_table==NULL ){
+		(*(**cm).token).conn_table = NULL;
+		MEMCLOG( CBLOGERR, CBERRALLOC, "\nmemc_allocate: posix_memalign, error %i (2).", CBERRALLOC); return CBERRALLOC;
+	}
+	memset( &(*(*(**cm).token).conn_table), 0x00, MEMCMAXREDUNDANTDBS * sizeof( dbs_conn ) );
 	for( indx=0; indx<MEMCMAXREDUNDANTDBS; ++indx ){
-		dbc = (dbs_conn*) malloc( sizeof( dbs_conn ) ); // data
+		dbc = &(*(**cm).token).conn_table[ indx ]; // data
 		// 31.10.2018: (*(**cm).token).conn[ indx ] = (dbs_conn*) malloc( sizeof( dbs_conn ) ); // data
-		if( dbc==NULL ){ cb_clog( CBLOGERR, CBERRALLOC, "\nmemc_allocate: malloc, error %i (2).", CBERRALLOC); return CBERRALLOC; }
 		(*dbc).fd = -1;
 		(*dbc).dbsindx = -1;
 		(*dbc).thr = NULL; // 7.8.2018
@@ -1865,6 +4866,7 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_ALLOCATE"); cb_flush_log();
 		(*dbc).lasterr = 0;
 		(*dbc).laststatus = 0;
 		(*dbc).connected = 0;
+		(*dbc).state = MEMCCONNIDLE; // 19.10.2026
 		(*dbc).processing = 0;
 		//(*dbc).mtx = PTHREAD_MUTEX_INITIALIZER;
 		//(*dbc).mtxconn = PTHREAD_MUTEX_INITIALIZER;
@@ -1874,22 +4876,136 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_ALLOCATE"); cb_flush_log();
 		dbc = NULL;
 		if( (*(**cm).token).conn[ indx ] == NULL ) return CBERRALLOC;
 	}
+	/*
+	 * Completions of the request threads, not destroyed in memc_reinit, 19.10.2026. */
+	if( pthread_mutex_init( &(**cm).pend, NULL )!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_allocate: pthread_mutex_init, errno %i '%s'.", errno, strerror( errno ) );
+		return MEMCERRTHREAD;
+	}
+	if( pthread_cond_init( &(**cm).pend_cond, NULL )!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_allocate: pthread_cond_init, errno %i '%s'.", errno, strerror( errno ) );
+		pthread_mutex_destroy( &(**cm).pend );
+		return MEMCERRTHREAD;
+	}
+	(**cm).pending_created = 1;
+	for( indx=0; indx<MEMCPARAMPOOLSIZE; ++indx ){
+		cpl = (memc_completion*) malloc( sizeof( memc_completion ) );
+		if( cpl==NULL ) break;
+		(*cpl).next = (**cm).completion_pool;
+		(**cm).completion_pool = &(*cpl);
+		cpl = NULL;
+	}
+	/*
+	 * Fork handlers, 19.10.2026. */
+	(**cm).fork_next = NULL;
+	(**cm).fork_locked = 0;
+	(**cm).forked = 0;
+	(**cm).prefork = NULL;
+	memc_fork_register( &(**cm) );
+	/*
+	 * Statistics, 19.10.2026. */
+	(**cm).trace_hook = NULL; // 19.10.2026
+	(**cm).trace_arg = NULL;
+	(**cm).trace_ids = 0;
+	(**cm).slowlog = NULL;
+	(**cm).slowlog_users = 0;
+	(**cm).recorder = NULL;
+	(**cm).recorder_users = 0;
+	(**cm).stats = (memc_stats*) calloc( 1, sizeof( memc_stats ) );
+	if( (**cm).stats==NULL ){
+		MEMCLOG( CBLOGWARNING, CBERRALLOC, "\nmemc_allocate: calloc, statistics are not in use." );
+	}
+	/*
+	 * Free list of the thread parameters, not destroyed in memc_reinit, 19.10.2026. */
+	if( pthread_mutex_init( &(**cm).param, NULL )!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_allocate: pthread_mutex_init, errno %i '%s'.", errno, strerror( errno ) );
+		return CBSUCCESS; // parameters are allocated with malloc
+	}
+	(**cm).param_created = 1;
+	for( indx=0; indx<MEMCPARAMPOOLSIZE; ++indx ){
+		pm = (MEMC_parameter*) malloc( sizeof( MEMC_parameter ) );
+		if( pm==NULL ) break;
+		(*pm).next = (**cm).param_pool;
+		(**cm).param_pool = &(*pm);
+		++(**cm).param_pooled;
+		pm = NULL;
+	}
+	for( indx=0; indx<MEMCPARAMPOOLSIZE; ++indx ){
+		fo = (memc_trace_fanout*) malloc( sizeof( memc_trace_fanout ) );
+		if( fo==NULL ) break;
+		(*fo).pooled = 1;
+		(*fo).next = (**cm).fanout_pool;
+		(**cm).fanout_pool = &(*fo);
+		fo = NULL;
+	}
 	return CBSUCCESS;
 }
 int  memc_free( MEMC *cm ){
-	int errn = 0; //, indx = 0;
+	int errn = 0, indx = 0;
+	MEMC_parameter *pm = NULL;
+	memc_completion *cpl = NULL;
+	memc_trace_fanout *fo = NULL;
 	if( cm==NULL ) return CBSUCCESS;
 
-cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_FREE"); cb_flush_log();
+MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nMEMC_FREE"); MEMCFLUSHLOG();
+
+	if( (*cm).pending_created!=0 )
+		memc_fork_unregister( &(*cm) ); // 19.10.2026, registered with the completions
+	memc_wait_pending( &(*cm), 0, -1, 1, NULL ); // 19.10.2026
 
 	errn = memc_close_mutexes( &(*cm) ); // 11.9.2018
-	if( errn!=CBSUCCESS ){ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nmemc_free: memc_close_mutexes, error %i", errn ); }
+	if( errn!=CBSUCCESS ){ MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_free: memc_close_mutexes, error %i", errn ); }
+
+	memc_nearcache_free( &(*cm) ); // 19.10.2026
+	memc_prefork_free( &(*cm) );
+	memc_shmcache_free( &(*cm) );
+	memc_negcache_free( &(*cm) );
+	memc_singleflight( &(*cm), 0 );
+	memc_slowlog_free( &(*cm) );
+	memc_record_stop( &(*cm), NULL, NULL );
+	if( (*cm).stats!=NULL ){ // 19.10.2026
+		for( indx=0; indx<MEMCSTATSSHARDS*MEMCMAXSESSIONDBS; ++indx )
+			if( (*(*cm).stats).shard[ indx / MEMCMAXSESSIONDBS ].server[ indx % MEMCMAXSESSIONDBS ]!=NULL )
+				free( (*(*cm).stats).shard[ indx / MEMCMAXSESSIONDBS ].server[ indx % MEMCMAXSESSIONDBS ] );
+		free( (*cm).stats );
+		(*cm).stats = NULL;
+	}
+
+	if( (*cm).param_created!=0 ){ // 19.10.2026
+		(*cm).param_created = 0;
+		while( (*cm).param_pool!=NULL ){
+			pm = &(*(*cm).param_pool);
+			(*cm).param_pool = (*pm).next;
+			free( pm );
+		}
+		(*cm).param_pooled = 0;
+		while( (*cm).fanout_pool!=NULL ){
+			fo = &(*(*cm).fanout_pool);
+			(*cm).fanout_pool = (*fo).next;
+			free( fo );
+		}
+		pthread_mutex_destroy( &(*cm).param );
+	}
+	if( (*cm).pending_created!=0 ){ // 19.10.2026
+		(*cm).pending_created = 0;
+		while( (*cm).completion_pool!=NULL ){
+			cpl = &(*(*cm).completion_pool);
+			(*cm).completion_pool = (*cpl).next;
+			free( cpl );
+		}
+		pthread_cond_destroy( &(*cm).pend_cond );
+		pthread_mutex_destroy( &(*cm).pend );
+	}
 
 	if( (*cm).server_address_list!=NULL ){
 		freeaddrinfo( (*cm).server_address_list );
 		(*cm).server_address_list = NULL;
 	}
 	if( (*cm).token!=NULL ){
+		if( (*(*cm).token).conn_table!=NULL ) // 19.10.2026
+			free( (*(*cm).token).conn_table );
+		if( (*(*cm).token).conn!=NULL )
+			free( (*(*cm).token).conn );
 		free( (*cm).token );
 		(*cm).token = NULL;
 	}
@@ -1903,85 +5019,88 @@ cb_clog( CBLOGDEBUG, CBSUCCESS, "\nMEMC_FREE"); cb_flush_log();
 void memc_print_err( int err ){ // err.sh
 	switch( err ){
   		case MEMCDATAVERSIONERROR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCDATAVERSIONERROR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCDATAVERSIONERROR" );
 			break;
   		case MEMCRECVHDRERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVHDRERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVHDRERR" );
 			break;
   		case MEMCRECVEXTERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVEXTERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVEXTERR" );
 			break;
   		case MEMCRECVKEYERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVKEYERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVKEYERR" );
 			break;
   		case MEMCRECVMSGERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVMSGERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVMSGERR" );
 			break;
   		case MEMCRECVINVALIDHDRERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDHDRERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDHDRERR" );
 			break;
   		case MEMCRECVINVALIDEXTERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDEXTERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDEXTERR" );
 			break;
   		case MEMCRECVINVALIDKEYERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDKEYERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDKEYERR" );
 			break;
   		case MEMCRECVINVALIDMSGERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDMSGERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDMSGERR" );
 			break;
   		case MEMCSENDHDRERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDHDRERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDHDRERR" );
 			break;
   		case MEMCSENDEXTERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDEXTERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDEXTERR" );
 			break;
   		case MEMCSENDKEYERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDKEYERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDKEYERR" );
 			break;
   		case MEMCSENDMSGERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDMSGERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDMSGERR" );
 			break;
   		case MEMCSENDINVALIDHDRERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDHDRERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDHDRERR" );
 			break;
   		case MEMCSENDINVALIDEXTERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDEXTERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDEXTERR" );
 			break;
   		case MEMCSENDINVALIDKEYERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDKEYERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDKEYERR" );
 			break;
   		case MEMCSENDINVALIDMSGERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDMSGERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDMSGERR" );
 			break;
   		case MEMCNOTHINGTOJOIN:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCNOTHINGTOJOIN" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCNOTHINGTOJOIN" );
+			break;
+  		case MEMCPARTIAL:
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCPARTIAL" );
 			break;
   		case MEMCADDRESSMISSING:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCADDRESSMISSING" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCADDRESSMISSING" );
 			break;
   		case MEMCERRBIND:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCERRBIND" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCERRBIND" );
 			break;
   		case MEMCERRSOCKET:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCERRSOCKET" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCERRSOCKET" );
 			break;
   		case MEMCERRCONNECT:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCERRCONNECT" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCERRCONNECT" );
 			break;
   		case MEMCERRTHREAD:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCERRTHREAD" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCERRTHREAD" );
 			break;
   		case MEMCERRSOCOPT:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCERRSOCOPT" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCERRSOCOPT" );
 			break;
 		case MEMCRECVINVALIDDATAERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDDATAERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCRECVINVALIDDATAERR" );
 			break;
 		case MEMCSENDINVALIDDATAERR:
-			cb_clog( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDDATAERR" );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, "MEMCSENDINVALIDDATAERR" );
 			break;
 		default:
-			cb_clog( CBLOGDEBUG, CBNEGATION, " ERROR %i ", err );
+			MEMCLOG( CBLOGDEBUG, CBNEGATION, " ERROR %i ", err );
 			break;
 	}
 }
@@ -26,6 +26,8 @@
 
 #define MEMCMAXSESSIONDBS    100
 #define MEMCMAXREDUNDANTDBS  10
+#define MEMCPARAMPOOLSIZE    ( 4 * MEMCMAXREDUNDANTDBS ) // thread parameters kept in the free list
+#define MEMCPENDINGMAX       1024   // completed requests of the keys kept for memc_wait_key
 
 #define ushort	unsigned short
 #define uint	unsigned int
@@ -85,6 +87,7 @@
 #define MEMCSENDINVALIDEXTERR    628
 
 #define MEMCNOTHINGTOJOIN         40
+#define MEMCPARTIAL               41 // memc_load, some of the connections were loaded, 19.10.2026
 #define MEMCADDRESSMISSING       600
 #define MEMCERRSOCKET            602
 #define MEMCERRTHREAD            604
@@ -97,6 +100,17 @@
 #define MEMCREPLACE		0x03
 #define MEMCDELETE 		0x04
 #define MEMCQUIT   		0x07
+#define MEMCTOUCH  		0x1c    // memc_touch and the near-cache revalidation, returns the CAS without the value
+#define MEMCADD    		0x02    // 19.10.2026, not sent by the client, served by memc-mock
+#define MEMCGETQ   		0x09
+#define MEMCNOOP   		0x0a
+#define MEMCGETK   		0x0c
+#define MEMCGETKQ  		0x0d
+#define MEMCSETQ   		0x11
+#define MEMCADDQ   		0x12
+#define MEMCREPLACEQ		0x13
+#define MEMCDELETEQ		0x14
+#define MEMCQUITQ  		0x17
 #define MEMCSASLLIST            0x20
 #define MEMCSASLAUTH            0x21
 #define MEMCSASLSTEP            0x22
@@ -109,44 +123,426 @@
 #define MEMCDATATYPE            0x00
 
 
+/*
+ * Header as on the wire, 24 bytes without bitfields, 19.10.2026. */
 typedef struct memc_msg {
 	uchar                  magic;
 	uchar                  opcode;
-	ushort                 key_length:16;
+	ushort                 key_length;
 	uchar                  extras_length;
 	uchar                  data_type;
 	union {
-	     ushort            status:16;
-	     ushort            vbucket_id:16;
+	     ushort            status;
+	     ushort            vbucket_id;
 	};
-	unsigned int           body_length:32;
-	unsigned int           opaque:32;
-	unsigned long long int cas:64;
-} memc_msg;
+	unsigned int           body_length;
+	unsigned int           opaque;
+	unsigned long long int cas;
+} __attribute__ ((packed)) memc_msg;
 
 typedef struct memc_extras {
-	uint     flags:32; // Get
-	uint     expiration:32; // Get and set
-} memc_extras;
+	uint     flags; // Get
+	uint     expiration; // Get and set
+} __attribute__ ((packed)) memc_extras;
+
+_Static_assert( sizeof( memc_msg )==24, "memc_msg is not the 24 byte header" );
+_Static_assert( sizeof( memc_extras )==8, "memc_extras is not 8 bytes" );
+
+/*
+ * Near-cache, 19.10.2026. Local copies of the values with the 64-bit CAS
+ * of the server. After 'soft_ttl' the entry is revalidated with TOUCH
+ * (returns the CAS only) or read again with a GET if 'touch_expiration'
+ * is zero. */
+typedef struct memc_nearcache_entry {
+	unsigned long long int  cas;       // data version of the server
+	unsigned long long int  validated; // monotonic time of the last fetch or revalidation, microseconds
+	unsigned long int       generation;// of the slot, incremented by the writes, a GET started before is not stored
+	uchar                  *key;
+	uchar                  *msg;
+	uint                    keylen;
+	uint                    msglen;
+} memc_nearcache_entry;
+
+typedef struct memc_nearcache {
+	memc_nearcache_entry   *entries;  // direct mapped with the hash of the key
+	int                     size;
+	int                     max_value_length;
+	unsigned long long int  soft_ttl; // microseconds before revalidation
+	int                     mtx_created;
+	ushort                  touch_expiration; // expiration sent with TOUCH, 0 to read again with GET
+	ushort                  emptypad;
+	pthread_mutex_t         mtx;
+	unsigned long int       hits;          // fresh entries returned
+	unsigned long int       revalidations; // stale entries with the same CAS, TOUCH did not transfer the value
+	unsigned long int       refetches;     // stale entries read again with GET
+} memc_nearcache;
+
+/*
+ * Shared memory cache, 19.10.2026. Mapped before fork and shared by all the
+ * forked processes. Each bucket is protected with a sequence number: odd while
+ * written, readers retry if the number changed while copying. The writers
+ * exclude each other with the process id in 'owner'. The bucket of a writer
+ * that has exited is cleared by the next process to find it locked. */
+typedef struct memc_shmcache_bucket {
+	uint                    seq;
+	uint                    keylen;
+	uint                    msglen;
+	int                     owner;    // pid of the writer, 0 if none
+	unsigned long long int  cas;
+	unsigned long long int  expires;  // CLOCK_MONOTONIC is the same in every process, microseconds
+	// key and value follow
+} memc_shmcache_bucket;
+
+typedef struct memc_shmcache {
+	uint                    magic;
+	int                     buckets;
+	int                     max_key_length;
+	int                     max_value_length;
+	size_t                  bucket_size;    // 64 byte aligned
+	size_t                  region_size;    // for munmap
+	unsigned long long int  ttl;            // microseconds
+	// buckets follow at offset sizeof(memc_shmcache) rounded to 64 bytes
+} memc_shmcache;
+
+/*
+ * Negative cache of the keys not found, 19.10.2026. The table has the keys. The
+ * counting Bloom filter (optional) keeps the rest of the misses, two generations
+ * rotated every TTL. A key is removed from the filter only if the table knows it
+ * was added to the generation, otherwise the generation is cleared. */
+#define MEMCNEGBLOOMHASHES      3
+#define MEMCNEGKEYMAX           250      // longest key of memcached, longer are not cached
+
+typedef struct memc_negcache_entry {
+	unsigned long long int  expires;     // microseconds
+	unsigned long int       generation;  // of the slot, incremented by the writes, a GET started before is not stored
+	uint                    hash;        // 0 if empty
+	uint                    keylen;
+	uint                    inserted[2]; // epoch of the Bloom filter generation when the key was added to it
+	uchar                   key[ MEMCNEGKEYMAX ];
+	uchar                   emptypad[6];
+} memc_negcache_entry;
+
+typedef struct memc_negcache {
+	memc_negcache_entry    *entries;
+	int                     size;
+	int                     bloom_size;      // counters in one generation, 0 if not in use
+	uchar                  *bloom[2];        // 8 bit counters
+	uint                    bloom_epoch[2];  // incremented when the generation is cleared
+	int                     bloom_current;
+	int                     mtx_created;
+	unsigned long long int  bloom_rotated;
+	unsigned long long int  ttl;
+	pthread_mutex_t         mtx;
+	unsigned long int       hits;
+} memc_negcache;
+
+/*
+ * Pre-fork pool, 19.10.2026. Sets of connected sockets kept in reserve, one socket
+ * for each of the redundant connections in a set. A set is offered to each forked
+ * child and taken at the first request of the child. The parent closes its copy of
+ * a taken set at the next fork and connects a new one. */
+typedef struct memc_prefork {
+	int                    *fd;        // sets * conns, -1 if not connected
+	int                    *dbsindx;   // sets * conns
+	uint                   *claim;     // sets, shared with the children: generation * 2, odd when a child took the set, atomic
+	int                     sets;
+	int                     conns;     // redundant_servers_count at creation
+	int                     handed;    // set offered to the child at fork, -1 if none
+	uint                    offered;   // claim of the offered set at fork
+	int                     next;      // the offers go round
+	int                     owner;     // process of memc_prefork_pool, the only one to refill
+	int                     refilling; // refill thread running, atomic
+	int                     mtx_created;
+	pthread_mutex_t         mtx;
+	unsigned long int       handouts;  // sets taken by the children
+	unsigned long int       refills;   // sockets connected after memc_prefork_pool
+} memc_prefork;
+
+/*
+ * GET of a key in progress, the other readers of the same key wait for the result, 19.10.2026.
+ * A write of the key removes it from the list, the first reader still frees it. The flights
+ * are reused from a free list with their condition and the buffer of the copy. */
+#define MEMCFLIGHTPOOLSIZE   64
+#define MEMCPOOLKEYLEN       250  // longest memcached key, longer keys of a flight or a fanout are allocated
+
+typedef struct memc_flight {
+	struct memc_flight     *next;
+	uchar                  *key;
+	uchar                  *msg;      // copy of the result for the waiters
+	uint                    keylen;
+	uint                    msglen;
+	uint                    msgbufsize; // allocated length of 'msg', kept in the free list
+	unsigned long long int  cas;
+	int                     err;
+	int                     waiters;
+	char                    done;
+	char                    pooled;   // 1 if from the free list, the key is in 'keybuf'
+	char                    copied;   // 'msg' has the result
+	char                    pad[5];
+	pthread_cond_t          cond;
+	uchar                   keybuf[ MEMCPOOLKEYLEN ];
+} memc_flight;
+
+/*
+ * Completion of a request thread, 19.10.2026. A new request waits only for the
+ * previous requests of the same key (or connection), not for all of them. */
+typedef struct memc_completion {
+	struct memc_completion *next;
+	uint                    keyhash;  // 0 if not a key (connect, quit)
+	int                     cindx;    // connection
+	int                     err;
+	int                     done;
+} memc_completion;
+
+/*
+ * Statistics, 19.10.2026. Latency histograms of each server and opcode and the counters of
+ * each server. The histogram is log-linear (HDR): 2^MEMCSTATSSUBBITS buckets in each power of
+ * two of microseconds, the error of a bucket is at most 1/2^MEMCSTATSSUBBITS. The threads
+ * update one of MEMCSTATSSHARDS shards and memc_stats_snapshot adds them together. */
+#define MEMCSTATSGET         0    // index of the opcode in 'op'
+#define MEMCSTATSSET         1
+#define MEMCSTATSREPLACE     2
+#define MEMCSTATSDELETE      3
+#define MEMCSTATSTOUCH       4
+#define MEMCSTATSQUIT        5
+#define MEMCSTATSOPS         6
+#define MEMCSTATSSUBBITS     3
+#define MEMCSTATSMAXBITS     25   // 2^25 microseconds (33 s) and above in the last bucket
+#define MEMCSTATSBUCKETS     ( ( MEMCSTATSMAXBITS - MEMCSTATSSUBBITS + 2 ) << MEMCSTATSSUBBITS )
+#define MEMCSTATSSHARDS      8
+
+typedef struct memc_stats_op {
+	unsigned long int       count;
+	unsigned long int       sum;        // microseconds
+	unsigned long int       max;        // microseconds
+	unsigned long int       buckets[ MEMCSTATSBUCKETS ];
+} memc_stats_op;
+
+typedef struct memc_stats_server {
+	memc_stats_op           op[ MEMCSTATSOPS ];
+	unsigned long int       hits;       // GET found
+	unsigned long int       misses;     // key not found
+	unsigned long int       errors;     // other than success, not found, exists or not stored
+	unsigned long int       timeouts;   // EAGAIN or ETIMEDOUT from the socket
+	unsigned long int       retries;    // GET from the next server after a failure
+	unsigned long int       reconnects;
+	unsigned long int       bytes_in;
+	unsigned long int       bytes_out;
+	long int                inflight;   // requests sent and not yet answered
+} memc_stats_server;
+
+typedef struct memc_stats_shard {
+	memc_stats_server      *server[ MEMCMAXSESSIONDBS ]; // allocated at the first request to the server
+} __attribute__ ((aligned (64))) memc_stats_shard;
+
+typedef struct memc_stats {
+	memc_stats_shard        shard[ MEMCSTATSSHARDS ];
+} memc_stats;
+
+/*
+ * Tracing, 19.10.2026. The hook is called at the phases of memc_get, memc_set, memc_replace and
+ * memc_delete in the thread of the phase. The calls of one operation have the same 'id'; the
+ * replicas of a SET are told apart with 'cindx'. Not called if the hook is NULL. */
+#define MEMCTRACEROUTE       0    // connection chosen
+#define MEMCTRACEACQUIRE     1    // connection taken, after waiting the previous requests of the key
+#define MEMCTRACESENT        2    // request written, after the send mutex
+#define MEMCTRACEFIRSTBYTE   3    // first byte of the responce, before the recv mutex
+#define MEMCTRACEPARSED      4    // responce read
+#define MEMCTRACEFANOUT      5    // all the connections done, 'err' of the last one
+#define MEMCTRACEPHASES      6
+
+typedef struct memc_trace_event {
+	unsigned long long int  timestamp;  // CLOCK_MONOTONIC, nanoseconds
+	uint                    id;         // operation
+	int                     phase;      // MEMCTRACE*
+	int                     opcode;     // MEMCGET, MEMCSET, MEMCREPLACE, MEMCDELETE or MEMCTOUCH
+	int                     cindx;      // connection, -1 in MEMCTRACEFANOUT
+	int                     dbsindx;    // server, 'sesdbparams' index, -1 in MEMCTRACEFANOUT
+	int                     err;
+} memc_trace_event;
+
+typedef void (*memc_trace_hook)( void *arg, memc_trace_event *ev );
+
+/*
+ * Threads of a SET or DELETE not yet done, the last one calls MEMCTRACEFANOUT and writes
+ * the record of the capture. */
+typedef struct memc_trace_fanout {
+	struct memc_trace_fanout *next;     // free list
+	int                     pending;    // atomic, the threads and the caller
+	int                     opcode;
+	uint                    id;
+	int                     err;
+	unsigned long long int  start;      // memc_time_usec at the call if captured, otherwise 0
+	uchar                  *key;        // copy in 'keybuf' or after the structure if captured
+	uint                    msglen;
+	int                     keylen;
+	int                     pooled;     // 1 if from the free list
+	int                     emptypad;
+	uchar                   keybuf[ MEMCPOOLKEYLEN ];
+} memc_trace_fanout;
+
+/*
+ * Slow requests, 19.10.2026. A request to one server taking longer than the threshold (from
+ * MEMCTRACEROUTE to the responce) is written to a ring of the last slow requests. The writers
+ * take a slot with an atomic counter, the slot has a sequence number, odd while written. */
+typedef struct memc_slowlog_entry {
+	uint                    seq;
+	uint                    keyhash;    // memc_hash_key, 0 if no key
+	unsigned long long int  timestamp;  // MEMCTRACEROUTE, CLOCK_MONOTONIC nanoseconds
+	unsigned long long int  total;      // nanoseconds
+	unsigned long long int  phase[ MEMCTRACEPHASES ]; // nanoseconds after MEMCTRACEROUTE, 0 if not reached
+	uint                    msglen;     // value sent or received
+	int                     opcode;
+	int                     cindx;
+	int                     dbsindx;
+	int                     status;     // error or the status of the server
+	int                     emptypad;
+} memc_slowlog_entry;
+
+typedef struct memc_slowlog {
+	memc_slowlog_entry     *entries;
+	uint                    size;       // power of two
+	uint                    next;       // atomic
+	unsigned long long int  threshold;  // nanoseconds
+	unsigned long int       recorded;   // atomic
+	unsigned long int       dropped;    // slot still written by an other thread, atomic
+} memc_slowlog;
+
+/*
+ * Capture of the operations, 19.10.2026. Every memc_get, memc_set, memc_replace and memc_delete
+ * writes a record of the call to a file, in the byte order of the host. The file begins with the
+ * header, the key follows its record if MEMCRECORDKEYS is set. memc-replay sends them again. */
+#define MEMCRECORDMAGIC      "MEMCREC1"
+#define MEMCRECORDKEYS       0x01   // the keys, otherwise only the hashes
+#define MEMCRECORDBUFFER     65536
+
+typedef struct memc_record_header {
+	char                    magic[8];   // MEMCRECORDMAGIC without the terminating zero
+	uint                    flags;      // MEMCRECORD*
+	uint                    size;       // sizeof( memc_record )
+	unsigned long long int  start;      // CLOCK_REALTIME microseconds at timestamp 0
+} memc_record_header;
+
+typedef struct memc_record {
+	unsigned long long int  timestamp;  // microseconds after the start, at the call
+	uint                    latency;    // microseconds from the call to the last responce
+	uint                    keyhash;    // memc_hash_key
+	uint                    msglen;     // value sent or received
+	int                     err;        // returned by memc_get, the last error of the servers otherwice
+	ushort                  keylen;
+	uchar                   opcode;     // MEMCGET, MEMCSET, MEMCREPLACE or MEMCDELETE
+	uchar                   emptypad;
+	uint                    emptypad2;
+} memc_record;
+
+/*
+ * Dump formats of memc_load, 19.10.2026. */
+#define MEMCLOADTSV          0      // lines '<key>\t<value>\n', the value without newlines
+#define MEMCLOADBINARY       1      // MEMCLOADMAGIC, then key length (2 bytes) and value length (4 bytes)
+                                    // in the network byte order, the key and the value
+#define MEMCLOADMAGIC        "MEMCDMP1"
+#define MEMCLOADWINDOW       1024   // SETQs before a NOOP
+#define MEMCLOADBUFFER       262144 // requests written at once
+
+typedef struct memc_load_stats {
+	unsigned long int       records;    // SETQs written to all the connections, atomic
+	unsigned long int       bytes;      // atomic
+	unsigned long int       failed;     // error responces, atomic
+	unsigned long int       skipped;    // malformed records, set by the first connection to parse the whole dump
+	int                     lasterror;  // status of the last error responce or an error of a connection
+	int                     connections;// connections the dump was written to completely
+} memc_load_stats;
+
+typedef void (*memc_load_progress)( void *arg, memc_load_stats *st );
+
+typedef struct memc_load_param {
+	pthread_t               thr;
+	struct MEMC            *cm;
+	uchar                  *data;
+	size_t                  datalen;
+	memc_load_stats        *st;
+	memc_load_progress      progress;   // first connection only
+	void                   *arg;
+	int                     cindx;
+	int                     format;
+	int                     window;
+	int                     err;
+	ushort                  expiration;
+	uchar                   emptypad[6];
+} memc_load_param;
+
+/*
+ * A write of memc_write_batch, 19.10.2026. */
+#define MEMCBATCHBUFFER      16384  // requests written at once, larger values are written from the caller
+
+typedef struct memc_batch_op {
+	uchar                  *key;
+	uchar                  *msg;        // SET and REPLACE
+	int                     keylen;
+	int                     msglen;
+	uint                    cas;
+	int                     status;     // result as from memc_wait_key
+	uint                    failed;     // connections with an error responce, set by memc_write_batch
+	ushort                  expiration;
+	uchar                   opcode;     // MEMCSET, MEMCREPLACE or MEMCDELETE
+	uchar                   emptypad;
+} memc_batch_op;
+
+typedef struct memc_recorder {
+	pthread_mutex_t         mtx;        // buffer and file
+	uchar                  *buf;
+	uint                    buflen;
+	uint                    used;
+	uint                    buffered;   // records in 'buf'
+	int                     fd;
+	int                     flags;
+	int                     emptypad;
+	unsigned long long int  start;      // CLOCK_MONOTONIC microseconds
+	unsigned long int       recorded;
+	unsigned long int       lost;       // write failed
+} memc_recorder;
+
+/*
+ * One connection, 19.10.2026: the fields used on every request are on the
+ * first 64-byte line, the thread handle and the mutexes on the following
+ * lines. The entries are allocated as one aligned table (MEMC_token.conn_table)
+ * to keep the neighbouring connections on separate cache lines. */
+#define MEMCCACHELINE      64
+
+/*
+ * Connection states, 19.10.2026. Changed only with compare-and-swap. A caller
+ * takes a READY connection as BUSY for one request and puts it back as READY
+ * (or FAILED if the stream was broken). */
+#define MEMCCONNIDLE         0    // socket, not connected
+#define MEMCCONNCONNECTING   1    // memc_connect_thr
+#define MEMCCONNREADY        2
+#define MEMCCONNBUSY         3    // request in progress
+#define MEMCCONNFAILED       4    // connect or io error, reconnect
+#define MEMCCONNCLOSING      5    // memc_quit_thr
 
 typedef struct dbs_conn {
-	pthread_t          thr;        // to use in joining the threads (pthread_t is pointer to a structure pthread)
-	int                thr_created;
-	int                emptypad;
-	unsigned long int  last_cas;   // version of the last get data
-	pthread_mutex_t    mtx;        // Pointer to structure pthread_mutex
-	int                mtx_created;
-	int                mtxconn_created;
-	pthread_mutex_t    mtxconn;
+	/*
+	 * Hot, one cache line. */
 	int                fd;
+	int                processing; // number of threads still using the connection (to join with 'thr'), atomic, 19.10.2026
+	int                lasterr;
 	int                dbsindx;    // Database number where conneted (to know to reconnect if needed)
 	int                last_thread_status;   // last thread status (with process isolation)
-	int                lasterr;
+	int                thr_created;
+	unsigned long int  last_cas;   // version of the last get data
 	ushort             laststatus;
 	char               connected;  // to know if connected
-	char               processing; // flag to know if a previous thread is still using the connection (to join with 'thr')
-	int                pad64;   // 24.10.2018, 30.10.2018
-} dbs_conn;
+	char               emptypad;
+	int                state;      // MEMCCONN*, atomic, futex of memc_conn_acquire, 19.10.2026
+	int                waiters;    // threads sleeping in memc_conn_acquire, atomic, 19.10.2026
+	/*
+	 * Cold. */
+	pthread_t          thr __attribute__ ((aligned (MEMCCACHELINE)));        // to use in joining the threads (pthread_t is pointer to a structure pthread)
+	int                mtx_created;
+	int                mtxconn_created;
+	pthread_mutex_t    mtx;        // Pointer to structure pthread_mutex
+	pthread_mutex_t    mtxconn;
+} __attribute__ ((aligned (MEMCCACHELINE))) dbs_conn;
 
 typedef struct MEMC_token {
 
@@ -155,6 +551,7 @@ typedef struct MEMC_token {
 	 * Note: different from 'sesdbparams'. */
 	//8.10.2018: dbs_conn           conn[MEMCMAXREDUNDANTDBS]; // individual connections, redundant_server_count.
 	dbs_conn         **conn; // individual connections, redundant_server_count.
+	dbs_conn          *conn_table; // contiguous storage of the entries of 'conn', MEMCCACHELINE aligned, 19.10.2026
 
 	/*
 	 * Connection data, copied to each process. */
@@ -186,16 +583,9 @@ typedef struct MEMC {
 	 */
 	struct addrinfo   *server_address_list; // pointer to res0 pointed memory in rvp_daemon.c, INIT PUUTTUU 7.7.2018
 
-	/*
-	 * Common mutexes, 24.8.2018. */
-	pthread_mutex_t    send;
-	int                send_created;
-	int                recv_created;
-	pthread_mutex_t    recv;
-
 	/*
 	 * Individual mutexes (thread safety), 24.8.2018. */
-	pthread_mutex_t    set;
+	pthread_mutex_t    set;         // not taken by the requests, the connections are acquired, 19.10.2026
 	int                set_created;
 	int                delete_created;
 	pthread_mutex_t    delete;
@@ -222,10 +612,84 @@ typedef struct MEMC {
         int                err;
 	int                some_socket_succeeded; // boolean, 10.11.2018
 
+	/*
+	 * Near-cache, NULL if not in use, 19.10.2026. */
+	memc_nearcache    *nearcache;
+
+	/*
+	 * Shared memory cache of the forked processes, NULL if not in use, 19.10.2026. */
+	memc_shmcache     *shmcache;
+
+	/*
+	 * Negative cache, NULL if not in use, 19.10.2026. */
+	memc_negcache     *negcache;
+
+	/*
+	 * GETs in progress (single flight), 19.10.2026. */
+	memc_flight       *flights;
+	memc_flight       *flight_pool;
+	int                flight_created;
+	pthread_mutex_t    flight;
+	unsigned long int  flight_mallocs; // flights and copies of the result allocated after memc_singleflight
+
+	/*
+	 * Free list of the thread parameters, 19.10.2026. */
+	struct MEMC_parameter *param_pool;
+	int                param_pooled;
+	int                param_created;
+	pthread_mutex_t    param;
+	unsigned long int  param_mallocs; // parameters allocated after memc_allocate (should stay zero)
+	memc_trace_fanout *fanout_pool;   // with the 'param' mutex
+	unsigned long int  fanout_mallocs; // fanouts of the traced or captured writes allocated after memc_allocate
+
+	/*
+	 * Requests in progress in the threads and the free list of the completions, 19.10.2026. */
+	memc_completion   *pending;
+	memc_completion   *completion_pool;
+	unsigned long int  completion_mallocs; // completions allocated after memc_allocate (should stay zero)
+	int                pending_created;
+	int                pending_count;
+	pthread_mutex_t    pend;
+	pthread_cond_t     pend_cond;
+	int                reaped;      // bits of the connections completed since memc_wait_all
+	int                reaped_err[ MEMCMAXREDUNDANTDBS ]; // the first error or status of the connection since memc_wait_all
+
+	/*
+	 * Fork handlers (pthread_atfork), 19.10.2026. */
+	struct MEMC       *fork_next;   // list of the allocated MEMCs
+	int                fork_locked; // mutexes locked in the prepare handler, MEMCFORK* bits
+	int                forked;      // 1 in the child until the first use reconnects, 2 while reconnecting
+
+	/*
+	 * Pre-fork pool of connected sockets, NULL if not in use, 19.10.2026. */
+	memc_prefork      *prefork;
+
+	/*
+	 * Statistics, always on, 19.10.2026. */
+	memc_stats        *stats;
+
+	/*
+	 * Tracing, NULL if not in use, 19.10.2026. */
+	memc_trace_hook    trace_hook;
+	void              *trace_arg;
+	uint               trace_ids;  // atomic
+	int                slowlog_users; // threads using 'slowlog', memc_slowlog_free waits them, atomic
+
+	/*
+	 * Ring of the slow requests, NULL if not in use, 19.10.2026. */
+	memc_slowlog      *slowlog;
+
+	/*
+	 * Capture of the operations, NULL if not in use, 19.10.2026. */
+	memc_recorder     *recorder;
+	int                recorder_users; // threads using 'recorder', memc_record_stop waits them, atomic
+	int                emptypad;
+
 } MEMC;
 
 
 typedef struct MEMC_parameter {
+	struct MEMC_parameter *next;    // In the free list of the MEMC, 19.10.2026
         unsigned char    *key;          // Parameter key to calculate the index
         MEMC             *cm;           // The same for all
         ushort            keylen;
@@ -234,6 +698,8 @@ typedef struct MEMC_parameter {
         int               cindx;        // Index of the connection in '(*(*cn).token).conn'
 // Connect
         uint              cas;          // Data version
+	uint              trace_id;     // operation, 19.10.2026
+	unsigned long long int cas64;   // Data version, all the 64 bits from the header (near-cache), 19.10.2026
         uchar            *msg;          // Message content
         uint              msglen;
         int               msgbuflen;
@@ -247,6 +713,9 @@ typedef struct MEMC_parameter {
         unsigned short    expiration;   // Set only
 	unsigned char     special;      // Use REPLACE instead if SET or other
 	unsigned char     pad[7];
+	memc_completion  *completion;   // signalled at the end of the thread, 19.10.2026
+	memc_trace_fanout *trace_fanout; // shared by the threads of the operation, NULL if not traced, 19.10.2026
+	unsigned long long int trace_ts[ MEMCTRACEPHASES ]; // nanoseconds of the phases, with a hook or the slow log, 19.10.2026
 } MEMC_parameter;
 
 
@@ -271,13 +740,134 @@ int  memc_set( MEMC *cm, uchar **key, int keylen, uchar **msg, int msglen, uint
 int  memc_replace( MEMC *cm, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort vbucketid, ushort expiration );  // cas is the data version from get, vbucketid is any the same value all the time
 int  memc_get( MEMC *cm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas, ushort vbucketid ); // cas is the data version, vbucketid is any the same value all the time
 int  memc_delete( MEMC *cm, uchar **key, int keylen, uint cas, ushort vbucketid );
+int  memc_touch( MEMC *cm, uchar **key, int keylen, ushort expiration, ushort vbucketid ); // new expiration in every redundant server, in sequence, 19.10.2026
 int  memc_quit( MEMC *cm ); // Send 'quit' to memcached and 'shutdown' all the redundant_servers_count connections
 
 int  memc_allocate( MEMC **cm );
 int  memc_free( MEMC *cm );
 
-/* The call is not be needed before memc_init, memc_set, memc_delete or memc_quit. */
+/*
+ * Near-cache of the values read with memc_get. Entries older than 'soft_ttl_ms' are revalidated
+ * by comparing the CAS of the server before returning them. If 'touch_expiration' is not zero, the
+ * revalidation is done with TOUCH (the value is not transferred, the expiration of the key in the
+ * server read is set to 'touch_expiration'), otherwice the value is read again with a GET.
+ * memc_set, memc_replace and memc_delete invalidate the entry before the requests are sent and
+ * again when each of the servers has answered. memc_nearcache_stats returns the fresh hits, the
+ * TOUCH revalidations and the GET refetches. 19.10.2026 */
+int  memc_nearcache_create( MEMC *cm, int entries, int soft_ttl_ms, int max_value_length, ushort touch_expiration );
+int  memc_nearcache_free( MEMC *cm );
+int  memc_nearcache_invalidate( MEMC *cm, uchar **key, int keylen );
+int  memc_nearcache_stats( MEMC *cm, unsigned long int *hits, unsigned long int *revalidations, unsigned long int *refetches );
+
+/*
+ * Shared memory cache of all the processes forked after the call. Call before the first
+ * fork. Entries expire after 'ttl_ms', memc_set, memc_replace and memc_delete of any of
+ * the processes invalidate the entry of every process, before the requests are sent and
+ * again when the servers have answered. 19.10.2026 */
+int  memc_shmcache_create( MEMC *cm, int buckets, int max_key_length, int max_value_length, int ttl_ms );
+int  memc_shmcache_free( MEMC *cm );
+
+/*
+ * Negative cache. memc_get returns MEMCKEYNOTFOUND without a request if the key was not found
+ * during the last 'ttl_ms'. With 'bloom_counters' greater than zero, the misses not fitting in
+ * the table are kept in a counting Bloom filter for TTL to two times TTL (a false positive is
+ * possible). memc_set, memc_replace and memc_delete remove the key before the requests are
+ * sent and again when the servers have answered, a miss read during the write is not kept.
+ * 19.10.2026 */
+int  memc_negcache_create( MEMC *cm, int entries, int ttl_ms, int bloom_counters );
+int  memc_negcache_free( MEMC *cm );
+
+/*
+ * Concurrent memc_get calls of the same key share one request. The first reads the value
+ * and the others copy it to their buffers. The calls after a completed write of the key do
+ * not join a read started before it. 'on' 0 turns off (not while reading). 19.10.2026 */
+int  memc_singleflight( MEMC *cm, char on );
+
+/*
+ * The call is not be needed before memc_init, memc_set, memc_delete or memc_quit. Returns CBSUCCESS
+ * if all of the requests of a connection succeeded after the previous memc_wait_all, otherwise
+ * the status of a server (for example MEMCKEYNOTFOUND) or the smallest of the errors. 19.10.2026 */
 int  memc_wait_all( MEMC *cm );
+/*
+ * Waits the requests of one key. The key and value given to memc_set can be reused after. Returns
+ * CBSUCCESS if one of the servers succeeded, otherwise the status of the server (MEMCKEYNOTFOUND of
+ * a REPLACE or DELETE, MEMCKEYEXISTS of a CAS mismatch) or the error. The result is kept until the
+ * wait unless more than MEMCPENDINGMAX requests of other keys are not waited. 19.10.2026 */
+int  memc_wait_key( MEMC *cm, uchar **key, int keylen );
+
+/*
+ * Fork, 19.10.2026. memc_allocate registers pthread_atfork handlers. The requests in progress
+ * are not drained: they continue in the parent, in the child their results are lost (memc_wait_key
+ * and memc_wait_all do not see them). Before fork the mutexes kept only for a moment are locked.
+ * In the child the inherited connections are closed and reconnected at the first memc_get, memc_set,
+ * memc_replace, memc_delete or memc_connect. memc_wait_all and memc_reinit are not needed around
+ * fork anymore, call memc_wait_all before fork to have the results in both processes. */
+
+/*
+ * Pre-fork pool. Keeps 'sets' sets of connected sockets (one for each of the redundant connections)
+ * in reserve. At fork the child takes one set as its connections without connecting, the parent
+ * closes its copy and connects a new set in a thread. Call after memc_connect. 19.10.2026 */
+int  memc_prefork_pool( MEMC *cm, int sets );
+int  memc_prefork_free( MEMC *cm );
+
+/*
+ * Lent sockets (memc_sidecar_borrow), 19.10.2026. memc_adopt_socket makes the connected 'fd' the
+ * connection 'cindx' to the server 'dbsindx'. memc_surrender_socket takes the socket out of the
+ * connection, the next request reconnects unless a socket is adopted before it. */
+int  memc_server_index( MEMC *cm, int cindx );                 // server of the connection, 'sesdbparams' index
+int  memc_server_socket( MEMC *cm, int dbsindx, int *fd );     // new connected socket
+int  memc_adopt_socket( MEMC *cm, int cindx, int dbsindx, int fd );
+int  memc_surrender_socket( MEMC *cm, int cindx, int *dbsindx, int *fd );
+
+/*
+ * Statistics of the server 'dbsindx' ('sesdbparams' index), -1 for all the servers together.
+ * memc_stats_percentile returns the upper bound of the bucket of the percentile 'pct'
+ * (0.0 - 100.0) in microseconds. The counters are not reset, subtract two snapshots for an
+ * interval. 19.10.2026 */
+int  memc_stats_snapshot( MEMC *cm, int dbsindx, memc_stats_server *snap );
+unsigned long int  memc_stats_percentile( memc_stats_op *op, double pct );
+
+/*
+ * Tracing hook, NULL removes. Set while no requests are in progress. With a hook, the first byte
+ * of a responce is waited with an extra recv( MSG_PEEK ). 19.10.2026 */
+int  memc_set_trace_hook( MEMC *cm, memc_trace_hook hook, void *arg );
+
+/*
+ * Slow requests. Keeps the last 'entries' (rounded up to a power of two) requests slower than
+ * 'threshold_us', the most recent ones and not the slowest: a newer request above the threshold
+ * overwrites the oldest entry even if that was slower. memc_slowlog_dump copies at most 'max' of
+ * them to 'entries', the slowest first, and sets 'count'. Create while no requests are in
+ * progress. memc_slowlog_free waits the requests writing to the ring. 19.10.2026 */
+int  memc_slowlog_create( MEMC *cm, int entries, int threshold_us );
+int  memc_slowlog_free( MEMC *cm );
+int  memc_slowlog_dump( MEMC *cm, memc_slowlog_entry *entries, int max, int *count );
+
+/*
+ * Capture of the operations to 'fd'. 'flags' MEMCRECORDKEYS writes the keys. The records are
+ * buffered, memc_record_stop waits the threads writing a record, writes the rest and does not
+ * close 'fd'. The operations still in progress at the stop are not written. 19.10.2026 */
+int  memc_record_start( MEMC *cm, int fd, int flags );
+int  memc_record_stop( MEMC *cm, unsigned long int *recorded, unsigned long int *lost );
+
+/*
+ * Bulk load of a dump in memory (mmap) to every redundant connection, 19.10.2026. A thread
+ * for each connection streams the records as quiet SETs (SETQ) and a NOOP after every
+ * 'window' records. Two windows are in flight: after the second NOOP the responces are read
+ * until the first NOOP. Only the failed SETQs are answered. The connections are reserved
+ * until the end, other requests wait. 'progress' is called by the thread of the first
+ * connection after every window, the counters of 'st' are updated by all the threads.
+ * Returns MEMCPARTIAL if some of the connections were loaded and some failed. */
+int  memc_load( MEMC *cm, uchar *data, size_t datalen, int format, int window, ushort expiration, memc_load_stats *st, memc_load_progress progress, void *arg );
+
+/*
+ * Pipelined SETs, REPLACEs and DELETEs, 19.10.2026. The operations are written to every
+ * redundant connection as quiet requests (SETQ, REPLACEQ, DELETEQ) and a NOOP after every
+ * MEMCLOADWINDOW of them, the connections are reserved until the NOOPs are answered. The
+ * previous requests of the keys are waited first and the caches are invalidated as with
+ * memc_set. The result of each operation is in its 'status' as memc_wait_key would return
+ * it. Returns CBSUCCESS if the batch was written to one of the connections, otherwise the
+ * error. The operations are not traced, the statistics have the time of the whole batch. */
+int  memc_write_batch( MEMC *cm, memc_batch_op *ops, int count );
 
 /* Debug printing. */
 void memc_print_err( int err );
@@ -0,0 +1,653 @@
+/*
+ * Load generator of the memc library, 19.10.2026. The threads share one MEMC and
+ * call memc_get and memc_set with the configured key distribution, value sizes,
+ * read and write mix and batch size. Reports the throughput and the latency
+ * percentiles of each operation as text or JSON.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>     // exit, qsort
+#include <string.h>     // memset
+#include <errno.h>      // errno
+#include <math.h>       // pow
+#include <pthread.h>    // threads
+#include <time.h>       // clock_gettime
+#include <signal.h>     // SIGPIPE
+#include <fcntl.h>      // open
+#include <unistd.h>     // close
+#include <sys/param.h>  // MAXPATHLEN
+#include <sys/types.h>  // getaddrinfo
+#include <sys/socket.h> // getaddrinfo
+#include <netdb.h>      // getaddrinfo
+#include <netinet/in.h> // IPPROTO_TCP
+
+#include "../include/ipvxformat.h"
+#include "../include/get_option.h"
+#include "../include/cb_buffer.h"
+#include "./memc.h"
+
+#define MEMCPORTLEN       10
+#define EXPIRATION        120
+
+#define BENCHGET          0
+#define BENCHSET          1
+#define BENCHOPS          2
+#define BENCHKEYLEN       32
+#define BENCHMAXTHREADS   256
+#define BENCHMAXBATCH     1024
+#define BENCHMAXVALUE     ( 1024*1024 )
+#define BENCHMALLOCPARAM  0   // allocations of the library after memc_allocate
+#define BENCHMALLOCCOMPL  1
+#define BENCHMALLOCFLIGHT 2
+#define BENCHMALLOCFANOUT 3
+#define BENCHMALLOCS      4
+
+typedef struct bench_config {
+	int                     threads;      // -t
+	long                    requests;     // -n, of each thread
+	long                    keys;         // -c, cardinality
+	double                  zipf;         // -z, 0 is uniform
+	int                     minvalue;     // -v <min>[-<max>]
+	int                     maxvalue;
+	int                     readpct;      // -R, percent of GETs
+	int                     batch;        // -b, requests before waiting the SETs
+	char                    json;         // -j
+	char                    preload;      // -P, SET every key before the run
+	uchar                  *value;        // read only, maxvalue bytes
+	double                  zetan;        // zipf constants
+	double                  zipfeta;
+	double                  zipfalpha;
+} bench_config;
+
+typedef struct bench_thread {
+	pthread_t               thr;
+	MEMC                   *cm;
+	bench_config           *cfg;
+	int                     id;
+	int                     emptypad;
+	unsigned long long int  rnd;          // xorshift64*
+	unsigned long long int *lat[ BENCHOPS ]; // nanoseconds, one for each request
+	long                    count[ BENCHOPS ];
+	long                    errors[ BENCHOPS ];
+	long                    misses;
+	long                    first;        // preload, keys from 'first' to 'last'
+	long                    last;
+	uchar                  *keys;         // batch * BENCHKEYLEN, valid until the SET is done
+	unsigned long long int *started;      // batch
+	uchar                  *msg;          // GET buffer
+} bench_thread;
+
+int  main( int argc, char *argv[] );
+void usage( char *progname[] );
+static int get_ip_and_port(unsigned char **ip, int *iplen, unsigned char **port, int *portlen, char *ipandport[], int len);
+static unsigned long long int bench_time_nsec( void );
+static unsigned long long int bench_random( bench_thread *bt );
+static void   bench_zipf_init( bench_config *cfg );
+static long   bench_next_key( bench_thread *bt );
+static int    bench_key( uchar *key, long keyindx );
+static void*  bench_preload_thr( void *prm );
+static void*  bench_run_thr( void *prm );
+static int    bench_compare( const void *a, const void *b );
+static unsigned long long int bench_percentile( unsigned long long int *lat, long count, double pct );
+static void   bench_report( bench_config *cfg, bench_thread *bt, unsigned long long int elapsed, memc_stats_server *st, unsigned long int *mallocs );
+
+void usage (char *progname[]){
+        fprintf(stderr,"Usage:\n");
+        fprintf(stderr,"\t%s [-j][-P][-h] [ -i <host ip> ] [ -t <threads> ] [ -n <requests of a thread> ] [ -c <keys> ] [ -z <zipf exponent> ] \\\n", progname[0]);
+        fprintf(stderr,"\t\t [ -v <value size>[-<max value size>] ] [ -R <percent of GET> ] [ -r <number of servers to copy the data> ] \\\n");
+        fprintf(stderr,"\t\t [ -b <batch> ] [ -T <capture file> ] <memcache IP>:<port> [ <memcache2 IP>:<port2> ... ]\n");
+        fprintf(stderr,"\t-i\tHost IP-address, default any.\n");
+        fprintf(stderr,"\t-t\tThreads sharing the client, default 4.\n");
+        fprintf(stderr,"\t-n\tRequests of each thread, default 10000.\n");
+        fprintf(stderr,"\t-c\tNumber of different keys, default 10000.\n");
+        fprintf(stderr,"\t-z\tZipf exponent of the key popularity, 0 is uniform (default 0.99).\n");
+        fprintf(stderr,"\t-v\tValue size in bytes or a uniform range, default 100.\n");
+        fprintf(stderr,"\t-R\tPercent of GET, the rest are SET, default 90.\n");
+        fprintf(stderr,"\t-r\tNumber of servers to copy the data.\n");
+        fprintf(stderr,"\t-b\tRequests before waiting the SETs to complete, default 1.\n");
+        fprintf(stderr,"\t-P\tPreload, SET every key before the run.\n");
+        fprintf(stderr,"\t-T\tCapture the operations of the run with the keys to a file, for memc-replay.\n");
+        fprintf(stderr,"\t-j\tJSON output.\n");
+        fprintf(stderr,"\t-h\tHelp.\n");
+        fprintf(stderr,"\n\tReports the throughput and p50, p99 and p99.9 latency of GET and SET.\n");
+        fprintf(stderr,"\tThe latency of a SET is from the call to the completion of all the replicas.\n");
+}
+
+unsigned long long int  bench_time_nsec( void ){
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( (unsigned long long int) ts.tv_sec * 1000000000ULL ) + (unsigned long long int) ts.tv_nsec;
+}
+unsigned long long int  bench_random( bench_thread *bt ){
+	(*bt).rnd ^= (*bt).rnd >> 12;
+	(*bt).rnd ^= (*bt).rnd << 25;
+	(*bt).rnd ^= (*bt).rnd >> 27;
+	return (*bt).rnd * 2685821657736338717ULL;
+}
+/*
+ * Zipf of Gray et al., "Quickly generating billion-record synthetic databases", as in YCSB.
+ * The exponent is below 1. */
+void  bench_zipf_init( bench_config *cfg ){
+	long indx = 0;
+	double zeta2 = 0;
+	if( (*cfg).keys<2 ) (*cfg).zipf = 0;
+	if( (*cfg).zipf<=0 ) return;
+	if( (*cfg).zipf>=1 ) (*cfg).zipf = 0.999;
+	(*cfg).zetan = 0;
+	for( indx=1; indx<=(*cfg).keys; ++indx )
+		(*cfg).zetan += 1.0 / pow( (double) indx, (*cfg).zipf );
+	zeta2 = 1.0 + 1.0 / pow( 2.0, (*cfg).zipf );
+	(*cfg).zipfalpha = 1.0 / ( 1.0 - (*cfg).zipf );
+	(*cfg).zipfeta = ( 1.0 - pow( 2.0 / (double) (*cfg).keys, 1.0 - (*cfg).zipf ) ) / ( 1.0 - zeta2 / (*cfg).zetan );
+}
+long  bench_next_key( bench_thread *bt ){
+	double u = 0, uz = 0;
+	long keyindx = 0;
+	bench_config *cfg = (*bt).cfg;
+	if( (*cfg).zipf<=0 )
+		return (long) ( bench_random( &(*bt) ) % (unsigned long long int) (*cfg).keys );
+	u = (double) ( bench_random( &(*bt) ) >> 11 ) / 9007199254740992.0; // [0,1)
+	uz = u * (*cfg).zetan;
+	if( uz<1.0 ) return 0;
+	if( uz<1.0 + pow( 0.5, (*cfg).zipf ) ) return 1;
+	keyindx = (long) ( (double) (*cfg).keys * pow( (*cfg).zipfeta * u - (*cfg).zipfeta + 1.0, (*cfg).zipfalpha ) );
+	return ( keyindx>=(*cfg).keys ) ? (*cfg).keys - 1 : keyindx;
+}
+int  bench_key( uchar *key, long keyindx ){
+	return snprintf( &(* (char*) key), (size_t) BENCHKEYLEN, "memc-bench:%ld", keyindx );
+}
+
+void* bench_preload_thr( void *prm ){
+	bench_thread *bt = (bench_thread*) prm;
+	uchar *key = NULL, *msg = NULL;
+	long keyindx = 0;
+	int keylen = 0, err = CBSUCCESS;
+	if( bt==NULL ) return NULL;
+	key = &(*bt).keys[0];
+	msg = &(*(*bt).cfg).value[0];
+	for( keyindx=(*bt).first; keyindx<(*bt).last; ++keyindx ){
+		keylen = bench_key( &key[0], keyindx );
+		err = memc_set( &(*(*bt).cm), &key, keylen, &msg, (*(*bt).cfg).minvalue, 0, 0, EXPIRATION );
+		if( err>=CBERROR ) ++(*bt).errors[ BENCHSET ];
+		memc_wait_key( &(*(*bt).cm), &key, keylen ); // the key buffer is used again
+	}
+	return NULL;
+}
+
+void* bench_run_thr( void *prm ){
+	bench_thread *bt = (bench_thread*) prm;
+	bench_config *cfg = NULL;
+	uchar *key = NULL, *msg = NULL, *value = NULL;
+	int keylen = 0, msglen = 0, valuelen = 0, err = CBSUCCESS, indx = 0, sets = 0;
+	int setlen[ BENCHMAXBATCH ];
+	uint cas = 0;
+	long req = 0;
+	unsigned long long int start = 0, now = 0;
+	if( bt==NULL ) return NULL;
+	cfg = (*bt).cfg;
+	msg = &(*bt).msg[0];
+	value = &(*cfg).value[0];
+
+	for( req=0; req<(*cfg).requests; ){
+
+		/*
+		 * Batch. GETs wait their responce, SETs are waited at the end of the batch. */
+		sets = 0;
+		for( indx=0; indx<(*cfg).batch && req<(*cfg).requests; ++indx, ++req ){
+			key = &(*bt).keys[ sets * BENCHKEYLEN ];
+			keylen = bench_key( &key[0], bench_next_key( &(*bt) ) );
+			if( (int) ( bench_random( &(*bt) ) % 100 ) < (*cfg).readpct ){
+				msglen = 0; cas = 0;
+				start = bench_time_nsec();
+				err = memc_get( &(*(*bt).cm), &key, keylen, &msg, &msglen, BENCHMAXVALUE, &cas, 0 );
+				(*bt).lat[ BENCHGET ][ (*bt).count[ BENCHGET ]++ ] = bench_time_nsec() - start;
+				if( err==MEMCKEYNOTFOUND || err==MEMCRECVKEYNOTFOUND )
+					++(*bt).misses;
+				else if( err!=CBSUCCESS )
+					++(*bt).errors[ BENCHGET ];
+			}else{
+				valuelen = (*cfg).minvalue;
+				if( (*cfg).maxvalue>(*cfg).minvalue )
+					valuelen += (int) ( bench_random( &(*bt) ) % (unsigned long long int) ( (*cfg).maxvalue - (*cfg).minvalue + 1 ) );
+				(*bt).started[ sets ] = bench_time_nsec();
+				setlen[ sets ] = keylen;
+				err = memc_set( &(*(*bt).cm), &key, keylen, &value, valuelen, 0, 0, EXPIRATION );
+				if( err>=CBERROR )
+					++(*bt).errors[ BENCHSET ];
+				++sets;
+			}
+		}
+
+		/*
+		 * Completion of the SETs of the batch, in the order they were sent. */
+		for( indx=0; indx<sets; ++indx ){
+			key = &(*bt).keys[ indx * BENCHKEYLEN ];
+			memc_wait_key( &(*(*bt).cm), &key, setlen[ indx ] );
+			now = bench_time_nsec();
+			(*bt).lat[ BENCHSET ][ (*bt).count[ BENCHSET ]++ ] = now - (*bt).started[ indx ];
+		}
+	}
+	return NULL;
+}
+
+int  bench_compare( const void *a, const void *b ){
+	unsigned long long int x = * (const unsigned long long int *) a, y = * (const unsigned long long int *) b;
+	return ( x<y ) ? -1 : ( ( x>y ) ? 1 : 0 );
+}
+/*
+ * 'lat' sorted. Nearest rank. */
+unsigned long long int  bench_percentile( unsigned long long int *lat, long count, double pct ){
+	long rank = 0;
+	if( lat==NULL || count<=0 ) return 0;
+	rank = (long) ( ( pct / 100.0 ) * (double) count + 0.999999 ) - 1;
+	if( rank<0 ) rank = 0;
+	if( rank>=count ) rank = count - 1;
+	return lat[ rank ];
+}
+
+void  bench_report( bench_config *cfg, bench_thread *bt, unsigned long long int elapsed, memc_stats_server *st, unsigned long int *mallocs ){
+	static const char *names[ BENCHOPS ] = { "get", "set" };
+	int op = 0, t = 0;
+	long count = 0, errors = 0, misses = 0, total = 0;
+	unsigned long long int *all = NULL;
+	unsigned long long int p50 = 0, p99 = 0, p999 = 0, max = 0;
+	double secs = (double) elapsed / 1000000000.0;
+
+	for( t=0; t<(*cfg).threads; ++t ){
+		total += bt[ t ].count[ BENCHGET ] + bt[ t ].count[ BENCHSET ];
+		misses += bt[ t ].misses;
+	}
+	if( (*cfg).json==1 ){
+		printf( "{\"threads\":%i,\"requests\":%ld,\"keys\":%ld,\"zipf\":%.3f,\"value_min\":%i,\"value_max\":%i,\"read_percent\":%i,\"batch\":%i,\"replicas\":%i,",
+			(*cfg).threads, (*cfg).requests, (*cfg).keys, (*cfg).zipf, (*cfg).minvalue, (*cfg).maxvalue, (*cfg).readpct, (*cfg).batch, (*bt[0].cm).redundant_servers_count );
+		printf( "\"seconds\":%.3f,\"throughput\":%.1f,\"misses\":%ld,\"ops\":{", secs, ( secs>0 ) ? (double) total / secs : 0.0, misses );
+	}else{
+		printf( "\nthreads %i, requests %ld, keys %ld, zipf %.3f, value %i-%i, GET %i %%, batch %i, replicas %i",
+			(*cfg).threads, (*cfg).requests, (*cfg).keys, (*cfg).zipf, (*cfg).minvalue, (*cfg).maxvalue, (*cfg).readpct, (*cfg).batch, (*bt[0].cm).redundant_servers_count );
+		printf( "\n%.3f s, %.1f requests/s, GET misses %ld", secs, ( secs>0 ) ? (double) total / secs : 0.0, misses );
+		printf( "\n%-4s %10s %12s %10s %10s %10s %10s %8s", "op", "count", "ops/s", "p50 us", "p99 us", "p99.9 us", "max us", "errors" );
+	}
+
+	for( op=0; op<BENCHOPS; ++op ){
+		count = 0; errors = 0;
+		for( t=0; t<(*cfg).threads; ++t ){
+			count += bt[ t ].count[ op ];
+			errors += bt[ t ].errors[ op ];
+		}
+		p50 = 0; p99 = 0; p999 = 0; max = 0;
+		if( count>0 ){
+			all = (unsigned long long int*) malloc( sizeof( unsigned long long int ) * (size_t) count );
+			if( all!=NULL ){
+				count = 0;
+				for( t=0; t<(*cfg).threads; ++t ){
+					memcpy( &all[ count ], &bt[ t ].lat[ op ][0], sizeof( unsigned long long int ) * (size_t) bt[ t ].count[ op ] );
+					count += bt[ t ].count[ op ];
+				}
+				qsort( &all[0], (size_t) count, sizeof( unsigned long long int ), &bench_compare );
+				p50 = bench_percentile( &all[0], count, 50.0 );
+				p99 = bench_percentile( &all[0], count, 99.0 );
+				p999 = bench_percentile( &all[0], count, 99.9 );
+				max = all[ count - 1 ];
+				free( all );
+				all = NULL;
+			}
+		}
+		if( (*cfg).json==1 ){
+			printf( "%s\"%s\":{\"count\":%ld,\"throughput\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,\"max_us\":%.1f,\"errors\":%ld}",
+				( op>0 ) ? "," : "", names[ op ], count, ( secs>0 ) ? (double) count / secs : 0.0,
+				(double) p50 / 1000.0, (double) p99 / 1000.0, (double) p999 / 1000.0, (double) max / 1000.0, errors );
+		}else{
+			printf( "\n%-4s %10ld %12.1f %10.1f %10.1f %10.1f %10.1f %8ld", names[ op ], count, ( secs>0 ) ? (double) count / secs : 0.0,
+				(double) p50 / 1000.0, (double) p99 / 1000.0, (double) p999 / 1000.0, (double) max / 1000.0, errors );
+		}
+	}
+
+	/*
+	 * Counters of the library, all the servers. */
+	if( (*cfg).json==1 ){
+		printf( "},\"library\":{\"hits\":%lu,\"misses\":%lu,\"errors\":%lu,\"timeouts\":%lu,\"retries\":%lu,\"reconnects\":%lu,\"bytes_in\":%lu,\"bytes_out\":%lu,\"param_mallocs\":%lu,\"completion_mallocs\":%lu,\"flight_mallocs\":%lu,\"fanout_mallocs\":%lu}}\n",
+			(*st).hits, (*st).misses, (*st).errors, (*st).timeouts, (*st).retries, (*st).reconnects, (*st).bytes_in, (*st).bytes_out,
+			mallocs[ BENCHMALLOCPARAM ], mallocs[ BENCHMALLOCCOMPL ], mallocs[ BENCHMALLOCFLIGHT ], mallocs[ BENCHMALLOCFANOUT ] );
+	}else{
+		printf( "\nlibrary: hits %lu misses %lu errors %lu timeouts %lu retries %lu reconnects %lu bytes in %lu out %lu\nmallocs: param %lu completion %lu flight %lu fanout %lu\n",
+			(*st).hits, (*st).misses, (*st).errors, (*st).timeouts, (*st).retries, (*st).reconnects, (*st).bytes_in, (*st).bytes_out,
+			mallocs[ BENCHMALLOCPARAM ], mallocs[ BENCHMALLOCCOMPL ], mallocs[ BENCHMALLOCFLIGHT ], mallocs[ BENCHMALLOCFANOUT ] );
+	}
+	fflush( stdout );
+}
+
+int  main( int argc, char *argv[] ){
+	int fromend = 0, atoms = 0, i = 0, indx = 0, num = 0, u = 0, t = 0, err = CBSUCCESS;
+	long keys = 0;
+	char *str_err = NULL;
+	char *value = NULL;
+	const char *hostip = NULL;
+	const char *capture = NULL;
+	int capturefd = -1;
+	unsigned long int recorded = 0, lost = 0, allocated = 0;
+	unsigned long int mallocs[ BENCHMALLOCS ];
+	struct addrinfo  hints;
+	unsigned long long int start = 0, elapsed = 0;
+	bench_config cfg;
+	bench_thread *bt = NULL;
+	memc_stats_server st, after;
+        unsigned char  ipdata[ MAXPATHLEN+1 ];
+        unsigned char *ip=NULL;
+	int            iplen=0;
+        unsigned char  portdata[ MEMCPORTLEN+1 ];
+        unsigned char *port=NULL;
+	int            portlen=0;
+	uchar          keydata[ BENCHKEYLEN ];
+	uchar         *key = &keydata[0];
+	MEMC *cm = NULL;
+
+	memset( &cfg, 0x00, sizeof( bench_config ) );
+	memset( &st, 0x00, sizeof( memc_stats_server ) );
+	memset( &after, 0x00, sizeof( memc_stats_server ) );
+	cfg.threads = 4;
+	cfg.requests = 10000;
+	cfg.keys = 10000;
+	cfg.zipf = 0.99;
+	cfg.minvalue = 100;
+	cfg.maxvalue = 100;
+	cfg.readpct = 90;
+	cfg.batch = 1;
+
+	err = memc_allocate( &cm );
+	if( err>=CBERROR ){
+	  fprintf( stderr, "\nmemc_allocate, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
+	  exit( err );
+	}
+
+        memset( &portdata[0], 0x20, (size_t) MEMCPORTLEN );
+        portdata[ MEMCPORTLEN ] = '\0';
+        port = &portdata[0];
+        memset( &ipdata[0], 0x20, (size_t) MAXPATHLEN );
+        ipdata[ MAXPATHLEN ]='\0';
+        ip = &ipdata[0];
+
+        atoms=argc;
+        if( argv[(atoms-1)]==NULL && argc>0 )
+          --atoms;
+        fromend = atoms-1;
+
+        /*
+         * Memcached ip and port, as in main.c. */
+        if ( atoms >= 2 ){
+	  i = -1;
+	  while( fromend>=1 && strncmp(argv[fromend],"-",1)!=0 && i<IPUFERROR && num<MEMCMAXSESSIONDBS ){
+            i = IPUFERROR;
+            if( strchr(argv[fromend],(int)':')!=NULL )
+              i = get_ip_and_port( &ip, &iplen, &port, &portlen, &argv[fromend], (int) strlen(argv[fromend]) );
+            if( i < IPUFERROR ){
+              --fromend;
+	      if( iplen>=MAXPATHLEN || portlen>=MEMCPORTLEN ){
+		fprintf( stderr, "\nIP or port length was over the limit." );
+		exit(-1);
+	      }
+	      (*(*cm).sesdbparams[ num ]).ip = (uchar *) malloc( (size_t) sizeof( char ) * ( iplen + 1 ) );
+	      (*(*cm).sesdbparams[ num ]).port = (uchar *) malloc( (size_t) sizeof( char ) * ( portlen + 1 ) );
+	      if( (*(*cm).sesdbparams[ num ]).ip==NULL || (*(*cm).sesdbparams[ num ]).port==NULL ) exit( CBERRALLOC );
+	      memcpy( &(*(*cm).sesdbparams[ num ]).ip[0], &ip[0], (size_t) iplen );
+	      (*(*cm).sesdbparams[ num ]).ip[ iplen ] = '\0';
+	      (*(*cm).sesdbparams[ num ]).iplen = iplen;
+	      memcpy( &(*(*cm).sesdbparams[ num ]).port[0], &port[0], (size_t) portlen );
+	      (*(*cm).sesdbparams[ num ]).port[ portlen ] = '\0';
+	      (*(*cm).sesdbparams[ num ]).portlen = portlen;
+	      ++num;
+            }
+	  }
+        }
+	(*cm).redundant_servers_count = 1;
+	(*cm).session_databases = num;
+
+	if( num<=0 ){
+	  usage( &(argv[0]) );
+          exit( CBSUCCESS );
+	}
+
+        for( i=1 ; i<=fromend ; ++i ){
+          u = get_option( argv[i], argv[i+1], 'i', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            hostip = value;
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 't', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.threads = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'n', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.requests = strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'c', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.keys = strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'z', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.zipf = strtod( value, &str_err );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'v', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ){
+		cfg.minvalue = (int) strtol( value, &str_err, 10 );
+		cfg.maxvalue = cfg.minvalue;
+		if( str_err!=NULL && *str_err=='-' )
+			cfg.maxvalue = (int) strtol( &str_err[1], &str_err, 10 );
+            }
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'R', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.readpct = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'r', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) (*cm).redundant_servers_count = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'b', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.batch = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'T', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            capture = value;
+            continue;
+          }
+          u = get_option( argv[i], NULL, 'j', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+	    cfg.json = 1;
+            continue;
+          }
+          u = get_option( argv[i], NULL, 'P', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+	    cfg.preload = 1;
+            continue;
+          }
+          u = get_option( argv[i], NULL, 'h', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+	    usage( &(argv[0]) );
+            exit( CBSUCCESS );
+          }
+	}
+
+	/*
+	 * Limits. */
+	if( cfg.threads<1 ) cfg.threads = 1;
+	if( cfg.threads>BENCHMAXTHREADS ) cfg.threads = BENCHMAXTHREADS;
+	if( cfg.requests<1 ) cfg.requests = 1;
+	if( cfg.keys<1 ) cfg.keys = 1;
+	if( cfg.minvalue<1 ) cfg.minvalue = 1;
+	if( cfg.maxvalue<cfg.minvalue ) cfg.maxvalue = cfg.minvalue;
+	if( cfg.maxvalue>=BENCHMAXVALUE ) cfg.maxvalue = BENCHMAXVALUE - 1;
+	if( cfg.minvalue>cfg.maxvalue ) cfg.minvalue = cfg.maxvalue;
+	if( cfg.readpct<0 ) cfg.readpct = 0;
+	if( cfg.readpct>100 ) cfg.readpct = 100;
+	if( cfg.batch<1 ) cfg.batch = 1;
+	if( cfg.batch>BENCHMAXBATCH ) cfg.batch = BENCHMAXBATCH;
+	if( (*cm).redundant_servers_count<1 ) (*cm).redundant_servers_count = 1;
+	if( (*cm).session_databases < (*cm).redundant_servers_count ){
+		fprintf( stderr, "\nNumber of session databases was smaller than the redundant servers count, using the number of session databases." );
+		(*cm).redundant_servers_count = (*cm).session_databases;
+	}
+	bench_zipf_init( &cfg );
+
+	/*
+	 * Host address, any if not given. */
+	memset( &hints, 0x00, sizeof( struct addrinfo ) );
+	hints.ai_family = PF_INET;
+	hints.ai_socktype = SOCK_STREAM; hints.ai_protocol = IPPROTO_TCP;
+	hints.ai_flags = ( hostip==NULL ) ? AI_PASSIVE : 0;
+	err = getaddrinfo( hostip, "0", &hints, &(*cm).server_address_list );
+	if( err!=0 ){
+		fprintf( stderr, "\n'%s': Error %i in getaddrinfo, '%s'.", argv[0], err, gai_strerror( err ) );
+		exit( err );
+	}
+
+	cfg.value = (uchar*) malloc( sizeof( uchar ) * (size_t) cfg.maxvalue );
+	bt = (bench_thread*) calloc( (size_t) cfg.threads, sizeof( bench_thread ) );
+	if( cfg.value==NULL || bt==NULL ){
+	  fprintf( stderr, "\nmalloc, error %i.", CBERRALLOC );
+	  exit( CBERRALLOC );
+	}
+	for( indx=0; indx<cfg.maxvalue; ++indx )
+		cfg.value[ indx ] = (uchar) ( 'a' + ( indx % 26 ) );
+	keys = ( cfg.keys + cfg.threads - 1 ) / cfg.threads;
+	for( t=0; t<cfg.threads; ++t ){
+		bt[ t ].cm = &(*cm);
+		bt[ t ].cfg = &cfg;
+		bt[ t ].id = t;
+		bt[ t ].rnd = 0x9E3779B97F4A7C15ULL * (unsigned long long int) ( t + 1 );
+		bt[ t ].first = t * keys;
+		bt[ t ].last = ( ( t + 1 ) * keys < cfg.keys ) ? ( t + 1 ) * keys : cfg.keys;
+		bt[ t ].lat[ BENCHGET ] = (unsigned long long int*) malloc( sizeof( unsigned long long int ) * (size_t) cfg.requests );
+		bt[ t ].lat[ BENCHSET ] = (unsigned long long int*) malloc( sizeof( unsigned long long int ) * (size_t) cfg.requests );
+		bt[ t ].keys = (uchar*) malloc( sizeof( uchar ) * (size_t) ( cfg.batch * BENCHKEYLEN ) );
+		bt[ t ].started = (unsigned long long int*) malloc( sizeof( unsigned long long int ) * (size_t) cfg.batch );
+		bt[ t ].msg = (uchar*) malloc( sizeof( uchar ) * BENCHMAXVALUE );
+		if( bt[ t ].lat[ BENCHGET ]==NULL || bt[ t ].lat[ BENCHSET ]==NULL || bt[ t ].keys==NULL || bt[ t ].started==NULL || bt[ t ].msg==NULL ){
+		  fprintf( stderr, "\nmalloc, error %i.", CBERRALLOC );
+		  exit( CBERRALLOC );
+		}
+	}
+
+	signal( SIGPIPE, SIG_IGN );
+	err = memc_init( &(*cm) );
+	if( err>=CBERROR ){ fprintf( stderr, "\nmemc_init, error %i.", err ); exit( err ); }
+	indx = bench_key( &key[0], 0 );
+	err = memc_connect( &(*cm), &key, indx );
+	if( err>=CBERROR ){ fprintf( stderr, "\nmemc_connect, error %i.", err ); exit( err ); }
+	memc_wait_all( &(*cm) );
+
+	/*
+	 * Preload, not measured. */
+	if( cfg.preload==1 ){
+		for( t=0; t<cfg.threads; ++t )
+			if( pthread_create( &bt[ t ].thr, NULL, &bench_preload_thr, &bt[ t ] )!=0 ) exit( MEMCERRTHREAD );
+		for( t=0; t<cfg.threads; ++t )
+			pthread_join( bt[ t ].thr, NULL );
+		memc_wait_all( &(*cm) );
+		for( t=0; t<cfg.threads; ++t )
+			bt[ t ].errors[ BENCHSET ] = 0;
+	}
+
+	/*
+	 * Capture of the run, 19.10.2026. */
+	if( capture!=NULL ){
+		capturefd = open( capture, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+		if( capturefd<0 ){ fprintf( stderr, "\nopen '%s', errno %i '%s'.", capture, errno, strerror( errno ) ); exit( CBERRFILEOP ); }
+		err = memc_record_start( &(*cm), capturefd, MEMCRECORDKEYS );
+		if( err!=CBSUCCESS ){ fprintf( stderr, "\nmemc_record_start, error %i.", err ); exit( err ); }
+	}
+
+	/*
+	 * Run. The counters of the library are from the run only. */
+	memc_stats_snapshot( &(*cm), -1, &st );
+	start = bench_time_nsec();
+	for( t=0; t<cfg.threads; ++t )
+		if( pthread_create( &bt[ t ].thr, NULL, &bench_run_thr, &bt[ t ] )!=0 ) exit( MEMCERRTHREAD );
+	for( t=0; t<cfg.threads; ++t )
+		pthread_join( bt[ t ].thr, NULL );
+	memc_wait_all( &(*cm) );
+	elapsed = bench_time_nsec() - start;
+	if( capturefd>=0 ){
+		err = memc_record_stop( &(*cm), &recorded, &lost );
+		if( err!=CBSUCCESS || lost>0 ){ fprintf( stderr, "\nmemc_record_stop, error %i, %lu records lost.", err, lost ); }
+		close( capturefd );
+		fprintf( stderr, "\n%lu operations captured to '%s'.", recorded, capture );
+	}
+
+	memc_stats_snapshot( &(*cm), -1, &after );
+	after.hits -= st.hits; after.misses -= st.misses; after.errors -= st.errors; after.timeouts -= st.timeouts;
+	after.retries -= st.retries; after.reconnects -= st.reconnects; after.bytes_in -= st.bytes_in; after.bytes_out -= st.bytes_out;
+	/*
+	 * Every allocation of the request path: the parameters, the completions of the threads,
+	 * the flights of the coalesced GETs and the fanouts of the traced or captured writes. */
+	mallocs[ BENCHMALLOCPARAM ] = (*cm).param_mallocs;
+	mallocs[ BENCHMALLOCCOMPL ] = (*cm).completion_mallocs;
+	mallocs[ BENCHMALLOCFLIGHT ] = (*cm).flight_mallocs;
+	mallocs[ BENCHMALLOCFANOUT ] = (*cm).fanout_mallocs;
+	for( i=0; i<BENCHMALLOCS; ++i )
+		allocated += mallocs[ i ];
+	bench_report( &cfg, &bt[0], elapsed, &after, &mallocs[0] );
+
+	err = memc_quit( &(*cm) );
+	if( err>=CBERROR ){ fprintf( stderr, "\nmemc_quit, error %i.", err ); }
+	memc_wait_all( &(*cm) );
+
+	for( t=0; t<cfg.threads; ++t ){
+		free( bt[ t ].lat[ BENCHGET ] );
+		free( bt[ t ].lat[ BENCHSET ] );
+		free( bt[ t ].keys );
+		free( bt[ t ].started );
+		free( bt[ t ].msg );
+	}
+	free( bt );
+	free( cfg.value );
+	err = memc_free( cm );
+	if( err>=CBERROR ){
+	  fprintf( stderr, "\nmemc_free, error %i.", err );
+	  exit( err );
+	}
+	/*
+	 * The hot path should not allocate, test.sh fails with this, 19.10.2026. */
+	if( allocated>0 ){
+	  fprintf( stderr, "\n%lu allocations on the request path.", allocated );
+	  exit( CBERRALLOC );
+	}
+	return CBSUCCESS;
+}
+int get_ip_and_port(unsigned char **ip, int *iplen, unsigned char **port, int *portlen, char *ipandport[], int len){
+        int err = CBSUCCESS;
+        int portnum = 0;
+        err = get_urlform_ip_and_port( (* (unsigned char **)  ipandport), len, &(* (unsigned char **) ip), &(*iplen), &portnum );
+        *portlen = snprintf( &(* (char**) port)[0], (size_t) MEMCPORTLEN, "%d", portnum );
+        return err;
+}
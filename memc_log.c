@@ -0,0 +1,212 @@
+/*
+ * Logging of the memc client, 19.10.2026.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <pthread.h>    // Posix threads
+#include <stdlib.h>     // malloc
+#include <stdio.h>      // vsnprintf
+#include <stdarg.h>     // va_list
+#include <string.h>     // memset
+#include <time.h>       // nanosleep
+#include <sys/types.h>  // uint
+
+#include "../include/cb_buffer.h"
+#include "./memc_log.h"
+
+/*
+ * Ring of one thread, one producer (the thread) and one consumer (the ring thread). The
+ * ring stays in the list after the thread ends and the next new thread takes it when it is empty. */
+typedef struct memc_log_entry {
+	int                     priority;
+	signed int              errtype;
+	char                    text[ MEMCLOGLINE ];
+} memc_log_entry;
+
+typedef struct memc_log_ring {
+	struct memc_log_ring   *next;
+	int                     owned;       // atomic, 1 while a thread uses the ring
+	int                     emptypad;
+	unsigned long int       dropped;     // atomic
+	uint                    head __attribute__ ((aligned (64)));  // producer
+	uint                    tail __attribute__ ((aligned (64)));  // consumer
+	memc_log_entry          entry[ MEMCLOGRING ];
+} memc_log_ring;
+
+int                          memc_log_level = MEMCLOGLEVEL;
+
+static int                   memc_log_on = 0;        // atomic
+static int                   memc_log_thr_created = 0;
+static pthread_t             memc_log_thr;
+static pthread_mutex_t       memc_log_mtx = PTHREAD_MUTEX_INITIALIZER; // memc_log_async only
+static memc_log_ring        *memc_log_rings = NULL;  // atomic push, never removed
+static pthread_once_t        memc_log_once = PTHREAD_ONCE_INIT;
+static pthread_key_t         memc_log_key;
+static __thread memc_log_ring *memc_log_own = NULL;
+
+static void            memc_log_key_create( void );
+static void            memc_log_release( void *ring );
+static memc_log_ring*  memc_log_ring_get( void );
+static int             memc_log_drain( void );       // returns the number of messages written
+static void*           memc_log_drain_thr( void *prm );
+
+int  memc_set_log_level( int level ){
+	if( level<CBLOGEMERG ) level = CBLOGEMERG;
+	if( level>MEMCLOGLEVEL ) level = MEMCLOGLEVEL;
+	memc_log_level = level;
+	return CBSUCCESS;
+}
+
+void  memc_log_key_create( void ){
+	pthread_key_create( &memc_log_key, &memc_log_release );
+}
+/*
+ * At the end of the thread. */
+void  memc_log_release( void *ring ){
+	if( ring==NULL ) return;
+	__atomic_store_n( &(* (memc_log_ring*) ring).owned, 0, __ATOMIC_RELEASE );
+}
+memc_log_ring*  memc_log_ring_get( void ){
+	int owned = 0;
+	memc_log_ring *rg = NULL;
+	if( memc_log_own!=NULL ) return memc_log_own;
+	pthread_once( &memc_log_once, &memc_log_key_create );
+	for( rg = __atomic_load_n( &memc_log_rings, __ATOMIC_ACQUIRE ); rg!=NULL; rg = (*rg).next ){
+		if( __atomic_load_n( &(*rg).tail, __ATOMIC_ACQUIRE )!=__atomic_load_n( &(*rg).head, __ATOMIC_ACQUIRE ) )
+			continue; // not yet written, a new ring instead
+		owned = 0;
+		if( __atomic_compare_exchange_n( &(*rg).owned, &owned, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) )
+			break;
+	}
+	if( rg==NULL ){
+		rg = (memc_log_ring*) malloc( sizeof( memc_log_ring ) );
+		if( rg==NULL ) return NULL;
+		memset( &(*rg), 0x00, sizeof( memc_log_ring ) );
+		(*rg).owned = 1;
+		(*rg).next = __atomic_load_n( &memc_log_rings, __ATOMIC_RELAXED );
+		while( ! __atomic_compare_exchange_n( &memc_log_rings, &(*rg).next, rg, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) )
+			;
+	}
+	pthread_setspecific( memc_log_key, &(*rg) );
+	memc_log_own = &(*rg);
+	return rg;
+}
+
+void  memc_log( int priority, signed int errtype, const char *format, ... ){
+	uint head = 0;
+	va_list ap;
+	char line[ MEMCLOGLINE ];
+	memc_log_ring *rg = NULL;
+	memc_log_entry *ent = NULL;
+	if( format==NULL ) return;
+	if( __atomic_load_n( &memc_log_on, __ATOMIC_ACQUIRE )!=0 )
+		rg = memc_log_ring_get();
+	if( rg==NULL ){
+		va_start( ap, format );
+		vsnprintf( &line[0], MEMCLOGLINE, format, ap );
+		va_end( ap );
+		cb_clog( priority, errtype, "%s", &line[0] );
+		if( priority<=CBLOGERR )
+			cb_flush_log();
+		return;
+	}
+	head = (*rg).head; // written only here
+	if( head - __atomic_load_n( &(*rg).tail, __ATOMIC_ACQUIRE )>=MEMCLOGRING ){
+		__atomic_add_fetch( &(*rg).dropped, 1, __ATOMIC_RELAXED );
+		return;
+	}
+	ent = &(*rg).entry[ head % MEMCLOGRING ];
+	(*ent).priority = priority;
+	(*ent).errtype = errtype;
+	va_start( ap, format );
+	vsnprintf( &(*ent).text[0], MEMCLOGLINE, format, ap );
+	va_end( ap );
+	__atomic_store_n( &(*rg).head, head + 1, __ATOMIC_RELEASE );
+}
+void  memc_flush_log( void ){
+	if( __atomic_load_n( &memc_log_on, __ATOMIC_ACQUIRE )==0 )
+		cb_flush_log(); // otherwise the ring thread flushes
+}
+
+int  memc_log_drain( void ){
+	int cnt = 0;
+	uint tail = 0;
+	unsigned long int dropped = 0;
+	memc_log_ring *rg = NULL;
+	memc_log_entry *ent = NULL;
+	for( rg = __atomic_load_n( &memc_log_rings, __ATOMIC_ACQUIRE ); rg!=NULL; rg = (*rg).next ){
+		tail = (*rg).tail; // written only here
+		while( tail!=__atomic_load_n( &(*rg).head, __ATOMIC_ACQUIRE ) ){
+			ent = &(*rg).entry[ tail % MEMCLOGRING ];
+			cb_clog( (*ent).priority, (*ent).errtype, "%s", &(*ent).text[0] );
+			++tail;
+			++cnt;
+			__atomic_store_n( &(*rg).tail, tail, __ATOMIC_RELEASE );
+		}
+		dropped = __atomic_exchange_n( &(*rg).dropped, 0, __ATOMIC_RELAXED );
+		if( dropped>0 ){
+			cb_clog( CBLOGWARNING, CBOVERFLOW, "\nmemc_log: %lu messages dropped, ring full.", dropped );
+			++cnt;
+		}
+	}
+	if( cnt>0 )
+		cb_flush_log();
+	return cnt;
+}
+void* memc_log_drain_thr( void *prm ){
+	struct timespec ts;
+	ts.tv_sec = 0;
+	ts.tv_nsec = MEMCLOGDRAINMS * 1000000L;
+	while( __atomic_load_n( &memc_log_on, __ATOMIC_ACQUIRE )!=0 ){
+		memc_log_drain();
+		nanosleep( &ts, NULL );
+	}
+	memc_log_drain();
+	return prm;
+}
+int  memc_log_async( char on ){
+	int err = 0;
+	pthread_mutex_lock( &memc_log_mtx );
+	if( on!=0 && memc_log_thr_created==0 ){
+		__atomic_store_n( &memc_log_on, 1, __ATOMIC_RELEASE );
+		err = pthread_create( &memc_log_thr, NULL, &memc_log_drain_thr, NULL );
+		if( err!=0 ){
+			__atomic_store_n( &memc_log_on, 0, __ATOMIC_RELEASE );
+			pthread_mutex_unlock( &memc_log_mtx );
+			cb_clog( CBLOGERR, CBERRALLOCTHR, "\nmemc_log_async: pthread_create, error %i.", err );
+			return CBERRALLOCTHR;
+		}
+		memc_log_thr_created = 1;
+	}else if( on==0 && memc_log_thr_created!=0 ){
+		__atomic_store_n( &memc_log_on, 0, __ATOMIC_RELEASE );
+		pthread_join( memc_log_thr, NULL ); // writes the rest
+		memc_log_thr_created = 0;
+		memc_log_drain(); // written after the last drain of the thread
+	}
+	pthread_mutex_unlock( &memc_log_mtx );
+	return CBSUCCESS;
+}
+void  memc_log_forked( void ){
+	__atomic_store_n( &memc_log_on, 0, __ATOMIC_RELEASE );
+	memc_log_thr_created = 0;
+	pthread_mutex_init( &memc_log_mtx, NULL );
+}
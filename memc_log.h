@@ -0,0 +1,53 @@
+/*
+ * Logging of the memc client, 19.10.2026.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * MEMCLOGLEVEL is the highest level compiled in (CBLOGEMERG ... CBLOGDEBUG), the
+ * calls above it are removed by the compiler. -DMEMCLOGLEVEL=CBLOGDEBUG compiles in
+ * the debug messages. memc_log_level is checked before the message is formatted. */
+#ifndef MEMCLOGLEVEL
+#define MEMCLOGLEVEL            CBLOGWARNING
+#endif
+
+#define MEMCLOGLINE             256    // longest message, formatted
+#define MEMCLOGRING             64     // messages in the ring of a thread
+#define MEMCLOGDRAINMS          10     // the ring thread writes the messages this often
+
+#define MEMCLOG( prio, err, ... )  do{ if( (prio)<=MEMCLOGLEVEL && (prio)<=memc_log_level ) memc_log( (prio), (err), __VA_ARGS__ ); }while(0)
+#define MEMCFLUSHLOG()             do{ if( MEMCLOGLEVEL>=CBLOGDEBUG && memc_log_level>=CBLOGDEBUG ) memc_flush_log(); }while(0)
+
+extern int  memc_log_level;    // at start MEMCLOGLEVEL
+
+/*
+ * memc_log_level, at most MEMCLOGLEVEL. */
+int  memc_set_log_level( int level );
+
+/*
+ * 'on' 1: the messages are written to a ring of the calling thread (without locks) and a
+ * thread writes them to the log with cb_clog every MEMCLOGDRAINMS. 'on' 0 stops the thread
+ * and writes the rest. A message is dropped if the ring of the thread is full. */
+int  memc_log_async( char on );
+
+void memc_log( int priority, signed int errtype, const char *format, ... ) __attribute__ ((format (printf, 3, 4)));
+void memc_flush_log( void );
+void memc_log_forked( void );  // in the child after fork, the ring thread is not there
@@ -0,0 +1,302 @@
+/*
+ * Microbenchmarks of the memc library, 19.10.2026. Header encoding and decoding,
+ * memc_send and memc_recv, key hashing and routing and the connection counters
+ * under contention. memc_send and memc_recv write and read a buffer in memory
+ * instead of a socket, the cost of the system calls is not measured.
+ *
+ * Includes memc.c to call its static functions; compiled with -O2 and linked
+ * without memc.o.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>     // strtol
+#include <string.h>     // memcpy
+#include <unistd.h>     // read and write, declared before the macros
+#include <pthread.h>    // threads
+#include <time.h>       // clock_gettime
+#include <sys/types.h>  // ssize_t
+#include <sys/uio.h>    // writev, declared before the macro
+
+/*
+ * The socket of memc_send and memc_recv is a buffer. */
+static ssize_t micro_write( int fd, const void *buf, size_t len );
+static ssize_t micro_read( int fd, void *buf, size_t len );
+static ssize_t micro_writev( int fd, const struct iovec *iov, int cnt );
+#define write( fd, buf, len )  micro_write( ( fd ), ( buf ), ( len ) )
+#define read( fd, buf, len )   micro_read( ( fd ), ( buf ), ( len ) )
+#define writev( fd, iov, cnt ) micro_writev( ( fd ), ( iov ), ( cnt ) )
+
+#include "./memc.c"
+
+#undef write
+#undef read
+#undef writev
+
+#include "../include/get_option.h"
+
+#define MICROITERATIONS     10000000
+#define MICROTHREADS        16
+#define MICROWIRE           65536
+#define MICROVALUE          100
+#define MICROKEYS           1024
+
+typedef struct micro_thread {
+	pthread_t               thr;
+	int                    *counter;     // packed array or the 'processing' of a connection
+	dbs_conn               *conn;
+	long                    iterations;
+} micro_thread;
+
+static uchar    micro_wire[ MICROWIRE ];
+static size_t   micro_wlen = 0;
+static size_t   micro_rpos = 0;
+static size_t   micro_rlen = 0;
+static volatile unsigned long long int micro_sink = 0;   // results, not optimized away
+static int      micro_packed[ MEMCMAXREDUNDANTDBS ];     // neighbouring counters, one cache line
+
+int  main( int argc, char *argv[] );
+void usage( char *progname[] );
+static unsigned long long int micro_time_nsec( void );
+static void   micro_print( const char *name, long iterations, unsigned long long int nsec );
+static void*  micro_packed_thr( void *prm );
+static void*  micro_conn_thr( void *prm );
+static unsigned long long int micro_contention( MEMC *cm, int threads, long iterations, char packed );
+
+void usage (char *progname[]){
+        fprintf(stderr,"Usage:\n");
+        fprintf(stderr,"\t%s [-h] [ -n <iterations> ] [ -t <threads> ]\n", progname[0]);
+        fprintf(stderr,"\t-n\tIterations of each benchmark, default %i.\n", MICROITERATIONS);
+        fprintf(stderr,"\t-t\tThreads of the contention benchmark, default %i.\n", MICROTHREADS);
+        fprintf(stderr,"\t-h\tHelp.\n");
+}
+
+ssize_t  micro_write( int fd, const void *buf, size_t len ){
+	(void) fd;
+	if( micro_wlen + len > MICROWIRE ) micro_wlen = 0;
+	memcpy( &micro_wire[ micro_wlen ], buf, len );
+	micro_wlen += len;
+	return (ssize_t) len;
+}
+ssize_t  micro_writev( int fd, const struct iovec *iov, int cnt ){
+	int indx = 0;
+	ssize_t total = 0;
+	for( indx=0; indx<cnt; ++indx )
+		total += micro_write( fd, iov[ indx ].iov_base, iov[ indx ].iov_len );
+	return total;
+}
+ssize_t  micro_read( int fd, void *buf, size_t len ){
+	(void) fd;
+	if( len > micro_rlen - micro_rpos ) len = micro_rlen - micro_rpos;
+	memcpy( buf, &micro_wire[ micro_rpos ], len );
+	micro_rpos += len;
+	return (ssize_t) len;
+}
+
+unsigned long long int  micro_time_nsec( void ){
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( (unsigned long long int) ts.tv_sec * 1000000000ULL ) + (unsigned long long int) ts.tv_nsec;
+}
+void  micro_print( const char *name, long iterations, unsigned long long int nsec ){
+	double ns = ( iterations>0 ) ? (double) nsec / (double) iterations : 0.0;
+	printf( "\n%-32s %10.2f ns/op %12.1f Mops/s", name, ns, ( ns>0 ) ? 1000.0 / ns : 0.0 );
+	fflush( stdout );
+}
+
+/*
+ * Contention of the 'processing' counters, user-031. Each thread increments and
+ * decrements its own counter: neighbouring ints of one cache line or the counter
+ * of its own connection in the aligned table. */
+void* micro_packed_thr( void *prm ){
+	micro_thread *mt = (micro_thread*) prm;
+	long indx = 0;
+	int val = 0;
+	for( indx=0; indx<(*mt).iterations; ++indx ){ // as memc_processing_inc and memc_processing_dec
+		__atomic_add_fetch( &(*(*mt).counter), 1, __ATOMIC_ACQ_REL );
+		val = __atomic_load_n( &(*(*mt).counter), __ATOMIC_ACQUIRE );
+		while( val>0 && ! __atomic_compare_exchange_n( &(*(*mt).counter), &val, val-1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+			;
+	}
+	return NULL;
+}
+void* micro_conn_thr( void *prm ){
+	micro_thread *mt = (micro_thread*) prm;
+	long indx = 0;
+	for( indx=0; indx<(*mt).iterations; ++indx ){
+		memc_processing_inc( &(*(*mt).conn) );
+		memc_processing_dec( &(*(*mt).conn) );
+	}
+	return NULL;
+}
+unsigned long long int  micro_contention( MEMC *cm, int threads, long iterations, char packed ){
+	int indx = 0;
+	unsigned long long int start = 0;
+	micro_thread mt[ MICROTHREADS * 4 ];
+	memset( &mt[0], 0x00, sizeof( mt ) );
+	start = micro_time_nsec();
+	for( indx=0; indx<threads; ++indx ){
+		mt[ indx ].iterations = iterations;
+		mt[ indx ].counter = &micro_packed[ indx % MEMCMAXREDUNDANTDBS ]; // shared as the connections
+		mt[ indx ].conn = &(*(*(*cm).token).conn[ indx % MEMCMAXREDUNDANTDBS ]);
+		if( pthread_create( &mt[ indx ].thr, NULL, ( packed==1 ) ? &micro_packed_thr : &micro_conn_thr, &mt[ indx ] )!=0 )
+			return 0;
+	}
+	for( indx=0; indx<threads; ++indx )
+		pthread_join( mt[ indx ].thr, NULL );
+	return micro_time_nsec() - start;
+}
+
+int  main( int argc, char *argv[] ){
+	int i = 0, u = 0, threads = MICROTHREADS, keylen = 0, err = CBSUCCESS;
+	long iterations = MICROITERATIONS, indx = 0;
+	char *str_err = NULL;
+	char *value = NULL;
+	unsigned long long int start = 0, sum = 0;
+	memc_msg hdr, resp;
+	memc_extras ext;
+	uchar keys[ MICROKEYS ][ 32 ];
+	uchar keydata[ 32 ], valuedata[ MICROVALUE ], msgdata[ MICROVALUE + 32 ];
+	uchar *key = &keydata[0], *msg = &valuedata[0], *rmsg = &msgdata[0];
+	uint rmsglen = 0;
+	size_t resplen = 0;
+	MEMC *cm = NULL;
+
+        for( i=1 ; i<argc ; ++i ){
+          u = get_option( argv[i], argv[i+1], 'n', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) iterations = strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 't', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) threads = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], NULL, 'h', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+	    usage( &(argv[0]) );
+            exit( CBSUCCESS );
+          }
+	}
+	if( iterations<1 ) iterations = 1;
+	if( threads<1 ) threads = 1;
+	if( threads>MICROTHREADS * 4 ) threads = MICROTHREADS * 4;
+
+	err = memc_allocate( &cm );
+	if( err>=CBERROR ){
+	  fprintf( stderr, "\nmemc_allocate, error %i.", err );
+	  exit( err );
+	}
+	(*cm).session_databases = 3;
+	memset( &valuedata[0], 'v', MICROVALUE );
+	keylen = snprintf( &(* (char*) keydata), sizeof( keydata ), "micro:key:%i", 12345 );
+	for( i=0; i<MICROKEYS; ++i )
+		snprintf( &(* (char*) keys[ i ]), sizeof( keys[ i ] ), "micro:key:%.4i", i ); // 14 bytes
+	memset( &ext, 0x00, sizeof( memc_extras ) );
+
+	/*
+	 * Header. */
+	start = micro_time_nsec();
+	for( indx=0; indx<iterations; ++indx ){
+		memc_hdr_request( &hdr, MEMCSET, (ushort) keylen, (uint) ( MICROVALUE + 8 + keylen ), 0, (unsigned long long int) indx );
+		sum += hdr.body_length;
+	}
+	micro_print( "header encode (memc_hdr_request)", iterations, micro_time_nsec() - start );
+
+	start = micro_time_nsec();
+	for( indx=0; indx<iterations; ++indx ){
+		hdr.cas = (unsigned long long int) indx;
+		memc_hdr_to_big_endian( &hdr );
+		sum += hdr.cas;
+	}
+	micro_print( "header decode (to_big_endian)", iterations, micro_time_nsec() - start );
+
+	/*
+	 * Requests, written to the buffer. */
+	start = micro_time_nsec();
+	for( indx=0; indx<iterations; ++indx ){
+		micro_wlen = 0;
+		memc_hdr_request( &hdr, MEMCGET, (ushort) keylen, (uint) keylen, 0, 0 );
+		err = memc_send( 1, &hdr, NULL, &key, (ushort) keylen, NULL, 0 );
+		sum += (unsigned long long int) err + micro_wlen;
+	}
+	micro_print( "memc_send GET", iterations, micro_time_nsec() - start );
+
+	start = micro_time_nsec();
+	for( indx=0; indx<iterations; ++indx ){
+		micro_wlen = 0;
+		memc_hdr_request( &hdr, MEMCSET, (ushort) keylen, (uint) ( MICROVALUE + 8 + keylen ), 0, 0 );
+		ext.flags = 0; ext.expiration = 120;
+		err = memc_send( 1, &hdr, &ext, &key, (ushort) keylen, &msg, MICROVALUE );
+		sum += (unsigned long long int) err + micro_wlen;
+	}
+	micro_print( "memc_send SET 100 bytes", iterations, micro_time_nsec() - start );
+
+	/*
+	 * Responce of a GET with flags and a value, read from the buffer. */
+	memset( &resp, 0x00, sizeof( memc_msg ) );
+	resp.magic = MEMCRESPONCE;
+	resp.opcode = MEMCGET;
+	resp.extras_length = 4;
+	resp.body_length = MEMCHTON32( 4 + MICROVALUE );
+	resp.opaque = MEMCHTON32( MEMCOPAQUE );
+	resp.cas = MEMCHTON64( 42 );
+	memcpy( &micro_wire[0], &resp, sizeof( memc_msg ) );
+	memset( &micro_wire[ sizeof( memc_msg ) ], 0x00, 4 );
+	memcpy( &micro_wire[ sizeof( memc_msg ) + 4 ], &valuedata[0], MICROVALUE );
+	resplen = sizeof( memc_msg ) + 4 + MICROVALUE;
+	start = micro_time_nsec();
+	for( indx=0; indx<iterations; ++indx ){
+		micro_rpos = 0; micro_rlen = resplen;
+		err = memc_recv( 0, &hdr, &ext, NULL, NULL, 0, &rmsg, &rmsglen, MICROVALUE + 32 );
+		sum += (unsigned long long int) err + rmsglen + hdr.cas;
+	}
+	micro_print( "memc_recv GET 100 bytes", iterations, micro_time_nsec() - start );
+	if( err!=CBSUCCESS || rmsglen!=MICROVALUE ) printf( " (error %i, value %u)", err, rmsglen );
+
+	/*
+	 * Routing. */
+	start = micro_time_nsec();
+	for( indx=0; indx<iterations; ++indx ){
+		sum += memc_hash_key( &keys[ indx & ( MICROKEYS - 1 ) ][0], 14 );
+	}
+	micro_print( "memc_hash_key", iterations, micro_time_nsec() - start );
+
+	start = micro_time_nsec();
+	for( indx=0; indx<iterations; ++indx ){
+		key = &keys[ indx & ( MICROKEYS - 1 ) ][0];
+		sum += memc_key_order( &key[0], 14 );
+		sum += (unsigned long long int) memc_get_starting_index( &(*cm), (char) key[ 13 ] );
+	}
+	micro_print( "routing (key_order, start index)", iterations, micro_time_nsec() - start );
+
+	/*
+	 * Contention. */
+	iterations = iterations / 10 + 1;
+	micro_print( "processing, packed ints", iterations * threads, micro_contention( &(*cm), threads, iterations, 1 ) );
+	micro_print( "processing, connection table", iterations * threads, micro_contention( &(*cm), threads, iterations, 0 ) );
+	printf( "\n%i threads, %i connections.\n", threads, MEMCMAXREDUNDANTDBS );
+
+	micro_sink = sum;
+	memc_free( cm );
+	return CBSUCCESS;
+}
@@ -0,0 +1,530 @@
+/*
+ * Mock memcached, 19.10.2026. Serves the binary protocol subset of the client
+ * (GET, SET, REPLACE, DELETE, QUIT, TOUCH, ADD, NOOP, GETK and the quiet variants)
+ * from a hash table in memory. Latency, jitter, errors and dropped connections
+ * can be injected to test the failover and to benchmark on one machine.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>     // malloc, strtol
+#include <string.h>     // memcpy
+#include <errno.h>      // errno
+#include <unistd.h>     // read, write
+#include <pthread.h>    // threads
+#include <signal.h>     // sigaction
+#include <time.h>       // nanosleep
+#include <sys/types.h>  // defines
+#include <sys/socket.h> // socket
+#include <netinet/in.h> // sockaddr_in
+#include <netinet/tcp.h> // TCP_NODELAY
+#include <arpa/inet.h>  // inet_pton, htons
+#include <endian.h>     // be64toh
+
+#include "../include/get_option.h"
+#include "../include/cb_buffer.h"
+#include "./memc.h"
+
+#define MOCKPORT            11211
+#define MOCKBUCKETS         65536      // power of two
+#define MOCKLOCKS           256        // mutexes of the buckets, power of two
+#define MOCKMAXKEY          250
+#define MOCKMAXVALUE        ( 1024*1024 )
+#define MOCKBACKLOG         128
+
+typedef struct mock_item {
+	struct mock_item       *next;
+	unsigned long long int  cas;
+	time_t                  expires;    // 0 never
+	uint                    flags;
+	uint                    vallen;
+	ushort                  keylen;
+	ushort                  emptypad;
+	uchar                   data[];     // key and value
+} mock_item;
+
+typedef struct mock_config {
+	int                     port;        // -p
+	int                     latency;     // -l, microseconds before each responce
+	int                     jitter;      // -j, microseconds, uniform from 0
+	int                     errorpct;    // -e, percent of the requests answered with MEMCTEMPORARYFAILURE
+	int                     droppct;     // -x, percent of the requests closing the connection without a responce
+	int                     verbose;     // -v
+	char                    address[ 64 ]; // -a
+} mock_config;
+
+typedef struct mock_conn {
+	int                     fd;
+	int                     emptypad;
+	unsigned long long int  rnd;         // xorshift64*
+	uchar                  *in;          // request body
+	uchar                  *out;         // responce
+} mock_conn;
+
+static mock_config              mock_cfg;
+static mock_item              **mock_table = NULL;
+static pthread_mutex_t          mock_locks[ MOCKLOCKS ];
+static unsigned long long int   mock_cas = 0;
+static volatile sig_atomic_t    mock_stop = 0;
+static int                      mock_lfd = -1;
+static unsigned long int        mock_requests = 0, mock_conns = 0, mock_errors = 0, mock_drops = 0;
+
+int  main( int argc, char *argv[] );
+void usage( char *progname[] );
+static void   mock_signal( int sig );
+static uint   mock_hash( uchar *key, int keylen );
+static unsigned long long int mock_random( mock_conn *mc );
+static int    mock_read_all( int fd, uchar *buf, int len );
+static int    mock_write_all( int fd, uchar *buf, int len );
+static int    mock_respond( mock_conn *mc, memc_msg *req, ushort status, int extlen, int keylen, int vallen, unsigned long long int cas );
+static mock_item* mock_find( uint hash, uchar *key, int keylen, mock_item ***prev ); // locked
+static int    mock_request( mock_conn *mc, memc_msg *req );
+static void*  mock_conn_thr( void *prm );
+
+void usage (char *progname[]){
+        fprintf(stderr,"Usage:\n");
+        fprintf(stderr,"\t%s [-v][-h] [ -a <address> ] [ -p <port> ] [ -l <microseconds> ] [ -j <microseconds> ] \\\n", progname[0]);
+        fprintf(stderr,"\t\t [ -e <percent> ] [ -x <percent> ]\n");
+        fprintf(stderr,"\t-a\tAddress to listen, default 127.0.0.1.\n");
+        fprintf(stderr,"\t-p\tPort, default %i.\n", MOCKPORT);
+        fprintf(stderr,"\t-l\tLatency added to each responce.\n");
+        fprintf(stderr,"\t-j\tJitter, a random latency from zero to the microseconds.\n");
+        fprintf(stderr,"\t-e\tPercent of the requests answered with a temporary failure.\n");
+        fprintf(stderr,"\t-x\tPercent of the requests closing the connection.\n");
+        fprintf(stderr,"\t-v\tPrint the counters at exit.\n");
+        fprintf(stderr,"\t-h\tHelp.\n");
+        fprintf(stderr,"\n\tMemcached binary protocol from memory until SIGINT or SIGTERM.\n");
+}
+
+void  mock_signal( int sig ){
+	(void) sig;
+	mock_stop = 1;
+	if( mock_lfd>=0 ){
+		shutdown( mock_lfd, SHUT_RDWR );
+	}
+}
+uint  mock_hash( uchar *key, int keylen ){
+	uint hash = 2166136261U;
+	int indx = 0;
+	for( indx=0; indx<keylen; ++indx ){
+		hash ^= (uint) key[ indx ];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+unsigned long long int  mock_random( mock_conn *mc ){
+	(*mc).rnd ^= (*mc).rnd >> 12;
+	(*mc).rnd ^= (*mc).rnd << 25;
+	(*mc).rnd ^= (*mc).rnd >> 27;
+	return (*mc).rnd * 2685821657736338717ULL;
+}
+int  mock_read_all( int fd, uchar *buf, int len ){
+	int done = 0, ret = 0;
+	while( done<len ){
+		ret = (int) read( fd, &buf[ done ], (size_t) ( len - done ) );
+		if( ret<0 && errno==EINTR ) continue;
+		if( ret<=0 ) return CBERRFILEOP;
+		done += ret;
+	}
+	return CBSUCCESS;
+}
+int  mock_write_all( int fd, uchar *buf, int len ){
+	int done = 0, ret = 0;
+	while( done<len ){
+		ret = (int) write( fd, &buf[ done ], (size_t) ( len - done ) );
+		if( ret<0 && errno==EINTR ) continue;
+		if( ret<=0 ) return CBERRFILEOP;
+		done += ret;
+	}
+	return CBSUCCESS;
+}
+
+/*
+ * Extras, key and value are already in 'out' after the header. One write. */
+int  mock_respond( mock_conn *mc, memc_msg *req, ushort status, int extlen, int keylen, int vallen, unsigned long long int cas ){
+	memc_msg hdr;
+	memset( &hdr, 0x00, sizeof( memc_msg ) );
+	hdr.magic = MEMCRESPONCE;
+	hdr.opcode = (*req).opcode;
+	hdr.key_length = htons( (ushort) keylen );
+	hdr.extras_length = (uchar) extlen;
+	hdr.data_type = MEMCDATATYPE;
+	hdr.status = htons( status );
+	hdr.body_length = htonl( (uint) ( extlen + keylen + vallen ) );
+	hdr.opaque = (*req).opaque;     // as received
+	hdr.cas = htobe64( cas );
+	memcpy( &(*mc).out[0], &hdr, sizeof( memc_msg ) );
+	return mock_write_all( (*mc).fd, &(*mc).out[0], (int) sizeof( memc_msg ) + extlen + keylen + vallen );
+}
+
+mock_item*  mock_find( uint hash, uchar *key, int keylen, mock_item ***prev ){
+	mock_item **ptr = &mock_table[ hash & ( MOCKBUCKETS - 1 ) ];
+	time_t now = time( NULL );
+	while( *ptr!=NULL ){
+		if( (**ptr).expires!=0 && (**ptr).expires<=now ){ // expired, removed
+			mock_item *old = *ptr;
+			*ptr = (*old).next;
+			free( old );
+			continue;
+		}
+		if( (**ptr).keylen==keylen && memcmp( &(**ptr).data[0], &key[0], (size_t) keylen )==0 ){
+			if( prev!=NULL ) *prev = ptr;
+			return *ptr;
+		}
+		ptr = &(**ptr).next;
+	}
+	return NULL;
+}
+
+/*
+ * Returns CBSUCCESS to read the next request, otherwise the connection is closed. */
+int  mock_request( mock_conn *mc, memc_msg *req ){
+	int keylen = 0, extlen = 0, vallen = 0, err = CBSUCCESS;
+	uint hash = 0, flags = 0, expiration = 0;
+	unsigned long long int cas = 0, rnd = 0, newcas = 0;
+	uchar *key = NULL, *val = NULL, *out = NULL;
+	uchar  opcode = (*req).opcode;
+	char   quiet = 0;
+	mock_item *item = NULL, **prev = NULL;
+	pthread_mutex_t *mtx = NULL;
+	struct timespec ts;
+
+	extlen = (int) (*req).extras_length;
+	keylen = (int) ntohs( (*req).key_length );
+	vallen = (int) ntohl( (*req).body_length ) - extlen - keylen;
+	cas = be64toh( (*req).cas );
+	key = &(*mc).in[ extlen ];
+	val = &(*mc).in[ extlen + keylen ];
+	out = &(*mc).out[ sizeof( memc_msg ) ];
+	quiet = ( opcode==MEMCGETQ || opcode==MEMCGETKQ || opcode==MEMCSETQ || opcode==MEMCADDQ || opcode==MEMCREPLACEQ || \
+		opcode==MEMCDELETEQ || opcode==MEMCQUITQ );
+	__atomic_add_fetch( &mock_requests, 1, __ATOMIC_RELAXED );
+
+	/*
+	 * Injected faults and latency. */
+	if( mock_cfg.droppct>0 && (int) ( mock_random( &(*mc) ) % 100 ) < mock_cfg.droppct ){
+		__atomic_add_fetch( &mock_drops, 1, __ATOMIC_RELAXED );
+		return CBNEGATION;
+	}
+	if( mock_cfg.latency>0 || mock_cfg.jitter>0 ){
+		rnd = (unsigned long long int) mock_cfg.latency;
+		if( mock_cfg.jitter>0 )
+			rnd += mock_random( &(*mc) ) % (unsigned long long int) ( mock_cfg.jitter + 1 );
+		ts.tv_sec = (time_t) ( rnd / 1000000 );
+		ts.tv_nsec = (long) ( ( rnd % 1000000 ) * 1000 );
+		nanosleep( &ts, NULL );
+	}
+	if( mock_cfg.errorpct>0 && opcode!=MEMCQUIT && opcode!=MEMCQUITQ && (int) ( mock_random( &(*mc) ) % 100 ) < mock_cfg.errorpct ){
+		__atomic_add_fetch( &mock_errors, 1, __ATOMIC_RELAXED );
+		memcpy( &out[0], "Temporary failure", 17 );
+		return mock_respond( &(*mc), &(*req), MEMCTEMPORARYFAILURE, 0, 0, 17, 0 );
+	}
+
+	if( keylen>MOCKMAXKEY ){
+		memcpy( &out[0], "Invalid arguments", 17 );
+		return mock_respond( &(*mc), &(*req), MEMCINVALIDARGUMENTS, 0, 0, 17, 0 );
+	}
+	hash = mock_hash( &key[0], keylen );
+	mtx = &mock_locks[ ( hash & ( MOCKBUCKETS - 1 ) ) & ( MOCKLOCKS - 1 ) ];
+
+	switch( opcode ){
+		case MEMCGET: case MEMCGETQ: case MEMCGETK: case MEMCGETKQ:
+			pthread_mutex_lock( mtx );
+			item = mock_find( hash, &key[0], keylen, NULL );
+			if( item!=NULL ){
+				flags = htonl( (*item).flags );
+				memcpy( &out[0], &flags, 4 );
+				vallen = (int) (*item).vallen;
+				keylen = ( opcode==MEMCGETK || opcode==MEMCGETKQ ) ? (int) (*item).keylen : 0;
+				if( keylen>0 )
+					memcpy( &out[4], &(*item).data[0], (size_t) keylen );
+				memcpy( &out[ 4 + keylen ], &(*item).data[ (*item).keylen ], (size_t) vallen );
+				cas = (*item).cas;
+			}
+			pthread_mutex_unlock( mtx );
+			if( item!=NULL )
+				return mock_respond( &(*mc), &(*req), MEMCSUCCESS, 4, keylen, vallen, cas );
+			if( quiet ) return CBSUCCESS;
+			memcpy( &out[0], "Not found", 9 );
+			return mock_respond( &(*mc), &(*req), MEMCKEYNOTFOUND, 0, 0, 9, 0 );
+
+		case MEMCSET: case MEMCSETQ: case MEMCADD: case MEMCADDQ: case MEMCREPLACE: case MEMCREPLACEQ:
+			if( extlen>=8 ){
+				memcpy( &flags, &(*mc).in[0], 4 );
+				memcpy( &expiration, &(*mc).in[4], 4 );
+				flags = ntohl( flags );
+				expiration = ntohl( expiration );
+			}
+			if( vallen<0 || vallen>MOCKMAXVALUE ){
+				memcpy( &out[0], "Too large", 9 );
+				return mock_respond( &(*mc), &(*req), MEMCVALUETOOLARGE, 0, 0, 9, 0 );
+			}
+			pthread_mutex_lock( mtx );
+			item = mock_find( hash, &key[0], keylen, &prev );
+			if( ( opcode==MEMCADD || opcode==MEMCADDQ ) && item!=NULL ){
+				err = MEMCKEYEXISTS;
+			}else if( ( opcode==MEMCREPLACE || opcode==MEMCREPLACEQ ) && item==NULL ){
+				err = MEMCKEYNOTFOUND;
+			}else if( cas!=0 && ( item==NULL || (*item).cas!=cas ) ){
+				err = ( item==NULL ) ? MEMCKEYNOTFOUND : MEMCKEYEXISTS;
+			}else{
+				mock_item *new = (mock_item*) malloc( sizeof( mock_item ) + (size_t) ( keylen + vallen ) );
+				if( new==NULL ){
+					err = MEMCOUTOFMEMORY;
+				}else{
+					(*new).keylen = (ushort) keylen;
+					(*new).vallen = (uint) vallen;
+					(*new).flags = flags;
+					(*new).expires = ( expiration==0 ) ? 0 : ( ( expiration>2592000 ) ? (time_t) expiration : time( NULL ) + (time_t) expiration );
+					(*new).cas = newcas = __atomic_add_fetch( &mock_cas, 1, __ATOMIC_RELAXED );
+					memcpy( &(*new).data[0], &key[0], (size_t) keylen );
+					memcpy( &(*new).data[ keylen ], &val[0], (size_t) vallen );
+					if( item!=NULL ){ // replaces in place
+						(*new).next = (*item).next;
+						*prev = new;
+						free( item );
+					}else{
+						(*new).next = mock_table[ hash & ( MOCKBUCKETS - 1 ) ];
+						mock_table[ hash & ( MOCKBUCKETS - 1 ) ] = new;
+					}
+					err = MEMCSUCCESS;
+				}
+			}
+			pthread_mutex_unlock( mtx );
+			if( err==MEMCSUCCESS ){
+				if( quiet ) return CBSUCCESS;
+				return mock_respond( &(*mc), &(*req), MEMCSUCCESS, 0, 0, 0, newcas );
+			}
+			vallen = snprintf( &(* (char*) out), 32, "%s", ( err==MEMCKEYEXISTS ) ? "Data exists for key." : ( ( err==MEMCKEYNOTFOUND ) ? "Not found" : "Out of memory" ) );
+			return mock_respond( &(*mc), &(*req), (ushort) err, 0, 0, vallen, 0 );
+
+		case MEMCDELETE: case MEMCDELETEQ:
+			pthread_mutex_lock( mtx );
+			item = mock_find( hash, &key[0], keylen, &prev );
+			if( item==NULL ){
+				err = MEMCKEYNOTFOUND;
+			}else if( cas!=0 && (*item).cas!=cas ){
+				err = MEMCKEYEXISTS;
+			}else{
+				*prev = (*item).next;
+				free( item );
+				err = MEMCSUCCESS;
+			}
+			pthread_mutex_unlock( mtx );
+			if( err==MEMCSUCCESS ){
+				if( quiet ) return CBSUCCESS;
+				return mock_respond( &(*mc), &(*req), MEMCSUCCESS, 0, 0, 0, 0 );
+			}
+			vallen = snprintf( &(* (char*) out), 32, "%s", ( err==MEMCKEYEXISTS ) ? "Data exists for key." : "Not found" );
+			return mock_respond( &(*mc), &(*req), (ushort) err, 0, 0, vallen, 0 );
+
+		case MEMCTOUCH:
+			if( extlen>=4 ){
+				memcpy( &expiration, &(*mc).in[0], 4 );
+				expiration = ntohl( expiration );
+			}
+			pthread_mutex_lock( mtx );
+			item = mock_find( hash, &key[0], keylen, NULL );
+			if( item!=NULL ){
+				(*item).expires = ( expiration==0 ) ? 0 : ( ( expiration>2592000 ) ? (time_t) expiration : time( NULL ) + (time_t) expiration );
+				cas = (*item).cas;
+				flags = htonl( (*item).flags );
+			}
+			pthread_mutex_unlock( mtx );
+			if( item!=NULL ){
+				memcpy( &out[0], &flags, 4 );
+				return mock_respond( &(*mc), &(*req), MEMCSUCCESS, 4, 0, 0, cas );
+			}
+			memcpy( &out[0], "Not found", 9 );
+			return mock_respond( &(*mc), &(*req), MEMCKEYNOTFOUND, 0, 0, 9, 0 );
+
+		case MEMCNOOP:
+			return mock_respond( &(*mc), &(*req), MEMCSUCCESS, 0, 0, 0, 0 );
+
+		case MEMCQUIT:
+			mock_respond( &(*mc), &(*req), MEMCSUCCESS, 0, 0, 0, 0 );
+			return CBNEGATION;
+
+		case MEMCQUITQ:
+			return CBNEGATION;
+
+		default:
+			memcpy( &out[0], "Unknown command", 15 );
+			return mock_respond( &(*mc), &(*req), MEMCUNKNOWNCOMMAND, 0, 0, 15, 0 );
+	}
+}
+
+void* mock_conn_thr( void *prm ){
+	mock_conn *mc = (mock_conn*) prm;
+	memc_msg req;
+	uint bodylen = 0;
+	if( mc==NULL ) return NULL;
+	while( mock_stop==0 ){
+		if( mock_read_all( (*mc).fd, (uchar*) &req, (int) sizeof( memc_msg ) )!=CBSUCCESS ) break;
+		if( req.magic!=MEMCREQUEST ) break;
+		bodylen = ntohl( req.body_length );
+		if( bodylen > (uint) ( MOCKMAXVALUE + MOCKMAXKEY + 32 ) ) break;
+		if( bodylen>0 && mock_read_all( (*mc).fd, &(*mc).in[0], (int) bodylen )!=CBSUCCESS ) break;
+		if( (uint) req.extras_length + (uint) ntohs( req.key_length ) > bodylen ) break;
+		if( mock_request( &(*mc), &req )!=CBSUCCESS ) break;
+	}
+	close( (*mc).fd );
+	free( (*mc).in );
+	free( (*mc).out );
+	free( mc );
+	return NULL;
+}
+
+int  main( int argc, char *argv[] ){
+	int i = 0, u = 0, fd = -1, on = 1, err = CBSUCCESS;
+	char *str_err = NULL;
+	char *value = NULL;
+	struct sockaddr_in addr;
+	struct sigaction sa;
+	pthread_t thr;
+	pthread_attr_t attr;
+	mock_conn *mc = NULL;
+
+	memset( &mock_cfg, 0x00, sizeof( mock_config ) );
+	mock_cfg.port = MOCKPORT;
+	strncpy( &mock_cfg.address[0], "127.0.0.1", sizeof( mock_cfg.address ) - 1 );
+
+        for( i=1 ; i<argc ; ++i ){
+          u = get_option( argv[i], argv[i+1], 'a', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) strncpy( &mock_cfg.address[0], value, sizeof( mock_cfg.address ) - 1 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'p', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) mock_cfg.port = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'l', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) mock_cfg.latency = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'j', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) mock_cfg.jitter = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'e', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) mock_cfg.errorpct = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'x', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) mock_cfg.droppct = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], NULL, 'v', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+	    mock_cfg.verbose = 1;
+            continue;
+          }
+          u = get_option( argv[i], NULL, 'h', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+	    usage( &(argv[0]) );
+            exit( CBSUCCESS );
+          }
+	}
+	if( mock_cfg.latency<0 ) mock_cfg.latency = 0;
+	if( mock_cfg.jitter<0 ) mock_cfg.jitter = 0;
+
+	mock_table = (mock_item**) calloc( MOCKBUCKETS, sizeof( mock_item* ) );
+	if( mock_table==NULL ){
+	  fprintf( stderr, "\n%s: calloc, error %i.", argv[0], CBERRALLOC );
+	  exit( CBERRALLOC );
+	}
+	for( i=0; i<MOCKLOCKS; ++i )
+		pthread_mutex_init( &mock_locks[ i ], NULL );
+
+	memset( &addr, 0x00, sizeof( struct sockaddr_in ) );
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons( (ushort) mock_cfg.port );
+	if( inet_pton( AF_INET, &mock_cfg.address[0], &addr.sin_addr )!=1 ){
+	  fprintf( stderr, "\n%s: address '%s' was not an IPv4 address.", argv[0], &mock_cfg.address[0] );
+	  exit( MEMCADDRESSMISSING );
+	}
+	mock_lfd = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+	if( mock_lfd<0 ){
+	  fprintf( stderr, "\n%s: socket, errno %i '%s'.", argv[0], errno, strerror( errno ) );
+	  exit( MEMCERRSOCKET );
+	}
+	setsockopt( mock_lfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof( on ) );
+	if( bind( mock_lfd, (struct sockaddr*) &addr, sizeof( struct sockaddr_in ) )<0 || listen( mock_lfd, MOCKBACKLOG )<0 ){
+	  fprintf( stderr, "\n%s: bind or listen to %s:%i, errno %i '%s'.", argv[0], &mock_cfg.address[0], mock_cfg.port, errno, strerror( errno ) );
+	  exit( MEMCERRBIND );
+	}
+
+	memset( &sa, 0x00, sizeof( struct sigaction ) );
+	sa.sa_handler = &mock_signal;
+	sigemptyset( &sa.sa_mask );
+	sigaction( SIGINT, &sa, NULL );
+	sigaction( SIGTERM, &sa, NULL );
+	signal( SIGPIPE, SIG_IGN );
+
+	pthread_attr_init( &attr );
+	pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+
+	/*
+	 * One thread of each connection. */
+	while( mock_stop==0 ){
+		fd = accept( mock_lfd, NULL, NULL );
+		if( fd<0 ){
+			if( errno==EINTR || errno==ECONNABORTED ) continue;
+			if( mock_stop==0 )
+				fprintf( stderr, "\n%s: accept, errno %i '%s'.", argv[0], errno, strerror( errno ) );
+			break;
+		}
+		setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof( on ) );
+		mc = (mock_conn*) calloc( 1, sizeof( mock_conn ) );
+		if( mc!=NULL ){
+			(*mc).in = (uchar*) malloc( MOCKMAXVALUE + MOCKMAXKEY + 32 );
+			(*mc).out = (uchar*) malloc( sizeof( memc_msg ) + MOCKMAXVALUE + MOCKMAXKEY + 32 );
+		}
+		if( mc==NULL || (*mc).in==NULL || (*mc).out==NULL ){
+			close( fd );
+			if( mc!=NULL ){ free( (*mc).in ); free( (*mc).out ); free( mc ); }
+			continue;
+		}
+		(*mc).fd = fd;
+		(*mc).rnd = 0x9E3779B97F4A7C15ULL ^ ( (unsigned long long int) time( NULL ) << 16 ) ^ (unsigned long long int) ++mock_conns;
+		err = pthread_create( &thr, &attr, &mock_conn_thr, &(*mc) );
+		if( err!=0 ){
+			fprintf( stderr, "\n%s: pthread_create, error %i.", argv[0], err );
+			close( fd );
+			free( (*mc).in ); free( (*mc).out ); free( mc );
+		}
+	}
+	pthread_attr_destroy( &attr );
+	close( mock_lfd );
+
+	if( mock_cfg.verbose==1 ){
+		fprintf( stderr, "\n%s: connections %lu, requests %lu, injected errors %lu, dropped %lu.\n", argv[0],
+			mock_conns, __atomic_load_n( &mock_requests, __ATOMIC_RELAXED ), __atomic_load_n( &mock_errors, __ATOMIC_RELAXED ),
+			__atomic_load_n( &mock_drops, __ATOMIC_RELAXED ) );
+	}
+	return CBSUCCESS;
+}
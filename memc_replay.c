@@ -0,0 +1,572 @@
+/*
+ * Replay of a capture of the operations (memc_record_start), 19.10.2026. The
+ * records are sent again at their original times, or faster with '-s', from
+ * threads sharing one MEMC. The records of a key go to the same thread in their
+ * order. Reports the latency of each operation next to the captured latency and
+ * how late the requests were from their schedule.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>     // exit, qsort
+#include <string.h>     // memset
+#include <errno.h>      // errno
+#include <pthread.h>    // threads
+#include <time.h>       // clock_gettime, clock_nanosleep
+#include <signal.h>     // SIGPIPE
+#include <fcntl.h>      // open
+#include <unistd.h>     // read, close
+#include <sys/param.h>  // MAXPATHLEN
+#include <sys/types.h>  // getaddrinfo
+#include <sys/stat.h>   // fstat
+#include <sys/socket.h> // getaddrinfo
+#include <netdb.h>      // getaddrinfo
+#include <netinet/in.h> // IPPROTO_TCP
+
+#include "../include/ipvxformat.h"
+#include "../include/get_option.h"
+#include "../include/cb_buffer.h"
+#include "./memc.h"
+
+#define MEMCPORTLEN       10
+#define EXPIRATION        120
+
+#define REPLAYGET         0
+#define REPLAYSET         1
+#define REPLAYREPLACE     2
+#define REPLAYDELETE      3
+#define REPLAYOPS         4
+#define REPLAYKEYLEN      24     // "memc-replay:" and the hash, if the keys were not captured
+#define REPLAYMAXTHREADS  256
+#define REPLAYMAXVALUE    ( 1024*1024 )
+
+typedef struct replay_op {
+	memc_record             rec;
+	uchar                  *key;          // in the capture or in 'keys'
+	long                    seq;          // in the file
+} replay_op;
+
+typedef struct replay_config {
+	int                     threads;      // -t
+	int                     emptypad;
+	double                  speed;        // -s, 0 is without waiting
+	uchar                  *value;        // read only, REPLAYMAXVALUE bytes
+	unsigned long long int  start;        // CLOCK_MONOTONIC nanoseconds of timestamp 0
+} replay_config;
+
+typedef struct replay_thread {
+	pthread_t               thr;
+	MEMC                   *cm;
+	replay_config          *cfg;
+	replay_op              *ops;          // of the keys of the thread, in the captured order
+	long                    opcount;
+	long                    count[ REPLAYOPS ];
+	long                    errors[ REPLAYOPS ];
+	long                    misses;
+	unsigned long long int  maxlag;       // nanoseconds after the schedule
+	unsigned long long int  sumlag;
+	unsigned long long int *lat[ REPLAYOPS ]; // nanoseconds
+	unsigned long long int *orig[ REPLAYOPS ]; // captured, nanoseconds
+	uchar                  *msg;          // GET buffer
+} replay_thread;
+
+int  main( int argc, char *argv[] );
+void usage( char *progname[] );
+static int get_ip_and_port(unsigned char **ip, int *iplen, unsigned char **port, int *portlen, char *ipandport[], int len);
+static unsigned long long int replay_time_nsec( void );
+static int    replay_op_index( int opcode );
+static int    replay_load( const char *filename, uchar **data, long *datalen, replay_op **ops, long *opcount, uchar **keys );
+static void*  replay_run_thr( void *prm );
+static int    replay_compare( const void *a, const void *b );
+static int    replay_compare_ops( const void *a, const void *b ); // timestamp, then the order in the file
+static unsigned long long int replay_percentile( unsigned long long int *lat, long count, double pct );
+static void   replay_report( replay_config *cfg, replay_thread *rt, unsigned long long int elapsed );
+
+void usage (char *progname[]){
+        fprintf(stderr,"Usage:\n");
+        fprintf(stderr,"\t%s [-h] -f <capture file> [ -i <host ip> ] [ -t <threads> ] [ -s <speed> ] \\\n", progname[0]);
+        fprintf(stderr,"\t\t [ -r <number of servers to copy the data> ] <memcache IP>:<port> [ <memcache2 IP>:<port2> ... ]\n");
+        fprintf(stderr,"\t-f\tFile written with memc_record_start (memc-bench -T).\n");
+        fprintf(stderr,"\t-i\tHost IP-address, default any.\n");
+        fprintf(stderr,"\t-t\tThreads sharing the client, default 16. The records of a key are sent from one thread.\n");
+        fprintf(stderr,"\t-s\tSpeed, 1 is the captured rate (default), 2 twice as fast, 0 without waiting.\n");
+        fprintf(stderr,"\t-r\tNumber of servers to copy the data.\n");
+        fprintf(stderr,"\t-h\tHelp.\n");
+        fprintf(stderr,"\n\tReports the p50 and p99 latency of each operation and of the capture, and the delay\n");
+        fprintf(stderr,"\tfrom the schedule. If the keys were not captured, the keys are made of the hashes.\n");
+}
+
+unsigned long long int  replay_time_nsec( void ){
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( (unsigned long long int) ts.tv_sec * 1000000000ULL ) + (unsigned long long int) ts.tv_nsec;
+}
+int  replay_op_index( int opcode ){
+	if( opcode==MEMCGET ) return REPLAYGET;
+	if( opcode==MEMCSET ) return REPLAYSET;
+	if( opcode==MEMCREPLACE ) return REPLAYREPLACE;
+	if( opcode==MEMCDELETE ) return REPLAYDELETE;
+	return -1;
+}
+
+/*
+ * Reads the file and copies the records to 'ops'. The keys point to 'data' or, if
+ * they were not captured, to 'keys'. */
+int  replay_load( const char *filename, uchar **data, long *datalen, replay_op **ops, long *opcount, uchar **keys ){
+	int fd = -1;
+	long pos = 0, next = 0, cnt = 0, indx = 0;
+	ssize_t got = 0;
+	struct stat st;
+	memc_record_header hdr;
+	memc_record rec;
+	uchar *buf = NULL;
+	if( filename==NULL || data==NULL || datalen==NULL || ops==NULL || opcount==NULL || keys==NULL ) return CBERRALLOC;
+
+	fd = open( filename, O_RDONLY );
+	if( fd<0 ){
+		fprintf( stderr, "\nopen '%s', errno %i '%s'.", filename, errno, strerror( errno ) );
+		return CBERRFILEOP;
+	}
+	if( fstat( fd, &st )!=0 || st.st_size<(off_t) sizeof( memc_record_header ) ){
+		fprintf( stderr, "\n'%s' is not a capture.", filename );
+		close( fd );
+		return CBERRFILEOP;
+	}
+	buf = (uchar*) malloc( (size_t) st.st_size );
+	if( buf==NULL ){ close( fd ); return CBERRALLOC; }
+	while( pos<(long) st.st_size ){
+		got = read( fd, &buf[ pos ], (size_t) ( (long) st.st_size - pos ) );
+		if( got<0 && errno==EINTR ) continue;
+		if( got<=0 ) break;
+		pos += (long) got;
+	}
+	close( fd );
+	if( pos<(long) st.st_size ){
+		fprintf( stderr, "\nread '%s', errno %i '%s'.", filename, errno, strerror( errno ) );
+		free( buf );
+		return CBERRFILEOP;
+	}
+
+	memcpy( &hdr, &buf[0], sizeof( memc_record_header ) );
+	if( memcmp( &hdr.magic[0], MEMCRECORDMAGIC, 8 )!=0 || hdr.size!=(uint) sizeof( memc_record ) ){
+		fprintf( stderr, "\n'%s' is not a capture of this version.", filename );
+		free( buf );
+		return CBERRFILEOP;
+	}
+
+	/*
+	 * Count, the last record may be cut if the capture was not stopped. */
+	pos = (long) sizeof( memc_record_header );
+	while( pos + (long) sizeof( memc_record ) <= (long) st.st_size ){
+		memcpy( &rec, &buf[ pos ], sizeof( memc_record ) );
+		next = pos + (long) sizeof( memc_record ) + ( ( ( hdr.flags & MEMCRECORDKEYS )!=0 ) ? (long) rec.keylen : 0 );
+		if( next>(long) st.st_size ) break;
+		pos = next;
+		++cnt;
+	}
+
+	*ops = (replay_op*) calloc( (size_t) ( cnt + 1 ), sizeof( replay_op ) );
+	*keys = (uchar*) malloc( sizeof( uchar ) * (size_t) ( cnt + 1 ) * REPLAYKEYLEN );
+	if( *ops==NULL || *keys==NULL ){ free( buf ); return CBERRALLOC; }
+	pos = (long) sizeof( memc_record_header );
+	for( indx=0; indx<cnt; ++indx ){
+		memcpy( &(*ops)[ indx ].rec, &buf[ pos ], sizeof( memc_record ) );
+		(*ops)[ indx ].seq = indx;
+		pos += (long) sizeof( memc_record );
+		if( ( hdr.flags & MEMCRECORDKEYS )!=0 ){
+			(*ops)[ indx ].key = &buf[ pos ];
+			pos += (long) (*ops)[ indx ].rec.keylen;
+		}else{
+			(*ops)[ indx ].key = &(*keys)[ indx * REPLAYKEYLEN ];
+			(*ops)[ indx ].rec.keylen = (ushort) snprintf( &(* (char*) (*ops)[ indx ].key ), (size_t) REPLAYKEYLEN, "memc-replay:%08x", (*ops)[ indx ].rec.keyhash );
+		}
+	}
+	*data = &buf[0];
+	*datalen = (long) st.st_size;
+	*opcount = cnt;
+	return CBSUCCESS;
+}
+
+void* replay_run_thr( void *prm ){
+	replay_thread *rt = (replay_thread*) prm;
+	replay_config *cfg = NULL;
+	replay_op *op = NULL;
+	uchar *key = NULL, *msg = NULL, *value = NULL;
+	int msglen = 0, valuelen = 0, err = CBSUCCESS, opindx = 0;
+	uint cas = 0;
+	long indx = 0;
+	unsigned long long int due = 0, now = 0, lag = 0;
+	struct timespec ts;
+	if( rt==NULL ) return NULL;
+	cfg = (*rt).cfg;
+	msg = &(*rt).msg[0];
+	value = &(*cfg).value[0];
+
+	for( indx=0; indx<(*rt).opcount; ++indx ){
+		op = &(*rt).ops[ indx ];
+		opindx = replay_op_index( (int) (*op).rec.opcode );
+		if( opindx<0 ) continue;
+
+		/*
+		 * Wait for the time of the record. */
+		now = replay_time_nsec();
+		if( (*cfg).speed>0 ){
+			due = (*cfg).start + (unsigned long long int) ( (double) (*op).rec.timestamp * 1000.0 / (*cfg).speed );
+			if( now<due ){
+				ts.tv_sec = (time_t) ( due / 1000000000ULL );
+				ts.tv_nsec = (long) ( due % 1000000000ULL );
+				while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL )==EINTR );
+				now = replay_time_nsec();
+			}
+			lag = ( now>due ) ? now - due : 0;
+			(*rt).sumlag += lag;
+			if( lag>(*rt).maxlag ) (*rt).maxlag = lag;
+		}
+
+		key = &(*op).key[0];
+		if( opindx==REPLAYGET ){
+			msglen = 0; cas = 0;
+			err = memc_get( &(*(*rt).cm), &key, (int) (*op).rec.keylen, &msg, &msglen, REPLAYMAXVALUE, &cas, 0 );
+			if( err==MEMCKEYNOTFOUND || err==MEMCRECVKEYNOTFOUND ){
+				++(*rt).misses;
+				err = CBSUCCESS;
+			}
+		}else if( opindx==REPLAYDELETE ){
+			err = memc_delete( &(*(*rt).cm), &key, (int) (*op).rec.keylen, 0, 0 );
+			if( err==MEMCKEYNOTFOUND || err==MEMCRECVKEYNOTFOUND ) err = CBSUCCESS;
+		}else{
+			valuelen = ( (*op).rec.msglen<REPLAYMAXVALUE ) ? (int) (*op).rec.msglen : REPLAYMAXVALUE - 1;
+			if( valuelen<1 ) valuelen = 1;
+			if( opindx==REPLAYREPLACE )
+				err = memc_replace( &(*(*rt).cm), &key, (int) (*op).rec.keylen, &value, valuelen, 0, 0, EXPIRATION );
+			else
+				err = memc_set( &(*(*rt).cm), &key, (int) (*op).rec.keylen, &value, valuelen, 0, 0, EXPIRATION );
+		}
+		(*rt).lat[ opindx ][ (*rt).count[ opindx ] ] = replay_time_nsec() - now;
+		(*rt).orig[ opindx ][ (*rt).count[ opindx ] ] = (unsigned long long int) (*op).rec.latency * 1000;
+		++(*rt).count[ opindx ];
+		if( err>=CBERROR || ( err!=CBSUCCESS && opindx==REPLAYGET ) )
+			++(*rt).errors[ opindx ];
+	}
+	return NULL;
+}
+
+int  replay_compare( const void *a, const void *b ){
+	unsigned long long int x = * (const unsigned long long int *) a, y = * (const unsigned long long int *) b;
+	return ( x<y ) ? -1 : ( ( x>y ) ? 1 : 0 );
+}
+int  replay_compare_ops( const void *a, const void *b ){
+	const replay_op *x = (const replay_op *) a, *y = (const replay_op *) b;
+	if( (*x).rec.timestamp!=(*y).rec.timestamp )
+		return ( (*x).rec.timestamp<(*y).rec.timestamp ) ? -1 : 1;
+	return ( (*x).seq<(*y).seq ) ? -1 : ( ( (*x).seq>(*y).seq ) ? 1 : 0 );
+}
+/*
+ * 'lat' sorted. Nearest rank. */
+unsigned long long int  replay_percentile( unsigned long long int *lat, long count, double pct ){
+	long rank = 0;
+	if( lat==NULL || count<=0 ) return 0;
+	rank = (long) ( ( pct / 100.0 ) * (double) count + 0.999999 ) - 1;
+	if( rank<0 ) rank = 0;
+	if( rank>=count ) rank = count - 1;
+	return lat[ rank ];
+}
+
+void  replay_report( replay_config *cfg, replay_thread *rt, unsigned long long int elapsed ){
+	static const char *names[ REPLAYOPS ] = { "get", "set", "replace", "delete" };
+	int op = 0, t = 0, k = 0;
+	long count = 0, errors = 0, misses = 0, total = 0;
+	unsigned long long int *all = NULL, maxlag = 0, sumlag = 0;
+	unsigned long long int pct[ 2 ][ 3 ];
+	double secs = (double) elapsed / 1000000000.0;
+
+	for( t=0; t<(*cfg).threads; ++t ){
+		for( op=0; op<REPLAYOPS; ++op ) total += rt[ t ].count[ op ];
+		misses += rt[ t ].misses;
+		sumlag += rt[ t ].sumlag;
+		if( rt[ t ].maxlag>maxlag ) maxlag = rt[ t ].maxlag;
+	}
+	printf( "\nthreads %i, speed %.2f, replicas %i", (*cfg).threads, (*cfg).speed, (*rt[0].cm).redundant_servers_count );
+	printf( "\n%.3f s, %ld requests, %.1f requests/s, GET misses %ld", secs, total, ( secs>0 ) ? (double) total / secs : 0.0, misses );
+	if( (*cfg).speed>0 )
+		printf( "\nbehind the schedule: mean %.1f us, max %.1f us", ( total>0 ) ? (double) sumlag / (double) total / 1000.0 : 0.0, (double) maxlag / 1000.0 );
+	printf( "\n%-8s %10s %10s %10s %10s %8s %12s %12s", "op", "count", "p50 us", "p99 us", "max us", "errors", "capture p50", "capture p99" );
+
+	for( op=0; op<REPLAYOPS; ++op ){
+		count = 0; errors = 0;
+		for( t=0; t<(*cfg).threads; ++t ){
+			count += rt[ t ].count[ op ];
+			errors += rt[ t ].errors[ op ];
+		}
+		if( count<=0 ) continue;
+		memset( &pct[0][0], 0x00, sizeof( pct ) );
+		all = (unsigned long long int*) malloc( sizeof( unsigned long long int ) * (size_t) count );
+		for( k=0; k<2 && all!=NULL; ++k ){
+			count = 0;
+			for( t=0; t<(*cfg).threads; ++t ){
+				memcpy( &all[ count ], ( k==0 ) ? &rt[ t ].lat[ op ][0] : &rt[ t ].orig[ op ][0], sizeof( unsigned long long int ) * (size_t) rt[ t ].count[ op ] );
+				count += rt[ t ].count[ op ];
+			}
+			qsort( &all[0], (size_t) count, sizeof( unsigned long long int ), &replay_compare );
+			pct[ k ][0] = replay_percentile( &all[0], count, 50.0 );
+			pct[ k ][1] = replay_percentile( &all[0], count, 99.0 );
+			pct[ k ][2] = all[ count - 1 ];
+		}
+		free( all );
+		all = NULL;
+		printf( "\n%-8s %10ld %10.1f %10.1f %10.1f %8ld %12.1f %12.1f", names[ op ], count, (double) pct[0][0] / 1000.0, (double) pct[0][1] / 1000.0,
+			(double) pct[0][2] / 1000.0, errors, (double) pct[1][0] / 1000.0, (double) pct[1][1] / 1000.0 );
+	}
+	printf( "\n" );
+	fflush( stdout );
+}
+
+int  main( int argc, char *argv[] ){
+	int fromend = 0, atoms = 0, i = 0, indx = 0, num = 0, u = 0, t = 0, op = 0, err = CBSUCCESS;
+	long opcount = 0, datalen = 0, recindx = 0;
+	long *threadops = NULL;
+	char *str_err = NULL;
+	char *value = NULL;
+	const char *hostip = NULL;
+	const char *filename = NULL;
+	struct addrinfo  hints;
+	unsigned long long int start = 0, elapsed = 0;
+	replay_config cfg;
+	replay_thread *rt = NULL;
+	replay_op *ops = NULL;
+	uchar *data = NULL, *keys = NULL;
+        unsigned char  ipdata[ MAXPATHLEN+1 ];
+        unsigned char *ip=NULL;
+	int            iplen=0;
+        unsigned char  portdata[ MEMCPORTLEN+1 ];
+        unsigned char *port=NULL;
+	int            portlen=0;
+	uchar          keydata[ REPLAYKEYLEN ];
+	uchar         *key = &keydata[0];
+	MEMC *cm = NULL;
+
+	memset( &cfg, 0x00, sizeof( replay_config ) );
+	cfg.threads = 16;
+	cfg.speed = 1.0;
+
+	err = memc_allocate( &cm );
+	if( err>=CBERROR ){
+	  fprintf( stderr, "\nmemc_allocate, error %i, errno %i '%s'.", err, errno, strerror( errno ) );
+	  exit( err );
+	}
+
+        memset( &portdata[0], 0x20, (size_t) MEMCPORTLEN );
+        portdata[ MEMCPORTLEN ] = '\0';
+        port = &portdata[0];
+        memset( &ipdata[0], 0x20, (size_t) MAXPATHLEN );
+        ipdata[ MAXPATHLEN ]='\0';
+        ip = &ipdata[0];
+
+        atoms=argc;
+        if( argv[(atoms-1)]==NULL && argc>0 )
+          --atoms;
+        fromend = atoms-1;
+
+        /*
+         * Memcached ip and port, as in main.c. */
+        if ( atoms >= 2 ){
+	  i = -1;
+	  while( fromend>=1 && strncmp(argv[fromend],"-",1)!=0 && i<IPUFERROR && num<MEMCMAXSESSIONDBS ){
+            i = IPUFERROR;
+            if( strchr(argv[fromend],(int)':')!=NULL )
+              i = get_ip_and_port( &ip, &iplen, &port, &portlen, &argv[fromend], (int) strlen(argv[fromend]) );
+            if( i < IPUFERROR ){
+              --fromend;
+	      if( iplen>=MAXPATHLEN || portlen>=MEMCPORTLEN ){
+		fprintf( stderr, "\nIP or port length was over the limit." );
+		exit(-1);
+	      }
+	      (*(*cm).sesdbparams[ num ]).ip = (uchar *) malloc( (size_t) sizeof( char ) * ( iplen + 1 ) );
+	      (*(*cm).sesdbparams[ num ]).port = (uchar *) malloc( (size_t) sizeof( char ) * ( portlen + 1 ) );
+	      if( (*(*cm).sesdbparams[ num ]).ip==NULL || (*(*cm).sesdbparams[ num ]).port==NULL ) exit( CBERRALLOC );
+	      memcpy( &(*(*cm).sesdbparams[ num ]).ip[0], &ip[0], (size_t) iplen );
+	      (*(*cm).sesdbparams[ num ]).ip[ iplen ] = '\0';
+	      (*(*cm).sesdbparams[ num ]).iplen = iplen;
+	      memcpy( &(*(*cm).sesdbparams[ num ]).port[0], &port[0], (size_t) portlen );
+	      (*(*cm).sesdbparams[ num ]).port[ portlen ] = '\0';
+	      (*(*cm).sesdbparams[ num ]).portlen = portlen;
+	      ++num;
+            }
+	  }
+        }
+	(*cm).redundant_servers_count = 1;
+	(*cm).session_databases = num;
+
+        for( i=1 ; i<=fromend ; ++i ){
+          u = get_option( argv[i], argv[i+1], 'f', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            filename = value;
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'i', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            hostip = value;
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 't', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.threads = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 's', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) cfg.speed = strtod( value, &str_err );
+            continue;
+          }
+          u = get_option( argv[i], argv[i+1], 'r', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+            if( value!=NULL ) (*cm).redundant_servers_count = (int) strtol( value, &str_err, 10 );
+            continue;
+          }
+          u = get_option( argv[i], NULL, 'h', &value );
+          if( u == GETOPTSUCCESS || u == GETOPTSUCCESSATTACHED || u == GETOPTSUCCESSPOSSIBLEVALUE ){
+	    usage( &(argv[0]) );
+            exit( CBSUCCESS );
+          }
+	}
+
+	if( num<=0 || filename==NULL ){
+	  usage( &(argv[0]) );
+          exit( CBSUCCESS );
+	}
+
+	/*
+	 * Limits. */
+	if( cfg.threads<1 ) cfg.threads = 1;
+	if( cfg.threads>REPLAYMAXTHREADS ) cfg.threads = REPLAYMAXTHREADS;
+	if( cfg.speed<0 ) cfg.speed = 0;
+	if( (*cm).redundant_servers_count<1 ) (*cm).redundant_servers_count = 1;
+	if( (*cm).session_databases < (*cm).redundant_servers_count ){
+		fprintf( stderr, "\nNumber of session databases was smaller than the redundant servers count, using the number of session databases." );
+		(*cm).redundant_servers_count = (*cm).session_databases;
+	}
+
+	err = replay_load( filename, &data, &datalen, &ops, &opcount, &keys );
+	if( err!=CBSUCCESS ) exit( err );
+	if( opcount<=0 ){
+	  fprintf( stderr, "\n'%s': no records.\n", filename );
+	  exit( CBSUCCESS );
+	}
+
+	/*
+	 * Host address, any if not given. */
+	memset( &hints, 0x00, sizeof( struct addrinfo ) );
+	hints.ai_family = PF_INET;
+	hints.ai_socktype = SOCK_STREAM; hints.ai_protocol = IPPROTO_TCP;
+	hints.ai_flags = ( hostip==NULL ) ? AI_PASSIVE : 0;
+	err = getaddrinfo( hostip, "0", &hints, &(*cm).server_address_list );
+	if( err!=0 ){
+		fprintf( stderr, "\n'%s': Error %i in getaddrinfo, '%s'.", argv[0], err, gai_strerror( err ) );
+		exit( err );
+	}
+
+	/*
+	 * The records are written at the end of the call, in the order of the start time here.
+	 * The records of a key to one thread. */
+	qsort( &ops[0], (size_t) opcount, sizeof( replay_op ), &replay_compare_ops );
+	cfg.value = (uchar*) malloc( sizeof( uchar ) * REPLAYMAXVALUE );
+	rt = (replay_thread*) calloc( (size_t) cfg.threads, sizeof( replay_thread ) );
+	threadops = (long*) calloc( (size_t) cfg.threads, sizeof( long ) );
+	if( cfg.value==NULL || rt==NULL || threadops==NULL ){
+	  fprintf( stderr, "\nmalloc, error %i.", CBERRALLOC );
+	  exit( CBERRALLOC );
+	}
+	for( indx=0; indx<REPLAYMAXVALUE; ++indx )
+		cfg.value[ indx ] = (uchar) ( 'a' + ( indx % 26 ) );
+	for( recindx=0; recindx<opcount; ++recindx )
+		++threadops[ ops[ recindx ].rec.keyhash % (uint) cfg.threads ];
+	for( t=0; t<cfg.threads; ++t ){
+		rt[ t ].cm = &(*cm);
+		rt[ t ].cfg = &cfg;
+		rt[ t ].ops = (replay_op*) malloc( sizeof( replay_op ) * (size_t) ( threadops[ t ] + 1 ) );
+		for( op=0; op<REPLAYOPS; ++op ){
+			rt[ t ].lat[ op ] = (unsigned long long int*) malloc( sizeof( unsigned long long int ) * (size_t) ( threadops[ t ] + 1 ) );
+			rt[ t ].orig[ op ] = (unsigned long long int*) malloc( sizeof( unsigned long long int ) * (size_t) ( threadops[ t ] + 1 ) );
+			if( rt[ t ].lat[ op ]==NULL || rt[ t ].orig[ op ]==NULL ) exit( CBERRALLOC );
+		}
+		rt[ t ].msg = (uchar*) malloc( sizeof( uchar ) * REPLAYMAXVALUE );
+		if( rt[ t ].ops==NULL || rt[ t ].msg==NULL ){
+		  fprintf( stderr, "\nmalloc, error %i.", CBERRALLOC );
+		  exit( CBERRALLOC );
+		}
+	}
+	for( recindx=0; recindx<opcount; ++recindx ){
+		t = (int) ( ops[ recindx ].rec.keyhash % (uint) cfg.threads );
+		rt[ t ].ops[ rt[ t ].opcount++ ] = ops[ recindx ];
+	}
+
+	signal( SIGPIPE, SIG_IGN );
+	err = memc_init( &(*cm) );
+	if( err>=CBERROR ){ fprintf( stderr, "\nmemc_init, error %i.", err ); exit( err ); }
+	indx = snprintf( &(* (char*) key), (size_t) REPLAYKEYLEN, "memc-replay" );
+	err = memc_connect( &(*cm), &key, indx );
+	if( err>=CBERROR ){ fprintf( stderr, "\nmemc_connect, error %i.", err ); exit( err ); }
+	memc_wait_all( &(*cm) );
+
+	/*
+	 * Run, the first record is sent after the threads have started. */
+	cfg.start = replay_time_nsec() + 10000000ULL - (unsigned long long int) ( (double) ops[0].rec.timestamp * 1000.0 / ( ( cfg.speed>0 ) ? cfg.speed : 1.0 ) );
+	start = replay_time_nsec();
+	for( t=0; t<cfg.threads; ++t )
+		if( pthread_create( &rt[ t ].thr, NULL, &replay_run_thr, &rt[ t ] )!=0 ) exit( MEMCERRTHREAD );
+	for( t=0; t<cfg.threads; ++t )
+		pthread_join( rt[ t ].thr, NULL );
+	memc_wait_all( &(*cm) );
+	elapsed = replay_time_nsec() - start;
+	replay_report( &cfg, &rt[0], elapsed );
+
+	err = memc_quit( &(*cm) );
+	if( err>=CBERROR ){ fprintf( stderr, "\nmemc_quit, error %i.", err ); }
+	memc_wait_all( &(*cm) );
+
+	for( t=0; t<cfg.threads; ++t ){
+		for( op=0; op<REPLAYOPS; ++op ){
+			free( rt[ t ].lat[ op ] );
+			free( rt[ t ].orig[ op ] );
+		}
+		free( rt[ t ].ops );
+		free( rt[ t ].msg );
+	}
+	free( rt );
+	free( threadops );
+	free( ops );
+	free( keys );
+	free( data );
+	free( cfg.value );
+	err = memc_free( cm );
+	if( err>=CBERROR ){
+	  fprintf( stderr, "\nmemc_free, error %i.", err );
+	  exit( err );
+	}
+	return CBSUCCESS;
+}
+int get_ip_and_port(unsigned char **ip, int *iplen, unsigned char **port, int *portlen, char *ipandport[], int len){
+        int err = CBSUCCESS;
+        int portnum = 0;
+        err = get_urlform_ip_and_port( (* (unsigned char **)  ipandport), len, &(* (unsigned char **) ip), &(*iplen), &portnum );
+        *portlen = snprintf( &(* (char**) port)[0], (size_t) MEMCPORTLEN, "%d", portnum );
+        return err;
+}
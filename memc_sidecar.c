@@ -0,0 +1,1351 @@
+/*
+ * Sidecar of the memc client, 19.10.2026. One process owns the memcached
+ * connections and serves the local worker processes over a Unix socket.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <pthread.h>    // Posix threads
+#include <stdlib.h>     // malloc
+#include <errno.h>      // errno
+#include <string.h>     // memmove
+#include <unistd.h>     // read, write
+#include <fcntl.h>      // fcntl
+#include <poll.h>       // poll
+#include <sched.h>      // sched_yield
+#include <signal.h>     // sig_atomic_t
+#include <sys/types.h>  // defines
+#include <sys/socket.h> // socket
+#include <sys/uio.h>    // writev
+#include <sys/un.h>     // sockaddr_un
+#include <sys/mman.h>   // mmap, shm_open
+#include <sys/stat.h>   // fstat
+#if defined(__linux__)
+#include <sys/syscall.h> // SYS_futex
+#include <linux/futex.h> // FUTEX_WAIT, FUTEX_WAKE
+#else
+#define FUTEX_WAIT              0      // sleeps a while instead
+#define FUTEX_WAKE              1
+#endif
+#include <limits.h>     // INT_MAX, NAME_MAX
+#include <time.h>       // timespec
+#include <stdio.h>      // snprintf
+
+#include "../include/cb_buffer.h"
+#include "../include/db_conn_param.h"
+#include "./memc.h"
+#include "./memc_log.h"
+#include "./memc_sidecar.h"
+
+#define MEMCSIDECARREADSIZE     65536  // first size of the read buffer of a worker
+#define MEMCSIDECARPOLLMS       1000   // to notice memc_sidecar_stop
+#define MEMCSIDECARFUTEXMS      100    // to notice a detach
+#define MEMCSIDECARBATCH        256    // SETs, REPLACEs and DELETEs written at once
+
+struct memc_sidecar;
+
+/*
+ * The writes of the frames of a client until the next GET, 19.10.2026. The keys and
+ * the values are in the read buffer of the client. */
+typedef struct memc_sidecar_batch {
+	memc_batch_op           op[ MEMCSIDECARBATCH ];
+	uint                    outpos[ MEMCSIDECARBATCH ]; // responces in the output buffer
+	int                     count;
+	int                     emptypad;
+} memc_sidecar_batch;
+
+/*
+ * Shared memory channel of one worker, served by its own thread. 19.10.2026 */
+typedef struct memc_sidecar_chan {
+	struct memc_sidecar    *sc;
+	memc_sidecar_shmhdr    *hdr;
+	uchar                  *reqslots;
+	uchar                  *respslots;
+	size_t                  maplen;
+	int                     stop;     // atomic, set by the poll thread, the thread unmaps
+	int                     emptypad;
+} memc_sidecar_chan;
+
+/*
+ * One connected worker process. The poll thread reads to 'buf' while 'busy'
+ * is 0, a thread of the sidecar answers the frames while 'busy' is 1. */
+typedef struct memc_sidecar_client {
+	uchar                  *buf;
+	uint                    buflen;
+	uint                    used;
+	int                     fd;       // -1 if not in use
+	int                     busy;     // atomic
+	int                     closing;  // write error in the thread, closed in the poll thread
+	int                     emptypad;
+	memc_sidecar_chan      *chan;     // shared memory channel or NULL
+	int                     passed[ MEMCSIDECARPASSED ]; // sockets returned, in the order of the frames
+	int                     npassed;
+} memc_sidecar_client;
+
+typedef struct memc_sidecar {
+	MEMC                   *cm;
+	memc_sidecar_client    *clients;
+	int                    *queue;    // ring of the client indexes
+	int                     qhead;
+	int                     qcount;
+	int                     wake[2];  // pipe, the threads wake the poll after a client is released
+	int                     mtx_created;
+	int                     channels; // atomic, threads of the shared memory channels
+	pthread_mutex_t         mtx;
+	pthread_cond_t          cond;
+	int                    *idle;     // idle sockets to lend, MEMCSIDECARIDLE for each server
+	int                     idlecount[ MEMCMAXSESSIONDBS ];
+	int                     lendmtx_created;
+	int                     emptypad;
+	pthread_mutex_t         lendmtx;
+	unsigned long int       lends;
+	unsigned long int       returns;
+} memc_sidecar;
+
+static volatile sig_atomic_t  memc_sidecar_running = 0;
+static int                    memc_sidecar_spin = -1;  // MEMCSIDECARSPIN, 0 with one processor
+
+static int    memc_sidecar_write_all( int fd, uchar *buf, size_t len );
+static int    memc_sidecar_read_all( int fd, uchar *buf, size_t len );
+static int    memc_sidecar_complete( uchar *buf, uint len, uint *framelen ); // 1 complete, 0 not yet, -1 invalid
+static int    memc_sidecar_read( memc_sidecar *sc, int indx );
+static int    memc_sidecar_release( memc_sidecar *sc, int indx );
+static void   memc_sidecar_drop( memc_sidecar_client *cl );
+static int    memc_sidecar_call( MEMC *cm, memc_sidecar_frame *req, uchar *key, uchar *msg, memc_sidecar_frame *resp, uchar *msgbuf, int msgbuflen );
+static int    memc_sidecar_answer( memc_sidecar *sc, memc_sidecar_client *cl, uchar *frame, uchar *msgbuf, uchar **out, uint *outlen, uint *outsize, int *passfd, memc_sidecar_batch *bt );
+static void   memc_sidecar_settle( MEMC *cm, memc_sidecar_batch *bt, uchar *out ); // writes the batch, statuses to the responces
+static int    memc_sidecar_send_fd( int fd, uchar *buf, size_t len, int passfd );
+static int    memc_sidecar_recv_fd( int fd, uchar *buf, size_t len, int *passfd );
+static int    memc_sidecar_healthy( int fd );
+static int    memc_sidecar_address( MEMC *cm, int dbsindx, uchar *addr, int addrbuflen ); // "ip:port", returns the length
+static int    memc_sidecar_server( memc_sidecar *sc, uchar *addr, int addrlen );         // 'sesdbparams' index
+static int    memc_sidecar_lend( memc_sidecar *sc, uchar *addr, int addrlen, int *passfd );
+static int    memc_sidecar_take( memc_sidecar *sc, memc_sidecar_client *cl, uchar *addr, int addrlen );
+static void*  memc_sidecar_thr( void *prm );
+static int    memc_sidecar_futex( uint *addr, int op, uint val );
+static int    memc_sidecar_ring_wait( uint *addr, uint val, int *waiters, int *stop, int fd );
+static void   memc_sidecar_ring_post( uint *addr, uint val, int *waiters );
+static int    memc_sidecar_attach( memc_sidecar *sc, memc_sidecar_client *cl, uchar *name, int namelen );
+static void   memc_sidecar_detach( memc_sidecar_client *cl );
+static void*  memc_sidecar_chan_thr( void *prm );
+static int    memc_sidecar_shm_request( memc_sidecar_shm *shm, uchar opcode, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration, \
+		uchar **out, int *outlen, int outbuflen, uint *outcas );
+static int    memc_sidecar_request( int fd, uchar opcode, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration, \
+		memc_sidecar_frame *resp, uchar *msgbuf, int msgbuflen );
+
+void  memc_sidecar_stop( void ){
+	memc_sidecar_running = 0;
+}
+
+int  memc_sidecar_write_all( int fd, uchar *buf, size_t len ){
+	ssize_t ret = 0;
+	size_t done = 0;
+	struct pollfd pfd;
+	while( done<len ){
+		ret = write( fd, &buf[ done ], len - done );
+		if( ret<0 && errno==EINTR ) continue;
+		if( ret<0 && ( errno==EAGAIN || errno==EWOULDBLOCK ) ){
+			pfd.fd = fd; pfd.events = POLLOUT; pfd.revents = 0;
+			poll( &pfd, 1, MEMCSIDECARPOLLMS );
+			continue;
+		}
+		if( ret<=0 ) return CBERRFILEOP;
+		done += (size_t) ret;
+	}
+	return CBSUCCESS;
+}
+int  memc_sidecar_read_all( int fd, uchar *buf, size_t len ){
+	ssize_t ret = 0;
+	size_t done = 0;
+	while( done<len ){
+		ret = read( fd, &buf[ done ], len - done );
+		if( ret<0 && errno==EINTR ) continue;
+		if( ret<=0 ) return CBERRFILEOP;
+		done += (size_t) ret;
+	}
+	return CBSUCCESS;
+}
+int  memc_sidecar_complete( uchar *buf, uint len, uint *framelen ){
+	memc_sidecar_frame frm;
+	if( buf==NULL || framelen==NULL ) return -1;
+	if( len<sizeof( memc_sidecar_frame ) ) return 0;
+	memcpy( &frm, &(*buf), sizeof( memc_sidecar_frame ) ); // not aligned in the buffer
+	if( frm.magic!=MEMCSIDECARMAGIC || frm.msglen>MEMCSIDECARMAXMSG ) return -1;
+	*framelen = (uint) sizeof( memc_sidecar_frame ) + frm.keylen + frm.msglen;
+	if( len<*framelen ) return 0;
+	return 1;
+}
+
+/*
+ * Daemon. */
+int  memc_sidecar_serve( MEMC *cm, const char *path, int workers ){
+	int err = CBSUCCESS, lfd = -1, fd = -1, indx = 0, pcount = 0, ret = 0;
+	int *pindx = NULL;
+	uchar drain[ 64 ];
+	struct sockaddr_un addr;
+	struct pollfd *pfd = NULL;
+	pthread_t *thr = NULL;
+	memc_sidecar sc;
+	if( cm==NULL || path==NULL ) return CBERRALLOC;
+	if( (*cm).token==NULL ) return MEMCUNINITIALIZED;
+	if( strlen( path )>=sizeof( addr.sun_path ) ) return CBOVERFLOW;
+	if( workers<=0 ) workers = MEMCSIDECARWORKERS;
+
+	memset( &sc, 0x00, sizeof( memc_sidecar ) );
+	sc.cm = &(*cm);
+	sc.wake[0] = -1; sc.wake[1] = -1;
+	sc.idle = (int*) malloc( sizeof( int ) * MEMCMAXSESSIONDBS * MEMCSIDECARIDLE );
+	sc.clients = (memc_sidecar_client*) malloc( sizeof( memc_sidecar_client ) * MEMCSIDECARMAXCLIENTS );
+	sc.queue = (int*) malloc( sizeof( int ) * MEMCSIDECARMAXCLIENTS );
+	pfd = (struct pollfd*) malloc( sizeof( struct pollfd ) * ( MEMCSIDECARMAXCLIENTS + 2 ) );
+	pindx = (int*) malloc( sizeof( int ) * ( MEMCSIDECARMAXCLIENTS + 2 ) );
+	thr = (pthread_t*) malloc( sizeof( pthread_t ) * (size_t) workers );
+	if( sc.clients==NULL || sc.queue==NULL || sc.idle==NULL || pfd==NULL || pindx==NULL || thr==NULL ){
+		err = CBERRALLOC;
+		goto memc_sidecar_serve_end;
+	}
+	for( indx=0; indx<MEMCSIDECARMAXCLIENTS; ++indx ){
+		sc.clients[ indx ].buf = NULL;
+		sc.clients[ indx ].buflen = 0;
+		sc.clients[ indx ].used = 0;
+		sc.clients[ indx ].fd = -1;
+		sc.clients[ indx ].busy = 0;
+		sc.clients[ indx ].closing = 0;
+		sc.clients[ indx ].chan = NULL;
+		sc.clients[ indx ].npassed = 0;
+	}
+	if( pipe( sc.wake )!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_sidecar_serve: pipe, errno %i '%s'.", errno, strerror( errno ) );
+		err = MEMCERRSOCKET;
+		goto memc_sidecar_serve_end;
+	}
+	fcntl( sc.wake[0], F_SETFL, fcntl( sc.wake[0], F_GETFL ) | O_NONBLOCK );
+	fcntl( sc.wake[1], F_SETFL, fcntl( sc.wake[1], F_GETFL ) | O_NONBLOCK );
+	if( pthread_mutex_init( &sc.mtx, NULL )!=0 || pthread_cond_init( &sc.cond, NULL )!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_sidecar_serve: pthread_mutex_init, errno %i '%s'.", errno, strerror( errno ) );
+		err = MEMCERRTHREAD;
+		goto memc_sidecar_serve_end;
+	}
+	sc.mtx_created = 1;
+	if( pthread_mutex_init( &sc.lendmtx, NULL )!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_sidecar_serve: pthread_mutex_init, errno %i '%s'.", errno, strerror( errno ) );
+		err = MEMCERRTHREAD;
+		goto memc_sidecar_serve_end;
+	}
+	sc.lendmtx_created = 1;
+
+	/*
+	 * Unix socket. */
+	lfd = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( lfd<0 ){
+		MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_sidecar_serve: socket, errno %i '%s'.", errno, strerror( errno ) );
+		err = MEMCERRSOCKET;
+		goto memc_sidecar_serve_end;
+	}
+	memset( &addr, 0x00, sizeof( struct sockaddr_un ) );
+	addr.sun_family = AF_UNIX;
+	strncpy( &addr.sun_path[0], path, sizeof( addr.sun_path ) - 1 );
+	unlink( path );
+	if( bind( lfd, (struct sockaddr*) &addr, sizeof( struct sockaddr_un ) )<0 || listen( lfd, MEMCSIDECARBACKLOG )<0 ){
+		MEMCLOG( CBLOGERR, MEMCERRBIND, "\nmemc_sidecar_serve: bind '%s', errno %i '%s'.", path, errno, strerror( errno ) );
+		err = MEMCERRBIND;
+		goto memc_sidecar_serve_end;
+	}
+	fcntl( lfd, F_SETFL, fcntl( lfd, F_GETFL ) | O_NONBLOCK );
+
+	memc_sidecar_running = 1;
+	for( indx=0; indx<workers; ++indx ){
+		if( pthread_create( &thr[ indx ], NULL, &memc_sidecar_thr, &sc )!=0 ){
+			MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_sidecar_serve: pthread_create, errno %i '%s'.", errno, strerror( errno ) );
+			break;
+		}
+	}
+	workers = indx; // the threads to join
+	if( workers==0 ){
+		memc_sidecar_running = 0;
+		err = MEMCERRTHREAD;
+	}
+
+	/*
+	 * Poll the new connections and the clients not given to the threads. */
+	while( memc_sidecar_running!=0 ){
+		pcount = 0;
+		pfd[ pcount ].fd = lfd; pfd[ pcount ].events = POLLIN; pfd[ pcount ].revents = 0; pindx[ pcount ] = -1; ++pcount;
+		pfd[ pcount ].fd = sc.wake[0]; pfd[ pcount ].events = POLLIN; pfd[ pcount ].revents = 0; pindx[ pcount ] = -1; ++pcount;
+		for( indx=0; indx<MEMCSIDECARMAXCLIENTS; ++indx ){
+			if( sc.clients[ indx ].fd<0 || __atomic_load_n( &sc.clients[ indx ].busy, __ATOMIC_ACQUIRE )!=0 )
+				continue;
+			if( sc.clients[ indx ].closing!=0 ){
+				memc_sidecar_drop( &sc.clients[ indx ] );
+				continue;
+			}
+			pfd[ pcount ].fd = sc.clients[ indx ].fd; pfd[ pcount ].events = POLLIN; pfd[ pcount ].revents = 0;
+			pindx[ pcount ] = indx;
+			++pcount;
+		}
+		ret = poll( &pfd[0], (nfds_t) pcount, MEMCSIDECARPOLLMS );
+		if( ret<0 && errno!=EINTR ){
+			MEMCLOG( CBLOGERR, MEMCERRSOCKET, "\nmemc_sidecar_serve: poll, errno %i '%s'.", errno, strerror( errno ) );
+			break;
+		}
+		if( ret<=0 ) continue;
+		if( ( pfd[1].revents & POLLIN )!=0 )
+			while( read( sc.wake[0], &drain[0], sizeof( drain ) )>0 )
+				;
+		if( ( pfd[0].revents & POLLIN )!=0 ){
+			fd = accept( lfd, NULL, NULL );
+			while( fd>=0 ){
+				for( indx=0; indx<MEMCSIDECARMAXCLIENTS && sc.clients[ indx ].fd>=0; ++indx )
+					;
+				if( indx<MEMCSIDECARMAXCLIENTS ){
+					fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+					sc.clients[ indx ].fd = fd;
+					sc.clients[ indx ].used = 0;
+					sc.clients[ indx ].closing = 0;
+				}else{
+					MEMCLOG( CBLOGWARNING, CBOVERFLOW, "\nmemc_sidecar_serve: over %i workers, connection closed.", MEMCSIDECARMAXCLIENTS );
+					close( fd );
+				}
+				fd = accept( lfd, NULL, NULL );
+			}
+		}
+		for( indx=2; indx<pcount; ++indx ){
+			if( ( pfd[ indx ].revents & ( POLLIN | POLLHUP | POLLERR ) )!=0 )
+				memc_sidecar_read( &sc, pindx[ indx ] );
+		}
+	}
+
+	/*
+	 * Stop the threads. */
+	memc_sidecar_running = 0;
+	pthread_mutex_lock( &sc.mtx );
+	pthread_cond_broadcast( &sc.cond );
+	pthread_mutex_unlock( &sc.mtx );
+	for( indx=0; indx<workers; ++indx )
+		pthread_join( thr[ indx ], NULL );
+	for( indx=0; indx<MEMCSIDECARMAXCLIENTS; ++indx )
+		memc_sidecar_detach( &sc.clients[ indx ] );
+	while( __atomic_load_n( &sc.channels, __ATOMIC_ACQUIRE )>0 )
+		sched_yield();
+
+memc_sidecar_serve_end:
+	if( lfd>=0 ){
+		close( lfd );
+		unlink( path );
+	}
+	if( sc.clients!=NULL ){
+		for( indx=0; indx<MEMCSIDECARMAXCLIENTS; ++indx ){
+			memc_sidecar_drop( &sc.clients[ indx ] );
+			if( sc.clients[ indx ].buf!=NULL ) free( sc.clients[ indx ].buf );
+		}
+		free( sc.clients );
+	}
+	if( sc.idle!=NULL ){
+		for( indx=0; indx<MEMCMAXSESSIONDBS; ++indx )
+			while( sc.idlecount[ indx ]>0 )
+				close( sc.idle[ indx*MEMCSIDECARIDLE + --sc.idlecount[ indx ] ] );
+		free( sc.idle );
+		MEMCLOG( CBLOGDEBUG, CBSUCCESS, "\nmemc_sidecar_serve: lent %lu, returned %lu sockets.", sc.lends, sc.returns );
+	}
+	if( sc.lendmtx_created!=0 )
+		pthread_mutex_destroy( &sc.lendmtx );
+	if( sc.wake[0]>=0 ) close( sc.wake[0] );
+	if( sc.wake[1]>=0 ) close( sc.wake[1] );
+	if( sc.mtx_created!=0 ){
+		pthread_cond_destroy( &sc.cond );
+		pthread_mutex_destroy( &sc.mtx );
+	}
+	if( sc.queue!=NULL ) free( sc.queue );
+	if( pfd!=NULL ) free( pfd );
+	if( pindx!=NULL ) free( pindx );
+	if( thr!=NULL ) free( thr );
+	return err;
+}
+/*
+ * Reads the frames of a client. A complete frame gives the client to a thread. */
+int  memc_sidecar_read( memc_sidecar *sc, int indx ){
+	ssize_t len = 0;
+	uint framelen = 0, newlen = 0;
+	int ret = 0;
+	int passfd = -1, cnt = 0;
+	uchar *ptr = NULL;
+	memc_sidecar_client *cl = NULL;
+	struct msghdr mh;
+	struct iovec iov;
+	struct cmsghdr *cmsg = NULL;
+	union {
+		struct cmsghdr  align;
+		char            buf[ CMSG_SPACE( sizeof( int ) * MEMCSIDECARPASSED ) ];
+	} ctl;
+	if( sc==NULL || indx<0 || indx>=MEMCSIDECARMAXCLIENTS ) return CBERRALLOC;
+	cl = &(*sc).clients[ indx ];
+	if( (*cl).buf==NULL ){
+		(*cl).buf = (uchar*) malloc( MEMCSIDECARREADSIZE );
+		if( (*cl).buf==NULL ) return CBERRALLOC;
+		(*cl).buflen = MEMCSIDECARREADSIZE;
+		(*cl).used = 0;
+	}
+	/*
+	 * A frame longer than the buffer. */
+	ret = memc_sidecar_complete( &(*cl).buf[0], (*cl).used, &framelen );
+	if( ret==0 && (*cl).used>=sizeof( memc_sidecar_frame ) && framelen>(*cl).buflen ){
+		newlen = framelen;
+		ptr = (uchar*) realloc( (*cl).buf, newlen );
+		if( ptr==NULL ) return CBERRALLOC;
+		(*cl).buf = &(*ptr);
+		(*cl).buflen = newlen;
+	}
+	if( (*cl).used<(*cl).buflen ){
+		/*
+		 * Sockets returned with MEMCSIDECARRETURN, 19.10.2026. */
+		iov.iov_base = &(*cl).buf[ (*cl).used ];
+		iov.iov_len = (*cl).buflen - (*cl).used;
+		memset( &mh, 0x00, sizeof( struct msghdr ) );
+		mh.msg_iov = &iov;
+		mh.msg_iovlen = 1;
+		mh.msg_control = &ctl.buf[0];
+		mh.msg_controllen = sizeof( ctl.buf );
+		len = recvmsg( (*cl).fd, &mh, 0 );
+		for( cmsg = CMSG_FIRSTHDR( &mh ); len>=0 && cmsg!=NULL; cmsg = CMSG_NXTHDR( &mh, cmsg ) ){
+			if( (*cmsg).cmsg_level!=SOL_SOCKET || (*cmsg).cmsg_type!=SCM_RIGHTS ) continue;
+			for( cnt=0; (size_t) cnt < ( (*cmsg).cmsg_len - CMSG_LEN( 0 ) ) / sizeof( int ); ++cnt ){
+				memcpy( &passfd, &CMSG_DATA( cmsg )[ sizeof( int ) * (size_t) cnt ], sizeof( int ) );
+				if( (*cl).npassed<MEMCSIDECARPASSED )
+					(*cl).passed[ (*cl).npassed++ ] = passfd;
+				else
+					close( passfd );
+			}
+		}
+		if( len==0 || ( len<0 && errno!=EAGAIN && errno!=EWOULDBLOCK && errno!=EINTR ) ){
+			memc_sidecar_drop( &(*cl) ); // worker closed the connection
+			return CBSUCCESS;
+		}
+		if( len>0 )
+			(*cl).used += (uint) len;
+	}
+	ret = memc_sidecar_complete( &(*cl).buf[0], (*cl).used, &framelen );
+	if( ret<0 ){
+		MEMCLOG( CBLOGWARNING, MEMCRECVINVALIDHDRERR, "\nmemc_sidecar_read: invalid frame, connection closed." );
+		memc_sidecar_drop( &(*cl) );
+		return MEMCRECVINVALIDHDRERR;
+	}
+	if( ret==1 ){
+		__atomic_store_n( &(*cl).busy, 1, __ATOMIC_RELEASE );
+		pthread_mutex_lock( &(*sc).mtx );
+		(*sc).queue[ ( (*sc).qhead + (*sc).qcount ) % MEMCSIDECARMAXCLIENTS ] = indx;
+		++(*sc).qcount;
+		pthread_cond_signal( &(*sc).cond );
+		pthread_mutex_unlock( &(*sc).mtx );
+	}
+	return CBSUCCESS;
+}
+int  memc_sidecar_release( memc_sidecar *sc, int indx ){
+	uchar one = 1;
+	if( sc==NULL ) return CBERRALLOC;
+	__atomic_store_n( &(*sc).clients[ indx ].busy, 0, __ATOMIC_RELEASE );
+	if( write( (*sc).wake[1], &one, 1 )<0 && errno!=EAGAIN ){
+		MEMCLOG( CBLOGDEBUG, CBERRFILEOP, "\nmemc_sidecar_release: write, errno %i.", errno );
+	}
+	return CBSUCCESS;
+}
+void  memc_sidecar_drop( memc_sidecar_client *cl ){
+	if( cl==NULL ) return;
+	memc_sidecar_detach( &(*cl) );
+	while( (*cl).npassed>0 )
+		close( (*cl).passed[ --(*cl).npassed ] );
+	if( (*cl).fd>=0 ) close( (*cl).fd );
+	(*cl).fd = -1;
+	(*cl).used = 0;
+	(*cl).closing = 0;
+}
+/*
+ * Calls the memc_* function of one request. A value read is in 'msgbuf'. A SET, REPLACE
+ * or DELETE is waited and the status is the status of the server. */
+int  memc_sidecar_call( MEMC *cm, memc_sidecar_frame *req, uchar *key, uchar *msg, memc_sidecar_frame *resp, uchar *msgbuf, int msgbuflen ){
+	int msglen = 0, err = CBSUCCESS;
+	uint cas = 0;
+	if( cm==NULL || req==NULL || key==NULL || msg==NULL || resp==NULL || msgbuf==NULL ) return CBERRALLOC;
+	cas = (*req).cas;
+	memset( &(*resp), 0x00, sizeof( memc_sidecar_frame ) );
+	(*resp).magic = MEMCSIDECARMAGIC;
+	(*resp).opcode = (*req).opcode;
+	(*resp).opaque = (*req).opaque;
+	switch( (*req).opcode ){
+		case MEMCGET:
+			(*resp).status = memc_get( &(*cm), &key, (int) (*req).keylen, &msgbuf, &msglen, msgbuflen, &cas, 0 );
+			if( (*resp).status==MEMCSUCCESS ){
+				(*resp).msglen = (uint) msglen;
+				(*resp).cas = cas;
+			}
+			break;
+		case MEMCSET:
+			(*resp).status = memc_set( &(*cm), &key, (int) (*req).keylen, &msg, (int) (*req).msglen, cas, 0, (*req).expiration );
+			break;
+		case MEMCREPLACE:
+			(*resp).status = memc_replace( &(*cm), &key, (int) (*req).keylen, &msg, (int) (*req).msglen, cas, 0, (*req).expiration );
+			break;
+		case MEMCDELETE:
+			(*resp).status = memc_delete( &(*cm), &key, (int) (*req).keylen, cas, 0 );
+			break;
+		default:
+			(*resp).status = MEMCUNKNOWNCOMMAND;
+			return CBSUCCESS;
+	}
+	if( (*req).opcode!=MEMCGET ){
+		err = memc_wait_key( &(*cm), &key, (int) (*req).keylen ); // also after an error, some of the replicas may have it
+		if( (*resp).status==MEMCSUCCESS )
+			(*resp).status = err;
+	}
+	return CBSUCCESS;
+}
+/*
+ * Writes the SETs, REPLACEs and DELETEs of the batch pipelined (memc_write_batch) and
+ * stores the results to their responces in 'out'. The responces are not aligned. */
+void  memc_sidecar_settle( MEMC *cm, memc_sidecar_batch *bt, uchar *out ){
+	int indx = 0, err = CBSUCCESS;
+	memc_sidecar_frame resp;
+	if( cm==NULL || bt==NULL || out==NULL || (*bt).count==0 ) return;
+	err = memc_write_batch( &(*cm), &(*bt).op[0], (*bt).count );
+	for( indx=0; indx<(*bt).count; ++indx ){
+		memcpy( &resp, &out[ (*bt).outpos[ indx ] ], sizeof( memc_sidecar_frame ) );
+		resp.status = ( err!=CBSUCCESS ) ? err : (*bt).op[ indx ].status;
+		memcpy( &out[ (*bt).outpos[ indx ] ], &resp, sizeof( memc_sidecar_frame ) );
+	}
+	(*bt).count = 0;
+}
+/*
+ * Calls the memc_* function of one request and appends the responce to 'out'. A SET,
+ * REPLACE or DELETE is added to the batch and answered in memc_sidecar_settle, the batch
+ * is written before a GET or an other request. */
+int  memc_sidecar_answer( memc_sidecar *sc, memc_sidecar_client *cl, uchar *frame, uchar *msgbuf, uchar **out, uint *outlen, uint *outsize, int *passfd, memc_sidecar_batch *bt ){
+	uint need = 0;
+	uchar *key = NULL, *msg = NULL, *ptr = NULL;
+	memc_batch_op *op = NULL;
+	memc_sidecar_frame req, resp;
+	if( sc==NULL || cl==NULL || frame==NULL || msgbuf==NULL || out==NULL || outlen==NULL || outsize==NULL || passfd==NULL || bt==NULL ) return CBERRALLOC;
+	memcpy( &req, &(*frame), sizeof( memc_sidecar_frame ) ); // not aligned in the read buffer
+	key = &frame[ sizeof( memc_sidecar_frame ) ];
+	msg = &key[ req.keylen ];
+
+	if( ( req.opcode==MEMCSET || req.opcode==MEMCREPLACE || req.opcode==MEMCDELETE ) && req.keylen>0 ){
+		if( (*bt).count>=MEMCSIDECARBATCH )
+			memc_sidecar_settle( &(*(*sc).cm), &(*bt), &(*out)[0] );
+		memset( &resp, 0x00, sizeof( memc_sidecar_frame ) );
+		resp.magic = MEMCSIDECARMAGIC;
+		resp.opcode = req.opcode;
+		resp.opaque = req.opaque;
+		op = &(*bt).op[ (*bt).count ];
+		memset( &(*op), 0x00, sizeof( memc_batch_op ) );
+		(*op).key = &key[0];
+		(*op).keylen = (int) req.keylen;
+		(*op).msg = ( req.opcode!=MEMCDELETE ) ? &msg[0] : NULL;
+		(*op).msglen = ( req.opcode!=MEMCDELETE ) ? (int) req.msglen : 0;
+		(*op).cas = req.cas;
+		(*op).expiration = req.expiration;
+		(*op).opcode = req.opcode;
+		(*bt).outpos[ (*bt).count ] = *outlen;
+		++(*bt).count;
+	}else if( req.opcode==MEMCSIDECARATTACH || req.opcode==MEMCSIDECARLEND || req.opcode==MEMCSIDECARRETURN ){
+		memset( &resp, 0x00, sizeof( memc_sidecar_frame ) );
+		resp.magic = MEMCSIDECARMAGIC;
+		resp.opcode = req.opcode;
+		resp.opaque = req.opaque;
+		if( req.opcode==MEMCSIDECARATTACH )
+			resp.status = memc_sidecar_attach( &(*sc), &(*cl), &key[0], (int) req.keylen );
+		else if( req.opcode==MEMCSIDECARLEND )
+			resp.status = memc_sidecar_lend( &(*sc), &key[0], (int) req.keylen, &(*passfd) );
+		else
+			resp.status = memc_sidecar_take( &(*sc), &(*cl), &key[0], (int) req.keylen );
+	}else{
+		memc_sidecar_settle( &(*(*sc).cm), &(*bt), &(*out)[0] ); // the writes of the client before
+		memc_sidecar_call( &(*(*sc).cm), &req, &key[0], &msg[0], &resp, &msgbuf[0], MEMCSIDECARMAXMSG );
+	}
+
+	need = *outlen + (uint) sizeof( memc_sidecar_frame ) + resp.msglen;
+	if( need>*outsize ){
+		ptr = (uchar*) realloc( *out, need );
+		if( ptr==NULL ) return CBERRALLOC;
+		*out = &(*ptr);
+		*outsize = need;
+	}
+	memcpy( &(*out)[ *outlen ], &resp, sizeof( memc_sidecar_frame ) );
+	*outlen += (uint) sizeof( memc_sidecar_frame );
+	if( resp.msglen>0 ){
+		memcpy( &(*out)[ *outlen ], &msgbuf[0], resp.msglen );
+		*outlen += resp.msglen;
+	}
+	return CBSUCCESS;
+}
+/*
+ * Answers all the complete frames of a client at once and writes the responces
+ * with one write. The SETs, REPLACEs and DELETEs between the GETs are written
+ * pipelined with memc_write_batch, the values are in the read buffer until the
+ * batch is answered and their responces have the status of the server. */
+void* memc_sidecar_thr( void *prm ){
+	int indx = 0, err = CBSUCCESS, passfd = -1;
+	uint pos = 0, framelen = 0, outlen = 0, outsize = 0;
+	uchar *msgbuf = NULL, *out = NULL;
+	memc_sidecar *sc = NULL;
+	memc_sidecar_client *cl = NULL;
+	memc_sidecar_batch *bt = NULL;
+	if( prm==NULL ){ pthread_exit( NULL ); return NULL; }
+	sc = &(* (memc_sidecar*) prm);
+	msgbuf = (uchar*) malloc( MEMCSIDECARMAXMSG );
+	outsize = MEMCSIDECARREADSIZE;
+	out = (uchar*) malloc( outsize );
+	bt = (memc_sidecar_batch*) calloc( 1, sizeof( memc_sidecar_batch ) );
+	if( msgbuf==NULL || out==NULL || bt==NULL ){
+		MEMCLOG( CBLOGERR, CBERRALLOCTHR, "\nmemc_sidecar_thr: error %i.", CBERRALLOCTHR );
+		if( msgbuf!=NULL ) free( msgbuf );
+		if( out!=NULL ) free( out );
+		if( bt!=NULL ) free( bt );
+		pthread_exit( NULL );
+		return NULL;
+	}
+	for(;;){
+		pthread_mutex_lock( &(*sc).mtx );
+		while( (*sc).qcount==0 && memc_sidecar_running!=0 )
+			pthread_cond_wait( &(*sc).cond, &(*sc).mtx );
+		if( (*sc).qcount==0 ){
+			pthread_mutex_unlock( &(*sc).mtx );
+			break;
+		}
+		indx = (*sc).queue[ (*sc).qhead ];
+		(*sc).qhead = ( (*sc).qhead + 1 ) % MEMCSIDECARMAXCLIENTS;
+		--(*sc).qcount;
+		pthread_mutex_unlock( &(*sc).mtx );
+
+		cl = &(*sc).clients[ indx ];
+		pos = 0; outlen = 0;
+		while( memc_sidecar_complete( &(*cl).buf[ pos ], (*cl).used - pos, &framelen )==1 ){
+			err = memc_sidecar_answer( &(*sc), &(*cl), &(*cl).buf[ pos ], &msgbuf[0], &out, &outlen, &outsize, &passfd, &(*bt) );
+			if( err!=CBSUCCESS ) break;
+			pos += framelen;
+			if( passfd>=0 ){
+				/*
+				 * The responces before and the responce with the lent socket. */
+				memc_sidecar_settle( &(*(*sc).cm), &(*bt), &out[0] );
+				if( memc_sidecar_write_all( (*cl).fd, &out[0], outlen - sizeof( memc_sidecar_frame ) )!=CBSUCCESS || \
+				    memc_sidecar_send_fd( (*cl).fd, &out[ outlen - sizeof( memc_sidecar_frame ) ], sizeof( memc_sidecar_frame ), passfd )!=CBSUCCESS )
+					(*cl).closing = 1;
+				close( passfd ); // the worker has it now
+				passfd = -1;
+				outlen = 0;
+			}
+		}
+
+		/*
+		 * The keys and values of the batch are in the read buffer. */
+		memc_sidecar_settle( &(*(*sc).cm), &(*bt), &out[0] );
+		if( pos>0 && pos<(*cl).used )
+			memmove( &(*cl).buf[0], &(*cl).buf[ pos ], (*cl).used - pos );
+		(*cl).used -= pos;
+
+		if( err!=CBSUCCESS || memc_sidecar_write_all( (*cl).fd, &out[0], outlen )!=CBSUCCESS )
+			(*cl).closing = 1;
+		memc_sidecar_release( &(*sc), indx );
+	}
+	free( msgbuf );
+	free( out );
+	free( bt );
+	pthread_exit( NULL );
+	return NULL;
+}
+
+/*
+ * Broker, 19.10.2026. */
+int  memc_sidecar_send_fd( int fd, uchar *buf, size_t len, int passfd ){
+	ssize_t ret = 0;
+	struct msghdr mh;
+	struct iovec iov;
+	struct cmsghdr *cmsg = NULL;
+	struct pollfd pfd;
+	union {
+		struct cmsghdr  align;
+		char            buf[ CMSG_SPACE( sizeof( int ) ) ];
+	} ctl;
+	if( buf==NULL || len==0 || passfd<0 ) return CBERRALLOC;
+	iov.iov_base = &buf[0];
+	iov.iov_len = len;
+	memset( &mh, 0x00, sizeof( struct msghdr ) );
+	memset( &ctl, 0x00, sizeof( ctl ) );
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = &ctl.buf[0];
+	mh.msg_controllen = sizeof( ctl.buf );
+	cmsg = CMSG_FIRSTHDR( &mh );
+	(*cmsg).cmsg_level = SOL_SOCKET;
+	(*cmsg).cmsg_type = SCM_RIGHTS;
+	(*cmsg).cmsg_len = CMSG_LEN( sizeof( int ) );
+	memcpy( CMSG_DATA( cmsg ), &passfd, sizeof( int ) );
+	for(;;){
+		ret = sendmsg( fd, &mh, MSG_NOSIGNAL );
+		if( ret<0 && errno==EINTR ) continue;
+		if( ret<0 && ( errno==EAGAIN || errno==EWOULDBLOCK ) ){
+			pfd.fd = fd; pfd.events = POLLOUT; pfd.revents = 0;
+			poll( &pfd, 1, MEMCSIDECARPOLLMS );
+			continue;
+		}
+		break;
+	}
+	if( ret<=0 ) return CBERRFILEOP;
+	if( (size_t) ret<len )
+		return memc_sidecar_write_all( fd, &buf[ ret ], len - (size_t) ret );
+	return CBSUCCESS;
+}
+int  memc_sidecar_recv_fd( int fd, uchar *buf, size_t len, int *passfd ){
+	ssize_t ret = 0;
+	struct msghdr mh;
+	struct iovec iov;
+	struct cmsghdr *cmsg = NULL;
+	union {
+		struct cmsghdr  align;
+		char            buf[ CMSG_SPACE( sizeof( int ) ) ];
+	} ctl;
+	if( buf==NULL || len==0 || passfd==NULL ) return CBERRALLOC;
+	*passfd = -1;
+	iov.iov_base = &buf[0];
+	iov.iov_len = len;
+	memset( &mh, 0x00, sizeof( struct msghdr ) );
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = &ctl.buf[0];
+	mh.msg_controllen = sizeof( ctl.buf );
+	do{
+		ret = recvmsg( fd, &mh, 0 );
+	}while( ret<0 && errno==EINTR );
+	if( ret<=0 ) return CBERRFILEOP;
+	for( cmsg = CMSG_FIRSTHDR( &mh ); cmsg!=NULL; cmsg = CMSG_NXTHDR( &mh, cmsg ) )
+		if( (*cmsg).cmsg_level==SOL_SOCKET && (*cmsg).cmsg_type==SCM_RIGHTS && (*cmsg).cmsg_len>=CMSG_LEN( sizeof( int ) ) )
+			memcpy( &(*passfd), CMSG_DATA( cmsg ), sizeof( int ) );
+	if( (size_t) ret<len )
+		return memc_sidecar_read_all( fd, &buf[ ret ], len - (size_t) ret );
+	return CBSUCCESS;
+}
+/*
+ * Connected, nothing to read (no responce left from the previous user). */
+int  memc_sidecar_healthy( int fd ){
+	uchar peek = 0;
+	ssize_t ret = 0;
+	if( fd<0 ) return 0;
+	ret = recv( fd, &peek, 1, MSG_PEEK | MSG_DONTWAIT );
+	return ( ret<0 && ( errno==EAGAIN || errno==EWOULDBLOCK ) ) ? 1 : 0;
+}
+int  memc_sidecar_address( MEMC *cm, int dbsindx, uchar *addr, int addrbuflen ){
+	db_conn_param *dbp = NULL;
+	if( cm==NULL || addr==NULL || dbsindx<0 || dbsindx>=MEMCMAXSESSIONDBS || (*cm).sesdbparams[ dbsindx ]==NULL ) return -1;
+	dbp = &(*(*cm).sesdbparams[ dbsindx ]);
+	if( (*dbp).ip==NULL || (*dbp).port==NULL || (*dbp).iplen<=0 || (*dbp).portlen<=0 ) return -1;
+	if( (*dbp).iplen + 1 + (*dbp).portlen > addrbuflen ) return -1;
+	memcpy( &addr[0], &(*dbp).ip[0], (size_t) (*dbp).iplen );
+	addr[ (*dbp).iplen ] = ':';
+	memcpy( &addr[ (*dbp).iplen + 1 ], &(*dbp).port[0], (size_t) (*dbp).portlen );
+	return (*dbp).iplen + 1 + (*dbp).portlen;
+}
+int  memc_sidecar_server( memc_sidecar *sc, uchar *addr, int addrlen ){
+	int indx = 0, len = 0;
+	uchar own[ MEMCSIDECARADDRLEN ];
+	if( sc==NULL || addr==NULL ) return -1;
+	for( indx=0; indx<(*(*sc).cm).session_databases && indx<MEMCMAXSESSIONDBS; ++indx ){
+		len = memc_sidecar_address( &(*(*sc).cm), indx, &own[0], MEMCSIDECARADDRLEN );
+		if( len==addrlen && memcmp( &own[0], &addr[0], (size_t) len )==0 )
+			return indx;
+	}
+	return -1;
+}
+int  memc_sidecar_lend( memc_sidecar *sc, uchar *addr, int addrlen, int *passfd ){
+	int dbsindx = -1, fd = -1, err = CBSUCCESS;
+	if( sc==NULL || addr==NULL || passfd==NULL ) return CBERRALLOC;
+	*passfd = -1;
+	dbsindx = memc_sidecar_server( &(*sc), &addr[0], addrlen );
+	if( dbsindx<0 ) return MEMCADDRESSMISSING;
+	pthread_mutex_lock( &(*sc).lendmtx );
+	while( fd<0 && (*sc).idlecount[ dbsindx ]>0 ){
+		fd = (*sc).idle[ dbsindx*MEMCSIDECARIDLE + --(*sc).idlecount[ dbsindx ] ];
+		if( memc_sidecar_healthy( fd )==0 ){
+			close( fd );
+			fd = -1;
+		}
+	}
+	pthread_mutex_unlock( &(*sc).lendmtx );
+	if( fd<0 ){
+		err = memc_server_socket( &(*(*sc).cm), dbsindx, &fd );
+		if( err!=CBSUCCESS ) return err;
+	}
+	*passfd = fd;
+	__atomic_add_fetch( &(*sc).lends, 1, __ATOMIC_RELAXED );
+	return CBSUCCESS;
+}
+int  memc_sidecar_take( memc_sidecar *sc, memc_sidecar_client *cl, uchar *addr, int addrlen ){
+	int dbsindx = -1, fd = -1, indx = 0;
+	if( sc==NULL || cl==NULL || addr==NULL ) return CBERRALLOC;
+	if( (*cl).npassed<=0 ) return CBNEGATION; // no socket with the frame
+	fd = (*cl).passed[0];
+	for( indx=1; indx<(*cl).npassed; ++indx )
+		(*cl).passed[ indx-1 ] = (*cl).passed[ indx ];
+	--(*cl).npassed;
+	__atomic_add_fetch( &(*sc).returns, 1, __ATOMIC_RELAXED );
+	dbsindx = memc_sidecar_server( &(*sc), &addr[0], addrlen );
+	if( dbsindx<0 || memc_sidecar_healthy( fd )==0 ){
+		close( fd );
+		return CBSUCCESS;
+	}
+	pthread_mutex_lock( &(*sc).lendmtx );
+	if( (*sc).idlecount[ dbsindx ]<MEMCSIDECARIDLE ){
+		(*sc).idle[ dbsindx*MEMCSIDECARIDLE + (*sc).idlecount[ dbsindx ]++ ] = fd;
+		fd = -1;
+	}
+	pthread_mutex_unlock( &(*sc).lendmtx );
+	if( fd>=0 ) close( fd );
+	return CBSUCCESS;
+}
+int  memc_sidecar_borrow( int fd, MEMC *cm ){
+	int cindx = 0, addrlen = 0, sock = -1, err = CBSUCCESS, failed = 0, len = 0;
+	int dbsindx[ MEMCMAXREDUNDANTDBS ];
+	uchar buf[ MEMCMAXREDUNDANTDBS * ( sizeof( memc_sidecar_frame ) + MEMCSIDECARADDRLEN ) ];
+	memc_sidecar_frame frm;
+	if( fd<0 || cm==NULL || (*cm).token==NULL ) return CBERRALLOC;
+	/*
+	 * All the requests with one write, one round trip. */
+	for( cindx=0; cindx<(*cm).redundant_servers_count && cindx<MEMCMAXREDUNDANTDBS; ++cindx ){
+		dbsindx[ cindx ] = memc_server_index( &(*cm), cindx );
+		addrlen = memc_sidecar_address( &(*cm), dbsindx[ cindx ], &buf[ len + (int) sizeof( memc_sidecar_frame ) ], MEMCSIDECARADDRLEN );
+		if( addrlen<=0 ) return MEMCADDRESSMISSING;
+		memset( &frm, 0x00, sizeof( memc_sidecar_frame ) );
+		frm.magic = MEMCSIDECARMAGIC;
+		frm.opcode = MEMCSIDECARLEND;
+		frm.keylen = (ushort) addrlen;
+		frm.opaque = (uint) cindx;
+		memcpy( &buf[ len ], &frm, sizeof( memc_sidecar_frame ) );
+		len += (int) sizeof( memc_sidecar_frame ) + addrlen;
+	}
+	err = memc_sidecar_write_all( fd, &buf[0], (size_t) len );
+	if( err!=CBSUCCESS ) return err;
+	for( cindx=0; cindx<(*cm).redundant_servers_count && cindx<MEMCMAXREDUNDANTDBS; ++cindx ){
+		err = memc_sidecar_recv_fd( fd, (uchar*) &frm, sizeof( memc_sidecar_frame ), &sock );
+		if( err!=CBSUCCESS ) return err;
+		if( frm.magic!=MEMCSIDECARMAGIC || frm.opaque!=(uint) cindx ){
+			if( sock>=0 ) close( sock );
+			return MEMCRECVINVALIDHDRERR;
+		}
+		if( frm.status!=CBSUCCESS || sock<0 || memc_adopt_socket( &(*cm), cindx, dbsindx[ cindx ], sock )!=CBSUCCESS ){
+			MEMCLOG( CBLOGWARNING, MEMCERRCONNECT, "\nmemc_sidecar_borrow: connection %i, status %i.", cindx, frm.status );
+			if( sock>=0 ) close( sock );
+			++failed;
+		}
+		sock = -1;
+	}
+	return ( failed==0 ) ? CBSUCCESS : MEMCERRCONNECT;
+}
+int  memc_sidecar_giveback( int fd, MEMC *cm ){
+	int cindx = 0, dbsindx = 0, addrlen = 0, sock = -1, err = CBSUCCESS;
+	uchar buf[ sizeof( memc_sidecar_frame ) + MEMCSIDECARADDRLEN ];
+	memc_sidecar_frame frm;
+	if( fd<0 || cm==NULL || (*cm).token==NULL ) return CBERRALLOC;
+	for( cindx=0; cindx<(*cm).redundant_servers_count && cindx<MEMCMAXREDUNDANTDBS; ++cindx ){
+		if( memc_surrender_socket( &(*cm), cindx, &dbsindx, &sock )!=CBSUCCESS )
+			continue;
+		addrlen = memc_sidecar_address( &(*cm), dbsindx, &buf[ sizeof( memc_sidecar_frame ) ], MEMCSIDECARADDRLEN );
+		if( addrlen<=0 ){
+			close( sock );
+			continue;
+		}
+		memset( &frm, 0x00, sizeof( memc_sidecar_frame ) );
+		frm.magic = MEMCSIDECARMAGIC;
+		frm.opcode = MEMCSIDECARRETURN;
+		frm.keylen = (ushort) addrlen;
+		memcpy( &buf[0], &frm, sizeof( memc_sidecar_frame ) );
+		err = memc_sidecar_send_fd( fd, &buf[0], sizeof( memc_sidecar_frame ) + (size_t) addrlen, sock );
+		close( sock );
+		if( err==CBSUCCESS )
+			err = memc_sidecar_recv( fd, &frm, NULL, 0 );
+		if( err!=CBSUCCESS ) return err;
+	}
+	return CBSUCCESS;
+}
+
+/*
+ * Thin client. */
+int  memc_sidecar_connect( const char *path, int *fd ){
+	struct sockaddr_un addr;
+	if( path==NULL || fd==NULL ) return CBERRALLOC;
+	if( strlen( path )>=sizeof( addr.sun_path ) ) return CBOVERFLOW;
+	*fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( *fd<0 ) return MEMCERRSOCKET;
+	memset( &addr, 0x00, sizeof( struct sockaddr_un ) );
+	addr.sun_family = AF_UNIX;
+	strncpy( &addr.sun_path[0], path, sizeof( addr.sun_path ) - 1 );
+	if( connect( *fd, (struct sockaddr*) &addr, sizeof( struct sockaddr_un ) )<0 ){
+		close( *fd );
+		*fd = -1;
+		return MEMCERRCONNECT;
+	}
+	return CBSUCCESS;
+}
+int  memc_sidecar_close( int fd ){
+	if( fd>=0 ) close( fd );
+	return CBSUCCESS;
+}
+int  memc_sidecar_send( int fd, memc_sidecar_frame *frm, uchar *key, uchar *msg ){
+	ssize_t ret = 0;
+	size_t len = 0;
+	struct iovec iov[3];
+	if( fd<0 || frm==NULL || ( key==NULL && (*frm).keylen>0 ) || ( msg==NULL && (*frm).msglen>0 ) ) return CBERRALLOC;
+	if( (*frm).msglen>MEMCSIDECARMAXMSG ) return CBOVERFLOW;
+	(*frm).magic = MEMCSIDECARMAGIC;
+	iov[0].iov_base = &(*frm); iov[0].iov_len = sizeof( memc_sidecar_frame );
+	iov[1].iov_base = &(*key); iov[1].iov_len = (*frm).keylen;
+	iov[2].iov_base = &(*msg); iov[2].iov_len = (*frm).msglen;
+	len = sizeof( memc_sidecar_frame ) + (*frm).keylen + (*frm).msglen;
+	ret = writev( fd, &iov[0], 3 );
+	if( ret<0 && errno!=EINTR ) return CBERRFILEOP;
+	if( ret<0 ) ret = 0;
+	if( (size_t) ret==len ) return CBSUCCESS;
+	/*
+	 * The rest. */
+	if( (size_t) ret<sizeof( memc_sidecar_frame ) ){
+		if( memc_sidecar_write_all( fd, &(* (uchar*) frm) + ret, sizeof( memc_sidecar_frame ) - (size_t) ret )!=CBSUCCESS ) return CBERRFILEOP;
+		ret = (ssize_t) sizeof( memc_sidecar_frame );
+	}
+	ret -= (ssize_t) sizeof( memc_sidecar_frame );
+	if( (size_t) ret<(*frm).keylen ){
+		if( memc_sidecar_write_all( fd, &key[ ret ], (*frm).keylen - (size_t) ret )!=CBSUCCESS ) return CBERRFILEOP;
+		ret = (ssize_t) (*frm).keylen;
+	}
+	ret -= (ssize_t) (*frm).keylen;
+	if( (size_t) ret<(*frm).msglen ){
+		if( memc_sidecar_write_all( fd, &msg[ ret ], (*frm).msglen - (size_t) ret )!=CBSUCCESS ) return CBERRFILEOP;
+	}
+	return CBSUCCESS;
+}
+int  memc_sidecar_recv( int fd, memc_sidecar_frame *frm, uchar *msg, int msgbuflen ){
+	uint left = 0, len = 0;
+	uchar skip[ 256 ];
+	if( fd<0 || frm==NULL ) return CBERRALLOC;
+	if( memc_sidecar_read_all( fd, &(* (uchar*) frm), sizeof( memc_sidecar_frame ) )!=CBSUCCESS ) return CBERRFILEOP;
+	if( (*frm).magic!=MEMCSIDECARMAGIC || (*frm).msglen>MEMCSIDECARMAXMSG ) return MEMCRECVINVALIDHDRERR;
+	if( (*frm).msglen==0 ) return CBSUCCESS;
+	if( msg!=NULL && msgbuflen>=0 && (*frm).msglen<=(uint) msgbuflen )
+		return memc_sidecar_read_all( fd, &msg[0], (*frm).msglen );
+	/*
+	 * Does not fit, read past it. */
+	for( left = (*frm).msglen; left>0; left -= len ){
+		len = ( left<sizeof( skip ) ) ? left : (uint) sizeof( skip );
+		if( memc_sidecar_read_all( fd, &skip[0], len )!=CBSUCCESS ) return CBERRFILEOP;
+	}
+	return CBOVERFLOW;
+}
+int  memc_sidecar_request( int fd, uchar opcode, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration, \
+		memc_sidecar_frame *resp, uchar *msgbuf, int msgbuflen ){
+	int err = CBSUCCESS;
+	memc_sidecar_frame req;
+	if( key==NULL || *key==NULL || resp==NULL ) return CBERRALLOC;
+	if( keylen<=0 || keylen>65535 || msglen<0 ) return CBOVERFLOW;
+	memset( &req, 0x00, sizeof( memc_sidecar_frame ) );
+	req.opcode = opcode;
+	req.keylen = (ushort) keylen;
+	req.expiration = expiration;
+	req.msglen = (uint) msglen;
+	req.cas = cas;
+	err = memc_sidecar_send( fd, &req, &(**key), ( msg!=NULL ) ? &(**msg) : NULL );
+	if( err!=CBSUCCESS ) return err;
+	err = memc_sidecar_recv( fd, &(*resp), &(*msgbuf), msgbuflen );
+	if( err!=CBSUCCESS ) return err;
+	return (*resp).status;
+}
+int  memc_sidecar_get( int fd, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas ){
+	int err = CBSUCCESS;
+	memc_sidecar_frame resp;
+	if( msg==NULL || *msg==NULL || msglen==NULL || cas==NULL ) return CBERRALLOC;
+	err = memc_sidecar_request( fd, MEMCGET, &(*key), keylen, NULL, 0, 0, 0, &resp, &(**msg), msgbuflen );
+	if( err==MEMCSUCCESS ){
+		*msglen = (int) resp.msglen;
+		*cas = resp.cas;
+	}
+	return err;
+}
+int  memc_sidecar_set( int fd, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration ){
+	memc_sidecar_frame resp;
+	if( msg==NULL || *msg==NULL ) return CBERRALLOC;
+	return memc_sidecar_request( fd, MEMCSET, &(*key), keylen, &(*msg), msglen, cas, expiration, &resp, NULL, 0 );
+}
+int  memc_sidecar_replace( int fd, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration ){
+	memc_sidecar_frame resp;
+	if( msg==NULL || *msg==NULL ) return CBERRALLOC;
+	return memc_sidecar_request( fd, MEMCREPLACE, &(*key), keylen, &(*msg), msglen, cas, expiration, &resp, NULL, 0 );
+}
+int  memc_sidecar_delete( int fd, uchar **key, int keylen, uint cas ){
+	memc_sidecar_frame resp;
+	return memc_sidecar_request( fd, MEMCDELETE, &(*key), keylen, NULL, 0, cas, 0, &resp, NULL, 0 );
+}
+
+/*
+ * Shared memory channel, 19.10.2026. */
+int  memc_sidecar_futex( uint *addr, int op, uint val ){
+	struct timespec ts;
+#if defined(__linux__)
+	if( op==FUTEX_WAIT ){
+		ts.tv_sec = 0;
+		ts.tv_nsec = MEMCSIDECARFUTEXMS * 1000000L;
+		return (int) syscall( SYS_futex, &(*addr), FUTEX_WAIT, val, &ts, NULL, 0 );
+	}
+	return (int) syscall( SYS_futex, &(*addr), FUTEX_WAKE, INT_MAX, NULL, NULL, 0 );
+#else
+	if( op==FUTEX_WAIT ){
+		ts.tv_sec = 0;
+		ts.tv_nsec = 50000L;
+		return nanosleep( &ts, NULL );
+	}
+	return 0;
+#endif
+}
+/*
+ * Waits until '*addr' is not 'val'. Spins first, the futex only if the other side is slower.
+ * Returns CBNEGATION if '*stop' was set or the other end of the socket 'fd' closed. */
+int  memc_sidecar_ring_wait( uint *addr, uint val, int *waiters, int *stop, int fd ){
+	int spin = 0;
+	ssize_t ret = 0;
+	uchar peek = 0;
+	if( addr==NULL || waiters==NULL ) return CBERRALLOC;
+	if( __atomic_load_n( &memc_sidecar_spin, __ATOMIC_RELAXED )<0 )
+		__atomic_store_n( &memc_sidecar_spin, ( sysconf( _SC_NPROCESSORS_ONLN )>1 ) ? MEMCSIDECARSPIN : 0, __ATOMIC_RELAXED );
+	for( spin=0; spin<memc_sidecar_spin; ++spin )
+		if( __atomic_load_n( &(*addr), __ATOMIC_ACQUIRE )!=val )
+			return CBSUCCESS;
+	while( __atomic_load_n( &(*addr), __ATOMIC_ACQUIRE )==val ){
+		if( stop!=NULL && __atomic_load_n( &(*stop), __ATOMIC_ACQUIRE )!=0 ) return CBNEGATION;
+		if( fd>=0 ){
+			ret = recv( fd, &peek, 1, MSG_PEEK | MSG_DONTWAIT );
+			if( ret==0 || ( ret<0 && errno!=EAGAIN && errno!=EWOULDBLOCK && errno!=EINTR ) ) return CBNEGATION;
+		}
+		__atomic_add_fetch( &(*waiters), 1, __ATOMIC_SEQ_CST );
+		if( __atomic_load_n( &(*addr), __ATOMIC_SEQ_CST )==val )
+			memc_sidecar_futex( &(*addr), FUTEX_WAIT, val );
+		__atomic_sub_fetch( &(*waiters), 1, __ATOMIC_SEQ_CST );
+	}
+	return CBSUCCESS;
+}
+/*
+ * Publishes and wakes the other side only if it sleeps. */
+void  memc_sidecar_ring_post( uint *addr, uint val, int *waiters ){
+	__atomic_store_n( &(*addr), val, __ATOMIC_SEQ_CST );
+	if( __atomic_load_n( &(*waiters), __ATOMIC_SEQ_CST )>0 )
+		memc_sidecar_futex( &(*addr), FUTEX_WAKE, 0 );
+}
+int  memc_sidecar_attach( memc_sidecar *sc, memc_sidecar_client *cl, uchar *name, int namelen ){
+	int fd = -1, err = 0;
+	char shmname[ NAME_MAX+1 ];
+	struct stat st;
+	uchar *map = NULL;
+	memc_sidecar_shmhdr *hdr = NULL;
+	memc_sidecar_chan *chan = NULL;
+	pthread_t thr;
+	pthread_attr_t attr;
+	if( sc==NULL || cl==NULL || name==NULL ) return CBERRALLOC;
+	if( namelen<=0 || namelen>NAME_MAX ) return CBOVERFLOW;
+	if( (*cl).chan!=NULL ) return CBNEGATION; // one channel for each connection
+	memcpy( &shmname[0], &name[0], (size_t) namelen );
+	shmname[ namelen ] = '\0';
+
+	fd = shm_open( &shmname[0], O_RDWR, 0 );
+	if( fd<0 ){
+		MEMCLOG( CBLOGERR, CBERRFILEOP, "\nmemc_sidecar_attach: shm_open '%s', errno %i '%s'.", &shmname[0], errno, strerror( errno ) );
+		return CBERRFILEOP;
+	}
+	if( fstat( fd, &st )!=0 || (size_t) st.st_size<sizeof( memc_sidecar_shmhdr ) ){
+		close( fd );
+		return CBOVERFLOW;
+	}
+	map = (uchar*) mmap( NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	close( fd );
+	if( map==MAP_FAILED ){
+		MEMCLOG( CBLOGERR, CBERRFILEOP, "\nmemc_sidecar_attach: mmap, errno %i '%s'.", errno, strerror( errno ) );
+		return CBERRFILEOP;
+	}
+	hdr = (memc_sidecar_shmhdr*) &(*map);
+	if( (*hdr).magic!=MEMCSIDECARSHMMAGIC || (*hdr).slots==0 || ( (*hdr).slots & ( (*hdr).slots - 1 ) )!=0 || \
+	    (*hdr).slotsize<=sizeof( memc_sidecar_frame ) || ( (*hdr).slotsize % MEMCCACHELINE )!=0 || \
+	    sizeof( memc_sidecar_shmhdr ) + 2 * (size_t) (*hdr).slots * (size_t) (*hdr).slotsize > (size_t) st.st_size ){
+		munmap( map, (size_t) st.st_size );
+		return MEMCRECVINVALIDHDRERR;
+	}
+	chan = (memc_sidecar_chan*) malloc( sizeof( memc_sidecar_chan ) );
+	if( chan==NULL ){
+		munmap( map, (size_t) st.st_size );
+		return CBERRALLOC;
+	}
+	(*chan).sc = &(*sc);
+	(*chan).hdr = &(*hdr);
+	(*chan).reqslots = &map[ sizeof( memc_sidecar_shmhdr ) ];
+	(*chan).respslots = &(*chan).reqslots[ (size_t) (*hdr).slots * (*hdr).slotsize ];
+	(*chan).maplen = (size_t) st.st_size;
+	(*chan).stop = 0;
+
+	__atomic_add_fetch( &(*sc).channels, 1, __ATOMIC_SEQ_CST );
+	pthread_attr_init( &attr );
+	pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+	err = pthread_create( &thr, &attr, &memc_sidecar_chan_thr, &(*chan) );
+	pthread_attr_destroy( &attr );
+	if( err!=0 ){
+		MEMCLOG( CBLOGERR, MEMCERRTHREAD, "\nmemc_sidecar_attach: pthread_create, error %i.", err );
+		__atomic_sub_fetch( &(*sc).channels, 1, __ATOMIC_SEQ_CST );
+		munmap( map, (size_t) st.st_size );
+		free( chan );
+		return MEMCERRTHREAD;
+	}
+	(*cl).chan = &(*chan);
+	return CBSUCCESS;
+}
+/*
+ * From the poll thread. The channel is not used after 'stop' is set. */
+void  memc_sidecar_detach( memc_sidecar_client *cl ){
+	memc_sidecar_chan *chan = NULL;
+	memc_sidecar_shmhdr *hdr = NULL;
+	if( cl==NULL || (*cl).chan==NULL ) return;
+	chan = &(*(*cl).chan);
+	hdr = &(*(*chan).hdr);
+	(*cl).chan = NULL;
+	__atomic_store_n( &(*hdr).closed, 1, __ATOMIC_SEQ_CST );
+	__atomic_store_n( &(*chan).stop, 1, __ATOMIC_SEQ_CST );
+	/*
+	 * If already unmapped, futex returns EFAULT. */
+	memc_sidecar_futex( &(*hdr).req.head, FUTEX_WAKE, 0 );
+	memc_sidecar_futex( &(*hdr).resp.tail, FUTEX_WAKE, 0 );
+	memc_sidecar_futex( &(*hdr).resp.head, FUTEX_WAKE, 0 );
+	memc_sidecar_futex( &(*hdr).req.tail, FUTEX_WAKE, 0 );
+}
+/*
+ * Answers the requests of one channel in order. The value read is written directly to
+ * the responce slot. */
+void* memc_sidecar_chan_thr( void *prm ){
+	uint reqtail = 0, resphead = 0, mask = 0;
+	uchar *reqslot = NULL, *respslot = NULL, *key = NULL;
+	memc_sidecar_chan *chan = NULL;
+	memc_sidecar_shmhdr *hdr = NULL;
+	memc_sidecar_frame *req = NULL, *resp = NULL;
+	memc_sidecar *sc = NULL;
+	if( prm==NULL ){ pthread_exit( NULL ); return NULL; }
+	chan = &(* (memc_sidecar_chan*) prm);
+	hdr = &(*(*chan).hdr);
+	sc = &(*(*chan).sc);
+	mask = (*hdr).slots - 1;
+	reqtail = __atomic_load_n( &(*hdr).req.tail, __ATOMIC_ACQUIRE );
+	resphead = __atomic_load_n( &(*hdr).resp.head, __ATOMIC_ACQUIRE );
+	for(;;){
+		if( memc_sidecar_ring_wait( &(*hdr).req.head, reqtail, &(*hdr).req.headwaiters, &(*chan).stop, -1 )!=CBSUCCESS )
+			break;
+		if( memc_sidecar_ring_wait( &(*hdr).resp.tail, resphead - (*hdr).slots, &(*hdr).resp.tailwaiters, &(*chan).stop, -1 )!=CBSUCCESS )
+			break;
+		reqslot = &(*chan).reqslots[ (size_t) ( reqtail & mask ) * (*hdr).slotsize ];
+		respslot = &(*chan).respslots[ (size_t) ( resphead & mask ) * (*hdr).slotsize ];
+		req = (memc_sidecar_frame*) &(*reqslot);
+		resp = (memc_sidecar_frame*) &(*respslot);
+		key = &reqslot[ sizeof( memc_sidecar_frame ) ];
+		if( sizeof( memc_sidecar_frame ) + (size_t) (*req).keylen + (size_t) (*req).msglen > (size_t) (*hdr).slotsize ){
+			memset( &(*resp), 0x00, sizeof( memc_sidecar_frame ) );
+			(*resp).magic = MEMCSIDECARMAGIC;
+			(*resp).opcode = (*req).opcode;
+			(*resp).opaque = (*req).opaque;
+			(*resp).status = CBOVERFLOW;
+		}else{
+			memc_sidecar_call( &(*(*sc).cm), &(*req), &key[0], &key[ (*req).keylen ], &(*resp), \
+				&respslot[ sizeof( memc_sidecar_frame ) ], (int) ( (*hdr).slotsize - sizeof( memc_sidecar_frame ) ) ); // waited before the slot is reused
+		}
+		++reqtail;
+		memc_sidecar_ring_post( &(*hdr).req.tail, reqtail, &(*hdr).req.tailwaiters );
+		++resphead;
+		memc_sidecar_ring_post( &(*hdr).resp.head, resphead, &(*hdr).resp.headwaiters );
+	}
+	munmap( (void*) hdr, (*chan).maplen );
+	free( chan );
+	__atomic_sub_fetch( &(*sc).channels, 1, __ATOMIC_SEQ_CST );
+	pthread_exit( NULL );
+	return NULL;
+}
+
+/*
+ * Shared memory channel of a worker. */
+int  memc_sidecar_shm_open( const char *path, memc_sidecar_shm **shm, int slots, int slotsize ){
+	static uint count = 0;
+	int fd = -1, err = CBSUCCESS;
+	char name[ 64 ];
+	uchar *map = NULL;
+	memc_sidecar_frame frm;
+	if( path==NULL || shm==NULL ) return CBERRALLOC;
+	if( slots<=0 ) slots = MEMCSIDECARSLOTS;
+	if( slotsize<=0 ) slotsize = MEMCSIDECARSLOTSIZE;
+	if( ( slots & ( slots - 1 ) )!=0 ) return CBOVERFLOW;
+	slotsize = ( slotsize + MEMCCACHELINE - 1 ) & ~( MEMCCACHELINE - 1 );
+	if( (size_t) slotsize<=sizeof( memc_sidecar_frame ) ) return CBOVERFLOW;
+
+	*shm = (memc_sidecar_shm*) malloc( sizeof( memc_sidecar_shm ) );
+	if( *shm==NULL ) return CBERRALLOC;
+	(**shm).hdr = NULL;
+	(**shm).maplen = sizeof( memc_sidecar_shmhdr ) + 2 * (size_t) slots * (size_t) slotsize;
+	err = memc_sidecar_connect( &(*path), &(**shm).fd );
+	if( err!=CBSUCCESS ){
+		free( *shm ); *shm = NULL;
+		return err;
+	}
+
+	snprintf( &name[0], sizeof( name ), "/memc.%i.%u", (int) getpid(), __atomic_add_fetch( &count, 1, __ATOMIC_SEQ_CST ) );
+	fd = shm_open( &name[0], O_RDWR | O_CREAT | O_EXCL, 0600 );
+	if( fd<0 ){
+		MEMCLOG( CBLOGERR, CBERRFILEOP, "\nmemc_sidecar_shm_open: shm_open '%s', errno %i '%s'.", &name[0], errno, strerror( errno ) );
+		err = CBERRFILEOP;
+		goto memc_sidecar_shm_open_err;
+	}
+	if( ftruncate( fd, (off_t) (**shm).maplen )!=0 ){
+		err = CBERRFILEOP;
+		goto memc_sidecar_shm_open_err;
+	}
+	map = (uchar*) mmap( NULL, (**shm).maplen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	close( fd ); fd = -1;
+	if( map==MAP_FAILED ){
+		err = CBERRFILEOP;
+		goto memc_sidecar_shm_open_err;
+	}
+	(**shm).hdr = (memc_sidecar_shmhdr*) &(*map); // zeroed by ftruncate
+	(*(**shm).hdr).slots = (uint) slots;
+	(*(**shm).hdr).slotsize = (uint) slotsize;
+	(*(**shm).hdr).magic = MEMCSIDECARSHMMAGIC;
+	(**shm).reqslots = &map[ sizeof( memc_sidecar_shmhdr ) ];
+	(**shm).respslots = &(**shm).reqslots[ (size_t) slots * (size_t) slotsize ];
+
+	memset( &frm, 0x00, sizeof( memc_sidecar_frame ) );
+	frm.opcode = MEMCSIDECARATTACH;
+	frm.keylen = (ushort) strlen( &name[0] );
+	err = memc_sidecar_send( (**shm).fd, &frm, (uchar*) &name[0], NULL );
+	if( err==CBSUCCESS )
+		err = memc_sidecar_recv( (**shm).fd, &frm, NULL, 0 );
+	if( err==CBSUCCESS )
+		err = frm.status;
+	shm_unlink( &name[0] ); // mapped by both or failed
+	if( err==CBSUCCESS )
+		return CBSUCCESS;
+
+memc_sidecar_shm_open_err:
+	if( fd>=0 ) close( fd );
+	shm_unlink( &name[0] );
+	memc_sidecar_shm_close( &(*shm) );
+	return err;
+}
+int  memc_sidecar_shm_close( memc_sidecar_shm **shm ){
+	if( shm==NULL || *shm==NULL ) return CBSUCCESS;
+	memc_sidecar_close( (**shm).fd ); // detaches
+	if( (**shm).hdr!=NULL )
+		munmap( (void*) (**shm).hdr, (**shm).maplen );
+	free( *shm );
+	*shm = NULL;
+	return CBSUCCESS;
+}
+int  memc_sidecar_shm_reserve( memc_sidecar_shm *shm, int keylen, memc_sidecar_frame **frm, uchar **key, uchar **msg, int *msgbuflen ){
+	uint head = 0;
+	uchar *slot = NULL;
+	memc_sidecar_shmhdr *hdr = NULL;
+	if( shm==NULL || (*shm).hdr==NULL || frm==NULL || key==NULL || msg==NULL || msgbuflen==NULL ) return CBERRALLOC;
+	hdr = &(*(*shm).hdr);
+	if( keylen<=0 || keylen>65535 || sizeof( memc_sidecar_frame ) + (size_t) keylen > (size_t) (*hdr).slotsize ) return CBOVERFLOW;
+	head = __atomic_load_n( &(*hdr).req.head, __ATOMIC_RELAXED ); // written only here
+	if( memc_sidecar_ring_wait( &(*hdr).req.tail, head - (*hdr).slots, &(*hdr).req.tailwaiters, &(*hdr).closed, (*shm).fd )!=CBSUCCESS )
+		return MEMCERRCONNECT;
+	slot = &(*shm).reqslots[ (size_t) ( head & ( (*hdr).slots - 1 ) ) * (*hdr).slotsize ];
+	*frm = (memc_sidecar_frame*) &(*slot);
+	memset( &(**frm), 0x00, sizeof( memc_sidecar_frame ) );
+	(**frm).magic = MEMCSIDECARMAGIC;
+	(**frm).keylen = (ushort) keylen;
+	*key = &slot[ sizeof( memc_sidecar_frame ) ];
+	*msg = &(*key)[ keylen ];
+	*msgbuflen = (int) ( (*hdr).slotsize - sizeof( memc_sidecar_frame ) ) - keylen;
+	return CBSUCCESS;
+}
+int  memc_sidecar_shm_commit( memc_sidecar_shm *shm ){
+	uint head = 0;
+	if( shm==NULL || (*shm).hdr==NULL ) return CBERRALLOC;
+	head = __atomic_load_n( &(*(*shm).hdr).req.head, __ATOMIC_RELAXED );
+	memc_sidecar_ring_post( &(*(*shm).hdr).req.head, head + 1, &(*(*shm).hdr).req.headwaiters );
+	return CBSUCCESS;
+}
+int  memc_sidecar_shm_wait( memc_sidecar_shm *shm, memc_sidecar_frame **frm, uchar **msg ){
+	uint tail = 0;
+	uchar *slot = NULL;
+	memc_sidecar_shmhdr *hdr = NULL;
+	if( shm==NULL || (*shm).hdr==NULL || frm==NULL || msg==NULL ) return CBERRALLOC;
+	hdr = &(*(*shm).hdr);
+	tail = __atomic_load_n( &(*hdr).resp.tail, __ATOMIC_RELAXED ); // written only here
+	if( memc_sidecar_ring_wait( &(*hdr).resp.head, tail, &(*hdr).resp.headwaiters, &(*hdr).closed, (*shm).fd )!=CBSUCCESS )
+		return MEMCERRCONNECT;
+	slot = &(*shm).respslots[ (size_t) ( tail & ( (*hdr).slots - 1 ) ) * (*hdr).slotsize ];
+	*frm = (memc_sidecar_frame*) &(*slot);
+	*msg = &slot[ sizeof( memc_sidecar_frame ) ];
+	return CBSUCCESS;
+}
+int  memc_sidecar_shm_release( memc_sidecar_shm *shm ){
+	uint tail = 0;
+	if( shm==NULL || (*shm).hdr==NULL ) return CBERRALLOC;
+	tail = __atomic_load_n( &(*(*shm).hdr).resp.tail, __ATOMIC_RELAXED );
+	memc_sidecar_ring_post( &(*(*shm).hdr).resp.tail, tail + 1, &(*(*shm).hdr).resp.tailwaiters );
+	return CBSUCCESS;
+}
+int  memc_sidecar_shm_request( memc_sidecar_shm *shm, uchar opcode, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration, \
+		uchar **out, int *outlen, int outbuflen, uint *outcas ){
+	int err = CBSUCCESS, bufferlen = 0;
+	uchar *slotkey = NULL, *slotmsg = NULL;
+	memc_sidecar_frame *frm = NULL;
+	if( key==NULL || *key==NULL ) return CBERRALLOC;
+	err = memc_sidecar_shm_reserve( &(*shm), keylen, &frm, &slotkey, &slotmsg, &bufferlen );
+	if( err!=CBSUCCESS ) return err;
+	if( msglen<0 || msglen>bufferlen ) return CBOVERFLOW;
+	(*frm).opcode = opcode;
+	(*frm).expiration = expiration;
+	(*frm).msglen = (uint) msglen;
+	(*frm).cas = cas;
+	memcpy( &slotkey[0], &(**key), (size_t) keylen );
+	if( msglen>0 && msg!=NULL && *msg!=NULL )
+		memcpy( &slotmsg[0], &(**msg), (size_t) msglen );
+	memc_sidecar_shm_commit( &(*shm) );
+
+	err = memc_sidecar_shm_wait( &(*shm), &frm, &slotmsg );
+	if( err!=CBSUCCESS ) return err;
+	err = (*frm).status;
+	if( err==MEMCSUCCESS && out!=NULL && *out!=NULL && outlen!=NULL ){
+		if( (*frm).msglen>(uint) outbuflen ){
+			err = CBOVERFLOW;
+		}else{
+			memcpy( &(**out), &slotmsg[0], (*frm).msglen );
+			*outlen = (int) (*frm).msglen;
+			if( outcas!=NULL ) *outcas = (*frm).cas;
+		}
+	}
+	memc_sidecar_shm_release( &(*shm) );
+	return err;
+}
+int  memc_sidecar_shm_get( memc_sidecar_shm *shm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas ){
+	if( msg==NULL || *msg==NULL || msglen==NULL || cas==NULL ) return CBERRALLOC;
+	return memc_sidecar_shm_request( &(*shm), MEMCGET, &(*key), keylen, NULL, 0, 0, 0, &(*msg), &(*msglen), msgbuflen, &(*cas) );
+}
+int  memc_sidecar_shm_set( memc_sidecar_shm *shm, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration ){
+	if( msg==NULL || *msg==NULL ) return CBERRALLOC;
+	return memc_sidecar_shm_request( &(*shm), MEMCSET, &(*key), keylen, &(*msg), msglen, cas, expiration, NULL, NULL, 0, NULL );
+}
+int  memc_sidecar_shm_delete( memc_sidecar_shm *shm, uchar **key, int keylen, uint cas ){
+	return memc_sidecar_shm_request( &(*shm), MEMCDELETE, &(*key), keylen, NULL, 0, cas, 0, NULL, NULL, 0, NULL );
+}
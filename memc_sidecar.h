@@ -0,0 +1,138 @@
+/*
+ * Sidecar of the memc client, 19.10.2026. One process owns the memcached
+ * connections and serves the local worker processes over a Unix socket.
+ *
+ * Copyright (C) March 2018, November 2018. Jouni Laakso
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ * following disclaimer in the documentation and/or other materials provided with the distribution.
+ * Neither the name of the copyright owners nor the names of its contributors may be used to endorse or promote
+ * products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define MEMCSIDECARMAGIC        0x6d63        // 'mc'
+#define MEMCSIDECARMAXMSG       ( 1024*1024 ) // largest value
+#define MEMCSIDECARMAXCLIENTS   1024
+#define MEMCSIDECARWORKERS      4             // threads calling the memc_* functions
+#define MEMCSIDECARBACKLOG      128
+
+/*
+ * Frame, the same in both directions. Key and value follow the header. The
+ * byte order is the byte order of the host (local socket only).
+ *
+ * Requests from one worker are answered in the order they were sent. A worker
+ * may send several requests before reading the responces. */
+typedef struct memc_sidecar_frame {
+	ushort                  magic;
+	uchar                   opcode;     // MEMCGET, MEMCSET, MEMCREPLACE or MEMCDELETE
+	uchar                   emptypad;
+	ushort                  keylen;
+	ushort                  expiration; // SET and REPLACE
+	int                     status;     // responce, the return value of the memc_* function, the status of the server of a SET, REPLACE or DELETE
+	uint                    msglen;     // value after the key
+	uint                    cas;
+	uint                    opaque;     // copied to the responce
+} memc_sidecar_frame;
+
+/*
+ * Daemon. Serves the workers until memc_sidecar_stop, 'cm' has to be connected. */
+int  memc_sidecar_serve( MEMC *cm, const char *path, int workers );
+void memc_sidecar_stop( void ); // from a signal handler as well
+
+/*
+ * Thin client of the workers, one blocking request at a time. */
+int  memc_sidecar_connect( const char *path, int *fd );
+int  memc_sidecar_close( int fd );
+int  memc_sidecar_get( int fd, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas );
+int  memc_sidecar_set( int fd, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration );
+int  memc_sidecar_replace( int fd, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration );
+int  memc_sidecar_delete( int fd, uchar **key, int keylen, uint cas );
+
+/*
+ * Pipelined. Send any number of requests and read the responces in the same order. */
+int  memc_sidecar_send( int fd, memc_sidecar_frame *frm, uchar *key, uchar *msg );
+int  memc_sidecar_recv( int fd, memc_sidecar_frame *frm, uchar *msg, int msgbuflen );
+
+/*
+ * Shared memory channel, 19.10.2026. The worker creates a segment with a request ring
+ * and a responce ring and the sidecar maps it (MEMCSIDECARATTACH through the socket).
+ * Both rings have one producer and one consumer. The consumer spins a while and then
+ * sleeps in futex; the producer wakes it only if it sleeps (the ring was empty). The
+ * socket stays open, closing it detaches the channel.
+ *
+ * Slot: memc_sidecar_frame, key and value. A value is written to the request slot and
+ * read from the responce slot, it is not copied through a socket. */
+#define MEMCSIDECARATTACH       0xf0          // opcode, key is the name of the segment
+#define MEMCSIDECARSHMMAGIC     0x6d637368    // 'mcsh'
+#define MEMCSIDECARSPIN         4096          // polls of an empty ring before futex
+#define MEMCSIDECARSLOTS        64            // default, power of two
+#define MEMCSIDECARSLOTSIZE     ( 64*1024 )   // default, frame, key and value
+
+typedef struct memc_sidecar_ring {
+	uint                    head __attribute__ ((aligned (MEMCCACHELINE))); // producer
+	int                     headwaiters;  // consumer sleeping, futex on 'head'
+	uint                    tail __attribute__ ((aligned (MEMCCACHELINE))); // consumer
+	int                     tailwaiters;  // producer sleeping, ring was full
+} __attribute__ ((aligned (MEMCCACHELINE))) memc_sidecar_ring;
+
+typedef struct memc_sidecar_shmhdr {
+	uint                    magic;
+	uint                    slots;
+	uint                    slotsize;
+	int                     closed;       // set by the sidecar at detach
+	memc_sidecar_ring       req;          // worker to sidecar
+	memc_sidecar_ring       resp;         // sidecar to worker
+} __attribute__ ((aligned (MEMCCACHELINE))) memc_sidecar_shmhdr; // slots of 'req' and 'resp' follow
+
+typedef struct memc_sidecar_shm {
+	memc_sidecar_shmhdr    *hdr;
+	uchar                  *reqslots;
+	uchar                  *respslots;
+	size_t                  maplen;
+	int                     fd;           // Unix socket
+	int                     emptypad;
+} memc_sidecar_shm;
+
+/*
+ * 'slots' and 'slotsize' 0 use the defaults. */
+int  memc_sidecar_shm_open( const char *path, memc_sidecar_shm **shm, int slots, int slotsize );
+int  memc_sidecar_shm_close( memc_sidecar_shm **shm );
+int  memc_sidecar_shm_get( memc_sidecar_shm *shm, uchar **key, int keylen, uchar **msg, int *msglen, int msgbuflen, uint *cas );
+int  memc_sidecar_shm_set( memc_sidecar_shm *shm, uchar **key, int keylen, uchar **msg, int msglen, uint cas, ushort expiration );
+int  memc_sidecar_shm_delete( memc_sidecar_shm *shm, uchar **key, int keylen, uint cas );
+
+/*
+ * Without copying. memc_sidecar_shm_reserve returns the next request slot: set the opcode,
+ * 'msglen' and the rest of 'frm' and write the key and value to 'key' and 'msg' ('msgbuflen'
+ * bytes after the key). memc_sidecar_shm_commit sends it. memc_sidecar_shm_wait returns the
+ * next responce in its slot, valid until memc_sidecar_shm_release. */
+int  memc_sidecar_shm_reserve( memc_sidecar_shm *shm, int keylen, memc_sidecar_frame **frm, uchar **key, uchar **msg, int *msgbuflen );
+int  memc_sidecar_shm_commit( memc_sidecar_shm *shm );
+int  memc_sidecar_shm_wait( memc_sidecar_shm *shm, memc_sidecar_frame **frm, uchar **msg );
+int  memc_sidecar_shm_release( memc_sidecar_shm *shm );
+
+/*
+ * Broker of connected sockets, 19.10.2026. memc_sidecar_borrow takes a connected socket from
+ * the sidecar for each connection of 'cm' (SCM_RIGHTS through the socket 'fd') instead of
+ * connecting. memc_sidecar_giveback returns them; the sidecar keeps the healthy ones idle for
+ * the next worker. Between the calls the memc_* functions are used as usual. */
+#define MEMCSIDECARLEND         0xf1          // opcode, key is "ip:port" of the server
+#define MEMCSIDECARRETURN       0xf2          // opcode, the socket is attached to the frame
+#define MEMCSIDECARIDLE         16            // idle sockets kept for each server
+#define MEMCSIDECARPASSED       8             // sockets received and not yet handled, for each worker
+#define MEMCSIDECARADDRLEN      512
+
+int  memc_sidecar_borrow( int fd, MEMC *cm );
+int  memc_sidecar_giveback( int fd, MEMC *cm );
@@ -5,6 +5,17 @@ IP=
 PORT1=
 PORT2=
 HOSTIP=
+MOCKPIDS=
+FAILED=0
+
+#
+# Without the servers, two mock servers on this machine, 19.10.2026
+if [ -z "${IP}" ] ; then
+  IP=127.0.0.1 ; PORT1=21211 ; PORT2=21212 ; HOSTIP=127.0.0.1
+  ./memc-mock -p ${PORT1} & MOCKPIDS="$!"
+  ./memc-mock -p ${PORT2} & MOCKPIDS="${MOCKPIDS} $!"
+  sleep 1
+fi
 
 clear
 
@@ -24,3 +35,40 @@ time ./memc -r 2 -g -k "KEYKEYKEY" -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2}
 # Delete
 echo ; echo ; echo -n "*** test DELETE ***"
 time ./memc -r 2 -d -k "KEYKEYKEY" -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2}
+# Load, 19.10.2026
+echo ; echo ; echo -n "*** benchmark ***"
+# the benchmark exits with an error if the request path allocated memory
+if ! ./memc-bench -r 2 -t 4 -n 10000 -c 10000 -z 0.99 -v 100-1000 -R 90 -P -T memc-capture.bin -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2} ; then
+  echo ; echo "*** benchmark failed ***"
+  FAILED=1
+fi
+# Replay of the benchmark twice as fast
+echo ; echo ; echo -n "*** replay ***"
+./memc-replay -f memc-capture.bin -r 2 -s 2 -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2}
+rm memc-capture.bin
+# Bulk load of a dump
+echo ; echo ; echo -n "*** load ***"
+awk 'BEGIN{ for( i=0; i<10000; ++i ) printf( "load:%i\tvalue %i\n", i, i ) }' > memc-dump.tsv
+time ./memc -r 2 -L memc-dump.tsv -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2}
+# a record filling the write buffer (MEMCLOADBUFFER) exactly at the end of a window, the next one is read back
+echo ; echo ; echo -n "*** load, full buffer ***"
+awk 'BEGIN{ printf( "full:0\t" ); for( i=0; i<262106; ++i ) printf( "x" ); printf( "\nfull:1\tend\n" ) }' > memc-dump.tsv
+./memc -r 2 -L memc-dump.tsv -W 1 -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2}
+if ! ./memc -r 2 -g -k "full:1" -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2} 2>&1 | grep -q "Value: end" ; then
+  echo ; echo "*** load, full buffer failed ***"
+  FAILED=1
+fi
+rm memc-dump.tsv
+# Batch, the writes of a key in order and read back
+echo ; echo ; echo -n "*** batch ***"
+if ! printf 'set batch:a 1\nset batch:a 2\ndelete batch:b\nget batch:a\n' | ./memc -r 2 -e 60 -b - -i ${HOSTIP} ${IP}:${PORT1} ${IP}:${PORT2} | tr '\n' ' ' | \
+    grep -q "STORED batch:a STORED batch:a NOT_FOUND batch:b VALUE batch:a 1 2" ; then
+  echo ; echo "*** batch failed ***"
+  FAILED=1
+fi
+
+if [ -n "${MOCKPIDS}" ] ; then
+  kill ${MOCKPIDS}
+fi
+
+exit ${FAILED}